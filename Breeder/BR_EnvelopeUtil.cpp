@@ -35,6 +35,32 @@
 #include <WDL/lice/lice_bezier.h>
 #include <WDL/localize/localize.h>
 
+/******************************************************************************
+* Object states                                                               *
+******************************************************************************/
+// Reads go through the SWS object state cache, so objects already read in the
+// current transaction (see SWS_CacheObjectState()) aren't fetched again. Returns
+// a copy callers can tokenize, free it with delete[]
+static char* GetObjectStateCopy (void* object)
+{
+	char* copy = NULL;
+	if (const char* state = SWS_GetSetObjectState(object, NULL))
+	{
+		size_t size = strlen(state) + 1;
+		if ((copy = new (nothrow) char[size]))
+			memcpy(copy, state, size);
+		SWS_FreeHeapPtr(state);
+	}
+	return copy;
+}
+
+// Writes are immediate since they're usually followed by API calls on the same object
+static void SetObjectState (void* object, const char* state)
+{
+	SWS_UncacheObjectState(object);
+	GetSetObjectState(object, state);
+}
+
 /******************************************************************************
 * BR_Envelope                                                                 *
 ******************************************************************************/
@@ -52,7 +78,10 @@ m_rebuildConseq (true),
 m_height        (-1),
 m_yOffset       (-1),
 m_takeEnvType   (UNKNOWN),
-m_data          (NULL)
+m_data          (NULL),
+m_tempoEditStart (-1),
+m_tempoEditEnd   (-1),
+m_tempoEditCount (0)
 {
 }
 
@@ -70,7 +99,10 @@ m_rebuildConseq (true),
 m_height        (-1),
 m_yOffset       (-1),
 m_takeEnvType   (UNKNOWN),
-m_data          (NULL)
+m_data          (NULL),
+m_tempoEditStart (-1),
+m_tempoEditEnd   (-1),
+m_tempoEditCount (0)
 {
 	if (!m_parent)
 		m_take = GetTakeEnvParent(m_envelope, &m_takeEnvType);
@@ -91,7 +123,10 @@ m_rebuildConseq (true),
 m_height        (-1),
 m_yOffset       (-1),
 m_takeEnvType   (UNKNOWN),
-m_data          (NULL)
+m_data          (NULL),
+m_tempoEditStart (-1),
+m_tempoEditEnd   (-1),
+m_tempoEditCount (0)
 {
 	this->Build(takeEnvelopesUseProjectTime);
 }
@@ -110,7 +145,10 @@ m_rebuildConseq (true),
 m_height        (-1),
 m_yOffset       (-1),
 m_takeEnvType   (m_envelope ? envType : UNKNOWN),
-m_data          (NULL)
+m_data          (NULL),
+m_tempoEditStart (-1),
+m_tempoEditEnd   (-1),
+m_tempoEditCount (0)
 {
 	this->Build(takeEnvelopesUseProjectTime);
 }
@@ -135,7 +173,10 @@ m_pointsSel       (envelope.m_pointsSel),
 m_pointsConseq    (envelope.m_pointsConseq),
 m_properties      (envelope.m_properties),
 m_chunkProperties (envelope.m_chunkProperties),
-m_envName         (envelope.m_envName)
+m_envName         (envelope.m_envName),
+m_tempoEditStart  (-1),
+m_tempoEditEnd    (-1),
+m_tempoEditCount  (0)
 {
 }
 
@@ -170,6 +211,8 @@ BR_Envelope& BR_Envelope::operator= (const BR_Envelope& envelope)
 	m_chunkProperties.Set(&envelope.m_chunkProperties);
 	m_envName.Set(&envelope.m_envName);
 
+	this->EndTempoEdit();
+
 	return *this;
 }
 
@@ -1442,6 +1485,9 @@ bool BR_Envelope::Commit (bool force /*=false*/)
 	if ((force || (m_update && !this->IsLocked())) && m_envelope)
 	{
 		// Prevents reselection of points in time selection
+		// Cached state (if any) becomes stale
+		SWS_UncacheObjectState(m_envelope);
+
 		const ConfigVar<int> envClickSegMode("envclicksegmode");
 		ConfigVarOverride<int> tempEnvClickSegMode(envClickSegMode,
 			ClearBit(envClickSegMode.value_or(0), 6));
@@ -1452,11 +1498,36 @@ bool BR_Envelope::Commit (bool force /*=false*/)
 		// Need to commit whole chunk
 		if (m_tempoMap)
 		{
-			WDL_FastString chunkStart = this->GetProperties();
-			for (vector<BR_Envelope::EnvPoint>::iterator i = m_points.begin(); i != m_points.end(); ++i)
-				i->Append(chunkStart, true);
-			chunkStart.Append(">");
-			GetSetObjectState(m_envelope, chunkStart.Get());
+			WDL_FastString chunkStart;
+			if (m_tempoEditStart >= 0 && m_tempoEditEnd < (int)m_points.size())
+			{
+				// Points outside edit range don't change so format them only once
+				if (!m_tempoChunkHead.GetLength() || m_tempoEditCount != m_points.size())
+				{
+					WDL_FastString properties = this->GetProperties();
+					m_tempoChunkHead.Set(&properties);
+					m_tempoChunkTail.Set("");
+					for (int i = 0; i < m_tempoEditStart; ++i)
+						m_points[i].Append(m_tempoChunkHead, true);
+					for (size_t i = m_tempoEditEnd + 1; i < m_points.size(); ++i)
+						m_points[i].Append(m_tempoChunkTail, true);
+					m_tempoChunkTail.Append(">");
+					m_tempoEditCount = m_points.size();
+				}
+
+				chunkStart.Set(&m_tempoChunkHead);
+				for (int i = m_tempoEditStart; i <= m_tempoEditEnd; ++i)
+					m_points[i].Append(chunkStart, true);
+				chunkStart.Append(&m_tempoChunkTail);
+			}
+			else
+			{
+				chunkStart = this->GetProperties();
+				for (vector<BR_Envelope::EnvPoint>::iterator i = m_points.begin(); i != m_points.end(); ++i)
+					i->Append(chunkStart, true);
+				chunkStart.Append(">");
+			}
+			SetObjectState(m_envelope, chunkStart.Get());
 			UpdateTempoTimeline();
 		}
 		// We can update through API (faster)
@@ -1476,7 +1547,7 @@ bool BR_Envelope::Commit (bool force /*=false*/)
 					firstPointDone = true;
 				}
 				chunkStart.Append(">");
-				GetSetObjectState(m_envelope, chunkStart.Get());
+				SetObjectState(m_envelope, chunkStart.Get());
 			}
 
 			// Delete excess points
@@ -1522,6 +1593,25 @@ bool BR_Envelope::Commit (bool force /*=false*/)
 	return false;
 }
 
+void BR_Envelope::BeginTempoEdit (int startId, int endId)
+{
+	this->EndTempoEdit();
+	if (m_tempoMap && startId >= 0 && startId <= endId)
+	{
+		m_tempoEditStart = startId;
+		m_tempoEditEnd   = endId;
+	}
+}
+
+void BR_Envelope::EndTempoEdit ()
+{
+	m_tempoEditStart = -1;
+	m_tempoEditEnd   = -1;
+	m_tempoEditCount = 0;
+	m_tempoChunkHead.Set("");
+	m_tempoChunkTail.Set("");
+}
+
 int BR_Envelope::FindFirstPoint ()
 {
 	if (m_points.empty())
@@ -1656,8 +1746,8 @@ void BR_Envelope::Build (bool takeEnvelopesUseProjectTime)
 		// Since information on partial measures is missing from the API, we need to parse the chunk for tempo map
 		if (m_tempoMap)
 		{
-			char* envState = GetSetObjectState(m_envelope, "");
-			char* token = strtok(envState, "\n");
+			char* envState = GetObjectStateCopy(m_envelope);
+			char* token = envState ? strtok(envState, "\n") : NULL;
 			LineParser lp(false);
 			bool start = false;
 			int id = -1;
@@ -1677,7 +1767,7 @@ void BR_Envelope::Build (bool takeEnvelopesUseProjectTime)
 					AppendLine(m_chunkProperties, token);
 				token = strtok(NULL, "\n");
 			}
-			FreeHeapPtr(envState);
+			delete [] envState;
 		}
 		else
 		{
@@ -1760,8 +1850,7 @@ bool BR_Envelope::FillProperties () const
 {
 	if (!m_properties.filled)
 	{
-		char* chunk    = NULL;
-		bool freeChunk = false;
+		char* chunk = NULL;
 		if (m_chunkProperties.GetLength())
 		{
 			size_t size = m_chunkProperties.GetLength()+1;
@@ -1769,10 +1858,7 @@ bool BR_Envelope::FillProperties () const
 				memcpy(chunk, m_chunkProperties.Get(), size);
 		}
 		else
-		{
-			chunk = GetSetObjectState(m_envelope, "");
-			freeChunk = true;
-		}
+			chunk = GetObjectStateCopy(m_envelope);
 
 		if (chunk)
 		{
@@ -1910,8 +1996,7 @@ bool BR_Envelope::FillProperties () const
 				token = strtok(NULL, "\n");
 			}
 
-			if (freeChunk) FreeHeapPtr(chunk);
-			else           delete [] chunk;
+			delete [] chunk;
 			m_properties.filled = true;
 		}
 	}
@@ -2234,8 +2319,8 @@ MediaTrack* GetEnvParent (TrackEnvelope* envelope)
 
 vector<int> GetSelPoints (TrackEnvelope* envelope)
 {
-	char* envState = GetSetObjectState(envelope, "");
-	char* token = strtok(envState, "\n");
+	char* envState = GetObjectStateCopy(envelope);
+	char* token = envState ? strtok(envState, "\n") : NULL;
 
 	vector<int> selectedPoints;
 	LineParser lp(false);
@@ -2251,7 +2336,7 @@ vector<int> GetSelPoints (TrackEnvelope* envelope)
 		}
 		token = strtok(NULL, "\n");
 	}
-	FreeHeapPtr(envState);
+	delete [] envState;
 	return selectedPoints;
 }
 
@@ -2315,7 +2400,7 @@ bool ToggleShowSendEnvelope (MediaTrack* track, int sendId, BR_EnvType type)
 		}
 
 		WDL_FastString newState;
-		char* trackState = GetSetObjectState(receiveTrack, "");
+		char* trackState = GetObjectStateCopy(receiveTrack);
 		bool stateUpdated = false;
 		if (trackState)
 		{
@@ -2478,10 +2563,10 @@ bool ToggleShowSendEnvelope (MediaTrack* track, int sendId, BR_EnvType type)
 
 		if (stateUpdated)
 		{
-			GetSetObjectState(receiveTrack, newState.Get());
+			SetObjectState(receiveTrack, newState.Get());
 			update = true;
 		}
-		FreeHeapPtr(trackState);
+		delete [] trackState;
 	}
 
 	return update;
@@ -2522,7 +2607,7 @@ bool ShowSendEnvelopes (vector<MediaTrack*>& tracks, BR_EnvType envelopeTypes)
 			WDL_FastString newState;
 
 			// Parse chunk and rewrite it in newState
-			char* trackState = GetSetObjectState(track, "");
+			char* trackState = GetObjectStateCopy(track);
 			if (trackState)
 			{
 				LineParser lp(false);
@@ -2634,10 +2719,10 @@ bool ShowSendEnvelopes (vector<MediaTrack*>& tracks, BR_EnvType envelopeTypes)
 
 			if (stateUpdated)
 			{
-				GetSetObjectState(track, newState.Get());
+				SetObjectState(track, newState.Get());
 				update = true;
 			}
-			FreeHeapPtr(trackState);
+			delete [] trackState;
 		}
 	}
 
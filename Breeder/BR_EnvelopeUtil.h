@@ -165,6 +165,11 @@ public:
 	/* Committing - does absolutely nothing if there are no edits or locking is turned on (unless forced) */
 	bool Commit (bool force = false);
 
+	/* Tempo map only: while edit range is set, Commit() formats only points startId-endId and reuses chunk text cached on the first commit for   *
+	*  everything else (meant for continuous actions that keep editing the same points - edit other points or properties only after EndTempoEdit()) */
+	void BeginTempoEdit (int startId, int endId);
+	void EndTempoEdit ();
+
 private:
 	struct IdPair
 	{
@@ -263,6 +268,9 @@ private:
 	WDL_FastString m_chunkProperties;
 	WDL_FastString m_envName;
 	BR_Envelope::EnvProperties mutable m_properties; // access through separate class methods (they make sure data is read and written correctly) - mutable because FillProperties must be const (to make operator== const) but still be able to change m_properties
+	int m_tempoEditStart, m_tempoEditEnd;
+	size_t m_tempoEditCount;
+	WDL_FastString m_tempoChunkHead, m_tempoChunkTail;
 };
 
 /******************************************************************************
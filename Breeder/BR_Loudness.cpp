@@ -295,6 +295,31 @@ bool BR_LoudnessObject::Analyze (bool integratedOnly, bool doTruePeak, bool doHi
 	}
 }
 
+bool BR_LoudnessObject::PrepareAnalyze (bool integratedOnly, bool doTruePeak, bool doHighPrecisionMode, bool doDualMonoMode)
+{
+	this->AbortAnalyze();
+	this->SetIntegratedOnly(integratedOnly);
+	this->SetDoTruePeak(doTruePeak);
+	this->SetDoHighPrecisionMode(doHighPrecisionMode);
+	this->SetDoDualMonoMode(doDualMonoMode);
+	this->SetKillFlag(false);
+	this->SetProgress(0);
+
+	const bool valid = this->CheckSetAudioData() != 0;
+	this->SetRunning(valid);
+	return valid;
+}
+
+void BR_LoudnessObject::AnalyzeInCurrentThread ()
+{
+	AnalyzeData((void*)this);
+}
+
+void BR_LoudnessObject::RequestAbort ()
+{
+	this->SetKillFlag(true);
+}
+
 void BR_LoudnessObject::AbortAnalyze ()
 {
 	if (this->GetProcess())
@@ -42,6 +42,9 @@ public:
 	/* Analyze */
 	bool Analyze (bool integratedOnly, bool doTruePeak, bool doHighPrecisionMode, bool doDualMonoMode);
 	void AbortAnalyze ();
+	bool PrepareAnalyze (bool integratedOnly, bool doTruePeak, bool doHighPrecisionMode, bool doDualMonoMode); // for callers running their own worker threads: call from the main thread...
+	void AnalyzeInCurrentThread ();                                                                           // ...then this one from the worker thread
+	void RequestAbort ();                                                                                     // stops AnalyzeInCurrentThread(), caller waits for its own thread
 	bool IsRunning ();
 	double GetProgress ();
 
@@ -36,6 +36,7 @@
 #include "BR_ProjState.h"
 #include "BR_Util.h"
 #include "../Prompt.h"
+#include "../Utility/ArrangeIndex.h"
 #include "../SnM/SnM.h"
 #include "../SnM/SnM_Chunk.h"
 #include "../SnM/SnM_Dlg.h"
@@ -997,21 +998,38 @@ void SelectItemsByType (COMMAND_T* ct)
 	bool checkTimeSel = ct->user & ObeyTimeSelection ? tStart != tEnd : false;
 	bool update = false;
 
-	PreventUIRefresh(1);
-	const int itemCount = CountMediaItems(NULL);
-	for (int i = 0; i < itemCount; ++i)
+	// Only look at items around the time selection when obeying it
+	WDL_TypedBuf<MediaItem*> items;
+	if (checkTimeSel)
 	{
-		MediaItem* item = GetMediaItem(NULL, i);
-		if (!IsItemLocked(item))
+		WDL_TypedBuf<MediaItem*> trackItems;
+		const int trackCount = CountTracks(NULL);
+		for (int i = 0; i < trackCount; ++i)
 		{
-			if (checkTimeSel)
+			ArrangeIndex_GetItems(GetTrack(NULL, i), tStart, tEnd, &trackItems);
+			for (int j = 0; j < trackItems.GetSize(); ++j)
 			{
+				MediaItem* item = trackItems.Get()[j];
 				double itemStart = GetMediaItemInfo_Value(item, "D_POSITION");
 				double itemEnd   = itemStart + GetMediaItemInfo_Value(item, "D_LENGTH");
-				if (!AreOverlappedEx(itemStart, itemEnd, tStart, tEnd))
-					continue;
+				if (AreOverlappedEx(itemStart, itemEnd, tStart, tEnd)) // index includes items only touching the time selection
+					items.Add(item);
 			}
+		}
+	}
+	else
+	{
+		const int itemCount = CountMediaItems(NULL);
+		for (int i = 0; i < itemCount; ++i)
+			items.Add(GetMediaItem(NULL, i));
+	}
 
+	PreventUIRefresh(1);
+	for (int i = 0; i < items.GetSize(); ++i)
+	{
+		MediaItem* item = items.Get()[i];
+		if (!IsItemLocked(item))
+		{
 			const int actionType = ct->user & ~ObeyTimeSelection;
 			MediaItem_Take* take = GetActiveTake(item);
 
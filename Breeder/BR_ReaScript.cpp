@@ -36,6 +36,7 @@
 #include "../SnM/SnM.h"
 #include "../SnM/SnM_Chunk.h"
 #include "../SnM/SnM_Util.h"
+#include "../Utility/ReaScript_Utility.hpp"
 
 /******************************************************************************
 * Globals                                                                     *
@@ -141,6 +142,37 @@ bool BR_EnvGetPoint (BR_Envelope* envelope, int id, double* positionOut, double*
 	return false;
 }
 
+// Number of elements to process: arrays are optional (NULL), but all passed ones must be big enough
+static int ArraysSize (int count, reaper_array* a1, reaper_array* a2, reaper_array* a3, reaper_array* a4, reaper_array* a5 = NULL)
+{
+	reaper_array* arrays[] = {a1, a2, a3, a4, a5};
+	for (size_t i = 0; i < sizeof(arrays) / sizeof(arrays[0]); ++i)
+		if (arrays[i] && (int)arrays[i]->size < count)
+			count = (int)arrays[i]->size;
+	return count > 0 ? count : 0;
+}
+
+int BR_EnvGetPoints (BR_Envelope* envelope, int startId, reaper_array* positions, reaper_array* values, reaper_array* shapes, reaper_array* selected, reaper_array* beziers)
+{
+	if (envelope && g_script_brenvs.Find(envelope)>=0 && envelope->ValidateId(startId))
+	{
+		const int count = ArraysSize(envelope->CountPoints() - startId, positions, values, shapes, selected, beziers);
+		for (int i = 0; i < count; ++i)
+		{
+			double position, value, bezier;
+			int shape;
+			envelope->GetPoint(startId + i, &position, &value, &shape, &bezier);
+			if (positions) positions->data[i] = position;
+			if (values)    values->data[i]    = value;
+			if (shapes)    shapes->data[i]    = shape;
+			if (selected)  selected->data[i]  = envelope->GetSelection(startId + i) ? 1 : 0;
+			if (beziers)   beziers->data[i]   = bezier;
+		}
+		return count;
+	}
+	return 0;
+}
+
 void BR_EnvGetProperties (BR_Envelope* envelope, bool* activeOut, bool* visibleOut, bool* armedOut, bool* inLaneOut, int* laneHeightOut, int* defaultShapeOut, double* minValueOut, double* maxValueOut, double* centerValueOut, int* typeOut, bool* faderScalingOut, int* AIoptionsOut)
 {
 	if (envelope && g_script_brenvs.Find(envelope)>=0)
@@ -200,6 +232,47 @@ bool BR_EnvSetPoint (BR_Envelope* envelope, int id, double position, double valu
 	return false;
 }
 
+int BR_EnvSetPoints (BR_Envelope* envelope, int startId, reaper_array* positions, reaper_array* values, reaper_array* shapes, reaper_array* selected, reaper_array* beziers)
+{
+	if (!envelope || g_script_brenvs.Find(envelope)<0)
+		return 0;
+
+	// Create new points: positions and values are mandatory
+	if (startId == -1)
+	{
+		if (!positions || !values)
+			return 0;
+
+		const int count = ArraysSize((int)positions->size, positions, values, shapes, selected, beziers);
+		for (int i = 0; i < count; ++i)
+		{
+			envelope->SetCreatePoint(-1, positions->data[i], values->data[i],
+				shapes ? (int)shapes->data[i] : -1, beziers ? beziers->data[i] : 0, selected && selected->data[i] != 0);
+		}
+		return count;
+	}
+
+	// Edit existing points, missing arrays keep current values
+	if (!envelope->ValidateId(startId))
+		return 0;
+
+	const int count = ArraysSize(envelope->CountPoints() - startId, positions, values, shapes, selected, beziers);
+	for (int i = 0; i < count; ++i)
+	{
+		const int id = startId + i;
+		double position, value, bezier;
+		int shape;
+		envelope->GetPoint(id, &position, &value, &shape, &bezier);
+		envelope->SetCreatePoint(id,
+			positions ? positions->data[i]    : position,
+			values    ? values->data[i]       : value,
+			shapes    ? (int)shapes->data[i]  : shape,
+			beziers   ? beziers->data[i]      : bezier,
+			selected  ? selected->data[i] != 0 : envelope->GetSelection(id));
+	}
+	return count;
+}
+
 void BR_EnvSetProperties (BR_Envelope* envelope, bool active, bool visible, bool armed, bool inLane, int laneHeight, int defaultShape, bool faderScaling, int* AIoptionsOptional)
 {
 	if (envelope && g_script_brenvs.Find(envelope)>=0)
@@ -237,6 +310,18 @@ double BR_EnvValueAtPos (BR_Envelope* envelope, double position)
 	return 0;
 }
 
+int BR_EnvValuesAtPos (BR_Envelope* envelope, reaper_array* positions, reaper_array* values)
+{
+	if (envelope && g_script_brenvs.Find(envelope)>=0 && positions && values)
+	{
+		const int count = ArraysSize((int)positions->size, positions, values, NULL, NULL);
+		for (int i = 0; i < count; ++i)
+			values->data[i] = envelope->ValueAtPosition(positions->data[i]);
+		return count;
+	}
+	return 0;
+}
+
 void BR_GetArrangeView (ReaProject* proj, double* startPositionOut, double* endPositionOut)
 {
 	double start, end;
@@ -325,12 +410,8 @@ MediaTrack* BR_GetMediaTrackByGUID (ReaProject* proj, const char* guidStringIn)
 	{
 		GUID guid;
 		stringToGuid(guidStringIn, &guid);
-		for (int i = 0; i < CountTracks(proj); ++i)
-		{
-			MediaTrack* track = GetTrack(proj, i);
-			if (GuidsEqual(&guid, TrackToGuid(proj, track)))
-				return track;
-		}
+		if (!GuidsEqual(&guid, &GUID_NULL)) // master track excluded, as before
+			return GuidToTrack(proj, &guid);
 	}
 	return NULL;
 }
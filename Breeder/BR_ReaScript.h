@@ -28,6 +28,7 @@
 #pragma once
 
 class BR_Envelope;
+struct reaper_array;
 
 /******************************************************************************
 * ReaScript export                                                            *
@@ -42,11 +43,14 @@ bool            BR_EnvFree (BR_Envelope* envelope, bool commit);
 MediaItem_Take* BR_EnvGetParentTake (BR_Envelope* envelope);
 MediaTrack*     BR_EnvGetParentTrack (BR_Envelope* envelope);
 bool            BR_EnvGetPoint (BR_Envelope* envelope, int id, double* positionOut, double* valueOut, int* shapeOut, bool* selectedOut, double* bezierOut);
+int             BR_EnvGetPoints (BR_Envelope* envelope, int startId, reaper_array* positions, reaper_array* values, reaper_array* shapes, reaper_array* selected, reaper_array* beziers);
 void            BR_EnvGetProperties (BR_Envelope* envelope, bool* activeOut, bool* visibleOut, bool* armedOut, bool* inLaneOut, int* laneHeightOut, int* defaultShapeOut, double* minValueOut, double* maxValueOut, double* centerValueOut, int* typeOut, bool* faderScalingOut, int* AIoptionsOut);
 bool            BR_EnvSetPoint (BR_Envelope* envelope, int id, double position, double value, int shape, bool selected, double bezier);
+int             BR_EnvSetPoints (BR_Envelope* envelope, int startId, reaper_array* positions, reaper_array* values, reaper_array* shapes, reaper_array* selected, reaper_array* beziers);
 void            BR_EnvSetProperties (BR_Envelope* envelope, bool active, bool visible, bool armed, bool inLane, int laneHeight, int defaultShape, bool faderScaling, int* AIoptions);
 void            BR_EnvSortPoints (BR_Envelope* envelope);
 double          BR_EnvValueAtPos (BR_Envelope* envelope, double position);
+int             BR_EnvValuesAtPos (BR_Envelope* envelope, reaper_array* positions, reaper_array* values);
 void            BR_GetArrangeView (ReaProject* proj, double* startPositionOut, double* endPositionOut);
 double          BR_GetClosestGridDivision (double position);
 void            BR_GetCurrentTheme (char* themePathOut, int themePathOut_sz, char* themeNameOut, int themeNameOut_sz);
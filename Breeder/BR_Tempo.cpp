@@ -133,6 +133,128 @@ static bool MoveTempo (BR_Envelope& tempoMap, int id, double timeDiff, bool chec
 	return true;
 }
 
+/******************************************************************************
+* Tempo edit session - moves one tempo marker repeatedly (continuous actions) *
+* Everything the marker affects is read once when locking it, so every move   *
+* is calculated in closed form from the original values and only the         *
+* affected range of points gets reformatted on commit                         *
+******************************************************************************/
+class BR_TempoEditSession
+{
+public:
+	BR_TempoEditSession ();
+	BR_Envelope& TempoMap ();
+	bool Lock (int id);                                  // lock tempo marker to move (can't be the first one)
+	bool Move (double timeDiff, bool checkEditedPoints); // time difference is relative to marker's position when locked
+	bool Commit ();
+	int LockedId ();
+
+private:
+	BR_Envelope m_tempoMap;
+	int m_id;
+	double m_t1, m_t2, m_t3, m_b1, m_b2, m_b3;
+	int m_s1, m_s2;
+	bool m_P3;
+	vector<double> m_chainBpm;           // linear points before previous point (going backwards from id-2), their correction direction alternates
+	double m_chainMin[2], m_chainMax[2]; // extrema of those points split by direction so legality check doesn't depend on chain length
+};
+
+BR_TempoEditSession::BR_TempoEditSession () :
+m_tempoMap (GetTempoEnv()),
+m_id       (-1)
+{
+}
+
+BR_Envelope& BR_TempoEditSession::TempoMap ()
+{
+	return m_tempoMap;
+}
+
+int BR_TempoEditSession::LockedId ()
+{
+	return m_id;
+}
+
+bool BR_TempoEditSession::Lock (int id)
+{
+	m_id = -1;
+	m_tempoMap.EndTempoEdit();
+	if (id <= 0 || !m_tempoMap.GetPoint(id, &m_t2, &m_b2, &m_s2, NULL))
+		return false;
+
+	m_tempoMap.GetPoint(id-1, &m_t1, &m_b1, &m_s1, NULL);
+	m_P3 = m_tempoMap.GetPoint(id+1, &m_t3, &m_b3, NULL, NULL);
+
+	m_chainBpm.clear();
+	for (int i = id - 2; i >= 0; --i)
+	{
+		double b; int s;
+		if (!m_tempoMap.GetPoint(i, NULL, &b, &s, NULL) || s == SQUARE)
+			break;
+
+		int direction = m_chainBpm.size() % 2;
+		if (m_chainBpm.size() < 2 || b < m_chainMin[direction]) m_chainMin[direction] = b;
+		if (m_chainBpm.size() < 2 || b > m_chainMax[direction]) m_chainMax[direction] = b;
+		m_chainBpm.push_back(b);
+	}
+
+	m_id = id;
+	m_tempoMap.BeginTempoEdit(id - 1 - (int)m_chainBpm.size(), id);
+	return true;
+}
+
+bool BR_TempoEditSession::Move (double timeDiff, bool checkEditedPoints)
+{
+	if (m_id <= 0)
+		return false;
+
+	// Same math as MoveTempo(), but since musical length between points is preserved, moving from original values gives the same result as moving incrementally
+	double Nt2 = m_t2 + timeDiff;
+	double t3 = m_t3, Nb1, Nb2;
+	if (m_P3)
+	{
+		if (m_s2 == SQUARE) Nb2 = m_b2*(m_t3-m_t2) / (m_t3-Nt2);
+		else                Nb2 = (m_b2+m_b3)*(m_t3-m_t2) / (m_t3-Nt2) - m_b3;
+	}
+	else
+	{
+		Nb2 = m_b2;
+		t3 = Nt2 + 1; // t3 is faked so it can pass legality check
+	}
+
+	if (m_s1 == SQUARE) Nb1 = m_b1*(m_t2-m_t1) / (Nt2-m_t1);
+	else                Nb1 = (m_b1+m_b2)*(m_t2-m_t1) / (Nt2-m_t1) - Nb2;
+
+	// Linear points before previous point all get the same correction, only its sign alternates
+	double correction = Nb1 - m_b1;
+	if (checkEditedPoints)
+	{
+		if (Nb2 < MIN_BPM || Nb2 > MAX_BPM || Nb1 < MIN_BPM || Nb1 > MAX_BPM) return false;
+		if ((Nt2-m_t1) < MIN_TEMPO_DIST || (t3 - Nt2) < MIN_TEMPO_DIST)     return false;
+
+		for (size_t i = 0; i < 2 && i < m_chainBpm.size(); ++i)
+		{
+			double c = (i == 0) ? correction : -correction;
+			if (m_chainMin[i] - c < MIN_BPM || m_chainMax[i] - c > MAX_BPM)
+				return false;
+		}
+	}
+
+	for (size_t i = 0; i < m_chainBpm.size(); ++i)
+	{
+		double newBpm = m_chainBpm[i] - ((i % 2) ? -correction : correction);
+		m_tempoMap.SetPoint(m_id-2-(int)i, NULL, &newBpm, NULL, NULL);
+	}
+	m_tempoMap.SetPoint(m_id-1, NULL, &Nb1, NULL, NULL);
+	m_tempoMap.SetPoint(m_id, &Nt2, &Nb2, NULL, NULL);
+	return true;
+}
+
+bool BR_TempoEditSession::Commit ()
+{
+	return m_tempoMap.Commit();
+}
+
 static bool DeleteTempo (int id, bool checkEditedPoints, TrackEnvelope* tempoEnvelope)
 {
 	if (id < 0)
@@ -271,7 +393,7 @@ static bool DeleteTempo (int id, bool checkEditedPoints, TrackEnvelope* tempoEnv
 /******************************************************************************
 * Commands: Tempo continuous actions                                          *
 ******************************************************************************/
-static BR_Envelope* g_moveGridTempoMap = NULL;
+static BR_TempoEditSession* g_moveGridSession = NULL;
 static bool         g_movedGridOnce          = false;
 static bool         g_didTempoMapInit        = false;
 static bool         g_insertedStretchMarkers = false;
@@ -307,8 +429,8 @@ static bool MoveGridInit (COMMAND_T* ct, bool init)
 	else
 	{
 		ConfigVar<int>("undomask").try_set(s_editCursorUndo);
-		delete g_moveGridTempoMap;
-		g_moveGridTempoMap = NULL;
+		delete g_moveGridSession;
+		g_moveGridSession = NULL;
 	}
 
 	g_movedGridOnce          = false;
@@ -334,13 +456,13 @@ static HCURSOR MoveGridCursor (COMMAND_T* ct, int window)
 
 static void MoveGridToMouse (COMMAND_T* ct)
 {
-	static int    s_lockedId = -1;
+	static double s_grid = 0;
 	static double s_lastPosition = 0;
 
 	// Action called for the first time: reset variables and cache tempo map for future calls
-	if (!g_moveGridTempoMap)
+	if (!g_moveGridSession)
 	{
-		s_lockedId = -1;
+		s_grid = 0;
 		s_lastPosition = 0;
 
 		// Make sure tempo map already has at least one point created (for some reason it won't work if creating it directly in chunk)
@@ -350,16 +472,17 @@ static void MoveGridToMouse (COMMAND_T* ct)
 			g_didTempoMapInit = true;
 		}
 
-		g_moveGridTempoMap = new (nothrow) BR_Envelope(GetTempoEnv());
-		if (!g_moveGridTempoMap || !g_moveGridTempoMap->CountPoints() || g_moveGridTempoMap->IsLocked())
+		g_moveGridSession = new (nothrow) BR_TempoEditSession();
+		if (!g_moveGridSession || !g_moveGridSession->TempoMap().CountPoints() || g_moveGridSession->TempoMap().IsLocked())
 		{
 			ContinuousActionStopAll();
 			return;
 		}
 	}
+	BR_Envelope& tempoMap = g_moveGridSession->TempoMap();
 
 	// Find closest grid/tempo marker
-	double tDiff = 0;
+	bool doMove = false;
 	double mousePosition = PositionAtMouseCursor(true);
 	if (mousePosition == -1)
 	{
@@ -367,10 +490,10 @@ static void MoveGridToMouse (COMMAND_T* ct)
 	}
 	else
 	{
-		// Move action was already called so use data from the previous move
+		// Move action was already called so just follow the mouse from the locked marker's original position
 		if (g_movedGridOnce)
 		{
-			tDiff = mousePosition - s_lastPosition;
+			doMove = mousePosition != s_lastPosition;
 		}
 
 		// Find or create tempo marker to move
@@ -383,41 +506,41 @@ static void MoveGridToMouse (COMMAND_T* ct)
 			if ((int)ct->user == 1 || (int)ct->user == 2)
 			{
 				grid = ((int)ct->user == 1) ? (GetClosestGridLine(mousePosition)) : (GetClosestMeasureGridLine(mousePosition));
-				targetId = g_moveGridTempoMap->Find(grid, MIN_TEMPO_DIST);
+				targetId = tempoMap.Find(grid, MIN_TEMPO_DIST);
 			}
 			// Find closest tempo marker
 			else
 			{
-				targetId = g_moveGridTempoMap->FindClosest(mousePosition);
+				targetId = tempoMap.FindClosest(mousePosition);
 				if (targetId ==0) ++targetId;
-				if (!g_moveGridTempoMap->ValidateId(targetId))
+				if (!tempoMap.ValidateId(targetId))
 					return;
-				g_moveGridTempoMap->GetPoint(targetId, &grid, NULL, NULL, NULL);
+				tempoMap.GetPoint(targetId, &grid, NULL, NULL, NULL);
 			}
 
 			// No tempo marker on grid, create it (skip if moving closest tempo marker)
-			if (!g_moveGridTempoMap->ValidateId(targetId))
+			if (!tempoMap.ValidateId(targetId))
 			{
-				int prevId = g_moveGridTempoMap->FindPrevious(grid);
-				int shape; g_moveGridTempoMap->GetPoint(prevId, NULL, NULL, &shape, NULL);
-				if (g_moveGridTempoMap->CreatePoint(prevId+1, grid, g_moveGridTempoMap->ValueAtPosition(grid), shape, 0, false))
+				int prevId = tempoMap.FindPrevious(grid);
+				int shape; tempoMap.GetPoint(prevId, NULL, NULL, &shape, NULL);
+				if (tempoMap.CreatePoint(prevId+1, grid, tempoMap.ValueAtPosition(grid), shape, 0, false))
 				targetId = prevId + 1;
 			}
 
 			// Can't move first tempo marker so ignore this move action and wait for valid mouse position
-			if (targetId != 0)
+			if (targetId != 0 && g_moveGridSession->Lock(targetId))
 			{
-				s_lockedId = targetId;
-				tDiff = mousePosition - grid;
+				tempoMap.GetPoint(targetId, &s_grid, NULL, NULL, NULL);
+				doMove = mousePosition != s_grid;
 			}
 		}
 	}
 
 	// Move grid and commit changes
-	if (tDiff != 0 && s_lockedId >= 0)
+	if (doMove)
 	{
 		// Warn user if tempo marker couldn't get processed
-		if (!g_moveGridTempoMap || !MoveTempo(*g_moveGridTempoMap, s_lockedId, tDiff, true))
+		if (!g_moveGridSession->Move(mousePosition - s_grid, true))
 		{
 			static bool s_warnUser = true;
 			if (s_warnUser)
@@ -431,10 +554,10 @@ static void MoveGridToMouse (COMMAND_T* ct)
 		else
 		{
 			if (!g_movedGridOnce)
-				g_insertedStretchMarkers = InsertStretchMarkerInAllItems(mousePosition - tDiff, true);
+				g_insertedStretchMarkers = InsertStretchMarkerInAllItems(s_grid, true);
 
 			s_lastPosition = mousePosition;
-			g_moveGridTempoMap->Commit();
+			g_moveGridSession->Commit();
 			g_movedGridOnce = true;
 		}
 	}
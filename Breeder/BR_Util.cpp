@@ -39,6 +39,7 @@
 #include "../SnM/SnM_Dlg.h"
 #include "../SnM/SnM_Item.h"
 #include "../SnM/SnM_Util.h"
+#include "../Utility/GuidIndex.h"
 
 #include <WDL/localize/localize.h>
 #include <WDL/lice/lice.h>
@@ -1361,17 +1362,7 @@ GUID GetItemGuid (MediaItem* item)
 
 MediaItem* GuidToItem (const GUID* guid, ReaProject* proj /*=NULL*/)
 {
-	if (guid)
-	{
-		const int itemCount = CountMediaItems(proj);
-		for (int i = 0; i < itemCount; ++i)
-		{
-			MediaItem* item = GetMediaItem(proj, i);
-			if (GuidsEqual((GUID*)GetSetMediaItemInfo(item, "GUID", NULL), guid))
-				return item;
-		}
-	}
-	return NULL;
+	return GuidIndex_FindItem(proj, guid);
 }
 
 WDL_FastString GetSourceChunk (PCM_source* source)
@@ -36,22 +36,82 @@
 #include "../Freeze/Freeze.h"
 #include "../SnM/SnM.h"
 #include "../SnM/SnM_CSurf.h"
+#include "../SnM/SnM_Dlg.h"
 #include "../SnM/SnM_Util.h"
 #include "Console.h"
 
 #include <WDL/localize/localize.h>
 
-ReaConsoleWnd* g_pConsoleWnd = NULL;
+#include <regex>
+
+#define CONSOLE_WND_ID		"ReaConsole"
+
+// The window is only instantiated when it was left open or is opened (lazy init)
+SNM_WindowManager<ReaConsoleWnd> g_consoleWndMgr(CONSOLE_WND_ID);
 static WDL_TypedBuf<int> g_selTracks;
 static char g_cLastKey = 0;
 static DWORD g_dwLastKeyMsg = 0;
 #define CONSOLE_WINDOWPOS_KEY "ReaConsoleWindowPos"
+#define RUN_SCRIPT_MSG 0xF001
 bool g_bCloseOnReturnPref = false;
 
 void ParseTrackId(char* strId, bool bReset = true);
 void ProcessCommand(CONSOLE_COMMAND command, const char* args);
 const char* StatusString(CONSOLE_COMMAND command, const char* args);
 
+// Batch mode: tracks and their names are cached and compiled track ids are reused for the whole
+// script, until a command changes track names or selection (see RunConsoleScript())
+typedef struct CONSOLE_BATCH
+{
+	WDL_PtrList<MediaTrack> tracks;
+	WDL_PtrList_DeleteOnDestroy<WDL_FastString> names;
+	map<string, vector<int> > trackIds;
+	bool bDirty;
+} CONSOLE_BATCH;
+
+static CONSOLE_BATCH* g_batch = NULL;
+
+static void RefreshBatch()
+{
+	if (!g_batch || !g_batch->bDirty)
+		return;
+	g_batch->tracks.Empty();
+	g_batch->names.Empty(true);
+	g_batch->trackIds.clear();
+	for (int i = 1; i <= GetNumTracks(); i++)
+	{
+		MediaTrack* tr = CSurf_TrackFromID(i, false);
+		const char* cName = (const char*)GetSetMediaTrackInfo(tr, "P_NAME", NULL);
+		g_batch->tracks.Add(tr);
+		g_batch->names.Add(new WDL_FastString(cName ? cName : ""));
+	}
+	g_batch->bDirty = false;
+}
+
+static int ConsoleNumTracks()
+{
+	if (!g_batch)
+		return GetNumTracks();
+	RefreshBatch();
+	return g_batch->tracks.GetSize();
+}
+
+// track is 0-based
+static MediaTrack* ConsoleTrack(int track)
+{
+	return g_batch ? g_batch->tracks.Get(track) : CSurf_TrackFromID(track+1, false);
+}
+
+static const char* ConsoleTrackName(int track)
+{
+	if (g_batch)
+	{
+		WDL_FastString* name = g_batch->names.Get(track);
+		return name ? name->Get() : "";
+	}
+	return (const char*)GetSetMediaTrackInfo(CSurf_TrackFromID(track+1, false), "P_NAME", NULL);
+}
+
 typedef struct CUSTOM_COMMAND
 {
 	gaccel_register_t accel;
@@ -196,15 +256,35 @@ void ParseTrackId(char* strId, bool bReset)
 	bool bChildren = false;
 	bool bInvert = false;
 
-	if (!strId || !GetNumTracks())
+	if (!strId || !ConsoleNumTracks())
 		return;
 
 	if (bReset)
 	{
-		g_selTracks.Resize(GetNumTracks(), false);
+		g_selTracks.Resize(ConsoleNumTracks(), false);
 		memset(g_selTracks.Get(), 0, g_selTracks.GetSize() * sizeof(int));
 	}
 
+	// "~regex" matches track names (case insensitive), checked first as the expression can contain any separator
+	p = strId;
+	while (*p == ' ')
+		p++;
+	if (*p == '~')
+	{
+		try
+		{
+			const std::regex re(p+1, std::regex::ECMAScript | std::regex::icase);
+			for (track = 0; track < ConsoleNumTracks(); track++)
+			{
+				cName = ConsoleTrackName(track);
+				if (cName && cName[0] && std::regex_search(cName, re))
+					g_selTracks.Get()[track] = 1;
+			}
+		}
+		catch (const std::regex_error&) {} // incomplete or invalid expression: nothing matches
+		return;
+	}
+
 	// Comma seperated list or whitespace? strip and recall
 	if (strchr(strId, ','))
 	{
@@ -244,17 +324,17 @@ void ParseTrackId(char* strId, bool bReset)
 
 	// If the string is "all" or exactly "*", select all tracks.
 	if (_stricmp(strId, __LOCALIZE("all","sws_DLG_100")) == 0 || strcmp(strId, "*") == 0)
-		for (track = 0; track < GetNumTracks(); track++)
+		for (track = 0; track < ConsoleNumTracks(); track++)
 			g_selTracks.Get()[track] = 1;
 
 	// If the string is empty, use the tracks' selected flags
 	else if (strId[0] == 0)
-		for (track = 0; track < GetNumTracks(); track++)
+		for (track = 0; track < ConsoleNumTracks(); track++)
 		{
 			// If tracks were selected before (because of a comma separated list) don't change it here.
 			if (g_selTracks.Get()[track])
 				break;
-			int iSel = *((int*)GetSetMediaTrackInfo(CSurf_TrackFromID(track+1, false), "I_SELECTED", NULL));
+			int iSel = *((int*)GetSetMediaTrackInfo(ConsoleTrack(track), "I_SELECTED", NULL));
 			g_selTracks.Get()[track] = iSel;
 		}
 
@@ -273,8 +353,8 @@ void ParseTrackId(char* strId, bool bReset)
 		int end = atol(p+1);
 		if (start < 1)
 			start = 1;
-		if (end > GetNumTracks())
-			end = GetNumTracks();
+		if (end > ConsoleNumTracks())
+			end = ConsoleNumTracks();
 		for (track = start-1; track < end; track++)
 			g_selTracks.Get()[track] = 1;
 	}
@@ -283,9 +363,9 @@ void ParseTrackId(char* strId, bool bReset)
 	else if ((p = strchr(strId, '*')) != NULL)
 	{
 		char* strMatch = NULL;
-		for (track = 0; track < GetNumTracks(); track++)
+		for (track = 0; track < ConsoleNumTracks(); track++)
 		{
-			cName = (const char*)GetSetMediaTrackInfo(CSurf_TrackFromID(track+1, false), "P_NAME", NULL);
+			cName = ConsoleTrackName(track);
 			if (cName && cName[0])
 			{
 				if (p == strId && _strnicmp(strId+1, cName+1+strlen(cName)-strlen(strId), strlen(strId)-1) == 0)
@@ -308,7 +388,7 @@ void ParseTrackId(char* strId, bool bReset)
 		delete [] strMatch;
 	}
 	// Check for exact numeric
-	else if ((track = atol(strId)) > 0 && track <= GetNumTracks())
+	else if ((track = atol(strId)) > 0 && track <= ConsoleNumTracks())
 		g_selTracks.Get()[track-1] = 1;
 
 	// Check for exact name matches, with "auto compelete"
@@ -318,9 +398,9 @@ void ParseTrackId(char* strId, bool bReset)
 		int iCloseMatch = 0;
 		int iExactMatch = 0;
 		int iMatchedTrack;
-		for (track = 0; track < GetNumTracks(); track++)
+		for (track = 0; track < ConsoleNumTracks(); track++)
 		{
-			cName = (const char*)GetSetMediaTrackInfo(CSurf_TrackFromID(track+1, false), "P_NAME", NULL);
+			cName = ConsoleTrackName(track);
 			// Exact name match
 			if (cName[0] && _stricmp(strId, cName) == 0)
 			{
@@ -350,9 +430,9 @@ void ParseTrackId(char* strId, bool bReset)
 		int iParentDepth;
 		bool bSelected = false;
 		MediaTrack* gfd = NULL;
-		for (int i = 0; i < GetNumTracks(); i++)
+		for (int i = 0; i < ConsoleNumTracks(); i++)
 		{
-			MediaTrack* tr = CSurf_TrackFromID(i+1, false);
+			MediaTrack* tr = ConsoleTrack(i);
 			int iType;
 			int iFolder = GetFolderDepth(tr, &iType, &gfd);
 
@@ -372,7 +452,7 @@ void ParseTrackId(char* strId, bool bReset)
 
 	if (bInvert)
 	{
-		for (int i = 0; i < GetNumTracks(); i++)
+		for (int i = 0; i < ConsoleNumTracks(); i++)
 			g_selTracks.Get()[i] = g_selTracks.Get()[i] ? 0 : 1;
 	}
 }
@@ -430,9 +510,9 @@ void ProcessCommand(CONSOLE_COMMAND command, const char* args)
 		return;
 	}
 
-	for (int track = 0; track < GetNumTracks(); track++)
+	for (int track = 0; track < ConsoleNumTracks(); track++)
 	{
-		MediaTrack* pMt = CSurf_TrackFromID(track+1, false);
+		MediaTrack* pMt = ConsoleTrack(track);
 		// Do the class of commands that works only on the selected track
 		if (g_selTracks.Get()[track])
 		{
@@ -715,28 +795,149 @@ const char* StatusString(CONSOLE_COMMAND command, const char* args)
 void ConsoleCommand(COMMAND_T* ct)
 {
 	g_cLastKey = (int)ct->user;
-	if (g_pConsoleWnd)
-		g_pConsoleWnd->ShowConsole();
+	if (ReaConsoleWnd* w = g_consoleWndMgr.Create())
+		w->ShowConsole();
 }
 
 void BringKeyCommand(COMMAND_T* = NULL)
 {
 	if (GetTickCount() - g_dwLastKeyMsg > 10)
 		g_cLastKey = '\0';
-	if (g_pConsoleWnd)
-		g_pConsoleWnd->ShowConsole();
+	if (ReaConsoleWnd* w = g_consoleWndMgr.Create())
+		w->ShowConsole();
 }
 
-// primitive (no undo point)
-void RunConsoleCommand(const char* cmd)
+// Same as ParseTrackId() but in batch mode, a track id is parsed only once
+static void CompileTrackId(char* strId)
+{
+	if (!g_batch)
+	{
+		ParseTrackId(strId);
+		return;
+	}
+
+	RefreshBatch();
+	map<string, vector<int> >::iterator it = g_batch->trackIds.find(strId);
+	if (it != g_batch->trackIds.end())
+	{
+		g_selTracks.Resize((int)it->second.size(), false);
+		if (it->second.size())
+			memcpy(g_selTracks.Get(), &it->second[0], it->second.size() * sizeof(int));
+		return;
+	}
+
+	string key(strId); // ParseTrackId() modifies its input
+	ParseTrackId(strId);
+	g_batch->trackIds[key].assign(g_selTracks.Get(), g_selTracks.Get() + g_selTracks.GetSize());
+}
+
+static CONSOLE_COMMAND RunConsoleLine(const char* cmd)
 {
 	char strCommand[128] = "";
 	lstrcpyn(strCommand, cmd, sizeof(strCommand));
 	char* pTrackId = strCommand;
 	char* pArgs = strCommand;
 	CONSOLE_COMMAND command = ParseConsoleCommand(strCommand, &pTrackId, &pArgs);
-	ParseTrackId(pTrackId);
+	CompileTrackId(pTrackId);
 	ProcessCommand(command, pArgs);
+
+	if (g_batch)
+	{
+		switch (command)
+		{
+		case NAME_SET:
+		case NAME_PREFIX:
+		case NAME_SUFFIX:
+		case OSC_CMD: // could do anything
+			g_batch->bDirty = true;
+			break;
+		case SELECT_ENABLE:
+		case SELECT_DISABLE:
+		case SELECT_TOGGLE:
+		case SELECT_EXCLUSIVE:
+			g_batch->trackIds.clear(); // empty track id means selected tracks
+			break;
+		default:
+			break;
+		}
+	}
+	return command;
+}
+
+// primitive (no undo point)
+void RunConsoleCommand(const char* cmd)
+{
+	RunConsoleLine(cmd);
+}
+
+// primitive (no undo point), runs one command per line ("//" comments and empty lines are skipped) with a single UI refresh
+// _report: optional, gets per-line timings
+// returns the number of commands that were run
+int RunConsoleScript(const char* script, WDL_FastString* report)
+{
+	if (!script)
+		return 0;
+
+	CONSOLE_BATCH batch;
+	batch.bDirty = true;
+	g_batch = &batch;
+	PreventUIRefresh(1);
+
+	int count = 0;
+	const double startTime = time_precise();
+	const char* p = script;
+	while (*p)
+	{
+		const char* eol = p + strcspn(p, "\r\n");
+		char line[128] = "";
+		lstrcpyn(line, p, min((int)sizeof(line), (int)(eol-p)+1));
+		p = eol + strspn(eol, "\r\n");
+
+		const char* cmd = line;
+		while (*cmd == ' ' || *cmd == '\t')
+			cmd++;
+		if (!*cmd || !strncmp(cmd, "//", 2))
+			continue;
+
+		const double lineTime = time_precise();
+		CONSOLE_COMMAND command = RunConsoleLine(cmd);
+		if (command != UNKNOWN_COMMAND)
+			count++;
+		if (report)
+		{
+			if (command == UNKNOWN_COMMAND)
+				report->AppendFormatted(256, "%s: %s\n", __LOCALIZE("Unknown command","sws_DLG_100"), cmd);
+			else
+				report->AppendFormatted(256, "%8.3f ms  %s\n", (time_precise() - lineTime) * 1000.0, cmd);
+		}
+	}
+
+	PreventUIRefresh(-1);
+	g_batch = NULL;
+
+	if (report)
+		report->AppendFormatted(256, __LOCALIZE_VERFMT("%d command(s) run in %.3f ms","sws_DLG_100"), count, (time_precise() - startTime) * 1000.0);
+	return count;
+}
+
+void RunConsoleScriptFile(COMMAND_T* ct)
+{
+	char* fn = BrowseForFiles(__LOCALIZE("ReaConsole - Run script file","sws_DLG_100"), GetResourcePath(), NULL, false, "Text files (*.txt)\0*.txt\0All files (*.*)\0*.*\0");
+	if (!fn)
+		return;
+
+	WDL_FastString script, report;
+	if (LoadChunk(fn, &script, false))
+	{
+		if (RunConsoleScript(script.Get(), &report))
+		{
+			char cUndo[256];
+			snprintf(cUndo, sizeof(cUndo), __LOCALIZE("ReaConsole script %s","sws_undo"), GetFilenameWithExt(fn));
+			Undo_OnStateChangeEx(cUndo, UNDO_STATE_ALL, -1); // UNDO_STATE_TRACKCFG is not enough (marker, osc, ..)
+		}
+		SNM_ShowMsg(report.Get(), __LOCALIZE("ReaConsole - Script report","sws_DLG_100"));
+	}
+	free(fn);
 }
 
 void RunConsoleCommand(COMMAND_T* ct)
@@ -750,7 +951,8 @@ void RunConsoleCommand(COMMAND_T* ct)
 }
 
 int IsConsoleDisplayed(COMMAND_T*) {
-	return (g_pConsoleWnd && g_pConsoleWnd->IsWndVisible());
+	ReaConsoleWnd* w = g_consoleWndMgr.Get();
+	return (w && w->IsWndVisible());
 }
 
 void EditCustomCommands(COMMAND_T*)
@@ -829,6 +1031,7 @@ static COMMAND_T g_commandTable[] =
 	{ { DEFACCEL,   "SWS: Open console with '!' to add action marker" },	"SWSCONSOLEMARKER", ConsoleCommand,  NULL,   '!' },
 	{ { DEFACCEL,   "SWS/S&M: Open console with 'x' to add track FX" },		"S&M_CONSOLE_ADDFX",  ConsoleCommand,  NULL, 'x' },
 	{ { DEFACCEL,   "SWS/S&M: Open console with '/' to send a local OSC message" }, "S&M_CONSOLE_OSC",  ConsoleCommand,  NULL, '/' },
+	{ { DEFACCEL,   "SWS: Run console script file..." },					"SWSCONSOLESCRIPT", RunConsoleScriptFile, NULL, },
 #ifdef _WIN32
 	{ { DEFACCEL,   "SWS: [Deprecated, use the Cycle Action editor instead] Edit console custom commands (restart needed after save)" }, "SWSCONSOLEEDITCUST",  EditCustomCommands,  NULL, },
 #endif
@@ -862,10 +1065,7 @@ int ConsoleInit()
 					SWSRegisterCommandExt(RunConsoleCommand, id, desc, (INT_PTR)_strdup(custCmds.Get(i)->Get()), false);
 				}
 	}
-	g_pConsoleWnd = new ReaConsoleWnd();
-	if (!g_pConsoleWnd)
-		return 0;
-
+	g_consoleWndMgr.Init();
 	return 1;
 }
 
@@ -873,7 +1073,7 @@ void ConsoleExit()
 {
 	plugin_register("-accelerator",&g_ar);
 	WritePrivateProfileString("SWS","CloseConsoleOnReturnKey",g_bCloseOnReturnPref?"1":"0",get_ini_file());
-	DELETE_NULL(g_pConsoleWnd);
+	g_consoleWndMgr.Delete();
 }
 
 // _outCmds: it is up to the caller to unalloc items
@@ -905,8 +1105,9 @@ bool LoadConsoleCmds(WDL_PtrList<WDL_FastString>* _outCmds)
 ///////////////////////////////////////////////////////////////////////////////
 
 ReaConsoleWnd::ReaConsoleWnd()
-	: SWS_DockWnd(IDD_CONSOLE, "ReaConsole", "ReaConsole")
+	: SWS_DockWnd(IDD_CONSOLE, "ReaConsole", "")
 {
+	m_id.Set(CONSOLE_WND_ID);
 	*m_strCmd = '\0';
 	m_pTrackId = m_strCmd;
 	m_pArgs = m_strCmd;
@@ -932,6 +1133,7 @@ HMENU ReaConsoleWnd::OnContextMenu(int x, int y, bool* wantDefaultItems)
 #else
 	AddToMenu(hMenu, __LOCALIZE("Close on ENTER key (CMD+ENTER otherwise)","sws_DLG_100"), IDC_OPTIONS, -1, false, g_bCloseOnReturnPref?MFS_CHECKED:MFS_UNCHECKED);
 #endif
+	AddToMenu(hMenu, __LOCALIZE("Run script file...","sws_DLG_100"), RUN_SCRIPT_MSG);
 	return hMenu;
 }
 
@@ -971,6 +1173,9 @@ void ReaConsoleWnd::OnCommand(WPARAM wParam, LPARAM lParam)
 		case IDC_OPTIONS:
 			g_bCloseOnReturnPref = !g_bCloseOnReturnPref;
 			break;
+		case RUN_SCRIPT_MSG:
+			RunConsoleScriptFile(NULL);
+			break;
 		case IDC_COMMAND:
 			if (HIWORD(wParam)==EN_CHANGE)
 				Update();
@@ -5,6 +5,7 @@
 #include "CommandHandler.h"
 #include "FNG_Settings.h"
 #include "TimeMap.h"
+#include "../Utility/TempoMap.h"
 
 #include "RprItem.h"
 #include "RprTake.h"
@@ -292,6 +293,8 @@ void GrooveTemplateHandler::ApplyGrooveToMidiEditor(int beatDivider, double posS
     if(me->grooveInBeats.size() == 0)
         return;
 
+    /* tempo map isn't edited: convert all positions with a snapshot of it */
+    TempoMapScope tempoMap;
     std::vector<GrooveItem> grooveBeats;
     createGrooveVector(takePtr->getNoteAt(0)->getPosition(),
         getRightEdgeOfMidiTake(takePtr),
@@ -319,6 +322,7 @@ void GrooveTemplateHandler::ApplyGroove(int beatDivider, double posStrength, dou
         return;
 
     ctr->sort();
+    TempoMapScope tempoMap; /* see ApplyGrooveToMidiEditor() */
     std::vector<GrooveItem> grooveBeats;
 
     createGrooveVector(ctr->first().getPosition() + ctr->first().getSnapOffset(),
@@ -468,6 +472,7 @@ void GrooveTemplateHandler::GetGrooveFromMidiEditor()
     GrooveTemplateHandler *me = GrooveTemplateHandler::Instance();
     GrooveTemplateHandler::ClearGroove();
 
+    TempoMapScope tempoMap; /* see ApplyGrooveToMidiEditor() */
     GetMidiBeatPositions(*takePtr.get(), *takePtr->getParent(), me->grooveInBeats, true);
     finalizeGroove(me->nBeatsInGroove, me->grooveInBeats);
 }
@@ -492,6 +497,7 @@ void GrooveTemplateHandler::GetGrooveFromItems()
     }
     GrooveTemplateHandler::ClearGroove();
 
+    TempoMapScope tempoMap; /* see ApplyGrooveToMidiEditor() */
     for(int i = 0; i < ctr->size(); i++) {
         RprItem rprItem = ctr->getAt(i);
         if (rprItem.getActiveTake().isMIDI()) {
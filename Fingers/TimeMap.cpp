@@ -1,21 +1,31 @@
 #include "stdafx.h"
 
 #include "TimeMap.h"
+#include "../Utility/TempoMap.h"
+
+// All conversions use the tempo map snapshot of the current TempoMapScope, if any
 
 double TimeToBeat(double time)
 {
+    if(const TempoMapSnapshot *map = TempoMapSnapshot::GetCurrent())
+        return map->TimeToBeats(time);
     return TimeMap2_timeToBeats(0, time, NULL, NULL, NULL, NULL);
 }
 
 double BeatToTime(double beat)
 {
+    if(const TempoMapSnapshot *map = TempoMapSnapshot::GetCurrent())
+        return map->BeatsToTime(beat);
     return TimeMap2_beatsToTime(0, beat, NULL);
 }
 
 int TimeToMeasure(double time)
 {
     int measure = 0;
-    TimeMap2_timeToBeats(0, time, &measure, NULL, NULL, NULL);
+    if(const TempoMapSnapshot *map = TempoMapSnapshot::GetCurrent())
+        map->TimeToBeats(time, &measure);
+    else
+        TimeMap2_timeToBeats(0, time, &measure, NULL, NULL, NULL);
     return measure;
 }
 
@@ -27,6 +37,8 @@ int BeatToMeasure(double beat)
 
 double MeasureToTime(int measure)
 {
+    if(const TempoMapSnapshot *map = TempoMapSnapshot::GetCurrent())
+        return map->BeatsToTime(0.0, &measure);
     return TimeMap2_beatsToTime(0, 0.0f, &measure);
 }
 
@@ -34,31 +46,40 @@ int BeatsInMeasure(int measure)
 {
     double time = MeasureToTime(measure);
     int measureLength = 0;
-    TimeMap2_timeToBeats(0, time, &measure, &measureLength, NULL, NULL);
+    if(const TempoMapSnapshot *map = TempoMapSnapshot::GetCurrent())
+        map->TimeToBeats(time, &measure, &measureLength);
+    else
+        TimeMap2_timeToBeats(0, time, &measure, &measureLength, NULL, NULL);
     return measureLength;
 }
 
 double BeatsTillMeasure(int measure)
 {
     double time = MeasureToTime(measure);
-    return TimeMap2_timeToBeats(0, time, NULL, NULL, NULL, NULL);
+    return TimeToBeat(time);
 }
 
 double BPMAtTime(double time)
 {
+    if(const TempoMapSnapshot *map = TempoMapSnapshot::GetCurrent())
+        return map->DividedBpmAtTime(time);
     return TimeMap2_GetDividedBpmAtTime(0, time);
 }
 
 double QNtoTime(double qn)
 {
+    if(const TempoMapSnapshot *map = TempoMapSnapshot::GetCurrent())
+        return map->QNToTime(qn);
     return TimeMap2_QNToTime(0, qn);
 }
 double TimeToQN(double t)
 {
+    if(const TempoMapSnapshot *map = TempoMapSnapshot::GetCurrent())
+        return map->TimeToQN(t);
     return TimeMap2_timeToQN(0, t);
 }
 
 double BPMatTime(double t)
 {
-    return TimeMap2_GetDividedBpmAtTime(0, t);
+    return BPMAtTime(t);
 }
@@ -29,8 +29,10 @@
 #include "stdafx.h"
 
 #include "../Utility/Base64.h"
+#include "../Utility/GuidIndex.h"
 #include "ItemSelState.h"
 
+#include <unordered_map>
 #include <WDL/localize/localize.h>
 
 //*****************************************************
@@ -44,6 +46,9 @@ SWSProjConfig<SelItems> g_selItems;
 
 #define GUIDS_PER_LINE 4
 
+// GUID -> index (saved selections, saved tracks), see SelItems::Restore() for GUIDs saved several times
+typedef std::unordered_map<GUID, int, GuidHash, GuidEqual> GuidIdxMap;
+
 //*****************************************************
 // SelItems class
 
@@ -59,10 +64,10 @@ void SelItems::Save(MediaTrack* tr)
 
 void SelItems::Add(LineParser* lp)
 {
-	Base64 b64;
-	int bufSize;
-	GUID* guidBuf = (GUID*)b64.Decode(lp->gettoken_str(0), &bufSize);
-	for (unsigned int i = 0; i < bufSize / sizeof(GUID); i++)
+	const char* str = lp->gettoken_str(0);
+	GUID guidBuf[GUIDS_PER_LINE];
+	const int bufSize = Base64::DecodeTo(str, (int)strlen(str), (char*)guidBuf, sizeof(guidBuf));
+	for (int i = 0; i < bufSize / (int)sizeof(GUID); i++)
 	{
 		GUID* g = new GUID;
 		*g = guidBuf[i];
@@ -84,9 +89,10 @@ void SelItems::Add(MediaTrack* tr)
 	}
 }
 
-// bUsed is an array of bools with size == m_selItems.GetSize(), used to "check off" when an item from that list is used
-// caller initializes bUsed
-void SelItems::Match(MediaTrack* tr, bool* bUsed)
+// Deselects all items of tr, selects the ones found in the saved list.
+// heads: saved GUID -> its first unused entry, next: following entry with the same GUID (or -1)
+// bUsed: "checks off" the entries of the saved list, initialized by the caller
+static void MatchItems(MediaTrack* tr, GuidIdxMap* heads, const int* next, bool* bUsed)
 {
 	PreventUIRefresh(1);
 	int nbitems=GetTrackNumMediaItems(tr);
@@ -94,43 +100,50 @@ void SelItems::Match(MediaTrack* tr, bool* bUsed)
 	{
 		MediaItem* mi = GetTrackMediaItem(tr, i);
 		GetSetMediaItemInfo(mi, "B_UISEL", &g_bFalse);
-		GUID* g = (GUID*)GetSetMediaItemInfo(mi, "GUID", NULL);
-		for (int j = 0; j < m_selItems.GetSize(); j++)
-			if (!bUsed[j] && GuidsEqual(m_selItems.Get(j), g))
-			{
-				bUsed[j] = true;
-				GetSetMediaItemInfo(mi, "B_UISEL", &g_bTrue);
-				break;
-			}
+		GuidIdxMap::iterator it = heads->find(*(GUID*)GetSetMediaItemInfo(mi, "GUID", NULL));
+		if (it != heads->end() && it->second >= 0)
+		{
+			bUsed[it->second] = true;
+			it->second = next[it->second];
+			GetSetMediaItemInfo(mi, "B_UISEL", &g_bTrue);
+		}
 	}
 	PreventUIRefresh(-1);
 }
 
 void SelItems::Restore(MediaTrack* tr)
 {
-	bool* bUsed = NULL;
-	if (m_selItems.GetSize())
+	// Index the saved GUIDs: linear restore instead of items x saved GUID compares.
+	// A GUID saved several times selects as many items, first entries first (as before)
+	const int nbSaved = m_selItems.GetSize();
+	WDL_TypedBuf<int> next;
+	WDL_TypedBuf<bool> used;
+	int* pNext = next.Resize(nbSaved, false);
+	bool* bUsed = used.Resize(nbSaved, false);
+	GuidIdxMap heads;
+	heads.reserve(nbSaved);
+	for (int i = nbSaved-1; i >= 0; i--)
 	{
-		bUsed = new bool[m_selItems.GetSize()];
-		memset(bUsed, 0, sizeof(bool) * m_selItems.GetSize());
+		int& head = heads.emplace(*m_selItems.Get(i), -1).first->second;
+		pNext[i] = head;
+		head = i;
+		bUsed[i] = false;
 	}
 
 	if (tr == NULL)
 	{
 		PreventUIRefresh(1);
 		for (int i = 1; i <= GetNumTracks(); i++)
-			Match(CSurf_TrackFromID(i, false), bUsed);
+			MatchItems(CSurf_TrackFromID(i, false), &heads, pNext, bUsed);
 		PreventUIRefresh(-1);
 	}
 	else
-		Match(tr, bUsed);
+		MatchItems(tr, &heads, pNext, bUsed);
 
 	// Delete unused items
-	for (int i = m_selItems.GetSize()-1; i >= 0 ; i--)
+	for (int i = nbSaved-1; i >= 0 ; i--)
 		if (!bUsed[i])
 			m_selItems.Delete(i, true);
-
-	delete[] bUsed;
 }
 
 char* SelItems::ItemString(char* str, int maxLen, bool* bDone)
@@ -146,13 +159,13 @@ char* SelItems::ItemString(char* str, int maxLen, bool* bDone)
 	}
 	else
 	{
-		Base64 b64;
 		if (iGUIDs > GUIDS_PER_LINE)
 			iGUIDs = GUIDS_PER_LINE;
 		char pGUIDs[GUIDS_PER_LINE*sizeof(GUID)];
 		for (int i = 0; i < iGUIDs; i++)
 			memcpy(pGUIDs+i*sizeof(GUID), m_selItems.Get(iLine*GUIDS_PER_LINE+i), sizeof(GUID));
-		lstrcpyn(str, b64.Encode(pGUIDs, sizeof(GUID)*iGUIDs), maxLen);
+		if (Base64::EncodeTo(pGUIDs, sizeof(GUID)*iGUIDs, str, maxLen) < 0 && maxLen > 0)
+			*str = 0;
 		iLine++;
 	}
 	return str;
@@ -269,46 +282,52 @@ char* SelItemsTrack::ItemString(char* str, int maxLen, bool* bDone)
 
 //*****************************************************
 // Global functions
+
+// Saved tracks by GUID, the first one wins (as with linear searches)
+static void MapSelItemsTracks(GuidIdxMap* map)
+{
+	map->reserve(g_selItemsTrack.Get()->GetSize());
+	for (int i = 0; i < g_selItemsTrack.Get()->GetSize(); i++)
+		map->emplace(g_selItemsTrack.Get()->Get(i)->m_guid, i);
+}
+
+static SelItemsTrack* FindSelItemsTrack(const GuidIdxMap& map, MediaTrack* tr)
+{
+	GuidIdxMap::const_iterator it = map.find(*(GUID*)GetSetMediaTrackInfo(tr, "GUID", NULL));
+	return it != map.end() ? g_selItemsTrack.Get()->Get(it->second) : NULL;
+}
+
 void SaveSelTrackSelItems(int iSlot)
 {
+	GuidIdxMap tracks;
+	MapSelItemsTracks(&tracks);
 	for (int i = 1; i <= GetNumTracks(); i++)
 	{
 		MediaTrack* tr = CSurf_TrackFromID(i, false);
 		if (*(int*)GetSetMediaTrackInfo(tr, "I_SELECTED", NULL))
 		{
-			GUID* g = (GUID*)GetSetMediaTrackInfo(tr, "GUID", NULL);
-			int j;
-			for (j = 0; j < g_selItemsTrack.Get()->GetSize(); j++)
-				if (GuidsEqual(g, &g_selItemsTrack.Get()->Get(j)->m_guid))
-				{
-					g_selItemsTrack.Get()->Get(j)->Save(tr, iSlot);
-					break;
-				}
-			if (j == g_selItemsTrack.Get()->GetSize())
+			SelItemsTrack* sit = FindSelItemsTrack(tracks, tr);
+			if (!sit)
 			{
-				g_selItemsTrack.Get()->Add(new SelItemsTrack(tr));
-				g_selItemsTrack.Get()->Get(g_selItemsTrack.Get()->GetSize()-1)->Save(tr, iSlot);
+				sit = g_selItemsTrack.Get()->Add(new SelItemsTrack(tr));
+				tracks.emplace(sit->m_guid, g_selItemsTrack.Get()->GetSize()-1);
 			}
+			sit->Save(tr, iSlot);
 		}
 	}
 }
 
 void RestoreSelTrackSelItems(int iSlot)
 {
+	GuidIdxMap tracks;
+	MapSelItemsTracks(&tracks);
 	PreventUIRefresh(1);
 	for (int i = 1; i <= GetNumTracks(); i++)
 	{
 		MediaTrack* tr = CSurf_TrackFromID(i, false);
 		if (*(int*)GetSetMediaTrackInfo(tr, "I_SELECTED", NULL))
-		{
-			GUID* g = (GUID*)GetSetMediaTrackInfo(tr, "GUID", NULL);
-			for (int j = 0; j < g_selItemsTrack.Get()->GetSize(); j++)
-				if (GuidsEqual(g, &g_selItemsTrack.Get()->Get(j)->m_guid))
-				{
-					g_selItemsTrack.Get()->Get(j)->Restore(tr, iSlot);
-					break;
-				}
-		}
+			if (SelItemsTrack* sit = FindSelItemsTrack(tracks, tr))
+				sit->Restore(tr, iSlot);
 	}
 	PreventUIRefresh(-1);
 
@@ -320,20 +339,15 @@ void RestoreSelTrackSelItems(int iSlot)
 
 void RestoreLastSelItemTrack(COMMAND_T* ct)
 {
+	GuidIdxMap tracks;
+	MapSelItemsTracks(&tracks);
 	PreventUIRefresh(1);
 	for (int i = 1; i <= GetNumTracks(); i++)
 	{
 		MediaTrack* tr = CSurf_TrackFromID(i, false);
 		if (*(int*)GetSetMediaTrackInfo(tr, "I_SELECTED", NULL))
-		{
-			GUID* g = (GUID*)GetSetMediaTrackInfo(tr, "GUID", NULL);
-			for (int j = 0; j < g_selItemsTrack.Get()->GetSize(); j++)
-				if (GuidsEqual(g, &g_selItemsTrack.Get()->Get(j)->m_guid))
-				{
-					g_selItemsTrack.Get()->Get(j)->PreviousSelection(tr);
-					break;
-				}
-		}
+			if (SelItemsTrack* sit = FindSelItemsTrack(tracks, tr))
+				sit->PreviousSelection(tr);
 	}
 	PreventUIRefresh(-1);
 	Undo_OnStateChangeEx(SWS_CMD_SHORTNAME(ct), UNDO_STATE_ITEMS, -1);
@@ -44,7 +44,6 @@ public:
 
 private:
 	void Add(MediaTrack* tr);
-	void Match(MediaTrack* tr, bool* bUsed);
 	WDL_PtrList<GUID> m_selItems;
 };
 
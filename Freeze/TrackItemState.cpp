@@ -27,12 +27,36 @@
 
 
 #include "stdafx.h"
+#include "../Utility/GuidIndex.h"
 #include "TrackItemState.h"
 
+#include <unordered_map>
+
 //*****************************************************
 // Globals
 SWSProjConfig<WDL_PtrList_DOD<TrackState> > g_tracks;
 
+// Lookups by GUID, the first object/state wins (as with linear searches)
+typedef std::unordered_map<GUID, MediaItem*, GuidHash, GuidEqual> GuidItemMap;
+typedef std::unordered_map<GUID, int, GuidHash, GuidEqual> GuidIdxMap;
+
+static void MapTrackItems(MediaTrack* tr, GuidItemMap* items)
+{
+	const int nbItems = GetTrackNumMediaItems(tr);
+	items->reserve(nbItems);
+	for (int i = 0; i < nbItems; i++)
+	{
+		MediaItem* mi = GetTrackMediaItem(tr, i);
+		items->emplace(*(GUID*)GetSetMediaItemInfo(mi, "GUID", NULL), mi);
+	}
+}
+
+static MediaItem* FindItem(const GuidItemMap& items, const GUID& g)
+{
+	GuidItemMap::const_iterator it = items.find(g);
+	return it != items.end() ? it->second : NULL;
+}
+
 //*****************************************************
 // ItemState Class
 ItemState::ItemState(LineParser* lp)
@@ -71,25 +95,8 @@ ItemState::ItemState(MediaItem* mi)
 	m_dFadeOut = *(double*)GetSetMediaItemInfo(mi, "D_FADEOUTLEN", NULL);
 }
 
-MediaItem* ItemState::FindItem(MediaTrack* tr)
+void ItemState::Restore(MediaItem* mi, bool bSelOnly)
 {
-	// Find the media item in the track
-	MediaItem* mi = NULL;
-	for (int i = 0; i < GetTrackNumMediaItems(tr); i++)
-	{
-		mi = GetTrackMediaItem(tr, i);
-		if (GuidsEqual(&m_guid, (GUID*)GetSetMediaItemInfo(mi, "GUID", NULL)))
-			return mi;
-	}
-	return NULL;
-}
-
-void ItemState::Restore(MediaTrack* tr, bool bSelOnly)
-{
-	// First gotta find the media item in the track
-	MediaItem* mi = FindItem(tr);
-	if (mi == NULL)
-		return;
 	if (!bSelOnly || *(bool*)GetSetMediaItemInfo(mi, "B_UISEL", NULL))
 	{
 		GetSetMediaItemInfo(mi, "B_MUTE", &m_bMute);
@@ -115,14 +122,6 @@ char* ItemState::ItemString(char* str, int maxLen)
 	return str;
 }
 
-void ItemState::Select(MediaTrack* tr)
-{
-	MediaItem* mi = FindItem(tr);
-	if (mi == NULL)
-		return;
-	GetSetMediaItemInfo(mi, "B_UISEL", &g_bTrue);
-}
-
 //*****************************************************
 // TrackState Class
 TrackState::TrackState(MediaTrack* tr, bool bSelOnly)
@@ -158,21 +157,29 @@ TrackState::~TrackState()
 
 void TrackState::AddSelItems(MediaTrack* tr)
 {
+	GuidItemMap items;
+	MapTrackItems(tr, &items);
+	GuidIdxMap states;
+	states.reserve(m_items.GetSize());
+	for (int j = 0; j < m_items.GetSize(); j++)
+		states.emplace(m_items.Get(j)->m_guid, j);
+
+	// Update the saved states of selected items, add new ones
+	// (states added here can't match the next items, no need to index them)
 	for (int i = 0; i < GetTrackNumMediaItems(tr); i++)
 	{
 		MediaItem* mi = GetTrackMediaItem(tr, i);
 		if (*(bool*)GetSetMediaItemInfo(mi, "B_UISEL", NULL))
 		{
-			int j;
-			for (j = 0; j < m_items.GetSize(); j++)
-				if (mi == m_items.Get(j)->FindItem(tr))
-				{
-					ItemState* is = m_items.Get(j);
-					m_items.Set(j, new ItemState(mi));
-					delete is;
-					break;
-				}
-			if (j == m_items.GetSize())
+			const GUID& g = *(GUID*)GetSetMediaItemInfo(mi, "GUID", NULL);
+			GuidIdxMap::const_iterator it = states.find(g);
+			if (it != states.end() && FindItem(items, g) == mi)
+			{
+				ItemState* is = m_items.Get(it->second);
+				m_items.Set(it->second, new ItemState(mi));
+				delete is;
+			}
+			else
 				m_items.Add(new ItemState(mi));
 		}
 	}
@@ -195,8 +202,11 @@ void TrackState::Restore(MediaTrack* tr, bool bSelOnly)
 		GetSetMediaTrackInfo(tr, "B_FREEMODE", &m_bFIPM);
 		GetSetMediaTrackInfo(tr, "I_CUSTOMCOLOR", &m_iColor);
 	}
+	GuidItemMap items;
+	MapTrackItems(tr, &items);
 	for (int i = 0; i < m_items.GetSize(); i++)
-		m_items.Get(i)->Restore(tr, bSelOnly);
+		if (MediaItem* mi = FindItem(items, m_items.Get(i)->m_guid))
+			m_items.Get(i)->Restore(mi, bSelOnly);
 }
 
 char* TrackState::ItemString(char* str, int maxLen)
@@ -210,48 +220,71 @@ char* TrackState::ItemString(char* str, int maxLen)
 void TrackState::SelectItems(MediaTrack* tr)
 {
 	UnselAllItems(tr);
+	GuidItemMap items;
+	MapTrackItems(tr, &items);
 	for (int i = 0; i < m_items.GetSize(); i++)
-		m_items.Get(i)->Select(tr);
+		if (MediaItem* mi = FindItem(items, m_items.Get(i)->m_guid))
+			GetSetMediaItemInfo(mi, "B_UISEL", &g_bTrue);
 }
 
 //*****************************************************
 // Global Functions
+
+// Saved track states by track GUID
+static void MapTrackStates(GuidIdxMap* map)
+{
+	map->reserve(g_tracks.Get()->GetSize());
+	for (int i = 0; i < g_tracks.Get()->GetSize(); i++)
+		map->emplace(g_tracks.Get()->Get(i)->m_guid, i);
+}
+
+static int FindTrackState(const GuidIdxMap& map, MediaTrack* tr)
+{
+	GuidIdxMap::const_iterator it = map.find(*TrackToGuid(tr));
+	return it != map.end() ? it->second : -1;
+}
+
 void SaveTrack(COMMAND_T*)
 {
+	GuidIdxMap states;
+	MapTrackStates(&states);
 	for (int i = 1; i <= GetNumTracks(); i++)
 	{
 		MediaTrack* tr = CSurf_TrackFromID(i, false);
 		if (*(int*)GetSetMediaTrackInfo(tr, "I_SELECTED", NULL))
 		{
 			// First see if this track is saved already
-			int j;
-			for (j = 0; j < g_tracks.Get()->GetSize(); j++)
+			const int j = FindTrackState(states, tr);
+			if (j >= 0)
 			{
-				if (TrackMatchesGuid(tr, &g_tracks.Get()->Get(j)->m_guid))
-				{
-					TrackState* ts = g_tracks.Get()->Get(j);
-					g_tracks.Get()->Set(j, new TrackState(tr, false));
-					delete ts;
-					break;
-				}
+				TrackState* ts = g_tracks.Get()->Get(j);
+				g_tracks.Get()->Set(j, new TrackState(tr, false));
+				delete ts;
 			}
-			if (j == g_tracks.Get()->GetSize())
+			else
+			{
+				states.emplace(*TrackToGuid(tr), g_tracks.Get()->GetSize());
 				g_tracks.Get()->Add(new TrackState(tr, false));
+			}
 		}
 	}
 }
 
 void RestoreTrack(COMMAND_T* _ct)
 {
+	GuidIdxMap states;
+	MapTrackStates(&states);
 	PreventUIRefresh(1);
 	for (int i = 1; i <= GetNumTracks(); i++)
 	{
 		MediaTrack* tr = CSurf_TrackFromID(i, false);
 		if (*(int*)GetSetMediaTrackInfo(tr, "I_SELECTED", NULL))
+		{
 			// Find the saved track
-			for (int j = 0; j < g_tracks.Get()->GetSize(); j++)
-				if (TrackMatchesGuid(tr, &g_tracks.Get()->Get(j)->m_guid))
-					g_tracks.Get()->Get(j)->Restore(tr, false);
+			const int j = FindTrackState(states, tr);
+			if (j >= 0)
+				g_tracks.Get()->Get(j)->Restore(tr, false);
+		}
 	}
 	PreventUIRefresh(-1);
 	UpdateTimeline();
@@ -260,15 +293,19 @@ void RestoreTrack(COMMAND_T* _ct)
 
 void SelItemsWithState(COMMAND_T* _ct)
 {
+	GuidIdxMap states;
+	MapTrackStates(&states);
 	PreventUIRefresh(1);
 	for (int i = 1; i <= GetNumTracks(); i++)
 	{
 		MediaTrack* tr = CSurf_TrackFromID(i, false);
 		if (*(int*)GetSetMediaTrackInfo(tr, "I_SELECTED", NULL))
+		{
 			// Find the saved track
-			for (int j = 0; j < g_tracks.Get()->GetSize(); j++)
-				if (TrackMatchesGuid(tr, &g_tracks.Get()->Get(j)->m_guid))
-					g_tracks.Get()->Get(j)->SelectItems(tr);
+			const int j = FindTrackState(states, tr);
+			if (j >= 0)
+				g_tracks.Get()->Get(j)->SelectItems(tr);
+		}
 	}
 	PreventUIRefresh(-1);
 	UpdateArrange();
@@ -277,36 +314,41 @@ void SelItemsWithState(COMMAND_T* _ct)
 
 void SaveSelOnTrack(COMMAND_T*)
 {
+	GuidIdxMap states;
+	MapTrackStates(&states);
 	for (int i = 1; i <= GetNumTracks(); i++)
 	{
 		MediaTrack* tr = CSurf_TrackFromID(i, false);
 		if (*(int*)GetSetMediaTrackInfo(tr, "I_SELECTED", NULL))
 		{
 			// First see if this track is saved already
-			int j;
-			for (j = 0; j < g_tracks.Get()->GetSize(); j++)
-				if (TrackMatchesGuid(tr, &g_tracks.Get()->Get(j)->m_guid))
-				{
-					g_tracks.Get()->Get(j)->AddSelItems(tr);
-					break;
-				}
-			if (j == g_tracks.Get()->GetSize())
+			const int j = FindTrackState(states, tr);
+			if (j >= 0)
+				g_tracks.Get()->Get(j)->AddSelItems(tr);
+			else
+			{
+				states.emplace(*TrackToGuid(tr), g_tracks.Get()->GetSize());
 				g_tracks.Get()->Add(new TrackState(tr, true));
+			}
 		}
 	}
 }
 
 void RestoreSelOnTrack(COMMAND_T* _ct)
 {
+	GuidIdxMap states;
+	MapTrackStates(&states);
 	PreventUIRefresh(1);
 	for (int i = 1; i <= GetNumTracks(); i++)
 	{
 		MediaTrack* tr = CSurf_TrackFromID(i, false);
 		if (*(int*)GetSetMediaTrackInfo(tr, "I_SELECTED", NULL))
+		{
 			// Find the saved track
-			for (int j = 0; j < g_tracks.Get()->GetSize(); j++)
-				if (TrackMatchesGuid(tr, &g_tracks.Get()->Get(j)->m_guid))
-					g_tracks.Get()->Get(j)->Restore(tr, true);
+			const int j = FindTrackState(states, tr);
+			if (j >= 0)
+				g_tracks.Get()->Get(j)->Restore(tr, true);
+		}
 	}
 	PreventUIRefresh(-1);
 	UpdateTimeline();
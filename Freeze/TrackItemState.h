@@ -33,10 +33,8 @@ class ItemState
 public:
 	ItemState(LineParser* lp);
 	ItemState(MediaItem* mi);
-	MediaItem* FindItem(MediaTrack* tr);
-	void Restore(MediaTrack* tr, bool bSelOnly);
+	void Restore(MediaItem* mi, bool bSelOnly);
     char* ItemString(char* str, int maxLen);
-	void Select(MediaTrack* tr);
 
 	GUID m_guid;
 	bool m_bMute;
@@ -43,10 +43,13 @@
 #define RENAME_MSG		0x100F2
 #define FIRST_LOAD_MSG	0x10100
 
+#define MARKERLIST_WND_ID	"SWSMarkerList"
+
 // Globals
 static SWSProjConfig<WDL_PtrList_DOD<MarkerList> > g_savedLists;
 MarkerList* g_curList = NULL;
-SWS_MarkerListWnd* g_pMarkerList = NULL;
+// The window is only instantiated when it was left open or is opened (lazy init)
+SNM_WindowManager<SWS_MarkerListWnd> g_markerListWndMgr(MARKERLIST_WND_ID);
 
 // !WANT_LOCALIZE_STRINGS_BEGIN:sws_DLG_102
 static SWS_LVColumn g_cols[] = { { 75, 0, "Time" }, { 45, 0, "Type" }, { 30, 0, "ID" }, { 170, 1, "Description" },  { 70, 0, "Color", -1 }};
@@ -141,13 +144,13 @@ void SWS_MarkerListView::OnItemDblClk(SWS_ListItem* item, int iCol)
 			GetSet_LoopTimeRange(true, true, &d1, &d2, m_pMarkerList->m_bPlayOnSel);
 		}
 	}
-	else if (g_pMarkerList && SWS_IsWindow(g_pMarkerList->GetHWND()))
-		SendMessage(g_pMarkerList->GetHWND(), WM_COMMAND, COLOR_MSG, 0);
+	else if (SWS_IsWindow(m_pMarkerList->GetHWND()))
+		SendMessage(m_pMarkerList->GetHWND(), WM_COMMAND, COLOR_MSG, 0);
 }
 
 int SWS_MarkerListView::OnItemSort(SWS_ListItem* item1, SWS_ListItem* item2)
 {
-	int iRet;
+	int iRet = 0;
 	MarkerItem* mi1 = (MarkerItem*)item1;
 	MarkerItem* mi2 = (MarkerItem*)item2;
 
@@ -183,6 +186,7 @@ void SWS_MarkerListView::SetItemText(SWS_ListItem* item, int iCol, const char* s
 		MarkerItem* mi = (MarkerItem*)item;
 		mi->SetName(str);
 		mi->UpdateProject();
+		InvalidateItem(item); // no-op while editing, the edited row is refreshed then
 		Update();
 	}
 }
@@ -215,8 +219,9 @@ int SWS_MarkerListView::GetItemState(SWS_ListItem* item)
 }
 
 SWS_MarkerListWnd::SWS_MarkerListWnd()
-:SWS_DockWnd(IDD_MARKERLIST, __LOCALIZE("Marker List","sws_DLG_102"), "SWSMarkerList"), m_dCurPos(DBL_MAX)
+:SWS_DockWnd(IDD_MARKERLIST, __LOCALIZE("Marker List","sws_DLG_102"), ""), m_dCurPos(DBL_MAX)
 {
+	m_id.Set(MARKERLIST_WND_ID);
 	// Must call SWS_DockWnd::Init() to restore parameters and open the window if necessary
 	Init();
 }
@@ -229,6 +234,8 @@ void SWS_MarkerListWnd::Update(bool bForce)
 	if (*ConfigVar<int>("projtimemode") != prevTimeMode)
 	{
 		prevTimeMode = *ConfigVar<int>("projtimemode");
+		if (m_pLists.GetSize())
+			m_pLists.Get(0)->InvalidateAllItems();
 		bChanged = true;
 	}
 
@@ -318,6 +325,7 @@ void SWS_MarkerListWnd::OnCommand(WPARAM wParam, LPARAM lParam)
 		case COLOR_MSG:
 		{
 			int iColor;
+			WDL_PtrList<MarkerItem> colored;
 			m_pLists.Get(0)->DisableUpdates(true);
 			if (GR_SelectColor(m_hwnd, &iColor))
 			{
@@ -327,9 +335,17 @@ void SWS_MarkerListWnd::OnCommand(WPARAM wParam, LPARAM lParam)
 				{
 					item->SetColor(iColor | 0x1000000);
 					item->UpdateProject();
+					colored.Add(item);
 				}
 			}
 			m_pLists.Get(0)->DisableUpdates(false);
+			for (int i = 0; i < colored.GetSize(); i++) // changed in place, not a new marker
+				m_pLists.Get(0)->InvalidateItem((SWS_ListItem*)colored.Get(i));
+			if (colored.GetSize())
+			{
+				SWS_SectionLock lock(&g_curList->m_mutex);
+				m_pLists.Get(0)->Update();
+			}
 			break;
 		}
 		case RENAME_MSG:
@@ -637,7 +653,15 @@ INT_PTR WINAPI doFormatDialog(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lPa
 
 void OpenMarkerList(COMMAND_T*)
 {
-	g_pMarkerList->Show(true, true);
+	if (SWS_MarkerListWnd* w = g_markerListWndMgr.Create())
+		w->Show(true, true);
+}
+
+// no-op if the window has never been opened: actions rebuild g_curList themselves
+void MarkerListUpdate()
+{
+	if (SWS_MarkerListWnd* w = g_markerListWndMgr.Get())
+		w->Update();
 }
 
 void LoadMarkerList(COMMAND_T*)
@@ -668,7 +692,9 @@ void ExportFormat(COMMAND_T*)
 
 int MarkerListEnabled(COMMAND_T*)
 {
-	return g_pMarkerList->IsWndVisible();
+	if (SWS_MarkerListWnd* w = g_markerListWndMgr.Get())
+		return w->IsWndVisible();
+	return 0;
 }
 
 //!WANT_LOCALIZE_1ST_STRING_BEGIN:sws_actions
@@ -748,7 +774,7 @@ static void BeginLoadProjectState(bool isUndo, struct project_config_extension_t
 {
 	g_savedLists.Get()->Empty(true);
 	g_savedLists.Cleanup();
-	g_pMarkerList->Update();
+	MarkerListUpdate();
 }
 
 static project_config_extension_t g_projectconfig = { ProcessExtensionLine, SaveExtensionConfig, BeginLoadProjectState, NULL };
@@ -759,7 +785,7 @@ int MarkerListInit()
 		return 0;
 
 	SWSRegisterCommands(g_commandTable);
-	g_pMarkerList = new SWS_MarkerListWnd();
+	g_markerListWndMgr.Init();
 
 	return 1;
 }
@@ -767,5 +793,5 @@ int MarkerListInit()
 void MarkerListExit()
 {
 	plugin_register("-projectconfig",&g_projectconfig);
-	DELETE_NULL(g_pMarkerList);
+	g_markerListWndMgr.Delete();
 }
@@ -75,7 +75,7 @@ protected:
 int MarkerListInit();
 void MarkerListExit();
 extern MarkerList* g_curList;
-extern SWS_MarkerListWnd* g_pMarkerList;
+void MarkerListUpdate();
 
 // Functions to show dialog boxes
 void SaveMarkerList(COMMAND_T* = NULL);
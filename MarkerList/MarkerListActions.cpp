@@ -55,7 +55,7 @@ void ClipboardToList(COMMAND_T*)
 {
 	MarkerList list("Clipboard", false);
 	list.ClipboardToList();
-	g_pMarkerList->Update();
+	MarkerListUpdate();
 }
 
 void ExportToClipboard(COMMAND_T*)
@@ -105,7 +105,7 @@ void DeleteAllMarkers(COMMAND_T* ct)
 {
 	DeleteAllMarkers();
 	Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(ct), UNDO_STATE_MISCCFG, -1);
-	g_pMarkerList->Update();
+	MarkerListUpdate();
 }
 
 void DeleteAllRegions()
@@ -129,7 +129,7 @@ void DeleteAllRegions(COMMAND_T* ct)
 {
 	DeleteAllRegions();
 	Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(ct), UNDO_STATE_MISCCFG, -1);
-	g_pMarkerList->Update();
+	MarkerListUpdate();
 }
 
 void RenumberIds(COMMAND_T* ct)
@@ -146,7 +146,7 @@ void RenumberIds(COMMAND_T* ct)
 			mi->AddToProject();
 		}
 	}
-	g_pMarkerList->Update();
+	MarkerListUpdate();
 	UpdateTimeline();
 	Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(ct), UNDO_STATE_MISCCFG, -1);
 }
@@ -165,7 +165,7 @@ void RenumberRegions(COMMAND_T* ct)
 			mi->AddToProject();
 		}
 	}
-	g_pMarkerList->Update();
+	MarkerListUpdate();
 	UpdateTimeline();
 	Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(ct), UNDO_STATE_MISCCFG, -1);
 }
@@ -60,16 +60,27 @@ static bool AnalyzePCMSource(ANALYZE_PCM* a)
 	for (int i = 0; i < t.nch; i++)
 		dSumSquares[i] = 0.0;
 
+	// In windowed mode dSumSquares only covers the window, keep the totals apart
+	double* dTotalSquares = dSumSquares;
+	if (a->dWindowSize != 0.0)
+	{
+		dTotalSquares = new double[t.nch];
+		for (int i = 0; i < t.nch; i++)
+			dTotalSquares[i] = 0.0;
+	}
+
 	// Init output variables.  Note can have different channel count.
 	for (int i = 0; i < a->iChannels; i++)
 	{
 		if (a->dPeakVals) a->dPeakVals[i] = 0.0;
 		if (a->dRMSs) a->dRMSs[i] = 0.0;
+		if (a->dTotalRMSs) a->dTotalRMSs[i] = 0.0;
 		if (a->peakSamples) a->peakSamples[i] = 0;
 		if (a->peakRMSsamples) a->peakRMSsamples[i] = -666;
 	}
 	a->dPeakVal = 0.0;
 	a->dRMS = 0.0;
+	a->dTotalRMS = 0.0;
 	a->peakRMSsample = -666;
 	a->peakSample = 0;
 	a->dProgress = 0.0;
@@ -102,6 +113,7 @@ static bool AnalyzePCMSource(ANALYZE_PCM* a)
 				}
 				if (a->dWindowSize != 0.0)
 				{
+					dTotalSquares[chan] += t.samples[i] * t.samples[i];
 					dSumSquares[chan] -= prevBuf[i] * prevBuf[i];
 					if (dSumSquares[chan] < 0.0) // Unlikely but possible with rounding errors
 						dSumSquares[chan] = 0.0;
@@ -138,6 +150,19 @@ static bool AnalyzePCMSource(ANALYZE_PCM* a)
 		a->pcm->GetSamples(&t);
 	}
 
+	// RMS over the entire item, per channel and for all channels combined
+	if (a->sampleCount)
+	{
+		double dSS = 0.0;
+		for (int i = 0; i < t.nch; i++)
+		{
+			dSS += dTotalSquares[i];
+			if (a->dTotalRMSs && i < a->iChannels)
+				a->dTotalRMSs[i] = sqrt(dTotalSquares[i] / a->sampleCount);
+		}
+		a->dTotalRMS = sqrt(dSS / (a->sampleCount * t.nch));
+	}
+
 	if (a->dWindowSize == 0.0)
 	{
 		// Non-windowed mode.  Calculate the RMS for the entire item
@@ -166,6 +191,8 @@ static bool AnalyzePCMSource(ANALYZE_PCM* a)
 
 	delete[] t.samples;
 	delete[] prevBuf;
+	if (dTotalSquares != dSumSquares)
+		delete[] dTotalSquares;
 	delete[] dSumSquares;
 
 	return true;
@@ -179,23 +206,54 @@ unsigned int WINAPI AnalyzePCMThread(void* pAnalyze)
 	return 0;
 }
 
+// returns a zero-based copy of the item's source, NULL if there's nothing to analyze
+PCM_source* PrepareItemAnalysis(MediaItem* item)
+{
+	PCM_source* pcm = (PCM_source*)item;
+	if (!pcm || strcmp(pcm->GetType(), "MIDI") == 0 || strcmp(pcm->GetType(), "MIDIPOOL") == 0)
+		return NULL;
+
+	pcm = pcm->Duplicate();
+	if (pcm && !pcm->GetNumChannels())
+	{
+		delete pcm;
+		return NULL;
+	}
+
+	if (pcm)
+	{
+		double dZero = 0.0;
+		GetSetMediaItemInfo((MediaItem*)pcm, "D_POSITION", &dZero);
+	}
+	return pcm;
+}
+
+// no wait dialog, can be called from any thread
+bool AnalyzePreparedItem(ANALYZE_PCM* a)
+{
+	if (!a->pcm)
+		return false;
+
+	const double oldWinSize = a->dWindowSize;
+	if (a->dWindowSize > a->pcm->GetLength())
+		a->dWindowSize = 0.0;
+
+	a->success = AnalyzePCMSource(a);
+	a->dProgress = 1.0;
+
+	a->dWindowSize = oldWinSize;
+	return a->success;
+}
+
 // return true for successful analysis
 // wraps AnalyzePCM to check item validity and create a wait dialog
 bool AnalyzeItem(MediaItem* item, ANALYZE_PCM* a)
 {
 	a->dProgress = 0.0;
-	a->pcm = (PCM_source*)item;
-
-	if (!a->pcm || strcmp(a->pcm->GetType(), "MIDI") == 0 || strcmp(a->pcm->GetType(), "MIDIPOOL") == 0)
-		return false;
-
-	a->pcm = a->pcm->Duplicate();
-	if (!a->pcm || !a->pcm->GetNumChannels())
+	a->pcm = PrepareItemAnalysis(item);
+	if (!a->pcm)
 		return false;
 
-	double dZero = 0.0;
-	GetSetMediaItemInfo((MediaItem*)a->pcm, "D_POSITION", &dZero);
-
 	const char* cName = NULL;
 	MediaItem_Take* take = GetMediaItemTake(item, -1);
 	if (take)
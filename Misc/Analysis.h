@@ -47,12 +47,19 @@ typedef struct ANALYZE_PCM
 	INT64 sampleCount;      // out # of samples analyzed
 	double dWindowSize;     // RMS window in seconds.  If this is != 0.0, then RMS is calculated/returned as max within window
 	bool success;
+	double* dTotalRMSs;     // i/o Array of channel RMS values over the entire item, also calculated in windowed mode (optional)
+	double dTotalRMS;       // out RMS of all channels over the entire item, also calculated in windowed mode
 } ANALYZE_PCM;
 
 int AnalysisInit();
 
 bool AnalyzeItem(MediaItem* mi, ANALYZE_PCM* a);
 
+// For callers running their own worker threads: get the source on the main thread (caller deletes it)
+// then analyze it from any thread, a->pcm must be set to the prepared source
+PCM_source* PrepareItemAnalysis(MediaItem* item);
+bool AnalyzePreparedItem(ANALYZE_PCM* a);
+
 // #781 Export to ReaScript
 void NF_GetRMSOptions(double *targetOut, double *winSizeOut);
 bool NF_SetRMOptions(double target, double windowSize);
@@ -32,13 +32,23 @@
 // To mitigate these issues when dealing with operations that require many reads/writes,
 // Call SWS_GetSetObjectState and SWS_FreeHeapPtr instead.  When you want to cache your
 // state reads and writes call SWS_CacheObjectState(true).  When done call SWS_CacheObjectState(false)
-// and any changes will be written out.
+// and any changes will be written out.  Calls nest, so this is a project wide transaction:
+// SNM_ChunkParserPatcher and BR_Envelope go through it too, each object is read and written
+// at most once until the outermost SWS_CacheObjectState(false).
+// Call SWS_UncacheObjectState(obj) before altering an object by other means (API, direct
+// GetSetObjectState), pending changes are written and the next read gets a fresh state.
+// States set back unchanged are not written; reading a state from REAPER during a
+// transaction first writes the pending changes of the objects it contains or is part of
+// (e.g. a track and its items/envelopes), other changes wait for the end of the transaction.
+// Transactions are opt-in per action: while one is open, REAPER API getters don't see
+// pending changes, so actions that mix API and chunk accesses (track templates, routings,
+// etc..) must not be wrapped as a whole.
 //
 // See Snapshots for an example of use
 
 //#define GOS_DEBUG
 
-ObjectStateCache::ObjectStateCache():m_iUseCount(1)
+ObjectStateCache::ObjectStateCache():m_iUseCount(1),m_nbDirty(0)
 {
 }
 
@@ -52,13 +62,12 @@ void ObjectStateCache::WriteCache()
 #ifdef GOS_DEBUG
 	int iCount = 0;
 #endif
-	for (int i = 0; i < m_obj.GetSize(); i++)
+	for (int i = 0; i < m_states.GetSize(); i++)
 	{
-		if (m_str.Get(i)->GetLength() && m_orig.Get(i) && strcmp(m_str.Get(i)->Get(), m_orig.Get(i)))
+		CachedState* state = m_states.Get(i);
+		if (state->obj && state->bDirty)
 		{
-			int fxstate = SNM_PreObjectState(m_str.Get(i), false);
-			GetSetObjectState(m_obj.Get(i), m_str.Get(i)->Get());
-			SNM_PostObjectState(fxstate);
+			Write(state);
 #ifdef GOS_DEBUG
 			iCount++;
 #endif
@@ -71,41 +80,191 @@ void ObjectStateCache::WriteCache()
 	EmptyCache();
 }
 
-void ObjectStateCache::EmptyCache()
+void ObjectStateCache::Write(CachedState* state)
 {
-	m_obj.Empty();
-	m_str.Empty(true);
-	m_orig.Empty(true, FreeHeapPtr);
+	// ids are filtered when writing: obey the caller's choice at the time of the set
+	if (state->bKeepIds) g_disable_chunk_guid_filtering++;
+	int fxstate = SNM_PreObjectState(&state->str, false);
+	if (state->bKeepIds) g_disable_chunk_guid_filtering--;
+	GetSetObjectState(state->obj, state->str.Get());
+	SNM_PostObjectState(fxstate);
+	state->bDirty = false;
+	m_nbDirty--;
 }
 
-const char* ObjectStateCache::GetSetObjState(void* obj, const char* str, bool wantsMinimalState)
+// FNV-1a
+static WDL_UINT64 HashState(const char* str, int len)
 {
-	int i = m_obj.Find(obj);
-	if (i < 0)
+	WDL_UINT64 h = (WDL_UINT64)0xCBF29CE484222325ULL;
+	for (int i = 0; i < len; i++)
 	{
-		i = m_obj.GetSize();
-		m_obj.Add(obj);
-		m_str.Add(new WDL_FastString);
-		if (str && str[0])
-			m_orig.Add(NULL);
+		h ^= (unsigned char)str[i];
+		h *= (WDL_UINT64)0x00000100000001B3ULL;
+	}
+	return h;
+}
+
+// Length check first, the hash of the original state is computed once
+bool ObjectStateCache::IsUnchanged(CachedState* state, const char* str, int len)
+{
+	if (!state->orig)
+		return false;
+	if (state->origLen < 0)
+		state->origLen = (int)strlen(state->orig);
+	if (len != state->origLen)
+		return false;
+	if (!state->bHashed)
+	{
+		state->origHash = HashState(state->orig, state->origLen);
+		state->bHashed = true;
+	}
+	return HashState(str, len) == state->origHash;
+}
+
+// Returns false if the object type is unknown (then it's considered part of any other)
+bool ObjectStateCache::GetOwners(CachedState* state)
+{
+	if (state->iOwners < 0)
+	{
+		void* obj = state->obj;
+		state->owners[0] = state->owners[1] = NULL;
+		state->iOwners = 1;
+		if (ValidatePtr(obj, "MediaTrack*"))
+			;
+		else if (ValidatePtr(obj, "MediaItem*"))
+			state->owners[0] = GetMediaItem_Track((MediaItem*)obj);
+		else if (ValidatePtr(obj, "TrackEnvelope*"))
+		{
+			if (MediaItem* item = (MediaItem*)(INT_PTR)GetEnvelopeInfo_Value((TrackEnvelope*)obj, "P_ITEM"))
+			{
+				state->owners[0] = item;
+				state->owners[1] = GetMediaItem_Track(item);
+			}
+			else if (!(state->owners[0] = (MediaTrack*)(INT_PTR)GetEnvelopeInfo_Value((TrackEnvelope*)obj, "P_TRACK")))
+				state->iOwners = 0;
+		}
 		else
+			state->iOwners = 0;
+	}
+	return state->iOwners > 0;
+}
+
+// Writes and uncaches the pending states of the objects that contain obj or that obj
+// contains (e.g. a track's envelopes), a state read from REAPER must not miss them
+void ObjectStateCache::WritePending(void* obj)
+{
+	if (m_nbDirty <= 0)
+		return;
+
+	std::unordered_map<void*, CachedState*>::iterator it = m_index.find(obj);
+	CachedState* objState = it != m_index.end() ? it->second : NULL;
+	CachedState tmp;
+	if (!objState)
+	{
+		tmp.obj = obj;
+		tmp.iOwners = -1;
+		objState = &tmp;
+	}
+	const bool bKnown = GetOwners(objState);
+
+	for (int i = 0; m_nbDirty > 0 && i < m_states.GetSize(); i++)
+	{
+		CachedState* state = m_states.Get(i);
+		if (state->obj && state->bDirty && state != objState &&
+			(!bKnown || !GetOwners(state) ||
+			state->obj == objState->owners[0] || state->obj == objState->owners[1] ||
+			state->owners[0] == obj || state->owners[1] == obj))
+		{
+			Uncache(state->obj);
+		}
+	}
+}
+
+void ObjectStateCache::EmptyCache()
+{
+	for (int i = 0; i < m_states.GetSize(); i++)
+		if (m_states.Get(i)->orig)
+			FreeHeapPtr(m_states.Get(i)->orig);
+	m_states.Empty(true);
+	m_retired.Empty(true, FreeHeapPtr);
+	m_index.clear();
+	m_nbDirty = 0;
+}
+
+void ObjectStateCache::Uncache(void* obj)
+{
+	std::unordered_map<void*, CachedState*>::iterator it = m_index.find(obj);
+	if (it == m_index.end())
+		return;
+
+	CachedState* state = it->second;
+	if (state->bDirty)
+		Write(state);
+	state->obj = NULL; // freed with the cache, the caller may still use the returned state
+	m_index.erase(it);
+}
+
+const char* ObjectStateCache::GetSetObjState(void* obj, const char* str, int len, bool wantsMinimalState)
+{
+	const bool bSet = str && str[0];
+
+	CachedState* state;
+	std::unordered_map<void*, CachedState*>::iterator it = m_index.find(obj);
+	if (it != m_index.end())
+	{
+		state = it->second;
+		// a minimal state must not be returned to callers that want a full one
+		if (!bSet && !state->bDirty && state->bMinimal && !wantsMinimalState)
+		{
+			if (state->orig)
+				m_retired.Add(state->orig); // callers may still use it
+			WritePending(obj);
+			int fxstate = SNM_PreObjectState(NULL, false);
+			state->orig = GetSetObjectState(obj, NULL);
+			SNM_PostObjectState(fxstate);
+			state->origLen = -1;
+			state->bHashed = false;
+			state->bMinimal = false;
+		}
+	}
+	else
+	{
+		if (!bSet)
+			WritePending(obj);
+
+		state = m_states.Add(new CachedState);
+		state->obj = obj;
+		state->orig = NULL;
+		state->origLen = -1;
+		state->bDirty = false;
+		state->bMinimal = wantsMinimalState;
+		state->bKeepIds = false;
+		state->bHashed = false;
+		state->iOwners = -1;
+		if (!bSet)
 		{
 			int fxstate = SNM_PreObjectState(NULL, wantsMinimalState);
-			char* p = GetSetObjectState(obj, NULL);
+			state->orig = GetSetObjectState(obj, NULL);
 			SNM_PostObjectState(fxstate);
-			m_orig.Add(p);
 		}
+		m_index[obj] = state;
 	}
-	if (str && str[0])
+
+	if (bSet)
 	{
-		m_str.Get(i)->Set(str);
+		// unchanged states are not written (would re-instantiate FX, etc..)
+		const bool bDirty = !IsUnchanged(state, str, len);
+		m_nbDirty += (int)bDirty - (int)state->bDirty;
+		state->bDirty = bDirty;
+		if (bDirty)
+		{
+			state->str.Set(str);
+			state->bKeepIds = g_disable_chunk_guid_filtering > 0;
+		}
 		return NULL;
 	}
 
-	if (m_str.Get(i)->GetLength())
-		return m_str.Get(i)->Get();
-	else
-		return m_orig.Get(i);
+	return state->bDirty ? state->str.Get() : state->orig;
 }
 
 ObjectStateCache* g_objStateCache = NULL;
@@ -115,7 +274,7 @@ const char* SWS_GetSetObjectState(void* obj, WDL_FastString* str, bool wantsMini
 	const char* ret;
 	
 	if (g_objStateCache)
-		ret = g_objStateCache->GetSetObjState(obj, str ? str->Get() : NULL, wantsMinimalState);
+		ret = g_objStateCache->GetSetObjState(obj, str ? str->Get() : NULL, str ? str->GetLength() : 0, wantsMinimalState);
 	else
 	{
 		int fxstate = SNM_PreObjectState(str, wantsMinimalState);
@@ -145,12 +304,13 @@ void SWS_FreeHeapPtr(const char* ptr)
 	SWS_FreeHeapPtr((void*)ptr);
 }
 
+static SWS_Mutex s_cacheMutex;
+
 void SWS_CacheObjectState(bool bStart)
 {
-	static SWS_Mutex mutex;
 	if (bStart)
 	{
-		SWS_SectionLock lock(&mutex);
+		SWS_SectionLock lock(&s_cacheMutex);
 		if (g_objStateCache)
 			g_objStateCache->m_iUseCount++;
 		else
@@ -158,7 +318,7 @@ void SWS_CacheObjectState(bool bStart)
 	}
 	else if (g_objStateCache)
 	{
-		SWS_SectionLock lock(&mutex);
+		SWS_SectionLock lock(&s_cacheMutex);
 		if (g_objStateCache->m_iUseCount <= 1)
 		{
 			ObjectStateCache* cache = g_objStateCache;
@@ -172,6 +332,13 @@ void SWS_CacheObjectState(bool bStart)
 	}
 }
 
+void SWS_UncacheObjectState(void* obj)
+{
+	SWS_SectionLock lock(&s_cacheMutex);
+	if (g_objStateCache)
+		g_objStateCache->Uncache(obj);
+}
+
 // Helper function for parsing object "chunks" into more useful lines
 // newlines are retained.  Caller allocates the WDL_FastString necessary for the output
 // pos stores the state of the line parsing, set to zero to return the first line
@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <unordered_map>
+
 class ObjectStateCache
 {
 public:
@@ -35,18 +37,44 @@ public:
 	~ObjectStateCache();
 	void WriteCache();
 	void EmptyCache();
-	const char* GetSetObjState(void* obj, const char* str, bool wantsMinimalState = false);
+	const char* GetSetObjState(void* obj, const char* str, int len, bool wantsMinimalState = false);
+	void Uncache(void* obj);
 	int m_iUseCount;
 private:
-	WDL_PtrList<void> m_obj;
-	WDL_PtrList<WDL_FastString> m_str;
-	WDL_PtrList<char> m_orig;
+	struct CachedState
+	{
+		void* obj;
+		char* orig;
+		int origLen; // <0: not known yet
+		WDL_UINT64 origHash; // valid if bHashed
+		WDL_FastString str; // pending write, if dirty
+		bool bDirty, bMinimal, bKeepIds, bHashed;
+		int iOwners; // <0: not known yet, 0: unknown object type, 1: owners[] are valid
+		void* owners[2]; // containing objects, e.g. item and track of a take envelope
+	};
+	bool IsUnchanged(CachedState* state, const char* str, int len);
+	bool GetOwners(CachedState* state);
+	void Write(CachedState* state);
+	void WritePending(void* obj);
+	WDL_PtrList<CachedState> m_states; // read/write order
+	int m_nbDirty;
+	WDL_PtrList<char> m_retired;
+	std::unordered_map<void*, CachedState*> m_index;
 };
 
 const char* SWS_GetSetObjectState(void* obj, WDL_FastString* str, bool wantsMinimalState = false);
 void SWS_FreeHeapPtr(void* ptr);
 void SWS_FreeHeapPtr(const char* ptr);
 void SWS_CacheObjectState(bool bStart);
+void SWS_UncacheObjectState(void* obj);
+
+// Scoped object state transaction, see SWS_CacheObjectState()
+class SWS_ObjectStateTransaction
+{
+public:
+	SWS_ObjectStateTransaction() { SWS_CacheObjectState(true); }
+	~SWS_ObjectStateTransaction() { SWS_CacheObjectState(false); }
+};
 
 bool GetChunkLine(const char* chunk, char* line, int iLineMax, int* pos, bool bNewLine);
 void AppendChunkLine(WDL_FastString* chunk, const char* line);
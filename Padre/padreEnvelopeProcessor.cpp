@@ -223,6 +223,103 @@ EnvelopeProcessor::ErrorCode EnvelopeProcessor::getTrackEnvelopeMinMax(TrackEnve
 	return eERRORCODE_OK;
 }
 
+// Envelope points of a LFO, written in one go by writeLfoPoints()
+struct LfoPoint
+{
+	double t;
+	double v;
+	EnvShape shape;
+	LfoPoint(double _t, double _v, EnvShape _shape) : t(_t), v(_v), shape(_shape) {}
+};
+
+// Max error of a "slow start/end" segment (smoothstep) between two sine extrema, relative to the peak-to-peak amplitude
+#define	LFO_SLOW_SHAPE_ERROR	0.0101
+
+// Sine LFO from analytic extrema: one "slow start/end" segment per half cycle when it fits the error bound,
+// linear segments otherwise (step derived from the chord error of a sine)
+// dTolerance: max error relative to the peak-to-peak amplitude
+static void WriteSinePoints(vector<LfoPoint> &points, double dLength, double dFreq, double dDelaySec, double dOffset, double dMagnitude, double dScale, double dOff, double dTolerance)
+{
+	const double dPhaseStart = dFreq*dDelaySec;
+	const double dPhaseEnd = dFreq*(dLength+dDelaySec);
+	const bool bSlowShape = (dTolerance >= LFO_SLOW_SHAPE_ERROR);
+
+	// chord error of a sine over a phase step dPhi (radians): A*(1-cos(dPhi/2)), A = half of the peak-to-peak amplitude
+	double dMaxStep = 0.5; // in cycles
+	if(dTolerance < 1.0)
+		dMaxStep = 2.0*acos(1.0-2.0*dTolerance)/(2.0*PI);
+	if(dMaxStep < 0.001)
+		dMaxStep = 0.001;
+
+	// extrema are at phases 0.25 + k/2
+	double dExtremum = floor((dPhaseStart-0.25)*2.0)/2.0 + 0.25;
+	double dPhase = dPhaseStart;
+	bool bOnExtremum = false;
+	while(dPhase < dPhaseEnd)
+	{
+		dExtremum += 0.5;
+		while(dExtremum <= dPhase)
+			dExtremum += 0.5;
+		double dNext = dExtremum < dPhaseEnd ? dExtremum : dPhaseEnd;
+		bool bFullHalfCycle = bOnExtremum && dNext == dExtremum;
+
+		if(bFullHalfCycle && bSlowShape)
+		{
+			double dValue = dScale*(dOffset + dMagnitude*sin(2.0*PI*dPhase)) + dOff;
+			points.push_back(LfoPoint(dPhase/dFreq-dDelaySec, dValue, eENVSHAPE_SLOW));
+		}
+		else
+		{
+			int iSteps = (int)ceil((dNext-dPhase)/dMaxStep - 1e-9);
+			if(iSteps < 1)
+				iSteps = 1;
+			for(int i=0; i<iSteps; i++)
+			{
+				double dPh = dPhase + (dNext-dPhase)*i/iSteps;
+				double dValue = dScale*(dOffset + dMagnitude*sin(2.0*PI*dPh)) + dOff;
+				points.push_back(LfoPoint(dPh/dFreq-dDelaySec, dValue, eENVSHAPE_LINEAR));
+			}
+		}
+
+		dPhase = dNext;
+		bOnExtremum = true;
+	}
+}
+
+// Error-bounded simplification of linear runs: drops the points that lie within dMaxError of the line
+// joining the surrounding kept points (all dropped points are checked, not only the last one)
+static void SimplifyLinearPoints(vector<LfoPoint> &points, double dMaxError)
+{
+	if(points.size() < 3)
+		return;
+
+	vector<LfoPoint> kept;
+	kept.reserve(points.size());
+	kept.push_back(points[0]);
+	size_t anchor = 0;
+	for(size_t i=1; i+1<points.size(); i++)
+	{
+		bool bDrop = points[anchor].shape == eENVSHAPE_LINEAR && points[i].shape == eENVSHAPE_LINEAR;
+		if(bDrop)
+		{
+			const LfoPoint &a = points[anchor];
+			const LfoPoint &b = points[i+1];
+			for(size_t j=anchor+1; j<=i && bDrop; j++)
+			{
+				double dLine = a.v + (b.v-a.v)*(points[j].t-a.t)/(b.t-a.t);
+				bDrop = fabs(points[j].v-dLine) <= dMaxError;
+			}
+		}
+		if(!bDrop)
+		{
+			kept.push_back(points[i]);
+			anchor = i;
+		}
+	}
+	kept.push_back(points.back());
+	points.swap(kept);
+}
+
 void EnvelopeProcessor::writeLfoPoints(MediaItem_Take* take, string &envState, double dStartTime, double dEndTime, double dValMin, double dValMax, LfoWaveParams &waveParams, double dPrecision, LfoWaveParams* freqModulator)
 {
 	double dFreq, dDelay;
@@ -264,6 +361,19 @@ void EnvelopeProcessor::writeLfoPoints(MediaItem_Take* take, string &envState, d
 		break;
 	}
 
+	// no cycle at all: flat line at the offset
+	if(dFreq <= 0.0)
+	{
+		dValue = dScale*waveParams.offset + dOff;
+		for(int i=0; i<2; i++)
+		{
+			int iLen = snprintf(buffer, BUFFER_SIZE, "PT %lf %lf %d\n", i ? dEndTime : dStartTime, dValue, eENVSHAPE_LINEAR);
+			if(iLen > 0 && iLen < BUFFER_SIZE)
+				envState.append(buffer, iLen);
+		}
+		return;
+	}
+
 	double dPhase = 0.001*dDelay*dFreq;
 	dPhase = dPhase - (int)(dPhase);
 	if(dPhase<0.0)
@@ -331,38 +441,24 @@ void EnvelopeProcessor::writeLfoPoints(MediaItem_Take* take, string &envState, d
 	double dValueEnd = waveParams.offset + dMagnitude*dCarrierEnd;
 	dValueEnd = dScale*dValueEnd + dOff;
 
-	sprintf(buffer, "PT %lf %lf %d\n", dStartTime, dValueStart, tEnvShape);
-	envState.append(buffer);
-
-//double dFreqMod = dFreq;
-//freqModulator = new LfoWaveParams();
-//freqModulator->freqHz = dFreq/100.0;
-//freqModulator->strength = 0.6;
+	// corners/steps are computed from their index (no accumulated rounding errors on long time segments)
+	vector<LfoPoint> points;
+	int iFirstStep = (int)ceil(dDelaySec/dSamplerate);
+	if(iFirstStep*dSamplerate - dDelaySec <= 0.0)
+		iFirstStep++;
+	int iNbSteps = (int)((dLength+dDelaySec)/dSamplerate) + 1;
 
 	switch(waveParams.shape)
 	{
 		case eWAVSHAPE_SINE :
 		{
-			for(double t = -dDelaySec; t<dLength; t += dSamplerate)
-			{
-				if(t>0.0)
-				{
-//if(freqModulator)
-//{
-//	double dFreqCarrier = WaveformGeneratorSawUp(t, freqModulator->freqHz, 1000.0*freqModulator->delayMsec);
-//	dFreqMod = dFreq*(1.0 + freqModulator->strength * dFreqCarrier);
-//	// Watch out for NaNs !!!
-////	dSamplerate = dPrecision/dFreqMod;
-//	dSamplerate = 0.01;
-//}
-
-					dValue = waveParams.offset + dMagnitude*WaveformGeneratorSin(t, dFreq, dDelaySec);
-//dValue = waveParams.offset + dMagnitude*WaveformGeneratorSin(t, dFreqMod, dDelaySec);
-					dValue = dScale*dValue + dOff;
-					sprintf(buffer, "PT %lf %lf %d\n", t+dStartTime, dValue, tEnvShape);
-					envState.append(buffer);
-				}
-			}
+			// error bound: a quarter of the precision (former sampling step, in cycles), relative to the peak-to-peak amplitude
+			// i.e. 1.25% with the default precision: one "slow start/end" segment per half cycle
+			double dTolerance = 0.25*dPrecision;
+			WriteSinePoints(points, dLength, dFreq, dDelaySec, waveParams.offset, dMagnitude, dScale, dOff, dTolerance);
+			SimplifyLinearPoints(points, dTolerance*2.0*fabs(dMagnitude*dScale));
+			for(size_t i=0; i<points.size(); i++)
+				points[i].t += dStartTime;
 		}
 		break;
 
@@ -370,19 +466,16 @@ void EnvelopeProcessor::writeLfoPoints(MediaItem_Take* take, string &envState, d
 		case eWAVSHAPE_TRIANGLE_BEZIER :
 		case eWAVSHAPE_SQUARE :
 		{
-			//for(double t = dStartTime-dDelaySec; t < dEndTime; t += dSamplerate)
-			for(double t = -dDelaySec; t<dLength; t += dSamplerate)
+			points.push_back(LfoPoint(dStartTime, dValueStart, tEnvShape));
+			for(int i=iFirstStep; i<iNbSteps; i++)
 			{
-				//if(t<=dStartTime)
-					//continue;
-				if(t>0.0)
-				{
-					dValue = waveParams.offset + dMagnitude*dFlipFlop;
-					dValue = dScale*dValue + dOff;
-					sprintf(buffer, "PT %lf %lf %d\n", t+dStartTime, dValue, tEnvShape);
-					envState.append(buffer);
-					dFlipFlop = -dFlipFlop;
-				}
+				double t = i*dSamplerate - dDelaySec;
+				if(t >= dLength)
+					break;
+				dValue = waveParams.offset + dMagnitude*dFlipFlop;
+				dValue = dScale*dValue + dOff;
+				points.push_back(LfoPoint(t+dStartTime, dValue, tEnvShape));
+				dFlipFlop = -dFlipFlop;
 			}
 		}
 		break;
@@ -392,18 +485,18 @@ void EnvelopeProcessor::writeLfoPoints(MediaItem_Take* take, string &envState, d
 		case eWAVSHAPE_SAWUP_BEZIER :
 		case eWAVSHAPE_SAWDOWN_BEZIER :
 		{
-			for(double t = -dDelaySec; t<dLength; t += dSamplerate)
+			points.push_back(LfoPoint(dStartTime, dValueStart, tEnvShape));
+			for(int i=iFirstStep; i<iNbSteps; i++)
 			{
-				if(t>0.0)
+				double t = i*dSamplerate - dDelaySec;
+				if(t >= dLength)
+					break;
+				for(int j=0; j<2; j++)
 				{
-					for(int i=0; i<2; i++)
-					{
-						dValue = waveParams.offset + dMagnitude*dFlipFlop;
-						dValue = dScale*dValue + dOff;
-						sprintf(buffer, "PT %lf %lf %d\n", t+dStartTime, dValue, tEnvShape);
-						envState.append(buffer);
-						dFlipFlop = -dFlipFlop;
-					}
+					dValue = waveParams.offset + dMagnitude*dFlipFlop;
+					dValue = dScale*dValue + dOff;
+					points.push_back(LfoPoint(t+dStartTime, dValue, tEnvShape));
+					dFlipFlop = -dFlipFlop;
 				}
 			}
 
@@ -418,15 +511,15 @@ void EnvelopeProcessor::writeLfoPoints(MediaItem_Take* take, string &envState, d
 		case eWAVSHAPE_RANDOM :
 		case eWAVSHAPE_RANDOM_BEZIER :
 		{
-			for(double t = -dDelaySec; t<dLength; t += dSamplerate)
+			points.push_back(LfoPoint(dStartTime, dValueStart, tEnvShape));
+			for(int i=iFirstStep; i<iNbSteps; i++)
 			{
-				if(t>0.0)
-				{
-					dValue = waveParams.offset + dMagnitude*WaveformGeneratorRandom(t, dFreq, dDelaySec);
-					dValue = dScale*dValue + dOff;
-					sprintf(buffer, "PT %lf %lf %d\n", t+dStartTime, dValue, tEnvShape);
-					envState.append(buffer);
-				}
+				double t = i*dSamplerate - dDelaySec;
+				if(t >= dLength)
+					break;
+				dValue = waveParams.offset + dMagnitude*WaveformGeneratorRandom(t, dFreq, dDelaySec);
+				dValue = dScale*dValue + dOff;
+				points.push_back(LfoPoint(t+dStartTime, dValue, tEnvShape));
 			}
 		}
 		break;
@@ -435,8 +528,16 @@ void EnvelopeProcessor::writeLfoPoints(MediaItem_Take* take, string &envState, d
 		break;
 	}
 
-	sprintf(buffer, "PT %lf %lf %d\n", dEndTime, dValueEnd, tEnvShape);
-	envState.append(buffer);
+	points.push_back(LfoPoint(dEndTime, dValueEnd, tEnvShape));
+
+	// write all points in one go
+	envState.reserve(envState.size() + points.size()*48 + 2);
+	for(size_t i=0; i<points.size(); i++)
+	{
+		int iLen = snprintf(buffer, BUFFER_SIZE, "PT %lf %lf %d\n", points[i].t, points[i].v, points[i].shape);
+		if(iLen > 0 && iLen < BUFFER_SIZE)
+			envState.append(buffer, iLen);
+	}
 }
 
 EnvelopeProcessor::ErrorCode EnvelopeProcessor::processPoints(char* envState, string &newState, double dStartPos, double dEndPos, double dValMin, double dValMax, EnvModType envModType, double dStrength, double dOffset)
@@ -575,6 +676,7 @@ EnvelopeProcessor::ErrorCode EnvelopeProcessor::generateTrackLfo(TrackEnvelope*
 		return eERRORCODE_NOOBJSTATE;
 
 	string newState;
+	newState.reserve(strlen(envState)); // LFO points are reserved by writeLfoPoints()
 	double dValMin = 0.0;
 	double dValMax = 1.0;
 	double dTmp[2];
@@ -726,6 +828,7 @@ EnvelopeProcessor::ErrorCode EnvelopeProcessor::generateTakeLfo(MediaItem_Take*
 	}
 	
 	char* envState = &envStateStr[0];
+	newState.reserve(envStateStr.size()); // LFO points are reserved by writeLfoPoints()
 	double dTmp[2];
 	int iTmp;
 	char* token = strtok(envState, "\n");
@@ -945,8 +1048,9 @@ EnvelopeProcessor::getFreqDelay(_pParameters->waveParams, dFreq, dDelay);
 	if(iPrecision<1)
 		iPrecision = 1;
 
+	// decimated: a CC event is only sent when the 7-bit value changes (same output, fewer events)
 	double t, dValue;
-	int iValue;
+	int iValue, iLastValue = -1;
 	for(int pos = 0; pos<itemLengthSamples; pos += iPrecision)
 	{
 		t = (double)pos/MIDIITEMPROC_DEFAULT_SAMPLERATE;
@@ -954,6 +1058,9 @@ EnvelopeProcessor::getFreqDelay(_pParameters->waveParams, dFreq, dDelay);
 		dValue = _pParameters->waveParams.offset + dMagnitude*WaveformGenerator(t, dFreq, 0.001*dDelay);
 		dValue = dScale*dValue + dOff;
 		iValue = (int)(127.0*dValue);
+		if(iValue == iLastValue)
+			continue;
+		iLastValue = iValue;
 
 		MIDI_event_t evt;
 		evt.frame_offset = pos;
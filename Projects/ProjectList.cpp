@@ -29,11 +29,15 @@
 
 #include "ProjectList.h"
 #include "ProjectMgr.h"
+#include "../SnM/SnM_Dlg.h"
 
 #include <WDL/localize/localize.h>
 
+#define PROJLIST_WND_ID		"SWSProjectList"
+
 // Globals
-SWS_ProjectListWnd* g_pProjList = NULL;
+// The window is only instantiated when it was left open or is opened (lazy init)
+SNM_WindowManager<SWS_ProjectListWnd> g_projListWndMgr(PROJLIST_WND_ID);
 
 // !WANT_LOCALIZE_STRINGS_BEGIN:sws_DLG_146
 static SWS_LVColumn g_cols[] = { { 30, 0, "#" }, { 100, 0, "Name" }, { 185, 0, "Path", -1 }, };
@@ -84,7 +88,8 @@ void SWS_ProjectListView::GetItemText(SWS_ListItem* item, int iCol, char* str, i
 void SWS_ProjectListView::OnItemDblClk(SWS_ListItem* item, int iCol)
 {
 	SelectProjectInstance((ReaProject*)item);
-	g_pProjList->Show(false, true);
+	if (SWS_ProjectListWnd* w = g_projListWndMgr.Get())
+		w->Show(false, true);
 }
 
 void SWS_ProjectListView::GetItemList(SWS_ListItemList* pList)
@@ -96,8 +101,9 @@ void SWS_ProjectListView::GetItemList(SWS_ListItemList* pList)
 }
 
 SWS_ProjectListWnd::SWS_ProjectListWnd()
-:SWS_DockWnd(IDD_PROJLIST, __LOCALIZE("Project List","sws_DLG_157"), "SWSProjectList")
+:SWS_DockWnd(IDD_PROJLIST, __LOCALIZE("Project List","sws_DLG_157"), "")
 {
+	m_id.Set(PROJLIST_WND_ID);
 	// Must call SWS_DockWnd::Init() to restore parameters and open the window if necessary
 	Init();
 }
@@ -155,28 +161,31 @@ int SWS_ProjectListWnd::OnKey(MSG* msg, int iKeyState)
 
 void OpenProjectList(COMMAND_T*)
 {
-	g_pProjList->Show(true, true);
+	if (SWS_ProjectListWnd* w = g_projListWndMgr.Create())
+		w->Show(true, true);
 }
 
 int ProjectListEnabled(COMMAND_T*)
 {
-	return g_pProjList->IsWndVisible();
+	if (SWS_ProjectListWnd* w = g_projListWndMgr.Get())
+		return w->IsWndVisible();
+	return 0;
 }
 
 void ProjectListUpdate()
 {
-	g_pProjList->Update();
+	if (SWS_ProjectListWnd* w = g_projListWndMgr.Get())
+		w->Update();
 	UpdateOpenProjectTabActions();
 }
 
 int ProjectListInit()
 {
-	g_pProjList = new SWS_ProjectListWnd();
-
+	g_projListWndMgr.Init();
 	return 1;
 }
 
 void ProjectListExit()
 {
-	DELETE_NULL(g_pProjList);
+	g_projListWndMgr.Delete();
 }
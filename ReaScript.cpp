@@ -44,7 +44,9 @@
 // you will find also the realed reascript_test.eel and reascript_test.lua in the repo (python: todo).
 //#define _TEST_REASCRIPT_EXPORT
 #ifdef _TEST_REASCRIPT_EXPORT
-  #include "reascript_test.c" // test all possible parameter/return types
+  #include "Utility/Base64.h"
+  #include "Utility/TempoMap.h"
+  #include "reascript_test.c" // test all possible parameter/return types (+ some internals)
 #endif
 
 #ifdef _WIN32
@@ -132,6 +134,8 @@ APIdef g_apidefs[] =
 	{ APITESTFUNC(SNM_test6), "const char*", "char*", "a", "", }, // not an "Out" parm
 	{ APITESTFUNC(SNM_test7), "double", "int,int*,double*,bool*,char*,const char*", "i,aOut,bInOptional,cOutOptional,sOutOptional,csInOptional", "", },
 	{ APITESTFUNC(SNM_test8), "const char*", "char*,int,const char*,int,int,char*,int,int*", "buf1,buf1_sz,buf2,buf2_sz,i,buf3,buf3_sz,iOutOptional", "", },
+	{ APITESTFUNC(SNM_test9), "double", "int*", "mismatchesOut", "", },
+	{ APITESTFUNC(SNM_test10), "int", "", "", "", },
 #endif
 	{ APIFUNC(SNM_CreateFastString), "WDL_FastString*", "const char*", "str", "[S&M] Instantiates a new \"fast string\". You must delete this string, see SNM_DeleteFastString.", },
 	{ APIFUNC(SNM_DeleteFastString), "void", "WDL_FastString*", "str", "[S&M] Deletes a \"fast string\" instance.", },
@@ -180,11 +184,14 @@ APIdef g_apidefs[] =
 	{ APIFUNC(BR_EnvGetParentTake), "MediaItem_Take*", "BR_Envelope*", "envelope", "[BR] If envelope object allocated with <a href=\"#BR_EnvAlloc\">BR_EnvAlloc</a> is take envelope, returns parent media item take, otherwise NULL.", },
 	{ APIFUNC(BR_EnvGetParentTrack), "MediaTrack*", "BR_Envelope*", "envelope", "[BR] Get parent track of envelope object allocated with <a href=\"#BR_EnvAlloc\">BR_EnvAlloc</a>. If take envelope, returns NULL.", },
 	{ APIFUNC(BR_EnvGetPoint), "bool", "BR_Envelope*,int,double*,double*,int*,bool*,double*", "envelope,id,positionOut,valueOut,shapeOut,selectedOut,bezierOut", "[BR] Get envelope point by id (zero-based) from the envelope object allocated with <a href=\"#BR_EnvAlloc\">BR_EnvAlloc</a>. Returns true on success.", },
+	{ APIFUNC(BR_EnvGetPoints), "int", "BR_Envelope*,int,reaper_array*,reaper_array*,reaper_array*,reaper_array*,reaper_array*", "envelope,startId,positions,values,shapes,selected,beziers", "[BR] Get consecutive envelope points starting at startId (zero-based) from the envelope object allocated with <a href=\"#BR_EnvAlloc\">BR_EnvAlloc</a>, in one call. Arrays are created with reaper.new_array(), any of them can be nil. Reads as many points as fit in the smallest passed array.\nReturns the number of points read.\nSee <a href=\"#BR_EnvGetPoint\">BR_EnvGetPoint</a>.", },
 	{ APIFUNC(BR_EnvGetProperties), "void", "BR_Envelope*,bool*,bool*,bool*,bool*,int*,int*,double*,double*,double*,int*,bool*,int*", "envelope,activeOut,visibleOut,armedOut,inLaneOut,laneHeightOut,defaultShapeOut,minValueOut,maxValueOut,centerValueOut,typeOut,faderScalingOut,automationItemsOptionsOutOptional", "[BR] Get envelope properties for the envelope object allocated with <a href=\"#BR_EnvAlloc\">BR_EnvAlloc</a>.\n\nactive: true if envelope is active\nvisible: true if envelope is visible\narmed: true if envelope is armed\ninLane: true if envelope has it's own envelope lane\nlaneHeight: envelope lane override height. 0 for none, otherwise size in pixels\ndefaultShape: default point shape: 0->Linear, 1->Square, 2->Slow start/end, 3->Fast start, 4->Fast end, 5->Bezier\nminValue: minimum envelope value\nmaxValue: maximum envelope value\ntype: envelope type: 0->Volume, 1->Volume (Pre-FX), 2->Pan, 3->Pan (Pre-FX), 4->Width, 5->Width (Pre-FX), 6->Mute, 7->Pitch, 8->Playrate, 9->Tempo map, 10->Parameter\nfaderScaling: true if envelope uses fader scaling\nautomationItemsOptions: -1->project default, &1=0->don't attach to underl. env., &1->attach to underl. env. on right side,  &2->attach to underl. env. on both sides, &4: bypass underl. env.", },
 	{ APIFUNC(BR_EnvSetPoint), "bool", "BR_Envelope*,int,double,double,int,bool,double", "envelope,id,position,value,shape,selected,bezier", "[BR] Set envelope point by id (zero-based) in the envelope object allocated with <a href=\"#BR_EnvAlloc\">BR_EnvAlloc</a>. To create point instead, pass id = -1. Note that if new point is inserted or existing point's time position is changed, points won't automatically get sorted. To do that, see BR_EnvSortPoints.\nReturns true on success.", },
+	{ APIFUNC(BR_EnvSetPoints), "int", "BR_Envelope*,int,reaper_array*,reaper_array*,reaper_array*,reaper_array*,reaper_array*", "envelope,startId,positions,values,shapes,selected,beziers", "[BR] Set or create multiple envelope points in one call for the envelope object allocated with <a href=\"#BR_EnvAlloc\">BR_EnvAlloc</a>. Arrays are created with reaper.new_array().\nTo create new points pass startId -1: positions and values are mandatory, shapes, selected and beziers can be nil (default shape, unselected, no tension). New points are appended so call <a href=\"#BR_EnvSortPoints\">BR_EnvSortPoints</a> afterwards if needed.\nOtherwise existing points starting at startId (zero-based) are edited and any nil array keeps the current values.\nProcesses as many points as fit in the smallest passed array, returns the number of points set.\nSee <a href=\"#BR_EnvSetPoint\">BR_EnvSetPoint</a>.", },
 	{ APIFUNC(BR_EnvSetProperties), "void", "BR_Envelope*,bool,bool,bool,bool,int,int,bool,int*", "envelope,active,visible,armed,inLane,laneHeight,defaultShape,faderScaling,automationItemsOptionsInOptional", "[BR] Set envelope properties for the envelope object allocated with <a href=\"#BR_EnvAlloc\">BR_EnvAlloc</a>. For parameter description see BR_EnvGetProperties.\nSetting automationItemsOptions requires REAPER 5.979+.", },
 	{ APIFUNC(BR_EnvSortPoints), "void", "BR_Envelope*", "envelope", "[BR] Sort envelope points by position. The only reason to call this is if sorted points are explicitly needed after editing them with <a href=\"#BR_EnvSetPoint\">BR_EnvSetPoint</a>. Note that you do not have to call this before doing <a href=\"#BR_EnvFree\">BR_EnvFree</a> since it does handle unsorted points too.", },
 	{ APIFUNC(BR_EnvValueAtPos), "double", "BR_Envelope*,double", "envelope,position", "[BR] Get envelope value at time position for the envelope object allocated with <a href=\"#BR_EnvAlloc\">BR_EnvAlloc</a>.", },
+	{ APIFUNC(BR_EnvValuesAtPos), "int", "BR_Envelope*,reaper_array*,reaper_array*", "envelope,positions,values", "[BR] Get envelope values at all time positions in positions array (reaper.new_array()) and write them to values, in one call. Returns the number of values written (limited by the smaller array).\nSee <a href=\"#BR_EnvValueAtPos\">BR_EnvValueAtPos</a>.", },
 	{ APIFUNC(BR_GetArrangeView), "void", "ReaProject*,double*,double*", "proj,startTimeOut,endTimeOut", "[BR] Deprecated, see GetSet_ArrangeView2 (REAPER v5.12pre4+) -- Get start and end time position of arrange view. To set arrange view instead, see BR_SetArrangeView.", },
 	{ APIFUNC(BR_GetClosestGridDivision), "double", "double", "position", "[BR] Get closest grid division to position. Note that this functions is different from <a href=\"#SnapToGrid\">SnapToGrid</a> in two regards. SnapToGrid() needs snap enabled to work and this one works always. Secondly, grid divisions are different from grid lines because some grid lines may be hidden due to zoom level - this function ignores grid line visibility and always searches for the closest grid division at given position. For more grid division functions, see <a href=\"#BR_GetNextGridDivision\">BR_GetNextGridDivision</a> and <a href=\"#BR_GetPrevGridDivision\">BR_GetPrevGridDivision</a>.", },
 	{ APIFUNC(BR_GetCurrentTheme), "void", "char*,int,char*,int", "themePathOut,themePathOut_sz,themeNameOut,themeNameOut_sz", "[BR] Get current theme information. themePathOut is set to full theme path and themeNameOut is set to theme name excluding any path info and extension", },
@@ -288,6 +295,13 @@ APIdef g_apidefs[] =
 	{ APIFUNC(NF_GetMediaItemAverageRMS), "double", "MediaItem*", "item", "Returns the average overall (non-windowed) dB RMS level of active channels of an audio item active take, post item gain, post take volume envelope, post-fade, pre fader, pre item FX. \n Returns -150.0 if MIDI take or empty item.", },
 	{ APIFUNC(NF_AnalyzeMediaItemPeakAndRMS), "bool", "MediaItem*,double,void*,void*,void*,void*", "item,windowSize,reaper.array_peaks,reaper.array_peakpositions,reaper.array_RMSs,reaper.array_RMSpositions", "This function combines all other NF_Peak/RMS functions in a single one and additionally returns peak RMS positions. Lua example code <a href=\"https://forum.cockos.com/showpost.php?p=2050961&postcount=6\">here</a>. Note: It's recommended to use this function with ReaScript/Lua as it provides reaper.array objects. If using this function with other scripting languages, you must provide arrays in the <a href=\"https://forum.cockos.com/showpost.php?p=2039829&postcount=2\">reaper.array</a> format.", },
 
+	{ APIFUNC(NF_AnalysisBatch_Create), "NF_AnalysisBatch*", "", "", "Create a batch for analyzing many items at once on worker threads. Add items with <a href=\"#NF_AnalysisBatch_AddItem\">NF_AnalysisBatch_AddItem</a>, then call <a href=\"#NF_AnalysisBatch_Start\">NF_AnalysisBatch_Start</a>. Note: The batch must be freed with <a href=\"#NF_AnalysisBatch_Free\">NF_AnalysisBatch_Free</a>.", },
+	{ APIFUNC(NF_AnalysisBatch_AddItem), "bool", "NF_AnalysisBatch*,MediaItem*", "batch,item", "Add an item to the batch (active take is analyzed). Returns false once the batch was started.", },
+	{ APIFUNC(NF_AnalysisBatch_Start), "bool", "NF_AnalysisBatch*,int,bool", "batch,metrics,wait", "Analyze all items in the batch. All requested metrics of an item are computed together (peak and RMS values in a single pass), items are spread across worker threads. Each item is analyzed post item gain, post take volume, same as the matching NF_GetMediaItem*/NF_AnalyzeTakeLoudness functions.\nmetrics (bitmask): 1=max. peak (dBFS), 2=max. peak position, 4=average RMS, 8=highest non-windowed channel RMS, 16=windowed peak RMS (see <a href=\"#NF_SetSWS_RMSoptions\">NF_SetSWS_RMSoptions</a>), 32=LUFS integrated, 64=loudness range, 128=true peak (dBTP), 256=true peak position, 512=short-term max., 1024=momentary max. Positions are relative to item start.\nwait=true: blocks (showing a progress window) until done, otherwise returns immediately, poll <a href=\"#NF_AnalysisBatch_GetProgress\">NF_AnalysisBatch_GetProgress</a> (e.g. in a defer loop) to keep REAPER responsive.", },
+	{ APIFUNC(NF_AnalysisBatch_GetProgress), "double", "NF_AnalysisBatch*", "batch", "Returns analysis progress from 0.0 to 1.0, 1.0 when results are available. Returns -1 for an invalid batch.", },
+	{ APIFUNC(NF_AnalysisBatch_GetResults), "int", "NF_AnalysisBatch*,int,reaper_array*", "batch,metric,values", "Get the values of a single metric (see <a href=\"#NF_AnalysisBatch_Start\">NF_AnalysisBatch_Start</a>) for all items of a completed batch, in the order they were added. values is created with reaper.new_array(). Items that couldn't be analyzed (MIDI, empty...) get -150 (levels), -1 (positions) or 0 (loudness range).\nReturns the number of values written, 0 while the analysis is running.", },
+	{ APIFUNC(NF_AnalysisBatch_Free), "void", "NF_AnalysisBatch*", "batch", "Free a batch allocated with <a href=\"#NF_AnalysisBatch_Create\">NF_AnalysisBatch_Create</a>, aborting a running analysis.", },
+
 	// #880
 	{ APIFUNC(NF_AnalyzeTakeLoudness_IntegratedOnly), "bool", "MediaItem_Take*,double*", "take,lufsIntegratedOut", "Does LUFS integrated analysis only. Faster than full loudness analysis (<a href=\"#NF_AnalyzeTakeLoudness\">NF_AnalyzeTakeLoudness</a>) . Use this if only LUFS integrated is required. Take vol. env. is taken into account. See: <a href=\"http://wiki.cockos.com/wiki/index.php/Measure_and_normalize_loudness_with_SWS\">Signal flow</a>", },
 	{ APIFUNC(NF_AnalyzeTakeLoudness), "bool", "MediaItem_Take*,bool,double*,double*,double*,double*,double*,double*", "take,analyzeTruePeak,lufsIntegratedOut,rangeOut, truePeakOut,truePeakPosOut,shortTermMaxOut,momentaryMaxOut", "Full loudness analysis. retval: returns true on successful analysis, false on MIDI take or when analysis failed for some reason. analyzeTruePeak=true: Also do true peak analysis. Returns true peak value in dBTP and true peak position (relative to item position). Considerably slower than without true peak analysis (since it uses oversampling). Note: Short term uses a time window of 3 sec. for calculation. So for items shorter than this shortTermMaxOut can't be calculated correctly. Momentary uses a time window of 0.4 sec. ", },
@@ -92,6 +92,7 @@ static COMMAND_T s_cmdTable[] =
 
 	{ { DEFACCEL, "SWS/S&M: Copy selected tracks routings" }, "S&M_COPYSNDRCV2", CopyRoutings, NULL, },
 	{ { DEFACCEL, "SWS/S&M: Paste routings to selected tracks" }, "S&M_PASTSNDRCV2", PasteRoutings, NULL, },
+	{ { DEFACCEL, "SWS/S&M: Paste routings to selected tracks (dry run, show planned changes)" }, "S&M_PASTSNDRCV2_DRYRUN", PasteRoutingsDryRun, NULL, },
 	{ { DEFACCEL, "SWS/S&M: Cut selected tracks routings" }, "S&M_CUTSNDRCV2", CutRoutings, NULL, },
 
 	{ { DEFACCEL, "SWS/S&M: Copy selected tracks sends" }, "S&M_COPYSNDRCV3", CopySends, NULL, },
@@ -1114,8 +1115,8 @@ int MidiOscActionJob::AdjustRelative(int _adjmode, int _reladj)
 
 WDL_FastString g_SNM_IniFn, g_SNM_CyclIniFn, g_SNM_DiffToolFn;
 int g_SNM_Beta=0, g_SNM_LearnPitchAndNormOSC=0;
-int g_SNM_MediaFlags=0, g_SNM_ToolbarRefreshFreq=SNM_DEF_TOOLBAR_RFRSH_FREQ;
-bool g_SNM_ToolbarRefresh = false;
+int g_SNM_MediaFlags=0, g_SNM_ToolbarRefreshFreq=SNM_DEF_TOOLBAR_RFRSH_FREQ, g_SNM_PreviewCacheSize=SNM_DEF_PREVIEW_CACHE_SIZE;
+bool g_SNM_ToolbarRefresh = false, g_SNM_DiffTrackTemplates = true;
 
 
 void IniFileInit()
@@ -1127,9 +1128,11 @@ void IniFileInit()
 	SNM_UpgradeIniFiles(iniVersion);
 
 	g_SNM_MediaFlags |= (GetPrivateProfileInt("General", "MediaFileLockAudio", 0, g_SNM_IniFn.Get()) ? 1:0);
+	g_SNM_PreviewCacheSize = BOUNDED(GetPrivateProfileInt("General", "MediaFilePreloadCacheSize", SNM_DEF_PREVIEW_CACHE_SIZE, g_SNM_IniFn.Get()), 16, 4096);
 	g_SNM_ToolbarRefresh = (GetPrivateProfileInt("General", "ToolbarsAutoRefresh", 1, g_SNM_IniFn.Get()) == 1);
 	g_SNM_ToolbarRefreshFreq = BOUNDED(GetPrivateProfileInt("General", "ToolbarsAutoRefreshFreq", SNM_DEF_TOOLBAR_RFRSH_FREQ, g_SNM_IniFn.Get()), 100, 5000);
 	g_SNM_SupportBuggyPlug = GetPrivateProfileInt("General", "BuggyPlugsSupport", 0, g_SNM_IniFn.Get());
+	g_SNM_DiffTrackTemplates = (GetPrivateProfileInt("General", "TrackTemplatesDiffApply", 1, g_SNM_IniFn.Get()) == 1);
 
 	// #1175, prompt by default, may be overridden
 	if (GetPrivateProfileInt("Misc", "RemoveAllEnvsSelTracksPrompt", -666, g_SNM_IniFn.Get()) == -666)
@@ -1163,9 +1166,11 @@ void IniFileExit()
 	// general prefs
 		<< "IniFileUpgrade=" << SNM_INI_FILE_VERSION << '\0'
 		<< "MediaFileLockAudio=" << (g_SNM_MediaFlags&1 ? 1 : 0) << '\0'
+		<< "MediaFilePreloadCacheSize=" << g_SNM_PreviewCacheSize << " ; in MB (min: 16, max: 4096)" << '\0'
 		<< "ToolbarsAutoRefresh=" << (g_SNM_ToolbarRefresh ? 1 : 0) << '\0'
 		<< "ToolbarsAutoRefreshFreq=" << g_SNM_ToolbarRefreshFreq << " ; in ms (min: 100, max: 5000)" << '\0'
 		<< "BuggyPlugsSupport=" << (g_SNM_SupportBuggyPlug ? 1 : 0) << '\0'
+		<< "TrackTemplatesDiffApply=" << (g_SNM_DiffTrackTemplates ? 1 : 0) << '\0'
 #ifdef _WIN32
 		<< "ClearTypeFont=" << (g_SNM_ClearType ? 1 : 0) << '\0'
 		<< "DiffTool=\"" << g_SNM_DiffToolFn.Get() << '"' << '\0'
@@ -1253,6 +1258,7 @@ void SNM_Exit()
 	CyclactionExit();
 	SNM_UIExit();
 	IniFileExit();
+	SNM_FlushIniFile(); // pending in-memory ini writes, if any
 #ifdef _SNM_MISC
 	plugin_register("-hookcustommenu", (void*)SNM_Menuhook);
 #endif
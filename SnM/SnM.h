@@ -125,7 +125,7 @@
 #define SNM_CSURF_EXT_UNREGISTER   0x00016666
 #define SNM_REAPER_IMG_EXTS        "png,pcx,jpg,jpeg,jfif,ico,bmp" // img exts supported by REAPER (v4.32), can't get those at runtime yet
 #define SNM_INI_EXT_LIST           "INI files (*.INI)\0*.INI\0All Files\0*.*\0"
-#define SNM_SUB_EXT_LIST           "SubRip subtitle files (*.SRT)\0*.SRT\0"
+#define SNM_SUB_EXT_LIST           "SubRip subtitle files (*.SRT)\0*.SRT\0WebVTT subtitle files (*.VTT)\0*.VTT\0"
 #define SNM_TXT_EXT_LIST           "Text files (*.txt)\0*.txt\0All files (*.*)\0*.*\0"
 
 #define SNM_MARKER_MASK            1
@@ -201,9 +201,9 @@ vezn/Q+t/AIQiCv/Q4iRxAAAAABJRU5ErkJggg==\n"
 // Misc global/common classes, vars, etc.
 ///////////////////////////////////////////////////////////////////////////////
 
-extern int g_SNM_Beta, g_SNM_LearnPitchAndNormOSC, g_SNM_MediaFlags, g_SNM_ToolbarRefreshFreq;
+extern int g_SNM_Beta, g_SNM_LearnPitchAndNormOSC, g_SNM_MediaFlags, g_SNM_ToolbarRefreshFreq, g_SNM_PreviewCacheSize;
 extern WDL_FastString g_SNM_IniFn, g_SNM_CyclIniFn, g_SNM_DiffToolFn;
-extern bool g_SNM_ToolbarRefresh;
+extern bool g_SNM_ToolbarRefresh, g_SNM_DiffTrackTemplates;
 
 
 class SNM_TrackInt {
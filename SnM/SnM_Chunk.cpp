@@ -70,6 +70,50 @@ bool SNM_ChunkIndenter::NotifyChunkLine(int _mode,
 // no NotifySkippedSubChunk() needed: single lines (not sub-chunks)
 ///////////////////////////////////////////////////////////////////////////////
 
+// _rest: tokens following the MIDI flags (automation mode, etc..)
+static void AppendReceiveLine(WDL_FastString* _chunk, int _srcIdx, const SNM_SndRcv* _io, const char* _rest)
+{
+	_chunk->AppendFormatted(
+		SNM_MAX_CHUNK_LINE_LENGTH,
+		"AUXRECV %d %d %.14f %.14f %d %d %d %d %d %.14f %d %s\n", 
+		_srcIdx, 
+		_io->m_mode, 
+		_io->m_vol, 
+		_io->m_pan,
+		_io->m_mute,
+		_io->m_mono,
+		_io->m_phase,
+		_io->m_srcChan,
+		_io->m_destChan,
+		_io->m_panl,
+		_io->m_midi,
+		_rest);
+}
+
+// compares the AUXRECV line's mode, volume, pan, mute, mono, phase and pan law
+static bool SameReceiveParams(LineParser* _lp, const SNM_SndRcv* _io)
+{
+	return _lp->gettoken_int(2) == _io->m_mode &&
+		fabs(_lp->gettoken_float(3) - _io->m_vol) < SNM_FUDGE_FACTOR &&
+		fabs(_lp->gettoken_float(4) - _io->m_pan) < SNM_FUDGE_FACTOR &&
+		_lp->gettoken_int(5) == (int)_io->m_mute &&
+		_lp->gettoken_int(6) == _io->m_mono &&
+		_lp->gettoken_int(7) == _io->m_phase &&
+		fabs(_lp->gettoken_float(10) - _io->m_panl) < SNM_FUDGE_FACTOR;
+}
+
+// returns the line from its _n-th token (unquoted tokens only)
+static const char* SkipTokens(const char* _line, int _n)
+{
+	while (*_line == ' ' || *_line == '\t') _line++;
+	for (int i=0; i < _n && *_line; i++)
+	{
+		while (*_line && *_line != ' ' && *_line != '\t') _line++;
+		while (*_line == ' ' || *_line == '\t') _line++;
+	}
+	return _line;
+}
+
 bool SNM_SendPatcher::NotifyChunkLine(int _mode, 
 	LineParser* _lp, const char* _parsedLine, int _linePos, 
 	int _parsedOccurence, WDL_PtrList<WDL_FastString>* _parsedParents,  
@@ -102,27 +146,63 @@ bool SNM_SendPatcher::NotifyChunkLine(int _mode,
 		// add "detailed" receive
 		case -3:
 		{
-			SNM_SndRcv* mSndRcv = (SNM_SndRcv*)m_sndRcv;
-			_newChunk->AppendFormatted(
-				SNM_MAX_CHUNK_LINE_LENGTH,
-				"AUXRECV %d %d %.14f %.14f %d %d %d %d %d %.14f %d %d\n%s\n", 
-				m_srcId-1, 
-				m_sendType, 
-				mSndRcv->m_vol, 
-				mSndRcv->m_pan,
-				mSndRcv->m_mute,
-				mSndRcv->m_mono,
-				mSndRcv->m_phase,
-				mSndRcv->m_srcChan,
-				mSndRcv->m_destChan,
-				mSndRcv->m_panl,
-				mSndRcv->m_midi,
-				-1, // API LIMITATION: cannot get snd/rcv automation
-				_parsedLine);
+			AppendReceiveLine(_newChunk, m_srcId-1, (SNM_SndRcv*)m_sndRcv, "-1"); // API LIMITATION: cannot get snd/rcv automation
+			_newChunk->Append(_parsedLine);
+			_newChunk->Append("\n");
 			update = true;
 			m_breakParsePatch = true;
 		}
 		break;
+
+		// diff & patch receives, see PatchReceives()
+		// note: _newChunk is NULL when dry-running
+		case -4:
+		{
+			const char* keyword = _lp->gettoken_str(0);
+			if (!strcmp(keyword, "AUXRECV"))
+			{
+				const int srcIdx = _lp->gettoken_int(1);
+				if (m_plan->IsRemoved(srcIdx))
+				{
+					m_plan->m_removed++;
+					update = true; // i.e. we do not re-copy this receive
+				}
+				else if (SNM_SndRcv* io = m_plan->Consume(srcIdx, _lp->gettoken_int(8), _lp->gettoken_int(9), _lp->gettoken_int(11)))
+				{
+					if (!SameReceiveParams(_lp, io))
+					{
+						m_plan->m_updated++;
+						if (_newChunk)
+						{
+							// keep the automation mode & following tokens
+							const char* rest = SkipTokens(_parsedLine, 12);
+							AppendReceiveLine(_newChunk, srcIdx, io, *rest ? rest : "-1");
+							update = true;
+						}
+					}
+				}
+			}
+			// end of receives: add the remaining ones
+			else if (!strcmp(keyword, "MIDIOUT"))
+			{
+				int srcIdx;
+				for (int i=0; i < m_plan->GetNumAdds(); i++)
+					if (SNM_SndRcv* io = m_plan->GetUnconsumed(i, &srcIdx))
+					{
+						m_plan->m_added++;
+						if (_newChunk)
+							AppendReceiveLine(_newChunk, srcIdx, io, "-1"); // API LIMITATION: cannot get snd/rcv automation
+					}
+				if (_newChunk && m_plan->m_added)
+				{
+					_newChunk->Append(_parsedLine);
+					_newChunk->Append("\n");
+					update = true;
+				}
+				m_breakParsePatch = true;
+			}
+		}
+		break;
 	}
 	return update; 
 }
@@ -172,6 +252,22 @@ int SNM_SendPatcher::RemoveReceivesFrom(MediaTrack* _srcTr)
 	// REAPER will remove related envelopes, if any
 }
 
+// diffs & patches all receives in a single pass (vs one pass per added/removed receive)
+// _dryRun: only fills the diff of _plan (m_added, etc..), the chunk is left untouched
+// returns the number of added + updated + removed receives
+int SNM_SendPatcher::PatchReceives(SNM_RcvPlan* _plan, bool _dryRun)
+{
+	if (!_plan)
+		return 0;
+	_plan->StartDiff();
+	m_plan = _plan;
+	if (_dryRun) Parse(-4, 1, "TRACK");
+	else ParsePatch(-4, 1, "TRACK");
+	m_plan = NULL;
+	return _plan->m_added + _plan->m_updated + _plan->m_removed;
+	// REAPER will remove related envelopes of removed receives, if any
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // SNM_FXChainTakePatcher
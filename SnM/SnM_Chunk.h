@@ -61,6 +61,8 @@ protected:
 // SNM_SendPatcher
 ///////////////////////////////////////////////////////////////////////////////
 
+class SNM_RcvPlan;
+
 class SNM_SendPatcher : public SNM_ChunkParserPatcher
 {
 public:
@@ -71,12 +73,14 @@ public:
 		m_vol = NULL;
 		m_pan = NULL;
 		m_sndRcv = NULL;
+		m_plan = NULL;
 	}
 	~SNM_SendPatcher() {}
 	int AddReceive(MediaTrack* _srcTr, int _sendType, const char* _vol, const char* _pan);
 	bool AddReceive(MediaTrack* _srcTr, void* _io);
 	int RemoveReceives();
 	int RemoveReceivesFrom(MediaTrack* _srcTr);
+	int PatchReceives(SNM_RcvPlan* _plan, bool _dryRun = false);
 
 protected:
 	bool NotifyChunkLine(int _mode, 
@@ -89,6 +93,7 @@ protected:
 	const char* m_vol;
 	const char* m_pan;
 	void* m_sndRcv;
+	SNM_RcvPlan* m_plan;
 };
 
 
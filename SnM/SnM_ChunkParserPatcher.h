@@ -97,6 +97,7 @@ static int RemoveChunkLines(WDL_FastString* _chunk, WDL_PtrList<const char>* _se
 							bool _checkBOL = false, int _checkEOLChar = 0);
 static int FindEndOfSubChunk(const char* _chunk, int _startPos);
 
+extern int g_disable_chunk_guid_filtering;
 static int SNM_PreObjectState(WDL_FastString* _str = NULL, bool _wantsMinState = false);
 static void SNM_PostObjectState(int _oldfxstate);
 
@@ -137,6 +138,7 @@ SNM_ChunkParserPatcher(void* _reaObject, bool _autoCommit=true,
 	m_processInProjectMIDI = _processInProjectMIDI;
 	m_processFreeze = _processFreeze;
 	m_minimalState = false;
+	m_keepIds = false;
 }
 
 // when attached to a WDL_FastString* (simple text chunk parser/patcher)
@@ -157,6 +159,7 @@ SNM_ChunkParserPatcher(WDL_FastString* _chunk, bool _autoCommit=true,
 	m_processInProjectMIDI = _processInProjectMIDI;
 	m_processFreeze = _processFreeze;
 	m_minimalState = false;
+	m_keepIds = false;
 }
 
 virtual ~SNM_ChunkParserPatcher() 
@@ -251,15 +254,21 @@ int SetUpdates(int _updates) {
 // no-op if no updates: commit only if needed.
 // when attached to a reaThing*, global protections apply:
 // - no patch while recording 
-// - remove all ids before patching, see SNM_GetSetObjectState()
+// - remove all ids before patching, see SNM_GetSetObjectState() and SetKeepIds()
 virtual bool Commit(bool _force = false)
 {
 	if ((m_updates || _force) && GetChunk()->GetLength())
 	{
 		if (m_reaObject) {
-			if (!(GetPlayStateEx(NULL) & 4) && !SNM_GetSetObjectState(m_reaObject, m_chunk)) {
-				SetChunk("", 0);
-				return true;
+			if (!(GetPlayStateEx(NULL) & 4))
+			{
+				if (m_keepIds) g_disable_chunk_guid_filtering++;
+				bool ok = !SNM_GetSetObjectState(m_reaObject, m_chunk);
+				if (m_keepIds) g_disable_chunk_guid_filtering--;
+				if (ok) {
+					SetChunk("", 0);
+					return true;
+				}
 			}
 		}
 		else if (m_originalChunk) {
@@ -291,6 +300,13 @@ void SetWantsMinimalState(bool _enable) {
 	m_minimalState = _enable;
 }
 
+// commit ids (GUIDs, FXIDs, etc..) as they are in the chunk
+// note: the caller is responsible for id uniqueness, e.g. REAPER keeps
+//       fx instances loaded when their FXIDs are preserved
+void SetKeepIds(bool _enable) {
+	m_keepIds = _enable;
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // Helpers
@@ -461,6 +477,9 @@ protected:
 	// note: such states must not be patched back (corrupted/incomplete states)
 	bool m_minimalState;
 
+	// do not remove ids when committing, see SetKeepIds()
+	bool m_keepIds;
+
 	// this one is READ-ONLY (automatically set when parsing SOURCE sub-chunks)
 	bool m_isParsingSource;
 
@@ -1096,7 +1115,6 @@ static const char* FindKeyword(const char* _chunk) {
 // Other static helpers
 ///////////////////////////////////////////////////////////////////////////////
 
-extern int g_disable_chunk_guid_filtering;
 static int SNM_PreObjectState(WDL_FastString* _str, bool _wantsMinState)
 {
 	// when altering: remove all ids 
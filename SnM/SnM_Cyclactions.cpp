@@ -51,6 +51,7 @@ WDL_PtrList<Cyclaction> g_cas[SNM_MAX_CA_SECTIONS];
 SNM_WindowManager<CyclactionWnd> g_caWndMgr(CA_WND_ID);
 bool g_undos = true; // consolidate undo points
 bool g_preventUIRefresh = true;
+int g_caCodeGen = 0; // bumped when CAs are (un)registered: compiled code must be rebuilt
 
 ///////////////////////////////////////////////////////////////////////////////
 // CA helpers
@@ -468,71 +469,426 @@ static bool PerformSpecialCustomActionCommand(const int cmdId)
 	return false;
 }
 
-// assumes _cmdStr is valid and has been "exploded", if needed
-int PerformSingleCommand(int _section, const char* _cmdStr, int _val, int _valhw, int _relmode, HWND _hwnd)
+// _cmdId: registered command id
+static int PerformCommandId(int _section, KbdSectionInfo* _kbdSec, int _cmdId, int _val, int _valhw, int _relmode, HWND _hwnd)
 {
-#ifdef _SNM_DEBUG
-	OutputDebugString(_cmdStr);
-	OutputDebugString("\n");
-#endif
-	if (_cmdStr && *_cmdStr)
+	// can't just rely on kbdSec->onAction() because some actions
+	// depend on the current focused window, etc
+	switch (_section)
 	{
-		KbdSectionInfo* kbdSec = SNM_GetActionSection(_section);
-		if (!kbdSec)
+		case SNM_SEC_IDX_MAIN:
+			if(PerformSpecialCustomActionCommand(_cmdId))
+				return 1;
+			return KBD_OnMainActionEx(_cmdId, _val, _valhw, _relmode, _hwnd, NULL);
+		case SNM_SEC_IDX_ME:
+		case SNM_SEC_IDX_ME_EL:
+			return MIDIEditor_LastFocused_OnCommand(_cmdId, _section==SNM_SEC_IDX_ME_EL);
+		case SNM_SEC_IDX_EPXLORER:
+			if (HWND h = GetReaHwndByTitle(__localizeFunc("Media Explorer", "explorer", 0))) {
+				SendMessage(h, WM_COMMAND, _cmdId, 0);
+				return 1;
+			}
 			return 0;
+		default:
+			return _kbdSec->onAction(_cmdId, _val, _valhw, _relmode, _hwnd);
+	}
+}
 
-		// SNM_NamedCommandLookup hard check: the command MUST be registered
-		if (int cmdId = SNM_NamedCommandLookup(_cmdStr, kbdSec, true))
+// custom console or label processor command
+// note: authorized in any section
+static int PerformStatementCommand(const char* _cmdStr)
+{
+	if (!_strnicmp(STATEMENT_CONSOLE, _cmdStr, strlen(STATEMENT_CONSOLE)))
 	{
-			// can't just rely on kbdSec->onAction() because some actions
-			// depend on the current focused window, etc
-			switch (_section)
-			{
-				case SNM_SEC_IDX_MAIN:
-					if(PerformSpecialCustomActionCommand(cmdId))
-						return 1;
-					return KBD_OnMainActionEx(cmdId, _val, _valhw, _relmode, _hwnd, NULL);
-				case SNM_SEC_IDX_ME:
-				case SNM_SEC_IDX_ME_EL:
-					return MIDIEditor_LastFocused_OnCommand(cmdId, _section==SNM_SEC_IDX_ME_EL);
-				case SNM_SEC_IDX_EPXLORER:
-					if (HWND h = GetReaHwndByTitle(__localizeFunc("Media Explorer", "explorer", 0))) {
-						SendMessage(h, WM_COMMAND, cmdId, 0);
-						return 1;
-					}
-					return 0;
-				default:
-					return kbdSec->onAction(cmdId, _val, _valhw, _relmode, _hwnd);
-			}
+		RunConsoleCommand(_cmdStr+strlen(STATEMENT_CONSOLE)+1); // +1 for the space char in "CONSOLE cmd"
+		if (!g_undos)
+		{
+			char undo[128];
+			snprintf(undo, sizeof(undo), __LOCALIZE("ReaConsole command '%s'","sws_undo"), _cmdStr+strlen(STATEMENT_CONSOLE)+1);
+			Undo_OnStateChangeEx2(NULL, undo, UNDO_STATE_ALL, -1);
 		}
-		// custom console command?
-		// note: authorized in any section
-		else if (!_strnicmp(STATEMENT_CONSOLE, _cmdStr, strlen(STATEMENT_CONSOLE)))
+		return 1;
+	}
+	else if (!_strnicmp(STATEMENT_LABEL, _cmdStr, strlen(STATEMENT_LABEL)))
+	{
+		WDL_FastString str(_cmdStr+strlen(STATEMENT_LABEL)+1); // +1 for the space char in "LABEL cmd"
+		RunLabelCommand(&str);
+		if (!g_undos)
 		{
-			RunConsoleCommand(_cmdStr+strlen(STATEMENT_CONSOLE)+1); // +1 for the space char in "CONSOLE cmd"
-			if (!g_undos)
-			{
-				char undo[128];
-				snprintf(undo, sizeof(undo), __LOCALIZE("ReaConsole command '%s'","sws_undo"), _cmdStr+strlen(STATEMENT_CONSOLE)+1);
-				Undo_OnStateChangeEx2(NULL, undo, UNDO_STATE_ALL, -1);
+			char undo[128];
+			snprintf(undo, sizeof(undo), __LOCALIZE("Label Processor command '%s'","sws_undo"), _cmdStr+strlen(STATEMENT_LABEL)+1);
+			Undo_OnStateChangeEx2(NULL, undo, UNDO_STATE_ALL, -1); // do not use UNDO_STATE_ITEMS here
+		}
+		return 1;
+	}
+	return 0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Compiled cycle actions
+//
+// Each step of a cycle action is compiled once into an instruction array:
+// command ids resolved, statements pre-parsed and IF/ELSE jumps computed.
+// The code is dropped when the definition changes (see Cyclaction mutators)
+// or when cycle actions are (un)registered (see g_caCodeGen).
+// Sub-cycle actions are inlined at run time (their current step changes) and
+// jumps are then recomputed, i.e. the code is processed exactly like the
+// exploded command lists it replaces.
+///////////////////////////////////////////////////////////////////////////////
+
+enum {
+  CA_OP_CMD=0,
+  CA_OP_COND,
+  CA_OP_ELSE,
+  CA_OP_ENDIF,
+  CA_OP_LOOP,
+  CA_OP_ENDLOOP,
+  CA_OP_CONSOLE,
+  CA_OP_LABEL,
+  CA_OP_SUBCA
+};
+
+#define CA_LOOP_PROMPT		-2 // "LOOP x"
+#define CA_MAX_SUB_DEPTH	32 // recursive CAs are not registered, just in case
+
+struct CA_Instr
+{
+	int op;
+	int statement;   // IDX_STATEMENT_xxx or -1
+	const char* cmd; // the action's command string
+	int tglCmdId;    // toggle states (soft lookup), 0 if not found
+	int runCmdId;    // to perform (hard lookup), 0 if not found
+	bool noToggle;   // macro, script or ReaConsole action
+	int loopCnt;     // CA_OP_LOOP
+	int jumpElse;    // CA_OP_COND: next ELSE or ENDIF, CA_OP_ELSE: next ENDIF
+	int jumpEndif;   // CA_OP_COND: next ENDIF
+	Cyclaction* sub; // CA_OP_SUBCA
+};
+
+struct CA_Step
+{
+	CA_Step() : nextState(0), hasSubCAs(false), runs(0), totalTime(0.0), maxTime(0.0) {}
+	WDL_TypedBuf<CA_Instr> code;
+	int nextState; // m_performState once this step has been performed
+	bool hasSubCAs;
+
+	// profiler
+	int runs;
+	double totalTime, maxTime;
+};
+
+struct CyclactionCode
+{
+	CyclactionCode() : gen(-1), ok(false) {}
+	WDL_PtrList_DeleteOnDestroy<CA_Step> steps;
+	int gen;
+	bool ok;
+};
+
+static bool IsTwoCondStatementIdx(int _statement) {
+	return _statement>=IDX_STATEMENT_IFAND && _statement<=IDX_STATEMENT_IFXNOR;
+}
+
+static void ComputeJumps(CA_Instr* _code, int _sz)
+{
+	for (int i=0; i<_sz; i++)
+	{
+		CA_Instr* in = _code+i;
+		if (in->op != CA_OP_COND && in->op != CA_OP_ELSE)
+			continue;
+
+		// same lookups as the interpreter: skip conditions, first ELSE/ENDIF wins (no nesting)
+		int j = i + (in->op == CA_OP_COND ? (IsTwoCondStatementIdx(in->statement) ? 2 : 1) : 0);
+		bool elseFound = false;
+		in->jumpElse = in->jumpEndif = _sz;
+		while (++j<_sz)
+		{
+			if (in->op == CA_OP_COND && !elseFound && _code[j].op == CA_OP_ELSE) {
+				in->jumpElse = j;
+				elseFound = true;
 			}
-			return 1;
+			else if (_code[j].op == CA_OP_ENDIF) {
+				if (!elseFound) in->jumpElse = j;
+				in->jumpEndif = j;
+				break;
+			}
+		}
+	}
+}
+
+static bool CompileCommand(int _section, KbdSectionInfo* _kbdSec, const char* _cmd, CA_Instr* _in)
+{
+	memset(_in, 0, sizeof(CA_Instr));
+	_in->cmd = _cmd;
+	_in->statement = IsStatement(_cmd);
+
+	if (*_cmd == '_' && strstr(_cmd, "_CYCLACTION"))
+	{
+		// see ExplodeCyclaction(), "cross-section CAs" are not supported
+		_in->op = CA_OP_SUBCA;
+		_in->sub = _section == GetCASectionFromCustId(_cmd) ? GetCAFromCustomId(_section, _cmd) : NULL;
+		return _in->sub != NULL;
+	}
+
+	switch (_in->statement)
+	{
+		case IDX_STATEMENT_IF:
+		case IDX_STATEMENT_IFNOT:
+		case IDX_STATEMENT_IFAND:
+		case IDX_STATEMENT_IFNAND:
+		case IDX_STATEMENT_IFOR:
+		case IDX_STATEMENT_IFNOR:
+		case IDX_STATEMENT_IFXOR:
+		case IDX_STATEMENT_IFXNOR:
+			_in->op = CA_OP_COND;
+			break;
+		case IDX_STATEMENT_ELSE:
+			_in->op = CA_OP_ELSE;
+			break;
+		case IDX_STATEMENT_ENDIF:
+			_in->op = CA_OP_ENDIF;
+			break;
+		case IDX_STATEMENT_LOOP:
+		{
+			_in->op = CA_OP_LOOP;
+			const char* param = strlen(_cmd) > strlen(STATEMENT_LOOP) ? _cmd+strlen(STATEMENT_LOOP)+1 : ""; // +1 for the space char in "LOOP n"
+			_in->loopCnt = (*param == 'x' || *param == 'X') ? CA_LOOP_PROMPT : atoi(param);
+			break;
+		}
+		case IDX_STATEMENT_ENDLOOP:
+			_in->op = CA_OP_ENDLOOP;
+			break;
+		case IDX_STATEMENT_CONSOLE:
+			_in->op = CA_OP_CONSOLE;
+			break;
+		case IDX_STATEMENT_LABEL:
+			_in->op = CA_OP_LABEL;
+			break;
+		default:
+			_in->op = CA_OP_CMD;
+			_in->noToggle = *_cmd == '_' && (strstr(_cmd, "_SWSCONSOLE_CUST") || IsMacroOrScript(_cmd, false));
+			if ((_in->tglCmdId = SNM_NamedCommandLookup(_cmd, _kbdSec)))
+				_in->runCmdId = SNM_NamedCommandLookup(_cmd, _kbdSec, true);
+			break;
+	}
+	return true;
+}
+
+// steps are delimited like in ExplodeCyclaction()
+static bool CompileCyclaction(int _section, Cyclaction* _a, CyclactionCode* _code)
+{
+	_code->steps.Empty(true);
+	_code->gen = g_caCodeGen;
+	_code->ok = false;
+
+	KbdSectionInfo* kbdSec = SNM_GetActionSection(_section);
+	if (!kbdSec)
+		return false;
+
+	CA_Step* step = NULL;
+	for (int i=0; i<_a->GetCmdSize(); i++)
+	{
+		if (!step)
+			step = _code->steps.Add(new CA_Step);
+
+		const char* cmd = _a->GetCmd(i);
+		if (*cmd && *cmd != '!')
+		{
+			CA_Instr in;
+			if (!CompileCommand(_section, kbdSec, cmd, &in))
+				return false;
+			step->hasSubCAs |= in.op == CA_OP_SUBCA;
+			step->code.Add(in);
+		}
+
+		// end of list: cycle back to the 1st step
+		if (i == (_a->GetCmdSize()-1))
+			step->nextState = 0;
+		// next step
+		else if (*cmd == '!')
+		{
+			step->nextState = _code->steps.GetSize();
+			step = NULL;
 		}
-		// label processor command
-		else if (!_strnicmp(STATEMENT_LABEL, _cmdStr, strlen(STATEMENT_LABEL)))
+	}
+
+	for (int i=0; i<_code->steps.GetSize(); i++)
+		ComputeJumps(_code->steps.Get(i)->code.Get(), _code->steps.Get(i)->code.GetSize());
+
+	_code->ok = _code->steps.GetSize()>0;
+	return _code->ok;
+}
+
+static CA_Step* GetCurrentStep(int _section, Cyclaction* _a)
+{
+	CyclactionCode* code = _a->GetCode(_section);
+	return code ? code->steps.Get(_a->m_performState) : NULL;
+}
+
+static void MoveToNextStep(Cyclaction* _a, CA_Step* _step)
+{
+	_a->m_performState = _step->nextState;
+	_a->m_fakeToggle = !_a->m_fakeToggle;
+}
+
+// inline the current step of sub-cycle actions (and move them to their next step)
+static bool InlineSubCyclactions(int _section, CA_Step* _step, WDL_TypedBuf<CA_Instr>* _out, int _depth = 0)
+{
+	if (_depth > CA_MAX_SUB_DEPTH)
+		return false;
+
+	for (int i=0; i<_step->code.GetSize(); i++)
+	{
+		const CA_Instr* in = _step->code.Get()+i;
+		if (in->op == CA_OP_SUBCA)
 		{
-			WDL_FastString str(_cmdStr+strlen(STATEMENT_LABEL)+1); // +1 for the space char in "LABEL cmd"
-			RunLabelCommand(&str);
-			if (!g_undos)
+			CA_Step* subStep = GetCurrentStep(_section, in->sub);
+			if (!subStep || !InlineSubCyclactions(_section, subStep, _out, _depth+1))
+				return false;
+			MoveToNextStep(in->sub, subStep);
+		}
+		else
+			_out->Add(*in);
+	}
+	return true;
+}
+
+// command ids resolved at compile time can go stale (e.g. script unloaded then
+// reloaded under a new id): check named ones, look up again if needed
+static int ResolveCmdId(KbdSectionInfo* _kbdSec, CA_Instr* _in, int* _cmdId, bool _hardCheck)
+{
+	if (_in->op != CA_OP_CMD)
+		return *_cmdId;
+	if (*_cmdId && *_in->cmd == '_')
+	{
+		const char* custId = ReverseNamedCommandLookup(*_cmdId);
+		if (!custId || strcmp(custId, _in->cmd+1))
+			*_cmdId = 0;
+	}
+	if (!*_cmdId) // not registered at compile time, or stale
+		*_cmdId = SNM_NamedCommandLookup(_in->cmd, _kbdSec, _hardCheck);
+	return *_cmdId;
+}
+
+static int GetToggleState(KbdSectionInfo* _kbdSec, CA_Instr* _in)
+{
+	return GetToggleCommandState2(_kbdSec, ResolveCmdId(_kbdSec, _in, &_in->tglCmdId, false));
+}
+
+static int PerformInstr(int _section, KbdSectionInfo* _kbdSec, CA_Instr* _in, int _val, int _valhw, int _relmode, HWND _hwnd)
+{
+#ifdef _SNM_DEBUG
+	OutputDebugString(_in->cmd);
+	OutputDebugString("\n");
+#endif
+	if (ResolveCmdId(_kbdSec, _in, &_in->runCmdId, true))
+		return PerformCommandId(_section, _kbdSec, _in->runCmdId, _val, _valhw, _relmode, _hwnd);
+	return PerformStatementCommand(_in->cmd);
+}
+
+// evaluate statements, collect instructions to perform into _out
+// note: conditions are all evaluated before performing anything, as they always were
+static void EvalCode(KbdSectionInfo* _kbdSec, CA_Instr* _code, int _sz, const char* _undoStr, WDL_PtrList<CA_Instr>* _out)
+{
+	int loopCnt = -1;
+	WDL_PtrList<CA_Instr> loopCmds;
+	for (int i=0; i<_sz; i++)
+	{
+		CA_Instr* in = _code+i;
+		switch (in->op)
+		{
+			case CA_OP_COND:
 			{
-				char undo[128];
-				snprintf(undo, sizeof(undo), __LOCALIZE("Label Processor command '%s'","sws_undo"), _cmdStr+strlen(STATEMENT_LABEL)+1);
-				Undo_OnStateChangeEx2(NULL, undo, UNDO_STATE_ALL, -1); // do not use UNDO_STATE_ITEMS here
+				const int st = in->statement;
+				const bool twoConds = IsTwoCondStatementIdx(st);
+				if ((i + (twoConds?2:1)) < _sz)
+				{
+					const bool isON = (st==IDX_STATEMENT_IF || st==IDX_STATEMENT_IFAND || st==IDX_STATEMENT_IFOR || st==IDX_STATEMENT_IFXOR);
+
+					int tgl = GetToggleState(_kbdSec, _code + ++i); //++i ! => zap next command
+					if (twoConds)
+					{
+						int tgl2 = GetToggleState(_kbdSec, _code + ++i); //++i ! => zap next command
+
+						// tgl = overall toggle state value
+						if (st==IDX_STATEMENT_IFAND || st==IDX_STATEMENT_IFNAND)
+							tgl = (tgl && tgl2) ? 1 : 0;
+						else if (st==IDX_STATEMENT_IFOR || st==IDX_STATEMENT_IFNOR)
+							tgl = (tgl || tgl2) ? 1 : 0;
+						else // IDX_STATEMENT_IFXOR || IDX_STATEMENT_IFXNOR
+							tgl = (tgl ^ tgl2) ? 1 : 0;
+					}
+
+					if (tgl>=0)
+					{
+						// zap commands until next ELSE or ENDIF
+						if (isON ? tgl==0 : tgl==1)
+							i = in->jumpElse;
+					}
+					// zap commands until next ENDIF
+					else
+						i = in->jumpEndif;
+				}
+				break;
 			}
-			return 1;
+			case CA_OP_ELSE:
+				i = in->jumpElse; // zap commands until next ENDIF
+				break;
+			case CA_OP_LOOP:
+				if (in->loopCnt == CA_LOOP_PROMPT) {
+					loopCnt = PromptForInteger(_undoStr, __LOCALIZE("Number of times to repeat","sws_DLG_161"), 0, 4096, false);
+					loopCnt++; // 0-based => 1-based + ignore the loop if user has cancelled
+				}
+				else
+					loopCnt = in->loopCnt;
+				break;
+			case CA_OP_ENDLOOP:
+				if (loopCnt>=0)
+				{
+					for (int j=0; j<loopCnt; j++)
+						for (int k=0; k<loopCmds.GetSize(); k++)
+							_out->Add(loopCmds.Get(k));
+
+					loopCmds.Empty(false);
+					loopCnt = -1;
+				}
+				break;
+			case CA_OP_ENDIF:
+				break;
+			default:
+				if (loopCnt > 0)
+					loopCmds.Add(in);
+				else if (loopCnt == -1)
+					_out->Add(in);
+				break;
 		}
 	}
-	return 0;
+}
+
+// first valid toggle state of the current step, as ExplodeCyclaction() with _flags&2
+static int GetCyclactionToggleState(int _section, KbdSectionInfo* _kbdSec, Cyclaction* _a, int _depth = 0)
+{
+	switch(_a->IsToggle())
+	{
+		case 1: return _a->m_fakeToggle ? 1 : 0;
+		case 2: break; // real toggle state, see below..
+		default: return -1;
+	}
+
+	CA_Step* step = _depth <= CA_MAX_SUB_DEPTH ? GetCurrentStep(_section, _a) : NULL;
+	for (int i=0; step && i<step->code.GetSize(); i++)
+	{
+		CA_Instr* in = step->code.Get()+i;
+		int tgl = -1;
+		if (in->op == CA_OP_SUBCA)
+			tgl = GetCyclactionToggleState(_section, _kbdSec, in->sub, _depth+1);
+		else if (!in->noToggle && (in->tglCmdId || in->op == CA_OP_CMD))
+			tgl = GetToggleState(_kbdSec, in);
+		if (tgl>=0)
+			return tgl;
+	}
+	return -1;
 }
 
 // assumes the CA is valid (e.g. no recursion) + its statements are valid + etc..
@@ -556,149 +912,106 @@ void RunCycleAction(COMMAND_T* _ct, int _val, int _valhw, int _relmode, HWND _hw
 		// store step or action name *before* m_performState update
 		const char* undoStr = action->GetStepName();
 
-		WDL_PtrList_DeleteOnDestroy<WDL_FastString> subCmds;
-		if (ExplodeCyclaction(sec, _ct->id, &subCmds, NULL, NULL, 0x1, action) > 0) // 0x1!
-		{
-			int loopCnt = -1;
-			WDL_PtrList<WDL_FastString> allCmds, loopCmds;
-			for (int i=0; i<subCmds.GetSize(); i++)
-			{
-				const char* cmdStr = subCmds.Get(i) ? subCmds.Get(i)->Get() : "";
-				if (IsCondStatement(cmdStr))
-				{
-					bool twoConds = IsTwoCondStatement(cmdStr);
-					if ((i + (twoConds?2:1)) < subCmds.GetSize())
-					{
-						bool isON = (!_stricmp(STATEMENT_IF, cmdStr) ||
-							!_stricmp(STATEMENT_IFAND, cmdStr) ||
-							!_stricmp(STATEMENT_IFOR, cmdStr) ||
-							!_stricmp(STATEMENT_IFXOR, cmdStr));
-
-						const char* cmdStrIF = cmdStr;
-						cmdStr = subCmds.Get(++i) ? subCmds.Get(i)->Get() : ""; //++i ! => zap next command
-						int tgl = GetToggleCommandState2(kbdSec, SNM_NamedCommandLookup(cmdStr, kbdSec));
-						
-						if (twoConds)
-						{
-							cmdStr = subCmds.Get(++i) ? subCmds.Get(i)->Get() : ""; //++i ! => zap next command
-							int tgl2 = GetToggleCommandState2(kbdSec, SNM_NamedCommandLookup(cmdStr, kbdSec));
-
-							// tgl = overall toggle state value
-							if (!_stricmp(STATEMENT_IFAND, cmdStrIF) || !_stricmp(STATEMENT_IFNAND, cmdStrIF))
-								tgl = (tgl && tgl2) ? 1 : 0;
-							else if (!_stricmp(STATEMENT_IFOR, cmdStrIF) || !_stricmp(STATEMENT_IFNOR, cmdStrIF))
-								tgl = (tgl || tgl2) ? 1 : 0;
-							else // if (!_stricmp(STATEMENT_IFXOR, cmdStrIF) || !_stricmp(STATEMENT_IFXNOR, cmdStrIF))
-								tgl = (tgl ^ tgl2) ? 1 : 0;
-						}
-
-						if (tgl>=0)
-						{
-							if (isON ? tgl==0 : tgl==1)
-							{
-								// zap commands until next ELSE or ENDIF
-								while (++i<subCmds.GetSize())
-									if (subCmds.Get(i) && (!_stricmp(STATEMENT_ELSE, subCmds.Get(i)->Get()) || !_stricmp(STATEMENT_ENDIF, subCmds.Get(i)->Get())))
-										break;
-							}
-						}
-						// zap commands until next ENDIF
-						else
-						{
-							while (++i<subCmds.GetSize())
-								if (subCmds.Get(i) && !_stricmp(STATEMENT_ENDIF, subCmds.Get(i)->Get()))
-									break;
-						}
-					}
-					continue; // zap 
-				}
-				else if (!_stricmp(STATEMENT_ELSE, cmdStr))
-				{
-					// zap commands until next ELSE or ENDIF
-					while (++i<subCmds.GetSize())
-						if (subCmds.Get(i) && !_stricmp(STATEMENT_ENDIF, subCmds.Get(i)->Get()))
-							break;
-					continue;
-				}
-				else if (!_strnicmp(STATEMENT_LOOP, cmdStr, strlen(STATEMENT_LOOP)))
-				{
-					if (cmdStr[strlen(STATEMENT_LOOP)+1] == 'x' || cmdStr[strlen(STATEMENT_LOOP)+1] == 'X') {
-						loopCnt = PromptForInteger(undoStr, __LOCALIZE("Number of times to repeat","sws_DLG_161"), 0, 4096, false);
-						loopCnt++; // 0-based => 1-based + ignore the loop if user has cancelled
-					}
-					else
-						loopCnt = atoi((char*)cmdStr+strlen(STATEMENT_LOOP)+1); // +1 for the space char in "LOOP n"
-					continue;
-				}
-				else if (!_stricmp(STATEMENT_ENDLOOP, cmdStr))
-				{
-					if (loopCnt>=0)
-					{
-						for (int j=0; j<loopCnt; j++)
-							for (int k=0; k<loopCmds.GetSize(); k++)
-								if (loopCmds.Get(k))
-									allCmds.Add(loopCmds.Get(k));
+		CA_Step* step = GetCurrentStep(sec, action);
+		if (!step)
+			return;
 
-						loopCmds.Empty(false);
-						loopCnt = -1;
-					}
-					continue;
-				}
-				else if (!_stricmp(STATEMENT_ENDIF, cmdStr))
-					continue;
+		CA_Instr* code = step->code.Get();
+		int sz = step->code.GetSize();
+		WDL_TypedBuf<CA_Instr> inlined;
+		if (step->hasSubCAs)
+		{
+			if (!InlineSubCyclactions(sec, step, &inlined))
+				return;
+			ComputeJumps(inlined.Get(), inlined.GetSize());
+			code = inlined.Get();
+			sz = inlined.GetSize();
+		}
+		MoveToNextStep(action, step);
 
-				if (*cmdStr)
-				{
-					if (loopCnt > 0)
-						loopCmds.Add(subCmds.Get(i));
-					else if (loopCnt == -1)
-						allCmds.Add(subCmds.Get(i));
-				}
-			}
+		WDL_PtrList<CA_Instr> allCmds;
+		EvalCode(kbdSec, code, sz, undoStr, &allCmds);
 
-			if (allCmds.GetSize())
-			{
+		if (allCmds.GetSize())
+		{
 #ifdef _SNM_DEBUG
-				OutputDebugString("RunCycleAction: ");
-				OutputDebugString(undoStr);
-				OutputDebugString(" ---------->");
-				OutputDebugString("\n");
+			OutputDebugString("RunCycleAction: ");
+			OutputDebugString(undoStr);
+			OutputDebugString(" ---------->");
+			OutputDebugString("\n");
 #endif
-				if (g_undos)
-					Undo_BeginBlock2(NULL);
+			const int gen = g_caCodeGen;
+			const double startTime = time_precise();
 
-				if (g_preventUIRefresh)
-					PreventUIRefresh(1);
+			if (g_undos)
+				Undo_BeginBlock2(NULL);
 
-				for (int i=0; i<allCmds.GetSize(); i++)
-					PerformSingleCommand(sec, allCmds.Get(i)->Get(), _val, _valhw, _relmode, _hwnd);
+			if (g_preventUIRefresh)
+				PreventUIRefresh(1);
 
-				if (g_preventUIRefresh)
-					PreventUIRefresh(-1);
+			// stop if a command reloaded cycle actions (the code is gone)
+			for (int i=0; gen==g_caCodeGen && i<allCmds.GetSize(); i++)
+				PerformInstr(sec, kbdSec, allCmds.Get(i), _val, _valhw, _relmode, _hwnd);
 
-				if (g_undos)
-					Undo_EndBlock2(NULL, undoStr, UNDO_STATE_ALL);
+			if (g_preventUIRefresh)
+				PreventUIRefresh(-1);
 
-				RefreshToolbar(0); // not strictly needed, except for toggle states of CAs calling other CAs
+			if (g_undos)
+				Undo_EndBlock2(NULL, undoStr, UNDO_STATE_ALL);
+
+			if (gen == g_caCodeGen)
+			{
+				const double t = time_precise() - startTime;
+				step->runs++;
+				step->totalTime += t;
+				if (t > step->maxTime)
+					step->maxTime = t;
+			}
+
+			RefreshToolbar(0); // not strictly needed, except for toggle states of CAs calling other CAs
 #ifdef _SNM_DEBUG
-				OutputDebugString("RunCycleAction <-------------------------");
-				OutputDebugString("\n");
+			OutputDebugString("RunCycleAction <-------------------------");
+			OutputDebugString("\n");
 #endif
+			break;
+		}
+		// (try to) switch to the next action step if nothing has been
+		// performed (avoids to run some CAs once before they sync properly)
+		// note: m_performState is already updated via MoveToNextStep()
+		else //JFB!! if (action->IsToggle()==2)
+		{
+			// cycled back to the 1st step?
+			if (!action->m_performState)
 				break;
-			}
-			// (try to) switch to the next action step if nothing has been
-			// performed (avoids to run some CAs once before they sync properly)
-			// note: m_performState is already updated via ExplodeCyclaction()
-			else //JFB!! if (action->IsToggle()==2)
-			{
-				// cycled back to the 1st step?
-				if (!action->m_performState)
-					break;
-			}
-		} // if (ExplodeCyclaction())
+		}
 	} // for(;;)
 }
 
+// per-step execution times of a registered cycle action
+static void ShowCyclactionProfile(int _section, Cyclaction* _a)
+{
+	WDL_FastString msg;
+	CyclactionCode* code = _a && _a->m_cmdId ? _a->GetCode(_section) : NULL;
+	if (!code)
+	{
+		msg.Set(__LOCALIZE("No profile available: cycle actions must be applied/registered first.","sws_DLG_161"));
+	}
+	else
+	{
+		msg.SetFormatted(256, __LOCALIZE_VERFMT("Cycle action '%s'","sws_DLG_161"), _a->GetName());
+		msg.Append("\r\n\r\n");
+		for (int i=0; i<code->steps.GetSize(); i++)
+		{
+			const CA_Step* step = code->steps.Get(i);
+			msg.AppendFormatted(512, __LOCALIZE_VERFMT("Step %d (%s): %d instructions, %d runs, %.3f ms average, %.3f ms max","sws_DLG_161"),
+				i+1, _a->GetStepName(i), step->code.GetSize(), step->runs,
+				step->runs ? step->totalTime*1000.0/step->runs : 0.0, step->maxTime*1000.0);
+			msg.Append("\r\n");
+		}
+	}
+	SNM_ShowMsg(msg.Get(), __LOCALIZE("S&M - Cycle action profile","sws_DLG_161"), g_caWndMgr.GetMsgHWND());
+}
+
 int IsCyclactionEnabled(COMMAND_T* _ct)
 {
 	int sec = _ct ? SNM_GetActionSectionIndex(_ct->uniqueSectionId) : -1;
@@ -711,7 +1024,7 @@ int IsCyclactionEnabled(COMMAND_T* _ct)
 		if (action->IsToggle()==2) // real state?
 		{
 			// no recursion check, etc.. : such faulty cycle actions are not registered
-			int tgl = ExplodeCyclaction(sec, _ct->id, NULL, NULL, NULL, 0x2, action);
+			int tgl = GetCyclactionToggleState(sec, SNM_GetActionSection(sec), action);
 			if (tgl>=0)
 				return tgl;
 		}
@@ -1023,6 +1336,7 @@ int RegisterCyclation(const char* _name, int _section, int _cycleId, int _cmdId)
 	char custId[SNM_MAX_ACTION_CUSTID_LEN]="";
 	if (snprintfStrict(custId, sizeof(custId), "%s%d", GetCACustomId(_section), _cycleId) > 0)
 	{
+		g_caCodeGen++;
 		return SWSCreateRegisterDynamicCmd(
 			SNM_GetActionSectionUniqueId(_section),
 			_cmdId,
@@ -1080,6 +1394,7 @@ int RegisterCyclation(Cyclaction* _a, int _section, int _cycleId,
 
 void FlushCyclactions(int _section)
 {
+	g_caCodeGen++;
 	for (int i=0; i<g_cas[_section].GetSize(); i++)
 		if (Cyclaction* a = g_cas[_section].Get(i)) {
 			SWSFreeUnregisterDynamicCmd(a->m_cmdId);
@@ -1265,6 +1580,27 @@ void SaveCyclactions(WDL_PtrList<Cyclaction>* _cyclactions = NULL, int _section
 // Cyclaction
 ///////////////////////////////////////////////////////////////////////////////
 
+Cyclaction::~Cyclaction()
+{
+	delete m_code;
+}
+
+// lazy compilation, returns NULL if the CA can't be compiled
+CyclactionCode* Cyclaction::GetCode(int _section)
+{
+	if (!m_code)
+		m_code = new CyclactionCode;
+	if (m_code->gen != g_caCodeGen)
+		CompileCyclaction(_section, this, m_code);
+	return m_code->ok ? m_code : NULL;
+}
+
+void Cyclaction::InvalidateCode()
+{
+	if (m_code)
+		m_code->gen = -1;
+}
+
 int Cyclaction::GetStepCount()
 {
 	int steps=1;
@@ -1352,6 +1688,7 @@ void Cyclaction::ReplaceCmd(WDL_FastString* _cmd, bool _wantDelete, WDL_PtrList<
 
 void Cyclaction::UpdateNameAndCmds()
 {
+	InvalidateCode();
 	m_cmds.EmptySafe(false); // to be deleted by callers (might be used in a list view)
 
 	char actionStr[CA_MAX_LEN] = "";
@@ -1368,6 +1705,7 @@ void Cyclaction::UpdateNameAndCmds()
 
 void Cyclaction::UpdateFromCmd()
 {
+	InvalidateCode();
 	WDL_FastString newDef;
 	if (int tgl=IsToggle())
 		newDef.SetFormatted(CA_MAX_LEN, "%c", tgl==1?CA_TGL1:CA_TGL2);
@@ -1433,6 +1771,7 @@ enum {
   RESET_CUR_SECTION_MSG,
   RESET_ALL_SECTIONS_MSG,
   LEARN_CYCLACTION_MSG,
+  PROFILE_CYCLACTION_MSG,
   LAST_MSG // keep as last item!
 };
 
@@ -2198,7 +2537,7 @@ void CyclactionWnd::OnCommand(WPARAM wParam, LPARAM lParam)
 					if (LOWORD(wParam) == RUN_CYCLACTION_MSG)
 					{
 						int c = action->m_cmdId, val=63, valhw=-1, relmode=0; // actioncommandID may get modified below
-						kbd_RunCommandThroughHooks(kbdSec,&c,&val,&valhw,&relmode,NULL); // NULL hwnd here, this is "managed" in PerformSingleCommand()
+						kbd_RunCommandThroughHooks(kbdSec,&c,&val,&valhw,&relmode,NULL); // NULL hwnd here, this is "managed" in PerformCommandId()
 					}
 					else if (LearnAction(kbdSec, action->m_cmdId) && g_lvL)
 						g_lvL->Update();
@@ -2211,6 +2550,18 @@ void CyclactionWnd::OnCommand(WPARAM wParam, LPARAM lParam)
 				}
 			}
 			break;
+		case PROFILE_CYCLACTION_MSG:
+			// the editor displays copies: the profile is in the registered CA
+			if (action && action->m_cmdId)
+			{
+				Cyclaction* registered = NULL;
+				for (int i=0; !registered && i<g_cas[g_editedSection].GetSize(); i++)
+					if (Cyclaction* a = g_cas[g_editedSection].Get(i))
+						if (a->m_cmdId == action->m_cmdId)
+							registered = a;
+				ShowCyclactionProfile(g_editedSection, registered);
+			}
+			break;
 		case ADD_CMD_MSG:
 			AddOrInsertCommand("", 3);
 			break;
@@ -2570,6 +2921,7 @@ HMENU CyclactionWnd::OnContextMenu(int x, int y, bool* wantDefaultItems)
 				AddToMenu(hMenu, __LOCALIZE("Remove cycle actions","sws_DLG_161"), DEL_CYCLACTION_MSG); 
 				AddToMenu(hMenu, SWS_SEPARATOR, 0);
 				AddToMenu(hMenu, __LOCALIZE("Run","sws_DLG_161"), RUN_CYCLACTION_MSG, -1, false, action->m_cmdId ? MF_ENABLED : MF_GRAYED); 
+				AddToMenu(hMenu, __LOCALIZE("Show execution profile","sws_DLG_161"), PROFILE_CYCLACTION_MSG, -1, false, action->m_cmdId ? MF_ENABLED : MF_GRAYED); 
 /* commented: this is a job for REAPER's action list
 				AddToMenu(hMenu, __LOCALIZE("Add shortcut...","sws_DLG_161"), LEARN_CYCLACTION_MSG, -1, false, action->m_cmdId ? MF_ENABLED : MF_GRAYED); 
 */
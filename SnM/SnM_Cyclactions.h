@@ -47,13 +47,15 @@ static const char s_CA_TGL1_STR[] = { CA_TGL1, '\0' };
 static const char s_CA_TGL2_STR[] = { CA_TGL2, '\0' };
 
 
+struct CyclactionCode; // compiled steps, see SnM_Cyclactions.cpp
+
 class Cyclaction
 {
 public:
 	// constructors assume their params are valid
-	Cyclaction(const char* _def=CA_EMPTY, bool _added=false) : m_def(_def), m_performState(0), m_fakeToggle(false), m_cmdId(0), m_added(_added) { UpdateNameAndCmds(); }
-	Cyclaction(Cyclaction* _a) : m_def(_a->m_def), m_performState(_a->m_performState), m_fakeToggle(_a->m_fakeToggle), m_cmdId(_a->m_cmdId), m_added(_a->m_added) { UpdateNameAndCmds(); }
-	~Cyclaction() {}
+	Cyclaction(const char* _def=CA_EMPTY, bool _added=false) : m_def(_def), m_performState(0), m_fakeToggle(false), m_cmdId(0), m_added(_added), m_code(NULL) { UpdateNameAndCmds(); }
+	Cyclaction(Cyclaction* _a) : m_def(_a->m_def), m_performState(_a->m_performState), m_fakeToggle(_a->m_fakeToggle), m_cmdId(_a->m_cmdId), m_added(_a->m_added), m_code(NULL) { UpdateNameAndCmds(); }
+	~Cyclaction();
 	const char* GetDefinition() { return m_def.Get(); }
 	void Update(const char* _def) { m_def.Set(_def); UpdateNameAndCmds(); }
 	int IsToggle() { return *m_def.Get()==CA_TGL1 ? 1 : *m_def.Get()==CA_TGL2 ? 2 : 0; }
@@ -74,6 +76,8 @@ public:
 	WDL_FastString* GetCmdString(int _i) { return m_cmds.Get(_i); }
 	int FindCmd(WDL_FastString* _cmd) { return m_cmds.Find(_cmd); }
 	int GetIndent(WDL_FastString* _cmd);
+	CyclactionCode* GetCode(int _section);
+	void InvalidateCode();
 
 	int m_performState;
 	bool m_added; // CA added by the user, not yet registered
@@ -87,6 +91,7 @@ private:
 	WDL_FastString m_def;
 	WDL_FastString m_name;
 	WDL_PtrList_DeleteOnDestroy<WDL_FastString> m_cmds;
+	CyclactionCode* m_code; // lazy init, see GetCode()
 };
 
 
@@ -468,11 +468,12 @@ int GetUserPresetNames(MediaTrack* _tr, int _fx, WDL_PtrList<WDL_FastString>* _p
 		{
 			char sec[64];
 			char buf[SNM_MAX_PRESET_NAME_LEN];
-			const int nbPresets = GetPrivateProfileInt("General", "NbPresets", 0, fn);
+			// served from memory, the file is only parsed again when it changes
+			const int nbPresets = SNM_GetIniInt("General", "NbPresets", 0, fn);
 			for (int i=0; i < nbPresets; i++)
 			{
 				snprintf(sec, sizeof(sec), "Preset%d", i);
-				GetPrivateProfileString(sec, "Name", "", buf, sizeof(buf), fn);
+				SNM_GetIniString(sec, "Name", "", buf, sizeof(buf), fn);
 				if (*buf)
 				{
 					if (_presetNames) _presetNames->Add(new WDL_FastString(buf));
@@ -39,11 +39,13 @@
 #include "SnM_Util.h"
 #include "../Zoom.h"
 
+#include <regex>
 #include <WDL/localize/localize.h>
 
 #define FIND_WND_ID				"SnMFind"
 #define FIND_INI_SEC			"Find"
 #define MAX_SEARCH_STR_LEN		128
+#define MAX_REGEX_TEXT_LEN		1024 // std::regex recurses per char: long lines are matched in windows, see RegexMatch()
 
 enum {
   TXTID_SCOPE=0xF000,
@@ -52,7 +54,9 @@ enum {
   BTNID_NEXT,
   BTNID_ZOOM_SCROLL_EN,
   CMBID_TYPE,
-  TXTID_RESULT
+  TXTID_RESULT,
+  BTNID_WHOLE_WORD,
+  BTNID_REGEX
 };
 
 enum {
@@ -63,70 +67,321 @@ enum {
 	TYPE_ITEM_NOTES,
 	TYPE_TRACK_NAME,
 	TYPE_TRACK_NOTES,
-	TYPE_MARKER_REGION
+	TYPE_MARKER_REGION,
+	NUM_TYPES
 };
 
 SNM_WindowManager<FindWnd> g_findWndMgr(FIND_WND_ID);
 char g_searchStr[MAX_SEARCH_STR_LEN] = "";
 bool g_notFound=false;
+char g_findResult[64] = ""; // "n of N", "N found", or an error msg if g_notFound
 
 
 ///////////////////////////////////////////////////////////////////////////////
+// Search index
+// One text list per search type, built once in project order and rebuilt
+// lazily on project switch/state change (track notes: SWS data, not covered
+// by the state count, re-read from memory on each search).
+// Texts are stored lowercase (ASCII only, UTF-8 safe) except media filenames
+// which are matched case-sensitively, as before.
+// Searches return all hits at once, cached until the list or the query changes.
+///////////////////////////////////////////////////////////////////////////////
+
+class SNM_FindIndex
+{
+public:
+	struct Entry {
+		void* obj;      // MediaItem*, MediaTrack* or NULL (markers/regions)
+		INT64 order;    // items: track id << 32 | item idx, tracks: track id
+		double pos;     // markers/regions only
+		int text;       // offset in List::texts
+	};
+
+	SNM_FindIndex() : m_proj(NULL), m_stateCount(-1) {}
+
+	// Hits in project order (markers/regions: position order), one per object
+	// _badRegex: set if the regular expression is invalid (no hits then)
+	const vector<int>& Search(int _type, const char* _str, bool _wholeWord, bool _regex, bool* _badRegex);
+	const Entry& GetEntry(int _type, int _idx) const { return m_lists[_type].entries[_idx]; }
+	// Call after our own undo points (selection, edit cursor): they bump the
+	// state count but leave the indexed texts untouched
+	void Resync() { if (m_proj == EnumProjects(-1, NULL, 0)) m_stateCount = GetProjectStateChangeCount(m_proj); }
+	// Index (in _hits) of the first hit after _order/_pos (_dir > 0) or of the last one before (_dir < 0), -1 if none
+	int FindHit(int _type, const vector<int>& _hits, INT64 _order, int _dir) const { return FindHit(_type, _hits, &Entry::order, _order, _dir); }
+	int FindHitByPos(int _type, const vector<int>& _hits, double _pos, int _dir) const { return FindHit(_type, _hits, &Entry::pos, _pos, _dir); }
+
+private:
+	struct List {
+		List() : built(false), caseSensitive(false), queryValid(false), wholeWord(false), regex(false), badRegex(false) {}
+		vector<Entry> entries;
+		string texts;
+		bool built, caseSensitive;
+		// last query
+		bool queryValid, wholeWord, regex, badRegex;
+		string query;
+		vector<int> hits;
+	};
+
+	void Check(int _type);
+	void Build(int _type);
+	void Add(List* _l, void* _obj, INT64 _order, double _pos, const char* _text);
+	template <class T> int FindHit(int _type, const vector<int>& _hits, T Entry::* _key, T _val, int _dir) const;
+
+	List m_lists[NUM_TYPES];
+	ReaProject* m_proj;
+	int m_stateCount;
+};
+
+static SNM_FindIndex g_findIndex;
 
-bool TakeNameMatch(MediaItem_Take* _tk, const char* _searchStr)
+// Same as SNM_FindIndex::Entry::order
+static INT64 ItemOrder(MediaItem* _item)
 {
-	char* takeName = _tk ? (char*)GetSetMediaItemTakeInfo(_tk, "P_NAME", NULL) : NULL;
-	return (takeName && stristr(takeName, _searchStr));
+	MediaTrack* tr = GetMediaItem_Track(_item);
+	return ((INT64)(tr ? CSurf_TrackToID(tr, false) : 0) << 32) | (INT64)GetMediaItemInfo_Value(_item, "IP_ITEMNUMBER");
 }
 
-bool TakeFilenameMatch(MediaItem_Take* _tk, const char* _searchStr)
+static bool IsWordChar(unsigned char _c) {
+	return (_c >= 'a' && _c <= 'z') || (_c >= 'A' && _c <= 'Z') || (_c >= '0' && _c <= '9') || _c == '_' || _c >= 0x80;
+}
+
+static void AppendLower(string* _s, const char* _text, bool _caseSensitive)
 {
-	bool match = false;
-	PCM_source* src = _tk ? (PCM_source*)GetSetMediaItemTakeInfo(_tk, "P_SOURCE", NULL) : NULL;
-	if (src) 
+	const size_t start = _s->size();
+	_s->append(_text);
+	if (!_caseSensitive)
+		for (size_t i = start; i < _s->size(); i++)
+			if ((*_s)[i] >= 'A' && (*_s)[i] <= 'Z')
+				(*_s)[i] += 'a' - 'A';
+}
+
+void SNM_FindIndex::Check(int _type)
+{
+	ReaProject* proj = EnumProjects(-1, NULL, 0);
+	const int stateCount = GetProjectStateChangeCount(proj);
+	if (proj != m_proj || stateCount != m_stateCount)
 	{
-		const char* takeFilename = src->GetFileName();
-		match = (takeFilename && strstr(takeFilename, _searchStr)); // no stristr: osx + utf-8
+		for (int i=0; i < NUM_TYPES; i++)
+			m_lists[i].built = false;
+		m_proj = proj;
+		m_stateCount = stateCount;
 	}
-	return match;
+	if (!m_lists[_type].built || _type == TYPE_TRACK_NOTES)
+		Build(_type);
+}
+
+void SNM_FindIndex::Add(List* _l, void* _obj, INT64 _order, double _pos, const char* _text)
+{
+	Entry e = { _obj, _order, _pos, (int)_l->texts.size() };
+	AppendLower(&_l->texts, _text ? _text : "", _l->caseSensitive);
+	_l->texts.push_back('\0');
+	_l->entries.push_back(e);
 }
 
-bool ItemNotesMatch(MediaItem* _item, const char* _searchStr)
+static bool SortByOrder(const SNM_FindIndex::Entry& _a, const SNM_FindIndex::Entry& _b) { return _a.order < _b.order; }
+static bool SortByPos(const SNM_FindIndex::Entry& _a, const SNM_FindIndex::Entry& _b) { return _a.pos < _b.pos; }
+
+void SNM_FindIndex::Build(int _type)
 {
-	bool match = false;
-	if (_item)
+	List& l = m_lists[_type];
+	l.entries.clear();
+	l.texts.clear();
+	l.queryValid = false;
+	l.built = true;
+	l.caseSensitive = (_type == TYPE_ITEM_FILENAME || _type == TYPE_ITEM_FILENAME_ALL_TAKES); // no stristr: osx + utf-8
+
+	switch(_type)
 	{
-		SNM_ChunkParserPatcher p(_item);
-		WDL_FastString notes;
-		if (p.GetSubChunk("NOTES", 2, 0, &notes, "VOLPAN") >= 0) // rmk: we use VOLPAN as it also exists for empty items
-			//JFB TODO? we compare a formated string with a normal one here, oh well..
-			match = (stristr(notes.Get(), _searchStr) != NULL);
+		case TYPE_ITEM_NAME:
+		case TYPE_ITEM_NAME_ALL_TAKES:
+		case TYPE_ITEM_FILENAME:
+		case TYPE_ITEM_FILENAME_ALL_TAKES:
+		case TYPE_ITEM_NOTES:
+		{
+			const bool allTakes = (_type == TYPE_ITEM_NAME_ALL_TAKES || _type == TYPE_ITEM_FILENAME_ALL_TAKES);
+			const bool names = (_type == TYPE_ITEM_NAME || _type == TYPE_ITEM_NAME_ALL_TAKES);
+			for (int i=1; i <= CountTracks(NULL); i++)
+			{
+				MediaTrack* tr = CSurf_TrackFromID(i, false);
+				const int nbItems = GetTrackNumMediaItems(tr);
+				for (int j=0; j < nbItems; j++)
+				{
+					MediaItem* item = GetTrackMediaItem(tr, j);
+					const INT64 order = ((INT64)i << 32) | j;
+					if (_type == TYPE_ITEM_NOTES)
+					{
+						// raw notes, no more chunk parsing
+						Add(&l, item, order, 0.0, (const char*)GetSetMediaItemInfo(item, "P_NOTES", NULL));
+						continue;
+					}
+
+					MediaItem_Take* activeTk = GetActiveTake(item);
+					const int nbTakes = GetMediaItemNumTakes(item);
+					for (int k=0; k < nbTakes; k++)
+					{
+						MediaItem_Take* tk = GetMediaItemTake(item, k);
+						if (!tk || (!allTakes && tk != activeTk))
+							continue;
+						if (names)
+							Add(&l, item, order, 0.0, (const char*)GetSetMediaItemTakeInfo(tk, "P_NAME", NULL));
+						else if (PCM_source* src = (PCM_source*)GetSetMediaItemTakeInfo(tk, "P_SOURCE", NULL))
+							Add(&l, item, order, 0.0, src->GetFileName());
+					}
+				}
+			}
+			break;
+		}
+		case TYPE_TRACK_NAME:
+			for (int i=0; i <= CountTracks(NULL); i++) // incl. master
+			{
+				MediaTrack* tr = CSurf_TrackFromID(i, false);
+				Add(&l, tr, i, 0.0, (const char*)GetSetMediaTrackInfo(tr, "P_NAME", NULL));
+			}
+			break;
+		case TYPE_TRACK_NOTES:
+		{
+			WDL_PtrList<MediaTrack> added;
+			for (int i=0; i < g_SNM_TrackNotes.Get()->GetSize(); i++)
+			{
+				SNM_TrackNotes* notes = g_SNM_TrackNotes.Get()->Get(i);
+				MediaTrack* tr = notes->GetTrack();
+				const int id = tr ? CSurf_TrackToID(tr, false) : -1;
+				if (id >= 0 && added.Find(tr) < 0) // first notes of a track win, as before
+				{
+					added.Add(tr);
+					Add(&l, tr, id, 0.0, notes->GetNotes());
+				}
+			}
+			std::stable_sort(l.entries.begin(), l.entries.end(), SortByOrder);
+			break;
+		}
+		case TYPE_MARKER_REGION:
+		{
+			int x=0, num;
+			bool isRgn;
+			double pos, end;
+			const char* name;
+			while ((x = EnumProjectMarkers2(NULL, x, &isRgn, &pos, &end, &name, &num)))
+				Add(&l, NULL, x, pos, name);
+			std::stable_sort(l.entries.begin(), l.entries.end(), SortByPos);
+			break;
+		}
 	}
-	return match;
 }
 
-bool TrackNameMatch(MediaTrack* _tr, const char* _searchStr) {
-	char* name = _tr ? (char*)GetSetMediaTrackInfo(_tr, "P_NAME", NULL) : NULL;
-	return (name && stristr(name, _searchStr));
+static bool TextMatch(const char* _text, const char* _str, int _strLen, bool _wholeWord)
+{
+	for (const char* p = strstr(_text, _str); p; p = strstr(p+1, _str))
+		if (!_wholeWord ||
+			((p == _text || !IsWordChar(p[-1])) && !IsWordChar(p[_strLen])))
+			return true;
+	return false;
 }
 
-bool TrackNotesMatch(MediaTrack* _tr, const char* _searchStr) 
+// Matches _text line by line (^ and $ match at line boundaries), long lines are
+// matched in windows that overlap by half: a match can't span several lines nor
+// be longer than MAX_REGEX_TEXT_LEN/2 chars
+static bool RegexMatch(const char* _text, const std::regex& _re)
 {
-	bool match = false;
-	if (_tr)
+	for (const char* line = _text;;)
 	{
-		for (int i=0; i < g_SNM_TrackNotes.Get()->GetSize(); i++)
+		const char* eol = strchr(line, '\n');
+		if (!eol) eol = line + strlen(line);
+		const char* lineEnd = (eol > line && eol[-1] == '\r') ? eol-1 : eol;
+		for (const char* p = line;; p += MAX_REGEX_TEXT_LEN/2)
 		{
-			if (g_SNM_TrackNotes.Get()->Get(i)->GetTrack() == _tr)
-			{
-				match = stristr(g_SNM_TrackNotes.Get()->Get(i)->GetNotes(), _searchStr) != NULL;
+			const char* end = (lineEnd - p > MAX_REGEX_TEXT_LEN) ? p + MAX_REGEX_TEXT_LEN : lineEnd;
+			std::regex_constants::match_flag_type flags = std::regex_constants::match_default;
+			if (p > line)
+				flags |= std::regex_constants::match_prev_avail;
+			if (end < lineEnd)
+				flags |= std::regex_constants::match_not_eol | std::regex_constants::match_not_eow;
+			if (std::regex_search(p, end, _re, flags))
+				return true;
+			if (end == lineEnd)
 				break;
+		}
+		if (!*eol)
+			return false;
+		line = eol+1;
+	}
+}
+
+const vector<int>& SNM_FindIndex::Search(int _type, const char* _str, bool _wholeWord, bool _regex, bool* _badRegex)
+{
+	Check(_type);
+	List& l = m_lists[_type];
+	if (!l.queryValid || l.query != _str || l.wholeWord != _wholeWord || l.regex != _regex)
+	{
+		l.queryValid = true;
+		l.query = _str;
+		l.wholeWord = _wholeWord;
+		l.regex = _regex;
+		l.badRegex = false;
+		l.hits.clear();
+
+		const char* texts = l.texts.c_str();
+		void* lastObj = NULL;
+		if (_regex)
+		{
+			try
+			{
+				string expr(_wholeWord ? "\\b(?:" : "");
+				expr.append(_str);
+				if (_wholeWord)
+					expr.append(")\\b");
+				const std::regex re(expr, l.caseSensitive ? std::regex::ECMAScript : std::regex::ECMAScript | std::regex::icase);
+				for (int i=0; i < (int)l.entries.size(); i++)
+				{
+					if (lastObj && l.entries[i].obj == lastObj)
+						continue;
+					if (RegexMatch(texts + l.entries[i].text, re))
+					{
+						l.hits.push_back(i);
+						lastObj = l.entries[i].obj;
+					}
+				}
+			}
+			catch (const std::regex_error&) { // incomplete or invalid expression: nothing matches
+				l.badRegex = true;
+				l.hits.clear();
 			}
 		}
+		else
+		{
+			string needle;
+			AppendLower(&needle, _str, l.caseSensitive);
+			for (int i=0; i < (int)l.entries.size(); i++)
+				if ((!lastObj || l.entries[i].obj != lastObj) && TextMatch(texts + l.entries[i].text, needle.c_str(), (int)needle.size(), _wholeWord))
+				{
+					l.hits.push_back(i);
+					lastObj = l.entries[i].obj;
+				}
+		}
 	}
-	return match;
+	if (_badRegex)
+		*_badRegex = l.badRegex;
+	return l.hits;
 }
 
+template <class T> int SNM_FindIndex::FindHit(int _type, const vector<int>& _hits, T Entry::* _key, T _val, int _dir) const
+{
+	// binary search of the first hit > _val (_dir > 0) or >= _val (_dir < 0)
+	const vector<Entry>& entries = m_lists[_type].entries;
+	int lo = 0, hi = (int)_hits.size();
+	while (lo < hi)
+	{
+		const int mid = (lo+hi) / 2;
+		const T v = entries[_hits[mid]].*_key;
+		if (_dir > 0 ? v <= _val : v < _val) lo = mid+1;
+		else hi = mid;
+	}
+	if (_dir > 0)
+		return lo < (int)_hits.size() ? lo : -1;
+	return lo-1;
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // FindWnd
 ///////////////////////////////////////////////////////////////////////////////
@@ -139,6 +394,7 @@ FindWnd::FindWnd()
 	m_id.Set(FIND_WND_ID);
 	m_type = 0;
 	m_zoomSrollItems = false;
+	m_wholeWord = m_regex = false;
 
 	// Must call SWS_DockWnd::Init() to restore parameters and open the window if necessary
 	Init();
@@ -152,6 +408,8 @@ void FindWnd::OnInitDlg()
 	// load prefs 
 	m_type = GetPrivateProfileInt(FIND_INI_SEC, "Type", 0, g_SNM_IniFn.Get());
 	m_zoomSrollItems = (GetPrivateProfileInt(FIND_INI_SEC, "ZoomScrollToFoundItems", 0, g_SNM_IniFn.Get()) == 1);
+	m_wholeWord = (GetPrivateProfileInt(FIND_INI_SEC, "WholeWord", 0, g_SNM_IniFn.Get()) == 1);
+	m_regex = (GetPrivateProfileInt(FIND_INI_SEC, "Regex", 0, g_SNM_IniFn.Get()) == 1);
 
 
 	LICE_CachedFont* font = SNM_GetThemeFont();
@@ -169,6 +427,16 @@ void FindWnd::OnInitDlg()
 	m_btnEnableZommScroll.SetCheckState(m_zoomSrollItems);
 	m_parentVwnd.AddChild(&m_btnEnableZommScroll);
 
+	m_btnWholeWord.SetID(BTNID_WHOLE_WORD);
+	m_btnWholeWord.SetTextLabel(__LOCALIZE("Whole word","sws_DLG_154"), -1, font);
+	m_btnWholeWord.SetCheckState(m_wholeWord);
+	m_parentVwnd.AddChild(&m_btnWholeWord);
+
+	m_btnRegex.SetID(BTNID_REGEX);
+	m_btnRegex.SetTextLabel(__LOCALIZE("Regex","sws_DLG_154"), -1, font);
+	m_btnRegex.SetCheckState(m_regex);
+	m_parentVwnd.AddChild(&m_btnRegex);
+
 	m_btnFind.SetID(BTNID_FIND);
 	m_parentVwnd.AddChild(&m_btnFind);
 
@@ -198,6 +466,7 @@ void FindWnd::OnInitDlg()
 
 
 	g_notFound = false;
+	*g_findResult = '\0';
 //	*g_searchStr = 0;
 	SetDlgItemText(m_hwnd, IDC_EDIT, g_searchStr);
 
@@ -211,6 +480,8 @@ void FindWnd::OnDestroy()
 	if (snprintfStrict(type, sizeof(type), "%d", m_type) > 0)
 		WritePrivateProfileString(FIND_INI_SEC, "Type", type, g_SNM_IniFn.Get());
 	WritePrivateProfileString(FIND_INI_SEC, "ZoomScrollToFoundItems", m_zoomSrollItems ? "1" : "0", g_SNM_IniFn.Get());
+	WritePrivateProfileString(FIND_INI_SEC, "WholeWord", m_wholeWord ? "1" : "0", g_SNM_IniFn.Get());
+	WritePrivateProfileString(FIND_INI_SEC, "Regex", m_regex ? "1" : "0", g_SNM_IniFn.Get());
 
 	m_cbType.Empty();
 	g_notFound = false;
@@ -231,6 +502,18 @@ void FindWnd::OnCommand(WPARAM wParam, LPARAM lParam)
 			if (!HIWORD(wParam) ||  HIWORD(wParam)==600)
 				m_zoomSrollItems = !m_zoomSrollItems;
 			break;
+		case BTNID_WHOLE_WORD:
+			if (!HIWORD(wParam) ||  HIWORD(wParam)==600) {
+				m_wholeWord = !m_wholeWord;
+				UpdateNotFoundMsg(true); // + redraw
+			}
+			break;
+		case BTNID_REGEX:
+			if (!HIWORD(wParam) ||  HIWORD(wParam)==600) {
+				m_regex = !m_regex;
+				UpdateNotFoundMsg(true); // + redraw
+			}
+			break;
 		case BTNID_FIND:
 			Find(0);
 			break;
@@ -305,6 +588,7 @@ void FindWnd::DrawControls(LICE_IBitmap* _bm, const RECT* _r, int* _tooltipHeigh
 
 	if (SNM_AutoVWndPosition(DT_LEFT, &m_cbType, &m_txtScope, _r, &x0, _r->top, h))
 	{
+		bool options = true;
 		switch (m_type)
 		{
 			case TYPE_ITEM_NAME:
@@ -313,12 +597,19 @@ void FindWnd::DrawControls(LICE_IBitmap* _bm, const RECT* _r, int* _tooltipHeigh
 			case TYPE_ITEM_FILENAME_ALL_TAKES:
 			case TYPE_ITEM_NOTES:
 				m_btnEnableZommScroll.SetCheckState(m_zoomSrollItems);
-				drawLogo = SNM_AutoVWndPosition(DT_LEFT, &m_btnEnableZommScroll, NULL, _r, &x0, _r->top, h);
-				break;
-			default:
-				drawLogo = true;
+				options = SNM_AutoVWndPosition(DT_LEFT, &m_btnEnableZommScroll, NULL, _r, &x0, _r->top, h);
 				break;
 		}
+
+		if (options)
+		{
+			m_btnWholeWord.SetCheckState(m_wholeWord);
+			if (SNM_AutoVWndPosition(DT_LEFT, &m_btnWholeWord, NULL, _r, &x0, _r->top, h))
+			{
+				m_btnRegex.SetCheckState(m_regex);
+				drawLogo = SNM_AutoVWndPosition(DT_LEFT, &m_btnRegex, NULL, _r, &x0, _r->top, h);
+			}
+		}
 	}
 
 	if (drawLogo)
@@ -343,7 +634,12 @@ void FindWnd::DrawControls(LICE_IBitmap* _bm, const RECT* _r, int* _tooltipHeigh
 		}
 	}
 
-	m_txtResult.SetText(g_notFound ? __LOCALIZE("Not found!","sws_DLG_154") : "");
+	// red if not found, plain text otherwise (hit number/count)
+	if (g_notFound)
+		m_txtResult.SetColors(LICE_RGBA(170,0,0,255));
+	else if (ColorTheme* ct = SNM_GetColorTheme())
+		m_txtResult.SetColors(LICE_RGBA_FROMNATIVE(ct->main_text, 255));
+	m_txtResult.SetText(g_notFound && !*g_findResult ? __LOCALIZE("Not found!","sws_DLG_154") : g_findResult);
 	SNM_AutoVWndPosition(DT_LEFT, &m_txtResult, NULL, _r, &x0, y0, h);
 }
 
@@ -356,25 +652,15 @@ bool FindWnd::Find(int _mode)
 	switch(m_type)
 	{
 		case TYPE_ITEM_NAME:
-			update = FindMediaItem(_mode, false, TakeNameMatch);
-		break;
 		case TYPE_ITEM_NAME_ALL_TAKES:
-			update = FindMediaItem(_mode, true, TakeNameMatch);
-		break;
 		case TYPE_ITEM_FILENAME:
-			update = FindMediaItem(_mode, false, TakeFilenameMatch);
-		break;
 		case TYPE_ITEM_FILENAME_ALL_TAKES:
-			update = FindMediaItem(_mode, true, TakeFilenameMatch);
-		break;
 		case TYPE_ITEM_NOTES:
-			update = FindMediaItem(_mode, false, NULL, ItemNotesMatch);
+			update = FindMediaItem(_mode);
 		break;
 		case TYPE_TRACK_NAME:
-			update = FindTrack(_mode, TrackNameMatch);
-		break;
 		case TYPE_TRACK_NOTES:
-			update = FindTrack(_mode, TrackNotesMatch);
+			update = FindTrack(_mode);
 		break;
 		case TYPE_MARKER_REGION:
 			update = FindMarkerRegion(_mode);
@@ -382,257 +668,159 @@ bool FindWnd::Find(int _mode)
 	return update;
 }
 
-MediaItem* FindWnd::FindPrevNextItem(int _dir, MediaItem* _item)
+// Searches the index, returns the hits (NULL if none) and updates the result msg
+// if there are no hits (found hits are reported by the caller)
+const vector<int>* FindWnd::Search()
 {
-	if (!_dir)
-		return NULL;
-
-	MediaItem* previous = NULL;
-	int startTrIdx = (_dir == -1 ? CountTracks(NULL) : 1);
-	if (_item)
-		if (MediaTrack* trItem = GetMediaItem_Track(_item))
-			startTrIdx = CSurf_TrackToID(trItem, false);
-
-	if (startTrIdx>=0)
+	bool badRegex = false;
+	const vector<int>& hits = g_findIndex.Search(m_type, g_searchStr, m_wholeWord, m_regex, &badRegex);
+	if (hits.empty())
 	{
-		bool found = (_item == NULL);
-		for (int i = startTrIdx; !previous && i <= CountTracks(NULL) && i >= 1; i+=_dir)
+		UpdateNotFoundMsg(false);
+		if (badRegex)
 		{
-			MediaTrack* tr = CSurf_TrackFromID(i, false); 
-			int nbItems = GetTrackNumMediaItems(tr);
-			for (int j = (_dir > 0 ? 0 : (nbItems-1)); j < nbItems && j >= 0; j+=_dir)
-			{
-				MediaItem* item = GetTrackMediaItem(tr,j);
-				if (found && item) {
-					previous = item;
-					break;
-				}
-				if (_item && item == _item)
-					found = true;
-			}
+			lstrcpyn(g_findResult, __LOCALIZE("Invalid regex!","sws_DLG_154"), sizeof(g_findResult));
+			m_parentVwnd.RequestRedraw(NULL);
 		}
+		return NULL;
 	}
-	return previous;
+	return &hits;
 }
 
-// param _allTakes only makes sense if jobTake() is used
-bool FindWnd::FindMediaItem(int _dir, bool _allTakes, bool (*jobTake)(MediaItem_Take*,const char*), bool (*jobItem)(MediaItem*,const char*))
+// _hitIdx: index of the selected hit (next/prev), -1 for "find all"
+void FindWnd::UpdateResultMsg(int _hitIdx, int _nbHits)
 {
-	bool update = false, found = false, sel = true;
-	if (*g_searchStr)
-	{
-		PreventUIRefresh(1);
-
-		MediaItem* startItem = NULL;
-		bool clearCurrentSelection = false;
-		if (_dir)
-		{
-			WDL_PtrList<MediaItem> items;
-			SNM_GetSelectedItems(NULL, &items);
-			if (items.GetSize())
-			{
-				startItem = FindPrevNextItem(_dir, items.Get(_dir > 0 ? 0 : items.GetSize()-1));
-				clearCurrentSelection = (startItem != NULL); 
-			}
-			else
-				startItem = FindPrevNextItem(_dir, NULL);
-		}
-		else
-		{
-			startItem = FindPrevNextItem(1, NULL);
-			clearCurrentSelection = (startItem != NULL); 
-		}
+	g_notFound = false;
+	if (_hitIdx >= 0)
+		snprintf(g_findResult, sizeof(g_findResult), __LOCALIZE_VERFMT("%d of %d","sws_DLG_154"), _hitIdx+1, _nbHits);
+	else
+		snprintf(g_findResult, sizeof(g_findResult), __LOCALIZE_VERFMT("%d found","sws_DLG_154"), _nbHits);
+	m_parentVwnd.RequestRedraw(NULL);
+}
 
-		if (clearCurrentSelection)
-		{
-			Undo_BeginBlock2(NULL);
-			Main_OnCommand(40289,0); // unselect all items
-			update = true;
-		}
+// Next/previous: first hit after the 1st selected item/last hit before the last selected
+// item (or first/last hit if none), find all: all hits.
+// The selection is only changed when something is found.
+bool FindWnd::FindMediaItem(int _dir)
+{
+	if (!*g_searchStr)
+		return false;
 
-		MediaItem* item = NULL;
-		MediaTrack* startTr = startItem ? GetMediaItem_Track(startItem) : NULL;
-		int startTrIdx = startTr ? CSurf_TrackToID(startTr, false) : -1;
-		if (startTr && startItem && startTrIdx>=0)
-		{
-			// find startItem idx
-			int startItemIdx=-1;
-			while (item != startItem) 
-				item = GetTrackMediaItem(startTr,++startItemIdx);
+	const vector<int>* hits = Search();
+	if (!hits)
+		return false;
 
-			bool firstItem=true, breakSelection=false;
-			for (int i=startTrIdx; !breakSelection && i <= CountTracks(NULL) && i>=1; i += (!_dir ? 1 : _dir))
-			{
-				MediaTrack* tr = CSurf_TrackFromID(i, false); 
-				int nbItems = GetTrackNumMediaItems(tr);
-				for (int j = (firstItem ? startItemIdx : (_dir >= 0 ? 0 : (nbItems-1))); 
-					 tr && !breakSelection && j < nbItems && j >= 0; 
-					 j += (!_dir ? 1 : _dir))
-				{
-					item = GetTrackMediaItem(tr,j);
-					firstItem = false;
+	int hitIdx = -1;
+	if (_dir)
+	{
+		WDL_PtrList<MediaItem> items;
+		SNM_GetSelectedItems(NULL, &items);
+		if (items.GetSize())
+			hitIdx = g_findIndex.FindHit(m_type, *hits, ItemOrder(items.Get(_dir > 0 ? 0 : items.GetSize()-1)), _dir);
+		else
+			hitIdx = _dir > 0 ? 0 : (int)hits->size()-1;
 
-					// search at item level 
-					if (jobItem)
-					{
-						if (jobItem(item, g_searchStr))
-						{
-							if (!update) Undo_BeginBlock2(NULL);
-							update = found = true;
-							GetSetMediaItemInfo(item, "B_UISEL", &sel);
-							if (_dir) breakSelection = true;
-						}
-					}
-					// search at take level 
-					else if (jobTake)
-					{
-						int nbTakes = GetMediaItemNumTakes(item);
-						for (int k=0; item && k < nbTakes; k++)
-						{
-							MediaItem_Take* tk = GetMediaItemTake(item, k);
-							if (tk && (_allTakes || tk == GetActiveTake(item)))
-							{
-								if (jobTake(tk, g_searchStr))
-								{
-									if (!update) Undo_BeginBlock2(NULL);
-									update = found = true;
-									GetSetMediaItemInfo(item, "B_UISEL", &sel);
-									if (_dir) {
-										breakSelection = true;
-										break;
-									}
-								}
-							}
-						}
-					}
-				}
-			}
-		}
-		UpdateNotFoundMsg(found);
-		if (found && m_zoomSrollItems) {
-			if (!_dir) ZoomToSelItems();
-			else if (item) ScrollToSelItem(item);
+		if (hitIdx < 0)
+		{
+			UpdateNotFoundMsg(false);
+			return false;
 		}
-
-		PreventUIRefresh(-1);
 	}
 
-	if (update)
+	MediaItem* item = NULL;
+	PreventUIRefresh(1);
+	Undo_BeginBlock2(NULL);
+	Main_OnCommand(40289,0); // unselect all items
+	for (int i = (_dir ? hitIdx : 0); i < (_dir ? hitIdx+1 : (int)hits->size()); i++)
 	{
-		UpdateTimeline();
-		Undo_EndBlock2(NULL, __LOCALIZE("Find: change media item selection","sws_undo"), UNDO_STATE_ALL);
+		MediaItem* hit = (MediaItem*)g_findIndex.GetEntry(m_type, (*hits)[i]).obj;
+		if (ValidatePtr2(NULL, hit, "MediaItem*"))
+			GetSetMediaItemInfo(item = hit, "B_UISEL", &g_bTrue);
 	}
-	return update;
+	UpdateResultMsg(_dir ? hitIdx : -1, (int)hits->size());
+	if (item && m_zoomSrollItems) {
+		if (!_dir) ZoomToSelItems();
+		else ScrollToSelItem(item);
+	}
+	PreventUIRefresh(-1);
+
+	UpdateTimeline();
+	Undo_EndBlock2(NULL, __LOCALIZE("Find: change media item selection","sws_undo"), UNDO_STATE_ALL);
+	g_findIndex.Resync();
+	return true;
 }
 
-bool FindWnd::FindTrack(int _dir, bool (*job)(MediaTrack*,const char*))
+// Same as FindMediaItem(), master track included
+bool FindWnd::FindTrack(int _dir)
 {
-	bool update = false, found = false;
-	if (*g_searchStr)
+	if (!*g_searchStr)
+		return false;
+
+	const vector<int>* hits = Search();
+	if (!hits)
+		return false;
+
+	int hitIdx = -1;
+	if (_dir)
 	{
-		int startTrIdx = -1;
-		bool clearCurrentSelection = false;
-		if (_dir)
+		if (const int selTracksCount = SNM_CountSelectedTracks(NULL, true))
 		{
-			if (const int selTracksCount = SNM_CountSelectedTracks(NULL, true))
-			{
-				if (MediaTrack* startTr = SNM_GetSelectedTrack(NULL, _dir > 0 ? 0 : selTracksCount-1, true))
-				{
-					int id = CSurf_TrackToID(startTr, false);
-					if ((_dir > 0 && id < CountTracks(NULL)) || (_dir < 0 && id >0))
-					{
-						startTrIdx = id + _dir;
-						clearCurrentSelection = true;
-					}
-				}
-			}
-			else
-				startTrIdx = (_dir > 0 ? 0 : CountTracks(NULL));
+			if (MediaTrack* startTr = SNM_GetSelectedTrack(NULL, _dir > 0 ? 0 : selTracksCount-1, true))
+				hitIdx = g_findIndex.FindHit(m_type, *hits, CSurf_TrackToID(startTr, false), _dir);
 		}
 		else
-		{
-			startTrIdx = 0;
-			clearCurrentSelection = true;
-		}
+			hitIdx = _dir > 0 ? 0 : (int)hits->size()-1;
 
-		if (clearCurrentSelection)
+		if (hitIdx < 0)
 		{
-			Undo_BeginBlock2(NULL);
-			Main_OnCommand(40297,0); // unselect all tracks
-			update = true;
-		}
-
-		if (startTrIdx >= 0)
-		{
-			for (int i = startTrIdx; i <= CountTracks(NULL) && i>=0; i += (!_dir ? 1 : _dir))
-			{
-				MediaTrack* tr = CSurf_TrackFromID(i, false); 
-				if (tr && job(tr, g_searchStr))
-				{
-					if (!update)
-						Undo_BeginBlock2(NULL);
-
-					update = found = true;
-					GetSetMediaTrackInfo(tr, "I_SELECTED", &g_i1);
-					if (_dir) 
-						break;
-				}
-			}
+			UpdateNotFoundMsg(false);
+			return false;
 		}
-
-		UpdateNotFoundMsg(found);	
-		if (found)
-			ScrollSelTrack(true, true);
 	}
 
-	if (update)
-		Undo_EndBlock2(NULL, __LOCALIZE("Find: change track selection","sws_undo"), UNDO_STATE_ALL);
-
-	return update;
+	Undo_BeginBlock2(NULL);
+	Main_OnCommand(40297,0); // unselect all tracks
+	for (int i = (_dir ? hitIdx : 0); i < (_dir ? hitIdx+1 : (int)hits->size()); i++)
+	{
+		MediaTrack* tr = (MediaTrack*)g_findIndex.GetEntry(m_type, (*hits)[i]).obj;
+		if (ValidatePtr2(NULL, tr, "MediaTrack*"))
+			GetSetMediaTrackInfo(tr, "I_SELECTED", &g_i1);
+	}
+	UpdateResultMsg(_dir ? hitIdx : -1, (int)hits->size());
+	ScrollSelTrack(true, true);
+	Undo_EndBlock2(NULL, __LOCALIZE("Find: change track selection","sws_undo"), UNDO_STATE_ALL);
+	g_findIndex.Resync();
+	return true;
 }
 
+// Next/previous marker or region from the edit cursor
 bool FindWnd::FindMarkerRegion(int _dir)
 {
-	if (!_dir)
+	if (!_dir || !*g_searchStr)
+		return false;
+
+	const vector<int>* hits = Search();
+	if (!hits)
 		return false;
 
-	bool update = false, found = false;
-	if (*g_searchStr)
+	const int hitIdx = g_findIndex.FindHitByPos(m_type, *hits, GetCursorPositionEx(NULL), _dir);
+	if (hitIdx < 0)
 	{
-		double startPos = GetCursorPositionEx(NULL);
-		int id, x = 0;
-		bool bR;
-		double dPos, dRend, dMinMaxPos = _dir < 0 ? -DBL_MAX : DBL_MAX;
-		const char *cName;
-		while ((x=EnumProjectMarkers2(NULL, x, &bR, &dPos, &dRend, &cName, &id)))
-		{
-			if (_dir == 1 && dPos > startPos) {
-				if (stristr(cName, g_searchStr)) {
-					found = true;
-					dMinMaxPos = min(dPos, dMinMaxPos);
-				}
-			}
-			else if (_dir == -1 && dPos < startPos) {
-				if (stristr(cName, g_searchStr)) {
-					found = true;
-					dMinMaxPos = max(dPos, dMinMaxPos);
-				}
-			}
-		}
-		UpdateNotFoundMsg(found);	
-		if (found) {
-			SetEditCurPos2(NULL, dMinMaxPos, true, false);
-			update = true;
-		}
+		UpdateNotFoundMsg(false);
+		return false;
 	}
-	if (update)
-		Undo_OnStateChangeEx2(NULL, __LOCALIZE("Find: change edit cursor position","sws_undo"), UNDO_STATE_ALL, -1); // in case the pref "undo pt for edit cursor positions" is enabled..
-	return update;
+
+	SetEditCurPos2(NULL, g_findIndex.GetEntry(m_type, (*hits)[hitIdx]).pos, true, false);
+	UpdateResultMsg(hitIdx, (int)hits->size());
+	Undo_OnStateChangeEx2(NULL, __LOCALIZE("Find: change edit cursor position","sws_undo"), UNDO_STATE_ALL, -1); // in case the pref "undo pt for edit cursor positions" is enabled..
+	g_findIndex.Resync();
+	return true;
 }
 
 void FindWnd::UpdateNotFoundMsg(bool _found)
 {
 	g_notFound = !_found;
+	*g_findResult = '\0';
 	m_parentVwnd.RequestRedraw(NULL);
 }
 
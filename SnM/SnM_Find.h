@@ -40,11 +40,11 @@ public:
 	void OnCommand(WPARAM wParam, LPARAM lParam);
 	void GetMinSize(int* _w, int* _h) { *_w=297; *_h=100; }
 	bool Find(int _mode);
-	MediaItem* FindPrevNextItem(int _dir, MediaItem* _item);
-	bool FindMediaItem(int _dir, bool _allTakes, bool (*jobTake)(MediaItem_Take*,const char*), bool (*jobItem)(MediaItem*,const char*) = NULL);
-	bool FindTrack(int _dir, bool (*job)(MediaTrack*,const char*));
+	bool FindMediaItem(int _dir);
+	bool FindTrack(int _dir);
 	bool FindMarkerRegion(int _dir);
 	void UpdateNotFoundMsg(bool _found);
+	void UpdateResultMsg(int _hitIdx, int _nbHits);
 protected:
 	void OnInitDlg();
 	void OnDestroy();
@@ -52,12 +52,14 @@ protected:
 	void DrawControls(LICE_IBitmap* _bm, const RECT* _r, int* _tooltipHeight = NULL);
 
 	WDL_VirtualComboBox m_cbType;
-	WDL_VirtualIconButton m_btnEnableZommScroll;
+	WDL_VirtualIconButton m_btnEnableZommScroll, m_btnWholeWord, m_btnRegex;
 	WDL_VirtualStaticText m_txtScope, m_txtResult;
 	SNM_ToolbarButton m_btnFind, m_btnPrev, m_btnNext;
 
+	const vector<int>* Search();
+
 	int m_type;
-	bool m_zoomSrollItems;
+	bool m_zoomSrollItems, m_wholeWord, m_regex;
 };
 
 int FindInit();
@@ -37,6 +37,7 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 DWORD g_mkrRgnNotifyTime = 0; // really approx (updated on timer)
+int g_mkrRgnSuspended = 0;
 WDL_PtrList<MarkerRegion> g_mkrRgnCache;
 WDL_PtrList<SNM_MarkerRegionListener> g_mkrRgnListeners;
 
@@ -88,11 +89,19 @@ int UpdateMarkerRegionCache()
 	return updateFlags;
 }
 
+// for bulk marker/region edits: listeners are notified once, on the first poll after resuming
+void SuspendMarkerRegionUpdates(bool _suspend)
+{
+	g_mkrRgnSuspended += _suspend ? 1 : -1;
+	if (!g_mkrRgnSuspended)
+		g_mkrRgnNotifyTime = 0;
+}
+
 // notify marker/region listeners?
 // polled via SNM_CSurfRun()
 void UpdateMarkerRegionRun()
 {
-	if (GetTickCount() > g_mkrRgnNotifyTime)
+	if (!g_mkrRgnSuspended && GetTickCount() > g_mkrRgnNotifyTime)
 	{
 		g_mkrRgnNotifyTime = GetTickCount() + SNM_MKR_RGN_UPDATE_FREQ;
 		
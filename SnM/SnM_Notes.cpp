@@ -51,6 +51,8 @@
 #include <WDL/localize/localize.h>
 #include <WDL/projectcontext.h>
 
+#include <unordered_map>
+
 #define NOTES_WND_ID				"SnMNotesHelp"
 #define NOTES_INI_SEC				"Notes"
 #define MAX_HELP_LENGTH				(64*1024) //JFB! instead of MAX_INI_SECTION (too large)
@@ -126,6 +128,154 @@ MediaTrack* g_trNote = NULL;
 // to distinguish internal marker/region updates from external ones
 bool g_internalMkrRgnChange = false;
 
+// next subtitle, converted ahead of time so that it can be displayed right away
+int g_nextSubId = -1;
+char g_nextSubText[MAX_HELP_LENGTH] = "";
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Marker/region position index and subtitle lookup
+// (FindMarkerRegion() and subtitle searches are linear, too slow during
+// playback with thousands of imported subtitles)
+///////////////////////////////////////////////////////////////////////////////
+
+class NotesMkrRgnIndex
+{
+public:
+	NotesMkrRgnIndex() : m_proj(NULL), m_stateCount(-1), m_dirty(true) {}
+	void Invalidate() { m_dirty = true; }
+
+	// same result as FindMarkerRegion(NULL, _pos, _flags, _idOut)
+	int Find(double _pos, int _flags, int* _idOut);
+	// id of the first marker/region starting after _pos, -1 if none
+	int FindNext(double _pos, int _flags);
+
+private:
+	struct Entry {
+		double pos, end;
+		int id, idx;
+		bool operator<(const Entry& _e) const { return pos < _e.pos; }
+	};
+	static bool PosLess(double _pos, const Entry& _e) { return _pos < _e.pos; }
+	void Check();
+
+	vector<Entry> m_markers, m_regions;
+	vector<int> m_rgnPrev; // previous region ending later, skips regions ending before a given position
+	ReaProject* m_proj;
+	int m_stateCount;
+	bool m_dirty;
+};
+
+void NotesMkrRgnIndex::Check()
+{
+	ReaProject* proj = EnumProjects(-1, NULL, 0);
+	int stateCount = GetProjectStateChangeCount(proj);
+	if (!m_dirty && proj == m_proj && stateCount == m_stateCount)
+		return;
+
+	m_markers.clear();
+	m_regions.clear();
+	bool isrgn;
+	double pos, end;
+	int x=0, lastx=0, num;
+	while ((x = EnumProjectMarkers3(proj, x, &isrgn, &pos, &end, NULL, &num, NULL)))
+	{
+		Entry e = { pos, end, MakeMarkerRegionId(num, isrgn), lastx };
+		(isrgn ? m_regions : m_markers).push_back(e);
+		lastx = x;
+	}
+	std::stable_sort(m_markers.begin(), m_markers.end());
+	std::stable_sort(m_regions.begin(), m_regions.end());
+
+	m_rgnPrev.resize(m_regions.size());
+	vector<int> stack;
+	for (int i=0; i<(int)m_regions.size(); i++)
+	{
+		while (!stack.empty() && m_regions[stack.back()].end <= m_regions[i].end)
+			stack.pop_back();
+		m_rgnPrev[i] = stack.empty() ? -1 : stack.back();
+		stack.push_back(i);
+	}
+
+	m_proj = proj;
+	m_stateCount = stateCount;
+	m_dirty = false;
+}
+
+int NotesMkrRgnIndex::Find(double _pos, int _flags, int* _idOut)
+{
+	Check();
+
+	const Entry* found = NULL;
+	if (_flags&SNM_MARKER_MASK)
+	{
+		int i = int(std::upper_bound(m_markers.begin(), m_markers.end(), _pos, PosLess) - m_markers.begin()) - 1;
+		if (i >= 0)
+			found = &m_markers[i];
+	}
+	if (_flags&SNM_REGION_MASK)
+	{
+		// last region starting before _pos, skip the ones that end before it
+		int i = int(std::upper_bound(m_regions.begin(), m_regions.end(), _pos, PosLess) - m_regions.begin()) - 1;
+		while (i >= 0 && m_regions[i].end < _pos)
+			i = m_rgnPrev[i];
+		if (i >= 0 && (!found || m_regions[i].idx > found->idx))
+			found = &m_regions[i];
+	}
+
+	if (_idOut) *_idOut = found ? found->id : -1;
+	return found ? found->idx : -1;
+}
+
+int NotesMkrRgnIndex::FindNext(double _pos, int _flags)
+{
+	Check();
+
+	const Entry* found = NULL;
+	if (_flags&SNM_MARKER_MASK)
+	{
+		vector<Entry>::const_iterator it = std::upper_bound(m_markers.begin(), m_markers.end(), _pos, PosLess);
+		if (it != m_markers.end())
+			found = &*it;
+	}
+	if (_flags&SNM_REGION_MASK)
+	{
+		vector<Entry>::const_iterator it = std::upper_bound(m_regions.begin(), m_regions.end(), _pos, PosLess);
+		if (it != m_regions.end() && (!found || it->idx < found->idx))
+			found = &*it;
+	}
+	return found ? found->id : -1;
+}
+
+NotesMkrRgnIndex g_mkrRgnIndex;
+
+// id -> subtitle, rebuilt on demand: call RegionSubsChanged() when adding/removing subtitles
+std::unordered_map<int, SNM_RegionSubtitle*> g_subsById;
+WDL_PtrList_DOD<SNM_RegionSubtitle>* g_subsByIdList = NULL;
+bool g_subsByIdDirty = true;
+
+void RegionSubsChanged()
+{
+	g_subsByIdDirty = true;
+	g_nextSubId = -1;
+}
+
+SNM_RegionSubtitle* FindRegionSub(int _id)
+{
+	WDL_PtrList_DOD<SNM_RegionSubtitle>* subs = g_pRegionSubs.Get();
+	if (g_subsByIdDirty || subs != g_subsByIdList)
+	{
+		g_subsById.clear();
+		for (int i=0; i < subs->GetSize(); i++)
+			if (SNM_RegionSubtitle* sub = subs->Get(i))
+				g_subsById.insert(std::make_pair(sub->GetId(), sub)); // keeps the 1st one, like the former linear searches
+		g_subsByIdList = subs;
+		g_subsByIdDirty = false;
+	}
+	std::unordered_map<int, SNM_RegionSubtitle*>::const_iterator it = g_subsById.find(_id);
+	return it != g_subsById.end() ? it->second : NULL;
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // NotesWnd
@@ -835,17 +985,15 @@ void NotesWnd::SaveCurrentMkrRgnNameOrSub(int _type, bool _wantUndo)
 		else
 		{
 			// CRLF removed only when saving the project..
-			bool found = false;
-			for (int i=0; i < g_pRegionSubs.Get()->GetSize(); i++) 
+			if (SNM_RegionSubtitle* sub = FindRegionSub(g_lastMarkerRegionId))
+				sub->SetNotes(g_lastText);
+			else
 			{
-				if (g_pRegionSubs.Get()->Get(i)->GetId() == g_lastMarkerRegionId) {
-					g_pRegionSubs.Get()->Get(i)->SetNotes(g_lastText);
-					found = true;
-					break;
-				}
-			}
-			if (!found)
 				g_pRegionSubs.Get()->Add(new SNM_RegionSubtitle(nullptr, g_lastMarkerRegionId, g_lastText));
+				RegionSubsChanged();
+			}
+			if (g_lastMarkerRegionId == g_nextSubId)
+				g_nextSubId = -1;
 			if (_wantUndo)
 				Undo_OnStateChangeEx2(NULL, IsRegion(g_lastMarkerRegionId) ? __LOCALIZE("Edit region subtitle","sws_undo") : __LOCALIZE("Edit marker subtitle","sws_undo"), UNDO_STATE_MISCCFG, -1);
 			else
@@ -1046,8 +1194,7 @@ int NotesWnd::UpdateMkrRgnNameOrSub(int _type)
 		if (_type!=SNM_NOTES_RGN_NAME && _type!=SNM_NOTES_RGN_SUB)
 			mask |= SNM_MARKER_MASK;
 
-		// NF: could use API GetLastMarkerAndCurRegion() instead
-		int id, idx = FindMarkerRegion(NULL, dPos, mask, &id);
+		int id, idx = g_mkrRgnIndex.Find(dPos, mask, &id);
 		if (id > 0)
 		{
 			if (id != g_lastMarkerRegionId)
@@ -1063,13 +1210,16 @@ int NotesWnd::UpdateMkrRgnNameOrSub(int _type)
 				}
 				else // update subtitle
 				{
-					for (int i=0; i < g_pRegionSubs.Get()->GetSize(); i++)
-						if (g_pRegionSubs.Get()->Get(i)->GetId() == id) {
-							SetText(g_pRegionSubs.Get()->Get(i)->GetNotes());
-							return REQUEST_REFRESH;
-						}
-					g_pRegionSubs.Get()->Add(new SNM_RegionSubtitle(nullptr, id, ""));
-					SetText("");
+					if (id == g_nextSubId)
+						SetText(g_nextSubText, false); // already converted
+					else if (SNM_RegionSubtitle* sub = FindRegionSub(id))
+						SetText(sub->GetNotes());
+					else
+					{
+						g_pRegionSubs.Get()->Add(new SNM_RegionSubtitle(nullptr, id, ""));
+						RegionSubsChanged();
+						SetText("");
+					}
 				}
 				refreshType = REQUEST_REFRESH;
 			}
@@ -1081,6 +1231,18 @@ int NotesWnd::UpdateMkrRgnNameOrSub(int _type)
 			SetText("");
 			refreshType = REQUEST_REFRESH;
 		}
+
+		// prepare the next subtitle
+		if (_type>=SNM_NOTES_MKR_SUB && _type<=SNM_NOTES_MKRRGN_SUB)
+		{
+			int nextId = g_mkrRgnIndex.FindNext(dPos, mask);
+			if (nextId != g_nextSubId)
+			{
+				SNM_RegionSubtitle* sub = nextId > 0 ? FindRegionSub(nextId) : NULL;
+				g_nextSubId = sub ? nextId : -1;
+				GetStringWithRN(sub ? sub->GetNotes() : "", g_nextSubText, sizeof(g_nextSubText));
+			}
+		}
 	}
 	return refreshType;
 }
@@ -1098,16 +1260,16 @@ void NotesWnd::ForceUpdateMkrRgnNameOrSub(int _type)
 	if (_type != SNM_NOTES_RGN_NAME && _type != SNM_NOTES_RGN_SUB)
 		mask |= SNM_MARKER_MASK;
 
-	int id; FindMarkerRegion(NULL, dPos, mask, &id);
+	g_nextSubId = -1; // sub may have been set from ReaScript
+	int id; g_mkrRgnIndex.Find(dPos, mask, &id);
 	if (id > 0)
 	{
-		for (int i = 0; i < g_pRegionSubs.Get()->GetSize(); i++)
-			if (g_pRegionSubs.Get()->Get(i)->GetId() == id) {
-				SetText(g_pRegionSubs.Get()->Get(i)->GetNotes());
-				if (g_locked)
-					RefreshGUI();
-				return;
-			}
+		if (SNM_RegionSubtitle* sub = FindRegionSub(id))
+		{
+			SetText(sub->GetNotes());
+			if (g_locked)
+				RefreshGUI();
+		}
 	}
 }
 
@@ -1263,6 +1425,9 @@ void NotesUpdateJob::Perform() {
 // ScheduledJob because of multi-notifs during project switches (vs CSurfSetTrackListChange)
 void NotesMarkerRegionListener::NotifyMarkerRegionUpdate(int _updateFlags)
 {
+	g_mkrRgnIndex.Invalidate();
+	g_nextSubId = -1;
+
 	if (g_notesType>=SNM_NOTES_MKR_SUB && g_notesType<=SNM_NOTES_MKRRGN_SUB)
 	{
 		ScheduledJob::Schedule(new NotesUpdateJob(SNM_SCHEDJOB_ASYNC_DELAY_OPT));
@@ -1279,77 +1444,186 @@ void NotesMarkerRegionListener::NotifyMarkerRegionUpdate(int _updateFlags)
 
 ///////////////////////////////////////////////////////////////////////////////
 
-// import/export subtitle files, only SubRip (.srt) files atm
+// import/export subtitle files, SubRip (.srt) and WebVTT (.vtt)
 // see http://en.wikipedia.org/wiki/SubRip#Specifications
+// and https://www.w3.org/TR/webvtt1/
+// files are read/written cue by cue, a cue being a block of lines separated by an empty line
+// (WebVTT header, NOTE or STYLE blocks have no timings, they are skipped)
+
+struct SNM_SubtitleCue {
+	int num; // wanted region number, -1 if none
+	double start, end;
+	WDL_FastString text;
+};
 
-bool ImportSubRipFile(const char* _fn)
+static bool CompareSubtitleCues(const SNM_SubtitleCue* _a, const SNM_SubtitleCue* _b) {
+	return _a->start < _b->start;
+}
+
+// reads a whole line whatever its length, without trailing CR/LF
+static bool ReadSubtitleLine(FILE* _f, WDL_FastString* _line)
 {
-	bool ok = false;
-	double firstPos = -1.0;
+	_line->Set("");
+	char buf[1024];
+	bool read = false;
+	while (fgets(buf, sizeof(buf), _f))
+	{
+		read = true;
+		_line->Append(buf);
+		if (strchr(buf, '\n'))
+			break;
+	}
+	int len = _line->GetLength();
+	while (len && (_line->Get()[len-1] == '\n' || _line->Get()[len-1] == '\r'))
+		len--;
+	_line->SetLen(len);
+	return read;
+}
 
-	// no need to check extension here, it's done for us
-	if (FILE* f = fopenUTF8(_fn, "rt"))
+// parses "[hh:]mm:ss,mmm" (SubRip) or "[hh:]mm:ss.mmm" (WebVTT)
+static bool ParseSubtitleTime(const char* _p, double* _t)
+{
+	int v[3], n=0;
+	while (*_p == ' ' || *_p == '\t') _p++;
+	while (n < 3 && isdigit(*_p))
+	{
+		v[n++] = atoi(_p);
+		while (isdigit(*_p)) _p++;
+		if (*_p != ':') break;
+		_p++;
+	}
+	if (n < 2 || (*_p != ',' && *_p != '.') || !isdigit(_p[1]))
+		return false;
+
+	double frac = 0.0, scale = 0.1;
+	for (_p++; isdigit(*_p); _p++, scale /= 10.0)
+		frac += (*_p - '0') * scale;
+	*_t = (n == 3 ? v[0]*3600 + v[1]*60 + v[2] : v[0]*60 + v[1]) + frac;
+	return true;
+}
+
+static bool ReadSubtitleFile(const char* _fn, WDL_PtrList<SNM_SubtitleCue>* _cuesOut)
+{
+	FILE* f = fopenUTF8(_fn, "rt");
+	if (!f)
+		return false;
+
+	WDL_FastString line, cueId;
+	SNM_SubtitleCue* cue = NULL;
+	bool firstLine = true;
+	for (;;)
 	{
-		char buf[1024];
-		while(fgets(buf, sizeof(buf), f) && *buf)
+		bool eof = !ReadSubtitleLine(f, &line);
+		if (firstLine && !strncmp(line.Get(), "\xEF\xBB\xBF", 3)) // UTF-8 BOM
+			line.DeleteSub(0, 3);
+		firstLine = false;
+
+		// end of block
+		if (eof || !line.GetLength())
+		{
+			if (cue)
+				_cuesOut->Add(cue);
+			cue = NULL;
+			cueId.Set("");
+			if (eof)
+				break;
+		}
+		else if (cue)
+		{
+			cue->text.Append(line.Get());
+			cue->text.Append("\n");
+		}
+		else if (const char* arrow = strstr(line.Get(), "-->"))
 		{
-			if (int num = atoi(buf))
+			double start, end;
+			if (ParseSubtitleTime(line.Get(), &start) && ParseSubtitleTime(arrow+3, &end))
 			{
-				if (fgets(buf, sizeof(buf), f) && *buf)
-				{
-					int p1[4], p2[4];
-					if (sscanf(buf, "%d:%d:%d,%d --> %d:%d:%d,%d", 
-						&p1[0], &p1[1], &p1[2], &p1[3], 
-						&p2[0], &p2[1], &p2[2], &p2[3]) != 8)
-					{
-						break;
-					}
+				cue = new SNM_SubtitleCue;
+				cue->num = atoi(cueId.Get()) > 0 ? atoi(cueId.Get()) : -1;
+				cue->start = start;
+				cue->end = end;
+			}
+		}
+		else
+			cueId.Set(line.Get()); // cue number (SubRip) or optional identifier (WebVTT)
+	}
+	fclose(f);
+	return true;
+}
 
-					WDL_FastString notes;
-					while (fgets(buf, sizeof(buf), f) && *buf) {
-						if (*buf == '\r' || *buf == '\n') break;
-						notes.Append(buf);
-					}
-          
-					WDL_String name(notes.Get());
-					char *p=name.Get();
-					while (*p) {
-						if (*p == '\r' || *p == '\n') *p=' ';
-						p++;
-					}
-					name.Ellipsize(0, 64); // 64 = native max mkr/rgn name length
+static void WriteSubtitleTime(FILE* _f, double _pos, char _msSep)
+{
+	int ms = int(_pos*1000.0 + 0.5); // rounded once so that seconds/ms are consistent
+	fprintf(_f, "%02d:%02d:%02d%c%03d", ms/3600000, (ms/60000)%60, (ms/1000)%60, _msSep, ms%1000);
+}
 
-					num = AddProjectMarker(NULL, true,
-						p1[0]*3600 + p1[1]*60 + p1[2] + double(p1[3])/1000, 
-						p2[0]*3600 + p2[1]*60 + p2[2] + double(p2[3])/1000, 
-						name.Get(), num);
+static void WriteSubtitleCue(FILE* _f, bool _vtt, int _idx, double _start, double _end, const char* _text)
+{
+	fprintf(_f, "%d\n", _idx); // subs have their own indexes
+	WriteSubtitleTime(_f, _start, _vtt ? '.' : ',');
+	fputs(" --> ", _f);
+	WriteSubtitleTime(_f, _end, _vtt ? '.' : ',');
+	fputs("\n", _f);
+
+	fputs(_text, _f);
+	size_t len = strlen(_text);
+	if (len && _text[len-1] != '\n')
+		fputs("\n", _f);
+	fputs("\n", _f);
+}
 
-					if (num >= 0)
-					{
-						ok = true; // region added (at least)
 
-						if (firstPos < 0.0)
-							firstPos = p1[0]*3600 + p1[1]*60 + p1[2] + double(p1[3])/1000;
+static bool ImportSubtitleFile(const char* _fn)
+{
+	// no need to check extension here, it's done for us
+	WDL_PtrList_DeleteOnDestroy<SNM_SubtitleCue> cues;
+	if (!ReadSubtitleFile(_fn, &cues) || !cues.GetSize())
+		return false;
 
-						int id = MakeMarkerRegionId(num, true);
-						if (id > 0) // add the sub, no duplicate mgmt..
-							g_pRegionSubs.Get()->Add(new SNM_RegionSubtitle(nullptr, id, notes.Get()));
-					}
-				}
-				else
-					break;
-			}
+	// add regions in time order (appended to REAPER's sorted marker list) and notify
+	// marker/region listeners only once, when done
+	std::stable_sort(cues.GetList(), cues.GetList()+cues.GetSize(), CompareSubtitleCues);
+	SuspendMarkerRegionUpdates(true);
+	PreventUIRefresh(1);
+
+	WDL_PtrList_DOD<SNM_RegionSubtitle>* subs = g_pRegionSubs.Get();
+	double firstPos = -1.0;
+	for (int i=0; i<cues.GetSize(); i++)
+	{
+		SNM_SubtitleCue* cue = cues.Get(i);
+
+		WDL_String name(cue->text.Get());
+		char *p=name.Get();
+		while (*p) {
+			if (*p == '\r' || *p == '\n') *p=' ';
+			p++;
+		}
+		name.Ellipsize(0, 64); // 64 = native max mkr/rgn name length
+
+		int num = AddProjectMarker(NULL, true, cue->start, cue->end, name.Get(), cue->num);
+		if (num >= 0)
+		{
+			if (firstPos < 0.0)
+				firstPos = cue->start;
+
+			int id = MakeMarkerRegionId(num, true);
+			if (id > 0) // add the sub, no duplicate mgmt..
+				subs->Add(new SNM_RegionSubtitle(nullptr, id, cue->text.Get()));
 		}
-		fclose(f);
 	}
-	
-	if (ok)
+	RegionSubsChanged();
+
+	PreventUIRefresh(-1);
+	SuspendMarkerRegionUpdates(false);
+
+	if (firstPos >= 0.0) // region added (at least)
 	{
 		UpdateTimeline(); // redraw the ruler (andd arrange view)
 		if (firstPos > 0.0)
 			SetEditCurPos2(NULL, firstPos, true, false);
+		return true;
 	}
-	return ok;
+	return false;
 }
 
 void ImportSubTitleFile(COMMAND_T* _ct)
@@ -1357,7 +1631,7 @@ void ImportSubTitleFile(COMMAND_T* _ct)
 	if (char* fn = BrowseForFiles(__LOCALIZE("S&M - Import subtitle file","sws_DLG_152"), g_lastImportSubFn, NULL, false, SNM_SUB_EXT_LIST))
 	{
 		lstrcpyn(g_lastImportSubFn, fn, sizeof(g_lastImportSubFn));
-		if (ImportSubRipFile(fn))
+		if (ImportSubtitleFile(fn))
 			//JFB hard-coded undo label: _ct might be NULL (when called from a button)
 			//    + avoid trailing "..." in undo point name (when called from an action)
 			Undo_OnStateChangeEx2(NULL, __LOCALIZE("Import subtitle file","sws_DLG_152"), UNDO_STATE_ALL, -1);
@@ -1367,55 +1641,33 @@ void ImportSubTitleFile(COMMAND_T* _ct)
 	}
 }
 
-bool ExportSubRipFile(const char* _fn)
+static bool ExportSubtitleFile(const char* _fn)
 {
-	if (FILE* f = fopenUTF8(_fn, "wt"))
-	{
-		WDL_FastString subs;
-		int x=0, subIdx=1, num; bool isRgn; double p1, p2;
-		while ((x = EnumProjectMarkers2(NULL, x, &isRgn, &p1, &p2, NULL, &num)))
-		{
-			// special case for markers: end position = next start position
-			if (!isRgn)
-			{
-				int x2=x;
-				if (!EnumProjectMarkers2(NULL, x2, NULL, &p2 /* <- the trick */, NULL, NULL, NULL))
-					p2 = p1 + 5.0; // best effort..
-			}
+	FILE* f = fopenUTF8(_fn, "wt");
+	if (!f)
+		return false;
 
-			int id = MakeMarkerRegionId(num, isRgn);
-			if (id > 0)
-			{
-				for (int i=0; i < g_pRegionSubs.Get()->GetSize(); i++)
-				{
-					SNM_RegionSubtitle* rn = g_pRegionSubs.Get()->Get(i);
-					if (rn->GetId() == id)
-					{
-						subs.AppendFormatted(64, "%d\n", subIdx++); // subs have their own indexes
-						
-						int h, m, s, ms;
-						TranslatePos(p1, &h, &m, &s, &ms);
-						subs.AppendFormatted(64,"%02d:%02d:%02d,%03d --> ",h,m,s,ms);
-						TranslatePos(p2, &h, &m, &s, &ms);
-						subs.AppendFormatted(64,"%02d:%02d:%02d,%03d\n",h,m,s,ms);
-
-						subs.Append(rn->GetNotes());
-						if (rn->GetNotesLength() && rn->GetNotes()[rn->GetNotesLength()-1] != '\n')
-							subs.Append("\n");
-						subs.Append("\n");
-					}
-				}
-			}
-		}
+	const bool vtt = !_stricmp(GetFileExtension(_fn), "vtt");
+	if (vtt)
+		fputs("WEBVTT\n\n", f);
 
-		if (subs.GetLength())
+	int x=0, subIdx=1, num; bool isRgn; double p1, p2;
+	while ((x = EnumProjectMarkers2(NULL, x, &isRgn, &p1, &p2, NULL, &num)))
+	{
+		// special case for markers: end position = next start position
+		if (!isRgn)
 		{
-			fputs(subs.Get(), f);
-			fclose(f);
-			return true;
+			int x2=x;
+			if (!EnumProjectMarkers2(NULL, x2, NULL, &p2 /* <- the trick */, NULL, NULL, NULL))
+				p2 = p1 + 5.0; // best effort..
 		}
+
+		int id = MakeMarkerRegionId(num, isRgn);
+		if (SNM_RegionSubtitle* sub = id > 0 ? FindRegionSub(id) : NULL)
+			WriteSubtitleCue(f, vtt, subIdx++, p1, p2, sub->GetNotes());
 	}
-	return false;
+	fclose(f);
+	return subIdx > 1;
 }
 
 void ExportSubTitleFile(COMMAND_T* _ct)
@@ -1423,7 +1675,7 @@ void ExportSubTitleFile(COMMAND_T* _ct)
 	char fn[SNM_MAX_PATH] = "";
 	if (BrowseForSaveFile(__LOCALIZE("S&M - Export subtitle file","sws_DLG_152"), g_lastExportSubFn, strrchr(g_lastExportSubFn, '.') ? g_lastExportSubFn : NULL, SNM_SUB_EXT_LIST, fn, sizeof(fn))) {
 		lstrcpyn(g_lastExportSubFn, fn, sizeof(g_lastExportSubFn));
-		ExportSubRipFile(fn);
+		ExportSubtitleFile(fn);
 	}
 }
 
@@ -1497,7 +1749,10 @@ static bool ProcessExtensionLine(const char *line, ProjectStateContext *ctx, boo
 
 			char buf[MAX_HELP_LENGTH] = "";
 			if (GetStringFromNotesChunk(&notes, buf, MAX_HELP_LENGTH))
+			{
 				g_pRegionSubs.Get()->Add(new SNM_RegionSubtitle(p, lp.gettoken_int(1), buf));
+				RegionSubsChanged();
+			}
 			return true;
 		}
 	}
@@ -1557,6 +1812,7 @@ static void SaveExtensionConfig(ProjectStateContext *ctx, bool isUndo, struct pr
 			else
 			{
 				g_pRegionSubs.Get()->Delete(i--, true);
+				RegionSubsChanged();
 			}
 		}
 	}
@@ -1572,6 +1828,7 @@ static void BeginLoadProjectState(bool isUndo, struct project_config_extension_t
 
 	g_pRegionSubs.Cleanup();
 	g_pRegionSubs.Get()->Empty(true);
+	RegionSubsChanged();
 
 	// g_globalNotes is loaded in NotesInit()
 }
@@ -1752,16 +2009,8 @@ const char* NFDoGetSWSMarkerRegionSub(int mkrRgnIdxNumberIn)
 	int mkrRgnId = GetMarkerRegionIdFromIndex(NULL, mkrRgnIdxNumberIn); // takes zero-based idx
 	if (mkrRgnId == -1) return "";
 
-	for (int i = 0; i < g_pRegionSubs.Get()->GetSize(); i++)
-	{
-		// mkrRgn sub exists
-		if (mkrRgnId == g_pRegionSubs.Get()->Get(i)->GetId())
-		{
-			return g_pRegionSubs.Get()->Get(i)->GetNotes();
-		}
-	}
-
-	return "";
+	SNM_RegionSubtitle* sub = FindRegionSub(mkrRgnId);
+	return sub ? sub->GetNotes() : "";
 }
 
 bool NFDoSetSWSMarkerRegionSub(const char* mkrRgnSubIn, int mkrRgnIdxNumberIn)
@@ -1775,19 +2024,19 @@ bool NFDoSetSWSMarkerRegionSub(const char* mkrRgnSubIn, int mkrRgnIdxNumberIn)
 			mkrRgnExists = true;
 		
 			int mkrRgnId = GetMarkerRegionIdFromIndex(NULL, idx - 1); // takes zero-based idx
-			for (int i = 0; i < g_pRegionSubs.Get()->GetSize(); i++)
+			if (SNM_RegionSubtitle* sub = FindRegionSub(mkrRgnId)) // mkrRgn sub exists, update it
 			{
-				if (mkrRgnId == g_pRegionSubs.Get()->Get(i)->GetId()) // mkrRgn sub exists, update it
-				{
-					g_pRegionSubs.Get()->Get(i)->SetNotes(mkrRgnSubIn);
-					return true;
-				}
+				sub->SetNotes(mkrRgnSubIn);
+				if (mkrRgnId == g_nextSubId)
+					g_nextSubId = -1;
+				return true;
 			}
 
 			// mkrRgn sub doesn't exist but marker/region is present in project, add new mkrRgn sub
 			if (mkrRgnExists)
 			{
 				g_pRegionSubs.Get()->Add(new SNM_RegionSubtitle(nullptr, mkrRgnId, mkrRgnSubIn));
+				RegionSubsChanged();
 				return true;
 			}
 			else // mkrRgn isn't present in project
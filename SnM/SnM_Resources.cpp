@@ -129,6 +129,9 @@ enum {
   COPY_BOOKMARK_MSG,
   DEL_BOOKMARK_MSG,
   REN_BOOKMARK_MSG,
+  MED_PRELOAD_MSG,
+  MED_PRELOAD_CHOKE_MSG,
+  MED_UNLOAD_MSG,
   NEW_BOOKMARK_START_MSG,                            // 512 bookmarks max -->
   NEW_BOOKMARK_END_MSG = NEW_BOOKMARK_START_MSG+512, // <--
 
@@ -172,6 +175,9 @@ enum {
 #define MED_ADD_TR_STR				__LOCALIZE("Add to current track","sws_DLG_150")
 #define MED_ADD_NEWTR_STR			__LOCALIZE("Add to new tracks","sws_DLG_150")
 #define MED_ADD_ITEM_STR			__LOCALIZE("Add to selected items","sws_DLG_150")
+#define MED_PRELOAD_STR				__LOCALIZE("Preload in memory (instant play)","sws_DLG_150")
+#define MED_PRELOAD_CHOKE_STR		__LOCALIZE("Preload in memory as a choke group","sws_DLG_150")
+#define MED_UNLOAD_STR				__LOCALIZE("Unload all preloaded media files","sws_DLG_150")
 #define IMG_SHOW_STR				__LOCALIZE("Show image","sws_DLG_150")
 #define IMG_TRICON_STR				__LOCALIZE("Set as icon for selected tracks","sws_DLG_150")
 #define THM_LOAD_STR				__LOCALIZE("Load theme","sws_DLG_150")
@@ -1444,6 +1450,34 @@ void ResourcesWnd::OnCommand(WPARAM wParam, LPARAM lParam)
 
 		// new bookmark cmds are in an interval of cmds: see "default" case below..
 
+		case MED_PRELOAD_MSG:
+		case MED_PRELOAD_CHOKE_MSG:
+		{
+			// selected slots of a same choke group stop each other (per track)
+			int choke = LOWORD(wParam)==MED_PRELOAD_CHOKE_MSG ? SNM_NewTrackPreviewChokeGroup() : 0;
+			int failed = 0;
+			char fullPath[SNM_MAX_PATH] = "";
+			while (item)
+			{
+				if (fl->GetFullPath(fl->Find(item), fullPath, sizeof(fullPath)) && *fullPath &&
+					!SNM_PreloadTrackPreview(fullPath, choke))
+				{
+					failed++;
+				}
+				item = (ResourceItem*)GetListView()->EnumSelected(&x);
+			}
+			if (failed)
+			{
+				char msg[256] = "";
+				snprintf(msg, sizeof(msg), __LOCALIZE_VERFMT("%d media file(s) could not be preloaded!\nMIDI files are not supported, or the cache is full (see MediaFilePreloadCacheSize in S&M.ini).","sws_DLG_150"), failed);
+				MessageBox(m_hwnd, msg, __LOCALIZE("S&M - Warning","sws_DLG_150"), MB_OK);
+			}
+			break;
+		}
+		case MED_UNLOAD_MSG:
+			SNM_UnloadTrackPreviews();
+			break;
+
 		case LOAD_TIED_PRJ_MSG:
 		case LOAD_TIED_PRJ_TAB_MSG:
 			if (g_tiedProjects.Get(g_resType)->GetLength())
@@ -1830,6 +1864,9 @@ HMENU ResourcesWnd::OnContextMenu(int _x, int _y, bool* _wantDefaultItems)
 				msg = MED_START_MSG;
 				AddToMenu(hMenu, MED_PLAY_STR, msg++, -1, false, enabled);
 				AddToMenu(hMenu, MED_LOOP_STR, msg++, -1, false, enabled);
+				AddToMenu(hMenu, MED_PRELOAD_STR, MED_PRELOAD_MSG, -1, false, enabled);
+				AddToMenu(hMenu, MED_PRELOAD_CHOKE_STR, MED_PRELOAD_CHOKE_MSG, -1, false, enabled);
+				AddToMenu(hMenu, MED_UNLOAD_STR, MED_UNLOAD_MSG, -1, false, SNM_CountPreloadedTrackPreviews() ? MF_ENABLED : MF_GRAYED);
 
 				AddToMenu(hMenu, SWS_SEPARATOR, 0);
 
@@ -2801,9 +2838,9 @@ void ReadSlotIniFile(const char* _key, int _slot, char* _path, int _pathSize, ch
 {
 	char buf[32];
 	if (snprintfStrict(buf, sizeof(buf), "Slot%d", _slot+1) > 0)
-		GetPrivateProfileString(_key, buf, "", _path, _pathSize, g_SNM_IniFn.Get());
+		SNM_GetIniString(_key, buf, "", _path, _pathSize, g_SNM_IniFn.Get());
 	if (snprintfStrict(buf, sizeof(buf), "Desc%d", _slot+1) > 0)
-		GetPrivateProfileString(_key, buf, "", _desc, _descSize, g_SNM_IniFn.Get());
+		SNM_GetIniString(_key, buf, "", _desc, _descSize, g_SNM_IniFn.Get());
 }
 
 // adds bookmarks and custom slot types from the S&M.ini file
@@ -2812,12 +2849,12 @@ void AddCustomTypesFromIniFile()
 	int i=0;
 	char buf[SNM_MAX_PATH]=""; // can be used with paths..
 	WDL_String iniKeyStr("CustomSlotType1");
-	GetPrivateProfileString(RES_INI_SEC, iniKeyStr.Get(), "", buf, sizeof(buf), g_SNM_IniFn.Get());
+	SNM_GetIniString(RES_INI_SEC, iniKeyStr.Get(), "", buf, sizeof(buf), g_SNM_IniFn.Get());
 	while (*buf && i<SNM_MAX_SLOT_TYPES)
 	{
 		AddCustomBookmark(buf);
 		iniKeyStr.SetFormatted(32, "CustomSlotType%d", (++i)+1);
-		GetPrivateProfileString(RES_INI_SEC, iniKeyStr.Get(), "", buf, sizeof(buf), g_SNM_IniFn.Get());
+		SNM_GetIniString(RES_INI_SEC, iniKeyStr.Get(), "", buf, sizeof(buf), g_SNM_IniFn.Get());
 	}
 }
 
@@ -3185,14 +3222,14 @@ int ResourcesInit()
 	AddCustomTypesFromIniFile();
 
 	// load general prefs
-	g_resType = BOUNDED((int)GetPrivateProfileInt( // bounded for safety (some custom slot types may have been removed..)
+	g_resType = BOUNDED((int)SNM_GetIniInt( // bounded for safety (some custom slot types may have been removed..)
 		RES_INI_SEC, "Type", SNM_SLOT_FXC, g_SNM_IniFn.Get()), SNM_SLOT_FXC, g_SNM_ResSlots.GetSize()-1);
 
-	g_filterPref = GetPrivateProfileInt(RES_INI_SEC, "Filter", 1, g_SNM_IniFn.Get());
-	g_asFXChainPref = GetPrivateProfileInt(RES_INI_SEC, "AutoSaveFXChain", FXC_AUTOSAVE_PREF_TRACK, g_SNM_IniFn.Get());
-	g_asFXChainNamePref = GetPrivateProfileInt(RES_INI_SEC, "AutoSaveFXChainName", 0, g_SNM_IniFn.Get());
-	g_asTrTmpltPref = GetPrivateProfileInt(RES_INI_SEC, "AutoSaveTrTemplate", 3, g_SNM_IniFn.Get());
-	g_addMedPref = GetPrivateProfileInt(RES_INI_SEC, "AddMediaFileOptions", 0, g_SNM_IniFn.Get());
+	g_filterPref = SNM_GetIniInt(RES_INI_SEC, "Filter", 1, g_SNM_IniFn.Get());
+	g_asFXChainPref = SNM_GetIniInt(RES_INI_SEC, "AutoSaveFXChain", FXC_AUTOSAVE_PREF_TRACK, g_SNM_IniFn.Get());
+	g_asFXChainNamePref = SNM_GetIniInt(RES_INI_SEC, "AutoSaveFXChainName", 0, g_SNM_IniFn.Get());
+	g_asTrTmpltPref = SNM_GetIniInt(RES_INI_SEC, "AutoSaveTrTemplate", 3, g_SNM_IniFn.Get());
+	g_addMedPref = SNM_GetIniInt(RES_INI_SEC, "AddMediaFileOptions", 0, g_SNM_IniFn.Get());
 
 	// auto-save, auto-fill directories, etc..
 	g_autoSaveDirs.Empty(true);
@@ -3217,27 +3254,27 @@ int ResourcesInit()
 
 		savePath = new WDL_FastString(defaultPath);
 		if (snprintfStrict(iniKey, sizeof(iniKey), "AutoSaveDir%s", iniSec) > 0) {
-			GetPrivateProfileString(RES_INI_SEC, iniKey, defaultPath, path, sizeof(path), g_SNM_IniFn.Get());
+			SNM_GetIniString(RES_INI_SEC, iniKey, defaultPath, path, sizeof(path), g_SNM_IniFn.Get());
 			savePath->Set(path);
 		}
 		g_autoSaveDirs.Add(savePath);
 
 		fillPath = new WDL_FastString(defaultPath);
 		if (snprintfStrict(iniKey, sizeof(iniKey), "AutoFillDir%s", iniSec) > 0) {
-			GetPrivateProfileString(RES_INI_SEC, iniKey, defaultPath, path, sizeof(path), g_SNM_IniFn.Get());
+			SNM_GetIniString(RES_INI_SEC, iniKey, defaultPath, path, sizeof(path), g_SNM_IniFn.Get());
 			fillPath->Set(path);
 		}
 		g_autoFillDirs.Add(fillPath);
 
 		g_syncAutoDirPrefs[i] = true;
 		if (snprintfStrict(iniKey, sizeof(iniKey), "SyncAutoDirs%s", iniSec) > 0)
-			g_syncAutoDirPrefs[i] = (GetPrivateProfileInt(RES_INI_SEC, iniKey, 1, g_SNM_IniFn.Get()) == 1);
+			g_syncAutoDirPrefs[i] = (SNM_GetIniInt(RES_INI_SEC, iniKey, 1, g_SNM_IniFn.Get()) == 1);
 		if (g_syncAutoDirPrefs[i]) // consistency check (e.g. after sws upgrade)
 			g_syncAutoDirPrefs[i] = (strcmp(savePath->Get(), fillPath->Get()) == 0);
 
 		g_dblClickPrefs[i] = 0;
 		if (g_SNM_ResSlots.Get(i)->IsDblClick() && snprintfStrict(iniKey, sizeof(iniKey), "DblClick%s", iniSec) > 0)
-			g_dblClickPrefs[i] = LOWORD(GetPrivateProfileInt(RES_INI_SEC, iniKey, 0, g_SNM_IniFn.Get())); // LOWORD() for histrical reason..
+			g_dblClickPrefs[i] = LOWORD(SNM_GetIniInt(RES_INI_SEC, iniKey, 0, g_SNM_IniFn.Get())); // LOWORD() for histrical reason..
 
 		tiedPrj = new WDL_FastString;
 		g_tiedProjects.Add(tiedPrj);
@@ -3248,14 +3285,14 @@ int ResourcesInit()
 			// load tied actions
 			g_tiedSlotActions[i] = i;
 			if (snprintfStrict(iniKey, sizeof(iniKey), "TiedActions%s", iniSec) > 0)
-				g_tiedSlotActions[i] = GetPrivateProfileInt(RES_INI_SEC, iniKey, i, g_SNM_IniFn.Get());
+				g_tiedSlotActions[i] = SNM_GetIniInt(RES_INI_SEC, iniKey, i, g_SNM_IniFn.Get());
 		}
 		// bookmark, custom type?
 		else
 		{
 			// load tied project
 			if (snprintfStrict(iniKey, sizeof(iniKey), "TiedProject%s", iniSec) > 0) {
-				GetPrivateProfileString(RES_INI_SEC, iniKey, "", path, sizeof(path), g_SNM_IniFn.Get());
+				SNM_GetIniString(RES_INI_SEC, iniKey, "", path, sizeof(path), g_SNM_IniFn.Get());
 				tiedPrj->Set(path);
 			}
 		}
@@ -3269,8 +3306,7 @@ int ResourcesInit()
 		{
 			GetIniSectionName(i, iniSec, sizeof(iniSec));
 			
-			//JFB TODO? would be faster to read section in one go..
-			GetPrivateProfileString(iniSec, "Max_slot", "0", maxSlotCount, sizeof(maxSlotCount), g_SNM_IniFn.Get()); 
+			SNM_GetIniString(iniSec, "Max_slot", "0", maxSlotCount, sizeof(maxSlotCount), g_SNM_IniFn.Get()); 
 			list->EmptySafe(true);
 			int cnt = atoi(maxSlotCount);
 			for (int j=0; j<cnt; j++) {
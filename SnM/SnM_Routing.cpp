@@ -29,12 +29,148 @@
 
 #include "SnM.h"
 #include "SnM_Chunk.h"
+#include "SnM_Dlg.h"
 #include "SnM_Routing.h"
 #include "SnM_Track.h"
 #include "SnM_Util.h"
 
 #include <WDL/localize/localize.h>
 
+
+///////////////////////////////////////////////////////////////////////////////
+// SNM_RcvPlan, SNM_RoutingBatch
+///////////////////////////////////////////////////////////////////////////////
+
+void SNM_RcvPlan::StartDiff()
+{
+	m_added = m_updated = m_removed = 0;
+	sort(m_removeFrom.begin(), m_removeFrom.end());
+	m_bySrc.clear();
+	for (int i=0; i < (int)m_adds.size(); i++)
+		m_bySrc.push_back(make_pair(m_addFrom[i], i));
+	sort(m_bySrc.begin(), m_bySrc.end()); // keeps the clipboard order for a same source
+	m_consumed.assign(m_adds.size(), 0);
+}
+
+bool SNM_RcvPlan::IsRemoved(int _srcIdx) const {
+	return m_removeAll || binary_search(m_removeFrom.begin(), m_removeFrom.end(), _srcIdx);
+}
+
+// returns the first receive to add that is the same routing as an existing one, if any
+// (same source track, channels and MIDI flags), each receive to add can match once
+SNM_SndRcv* SNM_RcvPlan::Consume(int _srcIdx, int _srcChan, int _destChan, int _midi)
+{
+	vector<pair<int,int> >::const_iterator it = lower_bound(m_bySrc.begin(), m_bySrc.end(), make_pair(_srcIdx, -1));
+	for (; it != m_bySrc.end() && it->first == _srcIdx; ++it)
+	{
+		SNM_SndRcv* io = m_adds[it->second];
+		if (!m_consumed[it->second] && io->m_srcChan == _srcChan && io->m_destChan == _destChan && io->m_midi == _midi)
+		{
+			m_consumed[it->second] = 1;
+			return io;
+		}
+	}
+	return NULL;
+}
+
+SNM_SndRcv* SNM_RcvPlan::GetUnconsumed(int _i, int* _srcIdx) const
+{
+	if (_i < 0 || _i >= (int)m_adds.size() || m_consumed[_i])
+		return NULL;
+	if (_srcIdx) *_srcIdx = m_addFrom[_i];
+	return m_adds[_i];
+}
+
+// Routing edits are collected per receiving track (sends are receives of their 
+// destination track) and applied with one SNM_SendPatcher::PatchReceives() per track
+class SNM_RoutingBatch
+{
+public:
+	bool AddReceive(MediaTrack* _src, MediaTrack* _dest, SNM_SndRcv* _io)
+	{
+		const int srcIdx = GetSrcIdx(_src);
+		if (!_dest || srcIdx < 0)
+			return false;
+		GetOrAddPlan(_dest)->AddReceive(srcIdx, _io);
+		return true;
+	}
+	bool RemoveReceivesFrom(MediaTrack* _src, MediaTrack* _dest)
+	{
+		const int srcIdx = GetSrcIdx(_src);
+		if (!_dest || srcIdx < 0)
+			return false;
+		GetOrAddPlan(_dest)->RemoveReceivesFrom(srcIdx);
+		return true;
+	}
+	void RemoveReceives(MediaTrack* _dest) {
+		if (_dest) GetOrAddPlan(_dest)->RemoveReceives();
+	}
+	bool IsEmpty() const {
+		for (int i=0; i < m_plans.GetSize(); i++)
+			if (!m_plans.Get(i)->IsEmpty()) return false;
+		return true;
+	}
+
+	// patchers are added to _ps (a same track can be multi-patched => patch everything in one go)
+	// _dryRun: nothing is patched, planned changes are reported in _report (if not NULL)
+	// returns the number of added + updated + removed receives
+	int Apply(WDL_PtrList<SNM_ChunkParserPatcher>* _ps, bool _dryRun, WDL_FastString* _report)
+	{
+		int added=0, updated=0, removed=0;
+		for (int i=0; i < m_plans.GetSize(); i++)
+		{
+			SNM_RcvPlan* plan = m_plans.Get(i);
+			if (plan->IsEmpty())
+				continue;
+
+			SNM_SendPatcher* p = (SNM_SendPatcher*)SNM_FindCPPbyObject(_ps, plan->m_tr);
+			if (!p) {
+				p = new SNM_SendPatcher(plan->m_tr); 
+				_ps->Add(p);
+			}
+			if (p->PatchReceives(plan, _dryRun) && _report)
+			{
+				const char* name = (const char*)GetSetMediaTrackInfo(plan->m_tr, "P_NAME", NULL);
+				_report->AppendFormatted(SNM_MAX_TRACK_NAME_LEN+128, __LOCALIZE_VERFMT("Track %d \"%s\": %d added, %d updated, %d removed\n","sws_mbox"),
+					CSurf_TrackToID(plan->m_tr, false), name ? name : "", plan->m_added, plan->m_updated, plan->m_removed);
+			}
+			added += plan->m_added;
+			updated += plan->m_updated;
+			removed += plan->m_removed;
+		}
+		if (_report && (added || updated || removed))
+			_report->AppendFormatted(128, __LOCALIZE_VERFMT("Total: %d added, %d updated, %d removed\n","sws_mbox"), added, updated, removed);
+		return added + updated + removed;
+	}
+
+private:
+	// 0-based index of the source track, as in AUXRECV lines (<0 for the master track or an invalid track)
+	static int GetSrcIdx(MediaTrack* _tr) {
+		return _tr ? (int)GetMediaTrackInfo_Value(_tr, "IP_TRACKNUMBER") - 1 : -1;
+	}
+
+	SNM_RcvPlan* GetOrAddPlan(MediaTrack* _tr)
+	{
+		map<MediaTrack*,SNM_RcvPlan*>::const_iterator it = m_planByTrack.find(_tr);
+		if (it != m_planByTrack.end())
+			return it->second;
+		SNM_RcvPlan* plan = m_plans.Add(new SNM_RcvPlan(_tr));
+		m_planByTrack[_tr] = plan;
+		return plan;
+	}
+
+	WDL_PtrList_DeleteOnDestroy<SNM_RcvPlan> m_plans;
+	map<MediaTrack*,SNM_RcvPlan*> m_planByTrack;
+};
+
+// commits (if needed) & deletes patchers, with a single UI refresh
+static void CommitPatchers(WDL_PtrList<SNM_ChunkParserPatcher>* _ps)
+{
+	PreventUIRefresh(1);
+	_ps->Empty(true);
+	PreventUIRefresh(-1);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Cut/copy/paste routings + track with routings
 // Note: these functions/actions ignore routing envelopes
@@ -123,59 +259,59 @@ void CopySendsReceives(bool _noIntra, WDL_PtrList<MediaTrack>* _trs,
 	// return addedRcvs || addedRcvs;
 }
 
-bool PasteSendsReceives(bool _send, MediaTrack* _tr, SndRcvClipboard* _ios,
-		int _trIdx, WDL_PtrList<SNM_ChunkParserPatcher>* _ps)
+// fills _batch with the routings of _ios' _trIdx-th track to paste to _tr
+static void PlanPasteSendsReceives(bool _send, MediaTrack* _tr, SndRcvClipboard* _ios,
+		int _trIdx, SNM_RoutingBatch* _batch)
 {
-	bool updated = false;
-	if (_tr && _ps && _ios && _ios->Get(_trIdx))
+	if (_tr && _ios && _ios->Get(_trIdx))
 	{
 		for (int j=0; j < _ios->Get(_trIdx)->GetSize(); j++)
 		{
 			SNM_SndRcv* io = _ios->Get(_trIdx)->Get(j);
 			if (MediaTrack* tr = GuidToTrack(_send ? &io->m_dest : &io->m_src))
-			{
-				SNM_SendPatcher* p = (SNM_SendPatcher*)SNM_FindCPPbyObject(_ps, _send ? tr : _tr);
-				if (!p) {
-					p = new SNM_SendPatcher(_send ? tr : _tr); 
-					_ps->Add(p);
-				}
-				updated |= p->AddReceive(_send ? _tr : tr, io);
-			}
+				_batch->AddReceive(_send ? _tr : tr, _send ? tr : _tr, io);
 		}
 	}
-	return updated;
 }
 
+// routings are diffed against the existing ones: pasting the same routing twice
+// does not duplicate it, pasting it with other volume, pan, etc.. updates it
+// _dryRunReport: if not NULL, nothing is pasted, planned changes are reported instead
 bool PasteSendsReceives(WDL_PtrList<MediaTrack>* _trs,
 		SndRcvClipboard* _snds, SndRcvClipboard* _rcvs,
-		WDL_PtrList<SNM_ChunkParserPatcher>* _ps)
+		WDL_PtrList<SNM_ChunkParserPatcher>* _ps, WDL_FastString* _dryRunReport)
 {
-	bool updated = false;
-
-	// a same track can be multi-patched
-	// => patch everything in one go thanks to this list
-	WDL_PtrList<SNM_ChunkParserPatcher>* ps = (_ps ? _ps : new WDL_PtrList<SNM_ChunkParserPatcher>);
-
+	SNM_RoutingBatch batch;
 	for (int i=0; i<_trs->GetSize(); i++)
 	{
 		// when the nb of copied tracks' routings == nb of dest tracks, paste them respectively
 		if ((!_snds || _trs->GetSize()==_snds->GetSize()) &&
 		    (!_rcvs || _trs->GetSize()==_rcvs->GetSize()))
 		{
-			updated |= PasteSendsReceives(true, _trs->Get(i), _snds, i, ps);
-			updated |= PasteSendsReceives(false, _trs->Get(i), _rcvs, i, ps);
+			PlanPasteSendsReceives(true, _trs->Get(i), _snds, i, &batch);
+			PlanPasteSendsReceives(false, _trs->Get(i), _rcvs, i, &batch);
 		}
 		// otherwise: merge all copied routings into dest tracks
 		//JFB TODO? "intra pasted routings" to manage?
 		else
 		{
 			for (int j=0; _snds && j<_snds->GetSize(); j++)
-				updated |= PasteSendsReceives(true, _trs->Get(i), _snds, j, ps);
+				PlanPasteSendsReceives(true, _trs->Get(i), _snds, j, &batch);
 			for (int j=0; _rcvs && j<_rcvs->GetSize(); j++)
-				updated |= PasteSendsReceives(false, _trs->Get(i), _rcvs, j, ps);
+				PlanPasteSendsReceives(false, _trs->Get(i), _rcvs, j, &batch);
 		}
 	}
-	if (!_ps) ps->Empty(true); // + auto commit if needed
+
+	// empty clipboard, or copied tracks/routings that no longer exist
+	if (_dryRunReport && batch.IsEmpty())
+	{
+		_dryRunReport->Set(__LOCALIZE("Nothing to paste: the routing clipboard is empty or its tracks no longer exist.","sws_mbox"));
+		return false;
+	}
+
+	WDL_PtrList<SNM_ChunkParserPatcher> ps;
+	const bool updated = (batch.Apply(_ps ? _ps : &ps, _dryRunReport != NULL, _dryRunReport) > 0);
+	CommitPatchers(&ps); // no-op if _ps, auto-commit otherwise
 	return updated;
 }
 
@@ -234,11 +370,8 @@ void CutRoutings(COMMAND_T* _ct)
 	SNM_GetSelectedTracks(NULL, &trs, false);
 	if (trs.GetSize())
 	{
-		WDL_PtrList<SNM_ChunkParserPatcher> ps;
 		CopySendsReceives(false, &trs, &g_sndClipboard, &g_rcvClipboard);
-		updated |= RemoveSends(&trs, &ps);
-		updated |= RemoveReceives(&trs, &ps);
-		ps.Empty(true); // auto-commit, if needed
+		updated = RemoveRoutings(&trs, NULL);
 	}
 	if (updated)
 		Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_ALL, -1);
@@ -252,6 +385,20 @@ void PasteRoutings(COMMAND_T* _ct)
 		Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_ALL, -1);
 }
 
+// reports what "Paste routings to selected tracks" would do, without doing it
+void PasteRoutingsDryRun(COMMAND_T* _ct)
+{
+	WDL_PtrList<MediaTrack> trs;
+	SNM_GetSelectedTracks(NULL, &trs, false);
+	if (trs.GetSize())
+	{
+		WDL_FastString report;
+		if (!PasteSendsReceives(&trs, &g_sndClipboard, &g_rcvClipboard, NULL, &report) && !report.GetLength())
+			report.Set(__LOCALIZE("Nothing to paste: the selected tracks already have these routings.","sws_mbox"));
+		SNM_ShowMsg(report.Get(), SWS_CMD_SHORTNAME(_ct));
+	}
+}
+
 // sends cut copy/paste
 void CopySends(COMMAND_T* _ct)
 {
@@ -317,26 +464,32 @@ void PasteReceives(COMMAND_T* _ct)
 // Remove routing
 ///////////////////////////////////////////////////////////////////////////////
 
-// primitive
-bool RemoveSends(WDL_PtrList<MediaTrack>* _trs, WDL_PtrList<SNM_ChunkParserPatcher>* _ps)
+// sends are removed from their destination tracks' chunks: only those are patched
+static void PlanRemoveSends(WDL_PtrList<MediaTrack>* _trs, SNM_RoutingBatch* _batch)
 {
-	bool updated = false;
-	WDL_PtrList<SNM_ChunkParserPatcher>* ps = (_ps ? _ps : new WDL_PtrList<SNM_ChunkParserPatcher>);
-	for (int j=1; j <= GetNumTracks(); j++) // skip master
-	{
-		if (MediaTrack* trSrc = CSurf_TrackFromID(j, false))
+	for (int i=0; i < _trs->GetSize(); i++)
+		if (MediaTrack* tr = _trs->Get(i))
 		{
-			SNM_SendPatcher* p = (SNM_SendPatcher*)SNM_FindCPPbyObject(ps, trSrc);
-			if (!p) {
-				p = new SNM_SendPatcher(trSrc); 
-				ps->Add(p);
-			}
-			for (int i=0; i < _trs->GetSize(); i++)
-//				if (_trs->Get(i) != trSrc)
-					updated |= (p->RemoveReceivesFrom(_trs->Get(i)) > 0);
+			MediaTrack* dest;
+			for (int si=0; (dest = (MediaTrack*)GetSetTrackSendInfo(tr, Send, si, "P_DESTTRACK", NULL)); si++)
+				_batch->RemoveReceivesFrom(tr, dest);
 		}
-	}
-	if (!_ps) ps->Empty(true); // auto-commit if needed
+}
+
+static void PlanRemoveReceives(WDL_PtrList<MediaTrack>* _trs, SNM_RoutingBatch* _batch)
+{
+	for (int i=0; i < _trs->GetSize(); i++)
+		_batch->RemoveReceives(_trs->Get(i));
+}
+
+// primitive
+bool RemoveSends(WDL_PtrList<MediaTrack>* _trs, WDL_PtrList<SNM_ChunkParserPatcher>* _ps)
+{
+	SNM_RoutingBatch batch;
+	PlanRemoveSends(_trs, &batch);
+	WDL_PtrList<SNM_ChunkParserPatcher> ps;
+	const bool updated = (batch.Apply(_ps ? _ps : &ps, false, NULL) > 0);
+	CommitPatchers(&ps); // no-op if _ps, auto-commit otherwise
 	return updated;
 }
 
@@ -354,19 +507,11 @@ void RemoveSends(COMMAND_T* _ct)
 // primitive
 bool RemoveReceives(WDL_PtrList<MediaTrack>* _trs, WDL_PtrList<SNM_ChunkParserPatcher>* _ps)
 {
-	bool updated = false;
-	WDL_PtrList<SNM_ChunkParserPatcher>* ps = (_ps ? _ps : new WDL_PtrList<SNM_ChunkParserPatcher>);
-	for (int i=0; i < _trs->GetSize(); i++)
-		if (MediaTrack* tr = _trs->Get(i))
-		{
-			SNM_SendPatcher* p = (SNM_SendPatcher*)SNM_FindCPPbyObject(ps, tr);
-			if (!p) {
-				p = new SNM_SendPatcher(tr); 
-				ps->Add(p);
-			}
-			updated |= (p->RemoveReceives() > 0); 
-		}
-	if (!_ps) ps->Empty(true); // auto-commit if needed
+	SNM_RoutingBatch batch;
+	PlanRemoveReceives(_trs, &batch);
+	WDL_PtrList<SNM_ChunkParserPatcher> ps;
+	const bool updated = (batch.Apply(_ps ? _ps : &ps, false, NULL) > 0);
+	CommitPatchers(&ps); // no-op if _ps, auto-commit otherwise
 	return updated;
 }
 
@@ -381,18 +526,25 @@ void RemoveReceives(COMMAND_T* _ct)
 		Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_ALL, -1);
 }
 
+// primitive: sends & receives, one pass per patched track
+bool RemoveRoutings(WDL_PtrList<MediaTrack>* _trs, WDL_PtrList<SNM_ChunkParserPatcher>* _ps)
+{
+	SNM_RoutingBatch batch;
+	PlanRemoveSends(_trs, &batch);
+	PlanRemoveReceives(_trs, &batch);
+	WDL_PtrList<SNM_ChunkParserPatcher> ps;
+	const bool updated = (batch.Apply(_ps ? _ps : &ps, false, NULL) > 0);
+	CommitPatchers(&ps); // no-op if _ps, auto-commit otherwise
+	return updated;
+}
+
 void RemoveRoutings(COMMAND_T* _ct)
 {
 	bool updated = false;
 	WDL_PtrList<MediaTrack> trs;
 	SNM_GetSelectedTracks(NULL, &trs, false);
 	if (trs.GetSize())
-	{
-		WDL_PtrList<SNM_ChunkParserPatcher> ps;
-		updated |= RemoveSends(&trs, &ps);
-		updated |= RemoveReceives(&trs, &ps);
-		ps.Empty(true); // auto-commit, if needed
-	}
+		updated = RemoveRoutings(&trs, NULL);
 	if (updated)
 		Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_ALL, -1); 
 }
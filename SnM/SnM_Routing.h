@@ -64,15 +64,49 @@ public:
 };
 
 
+// Receives to add/update/remove on a receiving track, applied in one chunk pass
+// by SNM_SendPatcher::PatchReceives() which diffs them against the existing ones:
+// an existing receive with the same source track, channels and MIDI flags as a 
+// receive to add is updated (or left as it is) rather than duplicated
+class SNM_RcvPlan
+{
+public:
+	SNM_RcvPlan(MediaTrack* _tr) : m_tr(_tr), m_removeAll(false), m_added(0), m_updated(0), m_removed(0) {}
+	void AddReceive(int _srcIdx, SNM_SndRcv* _io) { m_addFrom.push_back(_srcIdx); m_adds.push_back(_io); }
+	void RemoveReceivesFrom(int _srcIdx) { m_removeFrom.push_back(_srcIdx); }
+	void RemoveReceives() { m_removeAll = true; }
+	bool IsEmpty() const { return !m_removeAll && m_adds.empty() && m_removeFrom.empty(); }
+	int GetNumAdds() const { return (int)m_adds.size(); }
+
+	// diff helpers, see SNM_SendPatcher::PatchReceives()
+	void StartDiff();
+	bool IsRemoved(int _srcIdx) const;
+	SNM_SndRcv* Consume(int _srcIdx, int _srcChan, int _destChan, int _midi);
+	SNM_SndRcv* GetUnconsumed(int _i, int* _srcIdx) const;
+
+	MediaTrack* m_tr;
+	int m_added, m_updated, m_removed; // diff of the last PatchReceives()
+
+private:
+	bool m_removeAll;
+	vector<int> m_removeFrom;          // 0-based source track indexes, as in AUXRECV lines
+	vector<int> m_addFrom;             // idem, parallel to m_adds
+	vector<SNM_SndRcv*> m_adds;        // not owned (clipboard items)
+	vector<pair<int,int> > m_bySrc;    // source index -> m_adds index, sorted
+	vector<char> m_consumed;
+};
+
+
 typedef WDL_PtrList_DeleteOnDestroy<WDL_PtrList_DeleteOnDestroy<SNM_SndRcv>> SndRcvClipboard;
 void CopySendsReceives(bool _noIntra, WDL_PtrList<MediaTrack>* _trs, SndRcvClipboard* _snds, SndRcvClipboard* _rcvs, bool forceFlush = true);
-bool PasteSendsReceives(WDL_PtrList<MediaTrack>* _trs, SndRcvClipboard* _snds, SndRcvClipboard* _rcvs, WDL_PtrList<SNM_ChunkParserPatcher>* _ps);
+bool PasteSendsReceives(WDL_PtrList<MediaTrack>* _trs, SndRcvClipboard* _snds, SndRcvClipboard* _rcvs, WDL_PtrList<SNM_ChunkParserPatcher>* _ps, WDL_FastString* _dryRunReport = NULL);
 void CopyWithIOs(COMMAND_T*);
 void CutWithIOs(COMMAND_T*);
 void PasteWithIOs(COMMAND_T*);
 void CopyRoutings(COMMAND_T*);
 void CutRoutings(COMMAND_T*);
 void PasteRoutings(COMMAND_T*);
+void PasteRoutingsDryRun(COMMAND_T*);
 void CopySends(COMMAND_T*);
 void CutSends(COMMAND_T*);
 void PasteSends(COMMAND_T*);
@@ -84,6 +118,7 @@ bool RemoveSends(WDL_PtrList<MediaTrack>* _trs, WDL_PtrList<SNM_ChunkParserPatch
 void RemoveSends(COMMAND_T*);
 bool RemoveReceives(WDL_PtrList<MediaTrack>* _trs, WDL_PtrList<SNM_ChunkParserPatcher>* _ps);
 void RemoveReceives(COMMAND_T*);
+bool RemoveRoutings(WDL_PtrList<MediaTrack>* _trs, WDL_PtrList<SNM_ChunkParserPatcher>* _ps);
 void RemoveRoutings(COMMAND_T*);
 
 // reascript export
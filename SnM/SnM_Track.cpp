@@ -350,8 +350,14 @@ void SetTrackGroup(COMMAND_T* _ct) {
 		Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_ALL, -1);
 }
 
-void SetTrackToFirstUnusedGroup(COMMAND_T* _ct) {
-	if (SetTrackGroup(FindFirstUnusedGroup()))
+void SetTrackToFirstUnusedGroup(COMMAND_T* _ct)
+{
+	bool updated;
+	{
+		SWS_ObjectStateTransaction transaction; // read all tracks once, write the selected ones once
+		updated = SetTrackGroup(FindFirstUnusedGroup());
+	}
+	if (updated)
 		Undo_OnStateChangeEx2(NULL, SWS_CMD_SHORTNAME(_ct), UNDO_STATE_ALL, -1);
 }
 
@@ -846,11 +852,152 @@ bool ReplacePasteItemsFromTrackTemplate(MediaTrack* _tr, WDL_FastString* _tmpltI
 	return updated;
 }
 
+// fx block of a fx chain sub-chunk, i.e. from a "BYPASS" line up to the next one
+// (plugin state, PRESETNAME, FLOATPOS, FXID, WAK, fx param envelopes, etc..)
+class SNM_FXChunkBlock
+{
+public:
+	SNM_FXChunkBlock(int _pos)
+		: m_pos(_pos),m_len(0),m_hash(2166136261u),m_floatPosEnd(-1),m_idPos(-1),m_idLen(0),m_match(-1) {}
+	int m_pos, m_len; // in the fx chain sub-chunk
+	WDL_FastString m_key; // fx type and identifier
+	unsigned int m_hash; // fx state (FNV-1a), FXID and FLOATPOS lines excluded
+	int m_floatPosEnd; // end of the FLOATPOS line (if any)
+	int m_idPos, m_idLen; // FXID line (if any)
+	int m_match; // index of the matching fx in the other chain (if any)
+};
+
+// fx type + identifier from a plugin sub-chunk header, e.g.:
+// <VST "VST: ReaEQ (Cockos)" reaeq.dll 0 "" 1919247729<56535472656571726561657100000000> ""
+// <JS loser/3BandEQ ""
+static void GetFXChunkKey(const char* _line, int _len, WDL_FastString* _key)
+{
+	WDL_FastString line;
+	line.Set(_line, _len);
+	LineParser lp(false);
+	if (!lp.parse(line.Get()) && lp.getnumtokens() > 2)
+	{
+		const char* type = lp.gettoken_str(0);
+		_key->Set(type);
+		_key->Append(" ");
+		if (!strcmp(type, "<VST") || !strcmp(type, "<DX")) {
+			_key->Append(lp.gettoken_str(2)); // file name
+			_key->Append(" ");
+			_key->Append(lp.gettoken_str(lp.getnumtokens()>5 ? 5 : 2)); // unique id
+		}
+		else if (!strcmp(type, "<JS"))
+			_key->Append(lp.gettoken_str(1));
+		else
+			_key->Append(lp.gettoken_str(2));
+	}
+	else
+		_key->Set(_line, _len);
+}
+
+static void GetFXChunkBlocks(const char* _chain, WDL_PtrList_DOD<SNM_FXChunkBlock>* _blocks)
+{
+	int depth = 0;
+	SNM_FXChunkBlock* b = NULL;
+	const char* p = _chain;
+	while (*p)
+	{
+		const char* eol = strchr(p, '\n');
+		const int len = eol ? (int)(eol-p+1) : (int)strlen(p);
+		const int pos = (int)(p-_chain);
+		bool hashed = true;
+		if (*p == '>')
+		{
+			if (--depth == 0 && b) { // end of chain
+				b->m_len = pos - b->m_pos;
+				b = NULL;
+			}
+		}
+		else
+		{
+			if (depth == 1)
+			{
+				if (!strncmp(p, "BYPASS ", 7)) {
+					if (b) b->m_len = pos - b->m_pos;
+					b = _blocks->Add(new SNM_FXChunkBlock(pos));
+				}
+				else if (b && *p == '<' && !b->m_key.GetLength())
+					GetFXChunkKey(p, len, &b->m_key);
+				else if (b && !strncmp(p, "FLOATPOS ", 9)) {
+					b->m_floatPosEnd = pos + len;
+					hashed = false;
+				}
+				else if (b && !strncmp(p, "FXID ", 5)) {
+					b->m_idPos = pos;
+					b->m_idLen = len;
+					hashed = false;
+				}
+			}
+			if (*p == '<') depth++;
+		}
+		if (b && hashed)
+			for (int i=0; i<len; i++)
+				b->m_hash = (b->m_hash ^ (unsigned char)p[i]) * 16777619u;
+		p += len;
+	}
+}
+
+// gives the fx of _newChunk the FXIDs of matching fx in _cur (same type and identifier,
+// same state preferred) so that REAPER keeps these plugin instances loaded when applying
+// _newChunk: only the state of changed fx is reloaded, unmatched fx are (un)instantiated
+// note: assumes all ids have been removed from _newChunk
+static bool PatchFXChainIds(SNM_ChunkParserPatcher* _cur, WDL_FastString* _newChunk, const char* _chainKeyword)
+{
+	WDL_FastString curChain, newChain;
+	if (_cur->GetSubChunk(_chainKeyword, 2, 0, &curChain) < 0)
+		return false;
+	SNM_ChunkParserPatcher pnew(_newChunk); // auto-commit
+	if (pnew.GetSubChunk(_chainKeyword, 2, 0, &newChain) < 0)
+		return false;
+
+	WDL_PtrList_DOD<SNM_FXChunkBlock> curFx, newFx;
+	GetFXChunkBlocks(curChain.Get(), &curFx);
+	GetFXChunkBlocks(newChain.Get(), &newFx);
+
+	bool matched = false;
+	for (int i=0; i<newFx.GetSize(); i++)
+	{
+		SNM_FXChunkBlock* n = newFx.Get(i);
+		for (int j=0; j<curFx.GetSize(); j++)
+		{
+			SNM_FXChunkBlock* c = curFx.Get(j);
+			if (c->m_match<0 && c->m_idPos>=0 && !strcmp(c->m_key.Get(), n->m_key.Get()))
+			{
+				if (n->m_match<0 || c->m_hash == n->m_hash)
+					n->m_match = j;
+				if (c->m_hash == n->m_hash)
+					break;
+			}
+		}
+		if (n->m_match >= 0) {
+			curFx.Get(n->m_match)->m_match = i;
+			matched = true;
+		}
+	}
+	if (!matched)
+		return false;
+
+	// insert FXIDs, last fx first so that positions remain valid
+	for (int i=newFx.GetSize()-1; i>=0; i--)
+	{
+		SNM_FXChunkBlock* n = newFx.Get(i);
+		if (SNM_FXChunkBlock* c = curFx.Get(n->m_match))
+			newChain.Insert(curChain.Get()+c->m_idPos, n->m_floatPosEnd>=0 ? n->m_floatPosEnd : n->m_pos+n->m_len, c->m_idLen);
+	}
+	return pnew.ReplaceSubChunk(_chainKeyword, 2, 0, newChain.Get());
+}
+
 // apply a track template (primitive: no undo, folder states are lost, receives are removed)
 // _tmplt: the track template
 // _p: optional (to factorize chunk updates)
 // note: assumes _tmplt contains a single track (with items/envs already removed when _itemsFromTmplt/_envsFromTmplt are false)
 //       i.e. use MakeSingleTrackTemplateChunk() first!
+// diff mode (g_SNM_DiffTrackTemplates): the track GUID and the FXIDs of matching fx are
+// preserved, REAPER does not re-instantiate the fx that are both in the track and the template
 bool ApplyTrackTemplatePrimitive(MediaTrack* _tr, WDL_FastString* _tmplt, bool _itemsFromTmplt, bool _envsFromTmplt, SNM_SendPatcher* _p)
 {
 	bool updated = false;
@@ -859,6 +1006,10 @@ bool ApplyTrackTemplatePrimitive(MediaTrack* _tr, WDL_FastString* _tmplt, bool _
 		WDL_FastString tmplt(_tmplt); // not to mod the input template..
 		SNM_ChunkParserPatcher* p = (_p ? _p : new SNM_ChunkParserPatcher(_tr));
 
+		// diff mode: the template's ids are removed now, current items/envs keep theirs
+		if (g_SNM_DiffTrackTemplates)
+			RemoveAllIds(&tmplt);
+
 		// add current track items, if any
 		if (!_itemsFromTmplt) 
 		{
@@ -895,6 +1046,30 @@ bool ApplyTrackTemplatePrimitive(MediaTrack* _tr, WDL_FastString* _tmplt, bool _
 			}
 		}
 
+		// diff mode: restore the track GUID, reuse fx instances
+		if (g_SNM_DiffTrackTemplates)
+		{
+			PatchFXChainIds(p, &tmplt, "FXCHAIN");
+			PatchFXChainIds(p, &tmplt, "FXCHAIN_REC");
+
+			const char* cur = p->GetChunk()->Get();
+			const char* curEol = strchr(cur, '\n');
+			const char* tmpltEol = strchr(tmplt.Get(), '\n');
+			if (curEol && tmpltEol)
+			{
+				const int tmpltHeaderLen = (int)(tmpltEol-tmplt.Get());
+				if (const char* trId = strstr(curEol, "\nTRACKID {"))
+				{
+					const char* trIdEol = strchr(trId+1, '\n');
+					tmplt.Insert(trId+1, tmpltHeaderLen+1, trIdEol ? (int)(trIdEol-trId) : (int)strlen(trId+1));
+				}
+				// "<TRACK {GUID}" header line
+				tmplt.DeleteSub(0, tmpltHeaderLen);
+				tmplt.Insert(cur, 0, (int)(curEol-cur));
+			}
+			p->SetKeepIds(true);
+		}
+
 		// the meat, apply template!
 		p->SetChunk(tmplt.Get());
 		updated = true;
@@ -916,6 +1091,11 @@ bool ApplyTrackTemplate(MediaTrack* _tr, WDL_FastString* _tmplt, bool _itemsFrom
 	{
 		SNM_SendPatcher* p = (_p ? (SNM_SendPatcher*)_p : new SNM_SendPatcher(_tr));
 
+		// diff mode: do not set the state at all if the template would not change anything
+		WDL_FastString curChunk;
+		if (g_SNM_DiffTrackTemplates && !p->GetUpdates())
+			curChunk.Set(p->GetChunk());
+
 		// store receives, folder and compact states
 		WDL_PtrList_DeleteOnDestroy<WDL_PtrList_DeleteOnDestroy<SNM_SndRcv> > rcvs;
 		WDL_PtrList_DeleteOnDestroy<WDL_PtrList_DeleteOnDestroy<SNM_SndRcv> > snds;
@@ -940,6 +1120,13 @@ bool ApplyTrackTemplate(MediaTrack* _tr, WDL_FastString* _tmplt, bool _itemsFrom
 				p->ReplaceLine("TRACK", "ISBUS", 1, 0, busLine.Get(), "BUSCOMP");
 			if (compbusLine.GetLength())
 				p->ReplaceLine("TRACK", "BUSCOMP", 1, 0, compbusLine.Get(), "SHOWINMIX");
+
+			if (curChunk.GetLength() && !strcmp(curChunk.Get(), p->GetChunk()->Get()))
+			{
+				p->CancelUpdates();
+				p->SetKeepIds(false);
+				updated = false;
+			}
 		}
 
 /*JFB!! works with SNM_ChunkParserPatcher v2 + "SNM_SendPatcher" to remove
@@ -1203,12 +1390,16 @@ void TrackPreviewLockUnlockMutex(preview_register_t* _prev, bool _lock) {
 #endif
 }
 
+static bool ReleasePreviewVoice(preview_register_t* _prev);
+
 void DeleteTrackPreview(void* _prev)
 {
 	if (_prev)
 	{
 		preview_register_t* prev = (preview_register_t*)_prev;
 		StopTrackPreview2(NULL, prev);
+		if (ReleasePreviewVoice(prev)) // preloaded file: recycle the voice
+			return;
 		DELETE_NULL(prev->src);
 		TrackPreviewInitDeleteMutex(prev, false);
 		DELETE_NULL(prev);
@@ -1227,6 +1418,289 @@ void TrackPreviewLockUnlockTracks(bool _lock)
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+// Preloaded media files (RAM cache) and preview voice pool
+// Media files can be decoded in memory once for all (e.g. from the Resources
+// window) so that triggering them later on starts a preallocated voice: no
+// file i/o, no decoder instantiation and no allocation at play time.
+///////////////////////////////////////////////////////////////////////////////
+
+#define SNM_PREVIEW_VOICES		32	// max. number of simultaneous preloaded file previews
+#define SNM_PREVIEW_DECODE_BLOCK	4096
+
+// decoded (interleaved) samples of a preloaded media file
+class SNM_SampleData
+{
+public:
+	SNM_SampleData(const char* _fn, double _srate, int _nch, int _frames, int _choke)
+		: m_fn(_fn),m_srate(_srate),m_nch(_nch),m_frames(_frames),m_choke(_choke),m_users(0),m_lastUse(0) {}
+	INT64 GetBytes() const { return (INT64)m_frames*m_nch*sizeof(ReaSample); }
+	WDL_FastString m_fn;
+	double m_srate;
+	int m_nch, m_frames, m_choke;
+	int m_users; // number of voices playing these samples, main thread only
+	unsigned int m_lastUse;
+	WDL_TypedBuf<ReaSample> m_buf;
+};
+
+static void DeleteSampleData(SNM_SampleData* _data) { delete _data; }
+
+// case insensitive: consistent with file name matching in SNM_TogglePlaySelTrackPreviews()
+static WDL_StringKeyedArray<SNM_SampleData*> g_previewCache(false, DeleteSampleData);
+static INT64 g_previewCacheBytes = 0;
+static unsigned int g_previewCacheClock = 0;
+static int g_previewChokeGroups = 0;
+
+// plays a preloaded media file from memory
+// GetFileName() returns the original file name so that toggle/pause
+// features work the same with preloaded files
+class SNM_CachedSource : public PCM_source
+{
+public:
+	SNM_CachedSource() : m_data(NULL) {}
+	~SNM_CachedSource() {}
+	void SetData(SNM_SampleData* _data) { m_data = _data; }
+	SNM_SampleData* GetData() { return m_data; }
+
+	PCM_source* Duplicate() {
+		SNM_CachedSource* src = new SNM_CachedSource;
+		src->SetData(m_data);
+		return src;
+	}
+	bool IsAvailable() { return m_data != NULL; }
+	const char* GetType() { return "S&M_PRELOADED"; }
+	const char* GetFileName() { return m_data ? m_data->m_fn.Get() : NULL; }
+	bool SetFileName(const char* newfn) { return false; }
+	int GetNumChannels() { return m_data ? m_data->m_nch : 0; }
+	double GetSampleRate() { return m_data ? m_data->m_srate : 0.0; }
+	double GetLength() { return m_data ? m_data->m_frames/m_data->m_srate : 0.0; }
+	int PropertiesWindow(HWND hwndParent) { return -1; }
+	void SaveState(ProjectStateContext* ctx) {}
+	int LoadState(const char* firstline, ProjectStateContext* ctx) { return -1; }
+	void Peaks_Clear(bool deleteFile) {}
+	int PeaksBuild_Begin() { return 0; }
+	int PeaksBuild_Run() { return 0; }
+	void PeaksBuild_Finish() {}
+	void GetPeakInfo(PCM_source_peaktransfer_t* block) { block->peaks_out=0; }
+
+	// audio thread
+	void GetSamples(PCM_source_transfer_t* block)
+	{
+		block->samples_out=0;
+		const SNM_SampleData* data = m_data;
+		if (!data || !block->samples || block->length<=0 || block->nch<=0 || block->samplerate<=0.0)
+			return;
+
+		const int nch = block->nch, srcNch = data->m_nch;
+		const ReaSample* in = data->m_buf.Get();
+		ReaSample* out = block->samples;
+		int n = 0;
+
+		// same sample rate: straight copy
+		if (fabs(block->samplerate-data->m_srate) < 0.5)
+		{
+			int pos = (int)(block->time_s*data->m_srate + 0.5);
+			if (pos < 0) pos = 0;
+			n = min(block->length, data->m_frames-pos);
+			if (n <= 0) return;
+			in += pos*srcNch;
+			if (nch == srcNch)
+				memcpy(out, in, n*nch*sizeof(ReaSample));
+			else
+				for (int i=0; i<n; i++, in+=srcNch, out+=nch)
+					for (int c=0; c<nch; c++)
+						out[c] = c<srcNch ? in[c] : (srcNch==1 ? in[0] : 0.0);
+		}
+		// otherwise, linear interpolation
+		else
+		{
+			const double step = data->m_srate/block->samplerate;
+			double pos = max(0.0, block->time_s*data->m_srate);
+			for (; n<block->length; n++, pos+=step, out+=nch)
+			{
+				const int i0 = (int)pos;
+				if (i0 >= data->m_frames) break;
+				const int i1 = min(i0+1, data->m_frames-1);
+				const double frac = pos-i0;
+				for (int c=0; c<nch; c++)
+				{
+					const int sc = c<srcNch ? c : (srcNch==1 ? 0 : -1);
+					out[c] = sc<0 ? 0.0 : in[i0*srcNch+sc] + frac*(in[i1*srcNch+sc]-in[i0*srcNch+sc]);
+				}
+			}
+		}
+		block->samples_out = n;
+	}
+
+private:
+	SNM_SampleData* m_data;
+};
+
+// voices are allocated with the first preloaded file and recycled afterwards
+class SNM_PreviewVoice
+{
+public:
+	SNM_PreviewVoice() : m_busy(false) {
+		memset(&m_prev, 0, sizeof(preview_register_t));
+		TrackPreviewInitDeleteMutex(&m_prev, true);
+	}
+	~SNM_PreviewVoice() { TrackPreviewInitDeleteMutex(&m_prev, false); }
+	preview_register_t m_prev;
+	SNM_CachedSource m_src;
+	bool m_busy;
+};
+
+static WDL_PtrList_DOD<SNM_PreviewVoice> g_previewVoices;
+
+static SNM_PreviewVoice* GetPreviewVoice(preview_register_t* _prev)
+{
+	for (int i=0; i<g_previewVoices.GetSize(); i++)
+		if (&g_previewVoices.Get(i)->m_prev == _prev)
+			return g_previewVoices.Get(i);
+	return NULL;
+}
+
+// main thread, returns NULL if all voices are busy
+static preview_register_t* AcquirePreviewVoice(SNM_SampleData* _data)
+{
+	for (int i=0; i<g_previewVoices.GetSize(); i++)
+	{
+		SNM_PreviewVoice* v = g_previewVoices.Get(i);
+		if (!v->m_busy)
+		{
+			v->m_busy = true;
+			v->m_src.SetData(_data);
+			v->m_prev.src = &v->m_src;
+			_data->m_users++;
+			_data->m_lastUse = ++g_previewCacheClock;
+			return &v->m_prev;
+		}
+	}
+	return NULL;
+}
+
+// returns false if _prev is not a pooled voice
+// note: the preview must be stopped already (no more audio thread access)
+static bool ReleasePreviewVoice(preview_register_t* _prev)
+{
+	SNM_PreviewVoice* v = GetPreviewVoice(_prev);
+	if (!v) return false;
+	if (v->m_busy)
+	{
+		if (SNM_SampleData* data = v->m_src.GetData())
+			data->m_users--;
+		v->m_src.SetData(NULL);
+		v->m_prev.src = NULL;
+		v->m_busy = false;
+	}
+	return true;
+}
+
+// evict least recently used files (not being played) until the cache fits the budget
+static void TrimPreviewCache(INT64 _budget)
+{
+	while (g_previewCacheBytes > _budget)
+	{
+		const char* lruKey = NULL;
+		SNM_SampleData* lru = NULL;
+		for (int i=0; i<g_previewCache.GetSize(); i++)
+		{
+			const char* key = NULL;
+			SNM_SampleData* data = g_previewCache.Enumerate(i, &key);
+			if (data && !data->m_users && (!lru || data->m_lastUse < lru->m_lastUse)) {
+				lru = data;
+				lruKey = key;
+			}
+		}
+		if (!lru) break;
+		g_previewCacheBytes -= lru->GetBytes();
+		g_previewCache.Delete(lruKey);
+	}
+}
+
+// decodes a media file in memory, later previews of this file will be played from RAM
+// _chokeGroup > 0: starting this file stops other files of the same group on the same track
+// returns false for MIDI files, unsupported files or files bigger than the cache size
+bool SNM_PreloadTrackPreview(const char* _fn, int _chokeGroup)
+{
+	if (!_fn || !*_fn)
+		return false;
+
+	if (SNM_SampleData* data = g_previewCache.Get(_fn, NULL)) {
+		data->m_choke = _chokeGroup;
+		return true;
+	}
+
+	PCM_source* src = PCM_Source_CreateFromFileEx(_fn, true);
+	if (!src)
+		return false;
+
+	const INT64 budget = (INT64)g_SNM_PreviewCacheSize<<20;
+	const double srate = src->GetSampleRate();
+	const int nch = src->GetNumChannels();
+	const double frames = srate>0.0 ? ceil(src->GetLength()*srate) : 0.0;
+	if (!strncmp(src->GetType(), "MIDI", 4) || nch<=0 || frames<=0.0 ||
+		frames*nch > INT_MAX || frames*nch*sizeof(ReaSample) > budget)
+	{
+		delete src;
+		return false;
+	}
+
+	SNM_SampleData* data = new SNM_SampleData(_fn, srate, nch, (int)frames, _chokeGroup);
+	ReaSample* buf = data->m_buf.ResizeOK(data->m_frames*nch, false);
+	if (!buf)
+	{
+		delete data;
+		delete src;
+		return false;
+	}
+
+	PCM_source_transfer_t t;
+	memset(&t, 0, sizeof(PCM_source_transfer_t));
+	t.samplerate = srate;
+	t.nch = nch;
+	int pos = 0;
+	while (pos < data->m_frames)
+	{
+		t.time_s = pos/srate;
+		t.length = min(SNM_PREVIEW_DECODE_BLOCK, data->m_frames-pos);
+		t.samples = buf + pos*nch;
+		t.samples_out = 0;
+		src->GetSamples(&t);
+		if (t.samples_out <= 0) break;
+		pos += t.samples_out;
+	}
+	delete src;
+	if (pos < data->m_frames)
+		memset(buf + pos*nch, 0, (data->m_frames-pos)*nch*sizeof(ReaSample));
+
+	// preallocate voices once for all
+	if (!g_previewVoices.GetSize())
+		for (int i=0; i<SNM_PREVIEW_VOICES; i++)
+			g_previewVoices.Add(new SNM_PreviewVoice);
+
+	TrimPreviewCache(budget - data->GetBytes());
+	if (g_previewCacheBytes + data->GetBytes() > budget) // other files are being played
+	{
+		delete data;
+		return false;
+	}
+
+	data->m_lastUse = ++g_previewCacheClock;
+	g_previewCacheBytes += data->GetBytes();
+	g_previewCache.Insert(_fn, data);
+	return true;
+}
+
+int SNM_NewTrackPreviewChokeGroup() {
+	return ++g_previewChokeGroups;
+}
+
+int SNM_CountPreloadedTrackPreviews() {
+	return g_previewCache.GetSize();
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 
 class PausedPreview
@@ -1252,6 +1726,9 @@ WDL_PtrList_DOD<PausedPreview> g_pausedPreviews;
 // polled from the main thread via SNM_CSurfRun()
 void StopTrackPreviewsRun()
 {
+	if (!g_playPreviews.GetSize())
+		return;
+
 	static WDL_PtrList<void> ano_trs;
 	for (int i=g_playPreviews.GetSize()-1; i >=0; i--)
 	{
@@ -1290,49 +1767,92 @@ void StopTrackPreviewsRun()
 // if 1 is set in bufflags, it will buffer-ahead (in case your source needs to do some cpu intensive processing, a good idea
 // -- if it needs to be low latency, then don't set the 1 bit).
 // MSI is the measure start interval, which if set to n greater than 0, means start synchronized to playback synchronized to a multiple of n measures
-bool SNM_PlayTrackPreview(MediaTrack* _tr, PCM_source* _src, bool _pause, bool _loop, double _msi)
+static bool StartTrackPreview(preview_register_t* _prev, MediaTrack* _tr, bool _pause, bool _loop, double _msi)
 {
-	bool ok = false;
-	if (_src)
+	_prev->m_out_chan = -1;
+	_prev->curpos = 0.0;
+	_prev->loop = _loop;
+	_prev->volume = 1.0;
+	_prev->preview_track = _tr;
+
+	// update start position for paused items
+	// note: no need to mutex "_prev" here as it is not started yet
+	if (_pause)
 	{
-		preview_register_t* prev = new preview_register_t;
-		memset(prev, 0, sizeof(preview_register_t));
-		TrackPreviewInitDeleteMutex(prev, true);
-		prev->src = _src;
-		prev->m_out_chan = -1;
-		prev->curpos = 0.0;
-		prev->loop = _loop;
-		prev->volume = 1.0;
-		prev->preview_track = _tr;
+		for (int i=g_pausedPreviews.GetSize()-1; i>=0; i--)
+		{
+			if (g_pausedPreviews.Get(i)->IsMatching(_prev))
+			{
+				_prev->curpos = g_pausedPreviews.Get(i)->m_pos;
+				g_pausedPreviews.Delete(i, true);
+//				break;
+			}
+		}
+	}
 
-		// update start position for paused items
-		// note: no need to mutex "prev" here as it is not started yet
-		if (_pause)
+	// choke groups: stop other preloaded files of the same group on the same track
+	SNM_PreviewVoice* v = GetPreviewVoice(_prev);
+	if (int choke = (v && v->m_src.GetData()) ? v->m_src.GetData()->m_choke : 0)
+	{
+		for (int i=g_playPreviews.GetSize()-1; i>=0; i--)
 		{
-			for (int i=g_pausedPreviews.GetSize()-1; i>=0; i--)
+			SNM_PreviewVoice* other = GetPreviewVoice(g_playPreviews.Get(i));
+			if (other && other->m_prev.preview_track == _tr &&
+				other->m_src.GetData() && other->m_src.GetData()->m_choke == choke)
 			{
-				if (g_pausedPreviews.Get(i)->IsMatching(prev))
-				{
-					prev->curpos = g_pausedPreviews.Get(i)->m_pos;
-					g_pausedPreviews.Delete(i, true);
-//					break;
-				}
+				TrackPreviewLockUnlockMutex(&other->m_prev, true);
+				other->m_prev.loop = false;
+				other->m_prev.volume = 0.0; // => will be stopped by next call to StopTrackPreviewsRun()
+				TrackPreviewLockUnlockMutex(&other->m_prev, false);
 			}
 		}
+	}
+
+	// go!
+	g_playPreviews.Add(_prev);
+	return (PlayTrackPreview2Ex(NULL, _prev, !!_msi, _msi) != 0);
+}
 
-		// go!
-		g_playPreviews.Add(prev);
-		ok = (PlayTrackPreview2Ex(NULL, prev, !!_msi, _msi) != 0);
+bool SNM_PlayTrackPreview(MediaTrack* _tr, PCM_source* _src, bool _pause, bool _loop, double _msi)
+{
+	if (_src)
+	{
+		preview_register_t* prev = new preview_register_t;
+		memset(prev, 0, sizeof(preview_register_t));
+		TrackPreviewInitDeleteMutex(prev, true);
+		prev->src = _src;
+		return StartTrackPreview(prev, _tr, _pause, _loop, _msi);
 	}
-	return ok;
+	return false;
 }
 
 // primitive func: _fn must be a valid/existing file
 bool SNM_PlayTrackPreview(MediaTrack* _tr, const char* _fn, bool _pause, bool _loop, double _msi)
 {
-	if (PCM_source* src = PCM_Source_CreateFromFileEx(_fn, true)) // "true" so that the src is not imported as in-project data
-		return SNM_PlayTrackPreview(_tr, src, _pause, _loop, _msi);
-	return false;
+	bool ok = false;
+
+	// preloaded file? play it from RAM with a pooled voice
+	// (falls back to a regular preview when all voices are busy)
+	preview_register_t* prev = NULL;
+	if (SNM_SampleData* data = g_previewCache.Get(_fn, NULL))
+		if ((prev = AcquirePreviewVoice(data)))
+			ok = StartTrackPreview(prev, _tr, _pause, _loop, _msi);
+
+	if (!prev)
+		if (PCM_source* src = PCM_Source_CreateFromFileEx(_fn, true)) // "true" so that the src is not imported as in-project data
+			ok = SNM_PlayTrackPreview(_tr, src, _pause, _loop, _msi);
+
+	return ok;
+}
+
+// stops previews of preloaded files and frees the cache
+void SNM_UnloadTrackPreviews()
+{
+	for (int i=g_playPreviews.GetSize()-1; i>=0; i--)
+		if (GetPreviewVoice(g_playPreviews.Get(i)))
+			g_playPreviews.Delete(i, true, DeleteTrackPreview);
+	g_previewCache.DeleteAll();
+	g_previewCacheBytes = 0;
 }
 
 void SNM_PlaySelTrackPreviews(const char* _fn, bool _pause, bool _loop, double _msi)
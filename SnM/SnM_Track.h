@@ -76,6 +76,10 @@ void SNM_PlaySelTrackPreviews(const char* _fn, bool _pause, bool _loop, double _
 bool SNM_TogglePlaySelTrackPreviews(const char* _fn, bool _pause, bool _loop, double _msi = -1.0);
 void StopTrackPreviews(bool _selTracksOnly);
 void StopTrackPreviews(COMMAND_T*);
+bool SNM_PreloadTrackPreview(const char* _fn, int _chokeGroup = 0);
+int SNM_NewTrackPreviewChokeGroup();
+int SNM_CountPreloadedTrackPreviews();
+void SNM_UnloadTrackPreviews();
 
 bool SendAllNotesOff(WDL_PtrList<void>* _trs, int _cc_flags = 1|2);
 bool SendAllNotesOff(MediaTrack* _tr, int _cc_flags = 1|2);
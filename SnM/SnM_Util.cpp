@@ -35,6 +35,9 @@
 #include <WDL/localize/localize.h>
 #include <WDL/sha.h>
 #include <WDL/projectcontext.h>
+#include <WDL/mutex.h>
+
+#include <unordered_map>
 
 ///////////////////////////////////////////////////////////////////////////////
 // File util
@@ -545,6 +548,459 @@ void ExtensionConfigToString(WDL_FastString* _str, ProjectStateContext* _ctx)
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+// In-memory ini files
+// Each file is parsed once, reads are served from memory and writes are
+// buffered until SNM_FlushIniFile() rewrites the whole file in one go (temp
+// file + rename). External changes (REAPER, WritePrivateProfile*(), text
+// editors..) are detected with the file's mtime/size, checked at most once
+// per SNM_INI_STAT_DELAY, and with a content check before flushing (mtime has
+// a 1s resolution): the file is re-parsed and pending writes are applied
+// again on top of it.
+// Section and key names are case insensitive, like with the Win32 API.
+// Keys of duplicate sections are merged into the 1st one (and written there).
+// Files other than S&M.ini are dropped from memory once SNM_MAX_INI_FILES
+// files are cached, unless they have pending writes.
+// Note: as pending writes are not visible to Get/WritePrivateProfile*(), a
+// given section should be accessed through one API only.
+///////////////////////////////////////////////////////////////////////////////
+
+#define SNM_INI_STAT_DELAY	1000 // ms
+#define SNM_MAX_INI_FILES	8
+
+static std::string IniLowerCase(const char* _str)
+{
+	std::string s(_str ? _str : "");
+	for (size_t i=0; i<s.size(); i++)
+		s[i] = (char)tolower((unsigned char)s[i]);
+	return s;
+}
+
+static void IniTrim(const char** _start, const char** _end)
+{
+	while (*_start < *_end && (**_start == ' ' || **_start == '\t')) (*_start)++;
+	while (*_end > *_start && ((*_end)[-1] == ' ' || (*_end)[-1] == '\t' || (*_end)[-1] == '\r')) (*_end)--;
+}
+
+class SNM_IniFile
+{
+public:
+	SNM_IniFile(const char* _fn) : m_fn(_fn), m_loaded(false), m_bom(false), m_mtime(0), m_size(-1), m_lastStat(0) {}
+
+	bool HasPendingWrites() const { return !m_pending.empty(); }
+
+	// returns false if the key does not exist
+	bool Get(const char* _sec, const char* _key, std::string* _valOut)
+	{
+		Sync();
+		int secIdx = FindSection(_sec);
+		if (secIdx < 0)
+			return false;
+		const Section& sec = m_sections[secIdx];
+		std::unordered_map<std::string,size_t>::const_iterator it = sec.keys.find(IniLowerCase(_key));
+		if (it == sec.keys.end())
+			return false;
+
+		// surrounding quotes are stripped, like GetPrivateProfileString() does
+		const std::string& v = sec.lines[it->second].value;
+		if (v.size() >= 2 && (v[0] == '"' || v[0] == '\'') && v[v.size()-1] == v[0])
+			_valOut->assign(v, 1, v.size()-2);
+		else
+			*_valOut = v;
+		return true;
+	}
+
+	// _key == NULL: remove the section, _val == NULL: remove the key
+	void Set(const char* _sec, const char* _key, const char* _val)
+	{
+		Sync();
+		PendingWrite w;
+		w.sec = _sec;
+		w.hasKey = (_key != NULL);
+		if (_key) w.key = _key;
+		w.hasVal = (_val != NULL);
+		if (_val) w.val = _val;
+		m_pending.push_back(w);
+		Apply(w);
+	}
+
+	// forces a re-parse on next access (e.g. after WritePrivateProfile*())
+	void Invalidate() { m_loaded = false; }
+
+	bool Flush()
+	{
+		if (m_pending.empty())
+			return true;
+
+		Sync(true); // external changes: re-parse and replay pending writes
+
+#ifdef _WIN32
+		const char* eol = "\r\n";
+#else
+		const char* eol = "\n";
+#endif
+		std::string out;
+		if (m_bom)
+			out.append("\xEF\xBB\xBF");
+		for (size_t i=0; i<m_sections.size(); i++)
+		{
+			const Section& sec = m_sections[i];
+			if (sec.removed)
+				continue;
+			if (i) // m_sections[0]: lines before the first section
+				out.append("[").append(sec.name).append("]").append(eol);
+			for (size_t j=0; j<sec.lines.size(); j++)
+			{
+				const Line& l = sec.lines[j];
+				if (l.removed)
+					continue;
+				if (l.isKey)
+					out.append(l.key).append("=").append(l.value);
+				else
+					out.append(l.key);
+				out.append(eol);
+			}
+		}
+
+		std::string tmpFn(m_fn);
+		tmpFn.append(".tmp");
+		bool ok = false;
+		if (FILE* f = fopenUTF8(tmpFn.c_str(), "wb"))
+		{
+			ok = (fwrite(out.c_str(), 1, out.size(), f) == out.size());
+			ok = (fclose(f) == 0) && ok;
+		}
+		if (ok)
+		{
+#ifdef _WIN32
+			ok = !!MoveFileExW(win32::widen(tmpFn).c_str(), win32::widen(m_fn).c_str(), MOVEFILE_REPLACE_EXISTING);
+#else
+			ok = (rename(tmpFn.c_str(), m_fn.c_str()) == 0);
+#endif
+		}
+		if (!ok)
+		{
+			DeleteFile(tmpFn.c_str());
+			return false; // keep pending writes, next flush will retry
+		}
+
+		m_pending.clear();
+		m_content.swap(out); // what is on disk now
+		Stat(&m_mtime, &m_size);
+		m_lastStat = GetTickCount();
+		return true;
+	}
+
+private:
+	struct Line {
+		std::string key, value; // raw line in key when !isKey (comments, empty lines..)
+		bool isKey, removed;
+	};
+	struct Section {
+		std::string name;
+		vector<Line> lines;
+		std::unordered_map<std::string,size_t> keys; // lower case key -> index in lines (1st occurrence)
+		bool removed;
+		Section() : removed(false) {}
+		void Reindex() {
+			keys.clear();
+			for (size_t i=0; i<lines.size(); i++)
+				if (lines[i].isKey && !lines[i].removed)
+					keys.insert(std::make_pair(IniLowerCase(lines[i].key.c_str()), i));
+		}
+	};
+	struct PendingWrite {
+		std::string sec, key, val;
+		bool hasKey, hasVal;
+	};
+
+	void Stat(time_t* _mtime, long long* _size) const
+	{
+		struct stat s;
+#ifdef _WIN32
+		const bool exists = (statUTF8(m_fn.c_str(), &s) == 0);
+#else
+		const bool exists = (stat(m_fn.c_str(), &s) == 0);
+#endif
+		*_mtime = exists ? s.st_mtime : 0;
+		*_size = exists ? (long long)s.st_size : -1;
+	}
+
+	// (re)parse the file if needed
+	// _checkContent: compare the file content too, mtime/size miss same-second changes
+	void Sync(bool _checkContent = false)
+	{
+		const DWORD now = GetTickCount();
+		if (m_loaded && !_checkContent && (now - m_lastStat) < SNM_INI_STAT_DELAY)
+			return;
+		m_lastStat = now;
+
+		time_t mtime;
+		long long size;
+		Stat(&mtime, &size);
+		if (m_loaded && !_checkContent && mtime == m_mtime && size == m_size)
+			return;
+
+		std::string content;
+		if (size > 0)
+		{
+			if (WDL_HeapBuf* hb = LoadBin(m_fn.c_str()))
+			{
+				content.assign((const char*)hb->Get(), hb->GetSize());
+				delete hb;
+			}
+		}
+		m_mtime = mtime;
+		m_size = size;
+		if (m_loaded && content == m_content) // touched, or our own write
+			return;
+
+		m_sections.clear();
+		m_sectionIds.clear();
+		m_sections.push_back(Section());
+		m_bom = false;
+		m_content.swap(content);
+		Parse(m_content.c_str(), (int)m_content.size());
+		m_loaded = true;
+
+		for (size_t i=0; i<m_pending.size(); i++)
+			Apply(m_pending[i]);
+	}
+
+	void Parse(const char* _buf, int _len)
+	{
+		const char* p = _buf;
+		const char* end = _buf + _len;
+		if (_len >= 3 && !memcmp(p, "\xEF\xBB\xBF", 3)) {
+			m_bom = true;
+			p += 3;
+		}
+
+		Section* sec = &m_sections[0];
+		while (p < end)
+		{
+			const char* eol = (const char*)memchr(p, '\n', end-p);
+			if (!eol) eol = end;
+			const char* ls = p;
+			const char* le = eol;
+			IniTrim(&ls, &le);
+			p = eol + 1;
+
+			Line l;
+			l.removed = false;
+			const char* eq = (const char*)memchr(ls, '=', le-ls);
+			if (ls < le && *ls == '[' && !eq)
+			{
+				const char* ns = ls + 1;
+				const char* ne = (const char*)memchr(ns, ']', le-ns);
+				if (!ne) ne = le;
+				IniTrim(&ns, &ne);
+				std::string name(ns, ne-ns);
+				std::unordered_map<std::string,size_t>::const_iterator it = m_sectionIds.find(IniLowerCase(name.c_str()));
+				if (it != m_sectionIds.end()) // dupe section: merge its lines into the 1st one
+				{
+					sec = &m_sections[it->second];
+					continue;
+				}
+				m_sectionIds.insert(std::make_pair(IniLowerCase(name.c_str()), m_sections.size()));
+				m_sections.push_back(Section());
+				m_sections.back().name = name;
+				sec = &m_sections.back();
+				continue;
+			}
+			else if (eq)
+			{
+				const char* ke = eq;
+				const char* vs = eq + 1;
+				const char* ve = le;
+				IniTrim(&ls, &ke);
+				IniTrim(&vs, &ve);
+				l.isKey = true;
+				l.key.assign(ls, ke-ls);
+				l.value.assign(vs, ve-vs);
+				sec->keys.insert(std::make_pair(IniLowerCase(l.key.c_str()), sec->lines.size()));
+			}
+			else
+			{
+				l.isKey = false;
+				l.key.assign(ls, le-ls);
+			}
+			sec->lines.push_back(l);
+		}
+	}
+
+	int FindSection(const char* _sec) const
+	{
+		std::unordered_map<std::string,size_t>::const_iterator it = m_sectionIds.find(IniLowerCase(_sec));
+		return it == m_sectionIds.end() ? -1 : (int)it->second;
+	}
+
+	void Apply(const PendingWrite& _w)
+	{
+		int secIdx = FindSection(_w.sec.c_str());
+		if (!_w.hasKey) // remove section
+		{
+			if (secIdx > 0) {
+				m_sections[secIdx].removed = true;
+				m_sectionIds.erase(IniLowerCase(_w.sec.c_str()));
+			}
+			return;
+		}
+
+		std::string id = IniLowerCase(_w.key.c_str());
+		if (secIdx < 0)
+		{
+			if (!_w.hasVal)
+				return;
+
+			// new section, separated from the previous one with an empty line
+			Section& prev = m_sections.back();
+			if (m_sections.size() > 1 || !prev.lines.empty())
+				if (prev.lines.empty() || prev.lines.back().isKey || !prev.lines.back().key.empty()) {
+					Line l;
+					l.isKey = l.removed = false;
+					prev.lines.push_back(l);
+				}
+			secIdx = (int)m_sections.size();
+			m_sectionIds.insert(std::make_pair(IniLowerCase(_w.sec.c_str()), m_sections.size()));
+			m_sections.push_back(Section());
+			m_sections.back().name = _w.sec;
+		}
+
+		Section& sec = m_sections[secIdx];
+		std::unordered_map<std::string,size_t>::iterator it = sec.keys.find(id);
+		if (!_w.hasVal) // remove key
+		{
+			if (it != sec.keys.end()) {
+				sec.lines[it->second].removed = true;
+				sec.Reindex(); // a dupe key may show up
+			}
+		}
+		else if (it != sec.keys.end())
+		{
+			sec.lines[it->second].value = _w.val;
+		}
+		else
+		{
+			Line l;
+			l.isKey = true;
+			l.removed = false;
+			l.key = _w.key;
+			l.value = _w.val;
+
+			// insert before trailing empty lines, if any
+			size_t pos = sec.lines.size();
+			while (pos > 0 && !sec.lines[pos-1].isKey && sec.lines[pos-1].key.empty())
+				pos--;
+			sec.lines.insert(sec.lines.begin()+pos, l);
+			if (pos == sec.lines.size()-1) sec.keys.insert(std::make_pair(id, pos));
+			else sec.Reindex();
+		}
+	}
+
+	std::string m_fn;
+	bool m_loaded, m_bom;
+	time_t m_mtime;
+	long long m_size; // -1: no file
+	DWORD m_lastStat;
+	std::string m_content; // file content as last read/written
+	vector<Section> m_sections; // m_sections[0]: lines before the 1st section
+	std::unordered_map<std::string,size_t> m_sectionIds; // lower case name -> index in m_sections
+	vector<PendingWrite> m_pending;
+};
+
+static void DeleteIniFile(SNM_IniFile* _f) { delete _f; }
+static WDL_StringKeyedArray<SNM_IniFile*> s_iniFiles(true, DeleteIniFile);
+static WDL_Mutex s_iniFilesMutex;
+
+static SNM_IniFile* GetIniFile(const char* _iniFn)
+{
+	SNM_IniFile* f = s_iniFiles.Get(_iniFn, NULL);
+	if (!f)
+	{
+		// e.g. preset files are read once in a while: don't keep them all around
+		if (s_iniFiles.GetSize() >= SNM_MAX_INI_FILES)
+			for (int i=s_iniFiles.GetSize()-1; i>=0; i--)
+			{
+				const char* fn = NULL;
+				SNM_IniFile* cached = s_iniFiles.Enumerate(i, &fn);
+				if (cached && !cached->HasPendingWrites() && _stricmp(fn, g_SNM_IniFn.Get()))
+					s_iniFiles.DeleteByIndex(i);
+			}
+
+		f = new SNM_IniFile(_iniFn);
+		s_iniFiles.Insert(_iniFn, f);
+	}
+	return f;
+}
+
+// same as GetPrivateProfileString(), served from memory
+int SNM_GetIniString(const char* _sec, const char* _key, const char* _def, char* _buf, int _bufSz, const char* _iniFn)
+{
+	if (!_buf || _bufSz <= 0)
+		return 0;
+
+	std::string val;
+	bool found = false;
+	if (_sec && _key && _iniFn && *_iniFn)
+	{
+		WDL_MutexLock lock(&s_iniFilesMutex);
+		found = GetIniFile(_iniFn)->Get(_sec, _key, &val);
+	}
+	lstrcpyn(_buf, found ? val.c_str() : (_def ? _def : ""), _bufSz);
+	return (int)strlen(_buf);
+}
+
+// same as GetPrivateProfileInt(), served from memory
+int SNM_GetIniInt(const char* _sec, const char* _key, int _def, const char* _iniFn)
+{
+	std::string val;
+	if (_sec && _key && _iniFn && *_iniFn)
+	{
+		WDL_MutexLock lock(&s_iniFilesMutex);
+		if (GetIniFile(_iniFn)->Get(_sec, _key, &val))
+			return atoi(val.c_str());
+	}
+	return _def;
+}
+
+// same as WritePrivateProfileString() but buffered, see SNM_FlushIniFile()
+// _key == NULL: removes the section, _val == NULL: removes the key
+void SNM_SetIniString(const char* _sec, const char* _key, const char* _val, const char* _iniFn)
+{
+	if (_sec && _iniFn && *_iniFn)
+	{
+		WDL_MutexLock lock(&s_iniFilesMutex);
+		GetIniFile(_iniFn)->Set(_sec, _key, _val);
+	}
+}
+
+// to be called after _iniFn has been written with WritePrivateProfile*()
+// (external changes are only looked for once per SNM_INI_STAT_DELAY)
+static void InvalidateIniFile(const char* _iniFn)
+{
+	WDL_MutexLock lock(&s_iniFilesMutex);
+	if (SNM_IniFile* f = s_iniFiles.Get(_iniFn, NULL))
+		f->Invalidate();
+}
+
+// writes pending changes, _iniFn == NULL: flush all files
+bool SNM_FlushIniFile(const char* _iniFn)
+{
+	WDL_MutexLock lock(&s_iniFilesMutex);
+	if (_iniFn)
+	{
+		SNM_IniFile* f = s_iniFiles.Get(_iniFn, NULL);
+		return !f || f->Flush();
+	}
+
+	bool ok = true;
+	for (int i=0; i<s_iniFiles.GetSize(); i++)
+		if (SNM_IniFile* f = s_iniFiles.Enumerate(i))
+			ok = f->Flush() && ok;
+	return ok;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Ini file helpers
 ///////////////////////////////////////////////////////////////////////////////
@@ -558,7 +1014,9 @@ bool SaveIniSection(const char* _iniSectionName, const std::string& _iniSection,
 		return false;
 
 	WritePrivateProfileStruct(_iniSectionName, nullptr, nullptr, 0, _iniFn); // flush section
-	return WritePrivateProfileSection(_iniSectionName, _iniSection.c_str(), _iniFn);
+	const bool ok = !!WritePrivateProfileSection(_iniSectionName, _iniSection.c_str(), _iniFn);
+	InvalidateIniFile(_iniFn);
+	return ok;
 }
 
 void UpdatePrivateProfileSection(const char* _oldAppName, const char* _newAppName, const char* _iniFn, const char* _newIniFn)
@@ -568,6 +1026,9 @@ void UpdatePrivateProfileSection(const char* _oldAppName, const char* _newAppNam
 	WritePrivateProfileStruct(_oldAppName, NULL, NULL, 0, _iniFn); // flush section
 	if (sectionSz)
 		WritePrivateProfileSection(_newAppName, buf, _newIniFn ? _newIniFn : _iniFn);
+	InvalidateIniFile(_iniFn);
+	if (_newIniFn)
+		InvalidateIniFile(_newIniFn);
 }
 
 void UpdatePrivateProfileString(const char* _appName, const char* _oldKey, const char* _newKey, const char* _iniFn, const char* _newIniFn)
@@ -577,6 +1038,9 @@ void UpdatePrivateProfileString(const char* _appName, const char* _oldKey, const
 	WritePrivateProfileString(_appName, _oldKey, NULL, _iniFn); // remove key
 	if (*buf)
 		WritePrivateProfileString(_appName, _newKey, buf, _newIniFn ? _newIniFn : _iniFn);
+	InvalidateIniFile(_iniFn);
+	if (_newIniFn)
+		InvalidateIniFile(_newIniFn);
 }
 
 void SNM_UpgradeIniFiles(int _iniVersion)
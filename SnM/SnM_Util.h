@@ -64,6 +64,10 @@ void ExtensionConfigToString(WDL_FastString* _str, ProjectStateContext* _ctx);
 bool SaveIniSection(const char* _iniSectionName, const std::string& _iniSection, const char* _iniFn);
 void UpdatePrivateProfileSection(const char* _oldAppName, const char* _newAppName, const char* _iniFn, const char* _newIniFn = NULL);
 void UpdatePrivateProfileString(const char* _appName, const char* _oldKey, const char* _newKey, const char* _iniFn, const char* _newIniFn = NULL);
+int SNM_GetIniString(const char* _sec, const char* _key, const char* _def, char* _buf, int _bufSz, const char* _iniFn);
+int SNM_GetIniInt(const char* _sec, const char* _key, int _def, const char* _iniFn);
+void SNM_SetIniString(const char* _sec, const char* _key, const char* _val, const char* _iniFn);
+bool SNM_FlushIniFile(const char* _iniFn = NULL);
 void SNM_UpgradeIniFiles(int _iniVersion);
 
 int snprintfStrict(char* _buf, size_t _n, const char* _fmt, ...);
@@ -0,0 +1,262 @@
+/******************************************************************************
+/ SnapshotBlobs.cpp
+/
+/ Copyright (c) 2023 ReaTeam
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/ 
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/ 
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+
+#include "stdafx.h"
+
+#include "../Utility/Base64.h"
+#include "SnapshotBlobs.h"
+
+#include <WDL/zlib/zlib.h>
+
+#define BLOB_BYTES_PER_LINE 48 // multiple of 3: no base64 padding in between lines
+
+static WDL_StringKeyedArray<SnapshotBlob*> g_blobs;
+static bool g_bCompress = false;
+
+bool SnapshotBlobsCompressed()
+{
+	return g_bCompress;
+}
+
+void SetSnapshotBlobsCompressed(bool bCompress)
+{
+	g_bCompress = bCompress;
+}
+
+// hash: hex SHA-1, WDL_SHA1SIZE*2+1 chars
+static void HashData(const char* data, int len, char* hash)
+{
+	unsigned char digest[WDL_SHA1SIZE];
+	WDL_SHA1 sha;
+	sha.add(data, len);
+	sha.result(digest);
+	for (int i = 0; i < WDL_SHA1SIZE; i++)
+		snprintf(hash + i*2, 3, "%02x", digest[i]);
+}
+
+SnapshotBlob::SnapshotBlob(const char* hash, int len)
+:m_iSaveStamp(0),m_iLen(len),m_iRefs(0),m_bResolved(false)
+{
+	lstrcpyn(m_cHash, hash, sizeof(m_cHash));
+}
+
+// Returns the shared blob for data, creating it if needed
+SnapshotBlob* SnapshotBlob::Get(const char* data, int len)
+{
+	if (!data || len <= 0)
+		return NULL;
+
+	char hash[WDL_SHA1SIZE*2+1];
+	HashData(data, len, hash);
+
+	SnapshotBlob* blob = g_blobs.Get(hash, NULL);
+	if (!blob)
+	{
+		blob = new SnapshotBlob(hash, len);
+		g_blobs.Insert(hash, blob);
+	}
+	if (!blob->m_bResolved || !blob->m_data.GetLength())
+	{
+		// We already have the data, no need to unpack it later
+		blob->m_data.Set(data, len);
+		blob->m_iLen = len;
+		blob->m_bResolved = true;
+	}
+	return blob;
+}
+
+SnapshotBlob* SnapshotBlob::Find(const char* hash)
+{
+	return g_blobs.Get(hash, NULL);
+}
+
+// Build a blob from a <SWSBLOBS chunk, or returns the existing one
+// Packed data is not decompressed until needed
+SnapshotBlob* SnapshotBlob::FromChunk(const char* chunk)
+{
+	const char* body = strchr(chunk, '\n');
+	if (!body)
+		return NULL;
+	body++;
+
+	LineParser lp(false);
+	WDL_FastString firstLine;
+	firstLine.Set(chunk, (int)(body - chunk - 1));
+	if (lp.parse(firstLine.Get()) || lp.getnumtokens() < 3 || strcmp(lp.gettoken_str(0), "<SWSBLOBS"))
+		return NULL;
+
+	const char* hash = lp.gettoken_str(1);
+	const int len = lp.gettoken_int(2);
+	const bool bPacked = lp.getnumtokens() > 3 && !strcmp(lp.gettoken_str(3), "Z");
+	if (SnapshotBlob* blob = Find(hash))
+		return blob;
+	if (len <= 0 || strlen(hash) != WDL_SHA1SIZE*2)
+		return NULL;
+
+	// Body ends before the closing ">" line
+	const char* bodyEnd = strrchr(body, '>');
+	if (!bodyEnd)
+		return NULL;
+
+	SnapshotBlob* blob = new SnapshotBlob(hash, len);
+	if (bPacked)
+	{
+		// decode the base64 lines straight into the packed buffer
+		const int iMaxLen = Base64::MaxDecodedLength((int)(bodyEnd - body));
+		char* packed = (char*)blob->m_packed.Resize(iMaxLen, false);
+		Base64::Decoder decoder;
+		int iPackedLen = packed ? decoder.Feed(body, (int)(bodyEnd - body), packed, iMaxLen) : -1;
+		if (iPackedLen >= 0)
+		{
+			const int n = decoder.Finish(packed + iPackedLen, iMaxLen - iPackedLen);
+			iPackedLen = n < 0 ? -1 : iPackedLen + n;
+		}
+		if (iPackedLen <= 0)
+		{
+			delete blob;
+			return NULL;
+		}
+		blob->m_packed.Resize(iPackedLen);
+	}
+	else
+	{
+		// GetChunk() adds a newline if the data doesn't end with one
+		int iBodyLen = (int)(bodyEnd - body);
+		if (iBodyLen == len + 1 && body[len] == '\n')
+			iBodyLen = len;
+
+		char bodyHash[WDL_SHA1SIZE*2+1] = "";
+		if (iBodyLen == len)
+			HashData(body, len, bodyHash);
+		if (_stricmp(bodyHash, hash)) // also rejects length mismatches
+		{
+			delete blob;
+			return NULL;
+		}
+		blob->m_data.Set(body, len);
+		blob->m_bResolved = true;
+	}
+	g_blobs.Insert(blob->m_cHash, blob);
+	return blob;
+}
+
+void SnapshotBlob::Release()
+{
+	if (--m_iRefs <= 0)
+	{
+		g_blobs.Delete(m_cHash);
+		delete this;
+	}
+}
+
+bool SnapshotBlob::Resolve()
+{
+	if (m_bResolved)
+		return true;
+	m_bResolved = true;
+
+	// Reject data that doesn't match the length and hash it was saved with
+	WDL_HeapBuf buf;
+	uLongf len = m_iLen;
+	bool ok = m_iLen > 0 && buf.Resize(m_iLen, false) &&
+		uncompress((Bytef*)buf.Get(), &len, (const Bytef*)m_packed.Get(), (uLong)m_packed.GetSize()) == Z_OK &&
+		(int)len == m_iLen;
+	if (ok)
+	{
+		char hash[WDL_SHA1SIZE*2+1];
+		HashData((const char*)buf.Get(), m_iLen, hash);
+		ok = !_stricmp(hash, m_cHash);
+	}
+	if (!ok)
+	{
+		m_iLen = 0;
+		m_data.Set("");
+		return false;
+	}
+	m_data.Set((const char*)buf.Get(), m_iLen);
+	return true;
+}
+
+const char* SnapshotBlob::GetData()
+{
+	Resolve();
+	return m_data.Get();
+}
+
+// Only append, don't overwrite the chunk string
+void SnapshotBlob::GetChunk(WDL_FastString* chunk, bool bCompress)
+{
+	if (bCompress && !m_packed.GetSize() && Resolve())
+	{
+		uLongf len = compressBound(m_iLen);
+		if (m_packed.Resize((int)len, false) &&
+			compress2((Bytef*)m_packed.Get(), &len, (const Bytef*)m_data.Get(), m_iLen, Z_BEST_SPEED) == Z_OK)
+			m_packed.Resize((int)len);
+		else
+			m_packed.Resize(0);
+	}
+
+	if (bCompress && m_packed.GetSize())
+	{
+		chunk->AppendFormatted(SNM_MAX_CHUNK_LINE_LENGTH, "<SWSBLOBS %s %d Z\n", m_cHash, m_iLen);
+		Base64::AppendLines(chunk, (const char*)m_packed.Get(), m_packed.GetSize(), BLOB_BYTES_PER_LINE);
+	}
+	else
+	{
+		chunk->AppendFormatted(SNM_MAX_CHUNK_LINE_LENGTH, "<SWSBLOBS %s %d\n", m_cHash, m_iLen);
+		chunk->Append(GetData());
+		if (m_iLen && m_data.Get()[m_iLen-1] != '\n')
+			chunk->Append("\n");
+	}
+	chunk->Append(">\n");
+}
+
+void SnapshotBlobRef::Set(const char* str, int len)
+{
+	if (len < 0)
+		len = str ? (int)strlen(str) : 0;
+	SetBlob(SnapshotBlob::Get(str, len));
+}
+
+void SnapshotBlobRef::SetBlob(SnapshotBlob* blob)
+{
+	if (blob)
+		blob->AddRef();
+	if (m_blob)
+		m_blob->Release();
+	m_blob = blob;
+	m_bMissing = false;
+}
+
+// Unpacks the data if needed, returns false if the referenced blob is missing or
+// could not be unpacked: recalls must then leave the current data as it is
+bool SnapshotBlobRef::Resolve()
+{
+	if (!m_blob)
+		return !m_bMissing;
+	m_blob->GetData();
+	return m_blob->GetLength() > 0;
+}
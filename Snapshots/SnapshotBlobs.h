@@ -0,0 +1,88 @@
+/******************************************************************************
+/ SnapshotBlobs.h
+/
+/ Copyright (c) 2023 ReaTeam
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/ 
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/ 
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+
+#pragma once
+
+#include <WDL/sha.h>
+
+// Content-addressed storage for the large parts of track snapshots (FX chains
+// and envelopes). Identical data is stored once, keyed by its SHA-1, and shared
+// by all the snapshots referencing it. Blobs loaded from projects are kept
+// packed (optionally compressed) until they're needed by a recall.
+class SnapshotBlob
+{
+public:
+	static SnapshotBlob* Get(const char* data, int len);
+	static SnapshotBlob* Find(const char* hash);
+	static SnapshotBlob* FromChunk(const char* chunk);
+
+	void AddRef() { m_iRefs++; }
+	void Release();
+
+	const char* GetData(); // resolves packed data if needed
+	int GetLength() const { return m_iLen; }
+	const char* GetHash() const { return m_cHash; }
+	void GetChunk(WDL_FastString* chunk, bool bCompress);
+
+	int m_iSaveStamp; // avoids writing shared blobs more than once per project save
+
+private:
+	SnapshotBlob(const char* hash, int len);
+	~SnapshotBlob() {}
+	bool Resolve();
+
+	char m_cHash[WDL_SHA1SIZE*2+1];
+	int m_iLen;
+	int m_iRefs;
+	WDL_FastString m_data;
+	WDL_HeapBuf m_packed; // zlib-compressed data, if any
+	bool m_bResolved;
+};
+
+// Drop-in replacement for the WDL_FastString members of TrackSnapshot
+class SnapshotBlobRef
+{
+public:
+	SnapshotBlobRef() : m_blob(NULL), m_bMissing(false) {}
+	SnapshotBlobRef(const SnapshotBlobRef& ref) : m_blob(ref.m_blob), m_bMissing(ref.m_bMissing) { if (m_blob) m_blob->AddRef(); }
+	~SnapshotBlobRef() { if (m_blob) m_blob->Release(); }
+	SnapshotBlobRef& operator=(const SnapshotBlobRef& ref) { SetBlob(ref.m_blob); m_bMissing = ref.m_bMissing; return *this; }
+
+	void Set(const char* str, int len = -1);
+	void SetBlob(SnapshotBlob* blob);
+	void SetMissing() { SetBlob(NULL); m_bMissing = true; } // referenced blob not found
+	bool Resolve();
+	const char* Get() const { return m_blob ? m_blob->GetData() : ""; }
+	int GetLength() const { return m_blob ? m_blob->GetLength() : 0; }
+	SnapshotBlob* GetBlob() const { return m_blob; }
+
+private:
+	SnapshotBlob* m_blob;
+	bool m_bMissing;
+};
+
+bool SnapshotBlobsCompressed();
+void SetSnapshotBlobsCompressed(bool bCompress);
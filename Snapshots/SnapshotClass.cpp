@@ -35,6 +35,60 @@
 #include <WDL/projectcontext.h>
 #include <WDL/localize/localize.h>
 
+// "Std" track envelopes stored in snapshots, as found in track state chunks
+// JFB note: localized env names are retrieved in GetSetEnvelope()
+static const struct SnapshotEnv
+{
+	int mask;
+	const char* keyword;
+	const char* name;
+	SnapshotBlobRef TrackSnapshot::* str;
+} g_snapshotEnvs[] = {
+	{ VOL_MASK,  "<VOLENV",    "Volume (Pre-FX)", &TrackSnapshot::m_sVolEnv    },
+	{ VOL_MASK,  "<VOLENV2",   "Volume",          &TrackSnapshot::m_sVolEnv2   },
+	{ PAN_MASK,  "<PANENV",    "Pan (Pre-FX)",    &TrackSnapshot::m_sPanEnv    },
+	{ PAN_MASK,  "<PANENV2",   "Pan",             &TrackSnapshot::m_sPanEnv2   },
+	{ PAN_MASK,  "<WIDTHENV",  "Width (Pre-FX)",  &TrackSnapshot::m_sWidthEnv  },
+	{ PAN_MASK,  "<WIDTHENV2", "Width",           &TrackSnapshot::m_sWidthEnv2 },
+	{ MUTE_MASK, "<MUTEENV",   "Mute",            &TrackSnapshot::m_sMuteEnv   },
+};
+#define NUM_SNAPSHOT_ENVS ((int)(sizeof(g_snapshotEnvs) / sizeof(SnapshotEnv)))
+
+// Returns the g_snapshotEnvs index of the sub-chunk starting at line, or -1
+static int FindSnapshotEnv(const char* line)
+{
+	for (int i = 0; i < NUM_SNAPSHOT_ENVS; i++)
+	{
+		const int len = (int)strlen(g_snapshotEnvs[i].keyword);
+		if (!strncmp(line, g_snapshotEnvs[i].keyword, len) && (!line[len] || line[len] == '\n' || line[len] == ' ' || line[len] == '\r'))
+			return i;
+	}
+	return -1;
+}
+
+// Returns a pointer past the end of the line (i.e. past its '\n', if any)
+static const char* NextChunkLine(const char* p)
+{
+	const char* eol = strchr(p, '\n');
+	return eol ? eol + 1 : p + strlen(p);
+}
+
+// Returns a pointer past the end of the sub-chunk opened by the line at p
+static const char* SkipSubChunk(const char* p)
+{
+	int iDepth = 0;
+	do
+	{
+		if (*p == '<')
+			iDepth++;
+		else if (*p == '>')
+			iDepth--;
+		p = NextChunkLine(p);
+	}
+	while (iDepth > 0 && *p);
+	return p;
+}
+
 FXSnapshot::FXSnapshot(MediaTrack* tr, int fx)
 {
 	m_iCurParam = 0;
@@ -91,36 +145,24 @@ FXSnapshot::~FXSnapshot()
 void FXSnapshot::GetChunk(WDL_FastString *chunk)
 {
 	chunk->AppendFormatted(SNM_MAX_CHUNK_LINE_LENGTH, "<FX \"%s\" %d\n", m_cName, m_iNumParams);
-	int iDoublesLeft = m_iNumParams;
-	int iLine = 0;
-	Base64 b64;
-	while (iDoublesLeft)
-	{
-		int iDoubles = iDoublesLeft;
-		if (iDoublesLeft >= DOUBLES_PER_LINE)
-			iDoubles = DOUBLES_PER_LINE;
-		chunk->AppendFormatted(SNM_MAX_CHUNK_LINE_LENGTH, "%s", b64.Encode((char*)(&m_dParams[iLine*DOUBLES_PER_LINE]), iDoubles * sizeof(double)));
-		chunk->Append("\n");
-
-		iDoublesLeft -= iDoubles;
-		if (iDoublesLeft < 0)
-			iDoublesLeft = 0;
-	}
+	Base64::AppendLines(chunk, (const char*)m_dParams, m_iNumParams * sizeof(double), DOUBLES_PER_LINE * sizeof(double));
 	chunk->Append(">\n");
 }
 
 void FXSnapshot::RestoreParams(const char* str)
 {
-	Base64 b64;
-	int iLen;
-	double* newDoubles = (double*)b64.Decode(str, &iLen);
-	iLen /= sizeof(double);
-	// Do nothing if there's an issue
-	if (iLen == 0 || iLen > m_iNumParams - m_iCurParam)
+	// Do nothing if there's an issue (params are left untouched)
+	const int iStrLen = (int)strlen(str);
+	const int iMaxLen = Base64::MaxDecodedLength(iStrLen);
+	WDL_TypedBuf<char> buf;
+	char* pBuf = buf.ResizeOK(iMaxLen, false);
+	const int iLen = pBuf ? Base64::DecodeTo(str, iStrLen, pBuf, iMaxLen) : -1;
+	const int iDoubles = iLen / (int)sizeof(double);
+	if (iDoubles <= 0 || iDoubles > m_iNumParams - m_iCurParam)
 		return;
 
-	for (int i = 0; i < iLen; i++)
-		m_dParams[m_iCurParam++] = newDoubles[i];
+	memcpy(&m_dParams[m_iCurParam], pBuf, iDoubles * sizeof(double));
+	m_iCurParam += iDoubles;
 }
 
 int FXSnapshot::UpdateReaper(MediaTrack* tr, bool* bMatched, int num)
@@ -199,24 +241,14 @@ TrackSnapshot::TrackSnapshot(MediaTrack* tr, int mask)
 
 	// and the full FX chain
 	if (mask & FXCHAIN_MASK)
-		GetFXChain(tr, &m_sFXChain);
-	
-	// Get the "std" envelopes
-	// JFB note: localized env names are retrieved in GetSetEnvelope()
-	if (mask & VOL_MASK)
 	{
-		GetSetEnvelope(tr, &m_sVolEnv, "Volume (Pre-FX)", false);
-		GetSetEnvelope(tr, &m_sVolEnv2, "Volume", false);
+		WDL_TypedBuf<char> fxChain;
+		GetFXChain(tr, &fxChain);
+		m_sFXChain.Set(fxChain.Get(), fxChain.GetSize() ? (int)strlen(fxChain.Get()) : 0);
 	}
-	if (mask & PAN_MASK)
-	{
-		GetSetEnvelope(tr, &m_sPanEnv, "Pan (Pre-FX)", false);
-		GetSetEnvelope(tr, &m_sPanEnv2, "Pan", false);
-		GetSetEnvelope(tr, &m_sWidthEnv, "Width (Pre-FX)", false);
-		GetSetEnvelope(tr, &m_sWidthEnv2, "Width", false);
-	}
-	if (mask & MUTE_MASK)
-		GetSetEnvelope(tr, &m_sMuteEnv, "Mute", false);
+	
+	// Get the "std" envelopes
+	GetEnvelopes(tr, mask);
 }
 
 // "Copy" constructor with mask large items don't get copied too
@@ -232,11 +264,7 @@ TrackSnapshot::TrackSnapshot(TrackSnapshot& ts):m_sends(ts.m_sends)
 	m_iSel            = ts.m_iSel;
 	for (int i = 0; i < ts.m_fx.GetSize(); i++)
 		m_fx.Add(new FXSnapshot(*ts.m_fx.Get(i)));
-	if (ts.m_sFXChain.GetSize())
-	{
-		m_sFXChain.Resize(ts.m_sFXChain.GetSize());
-		memcpy(m_sFXChain.Get(), ts.m_sFXChain.Get(), m_sFXChain.GetSize());
-	}
+	m_sFXChain        = ts.m_sFXChain;
 	m_sName.Set(ts.m_sName.Get());
 	m_iTrackNum       = ts.m_iTrackNum;
 	m_iPanMode        = ts.m_iPanMode;
@@ -303,8 +331,6 @@ bool TrackSnapshot::UpdateReaper(int mask, bool bSelOnly, int* fxErr, bool wantC
 	if (mask & VOL_MASK)
 	{
 		GetSetMediaTrackInfo(tr, "D_VOL", &m_dVol);
-		GetSetEnvelope(tr, &m_sVolEnv, "Volume (Pre-FX)", true);
-		GetSetEnvelope(tr, &m_sVolEnv2, "Volume", true);
 	}
 	if (mask & PAN_MASK)
 	{
@@ -315,16 +341,9 @@ bool TrackSnapshot::UpdateReaper(int mask, bool bSelOnly, int* fxErr, bool wantC
 		GetSetMediaTrackInfo(tr, "D_DUALPANR", &m_dPanR);
 		if (m_dPanLaw != -100.0)
 			GetSetMediaTrackInfo(tr, "D_PANLAW", &m_dPanLaw);
-		GetSetEnvelope(tr, &m_sPanEnv, "Pan (Pre-FX)", true);
-		GetSetEnvelope(tr, &m_sPanEnv2, "Pan", true);
-		GetSetEnvelope(tr, &m_sWidthEnv, "Width (Pre-FX)", true);
-		GetSetEnvelope(tr, &m_sWidthEnv2, "Width", true);
 	}
 	if (mask & MUTE_MASK)
-	{
 		GetSetMediaTrackInfo(tr, "B_MUTE", &m_bMute);
-		GetSetEnvelope(tr, &m_sMuteEnv, "Mute", true);
-	}
 	if (mask & SOLO_MASK)
 		GetSetMediaTrackInfo(tr, "I_SOLO", &m_iSolo);
 	if (mask & VIS_MASK)
@@ -352,10 +371,20 @@ bool TrackSnapshot::UpdateReaper(int mask, bool bSelOnly, int* fxErr, bool wantC
 		else
 			*fxErr += m_fx.GetSize();
 	}
+	// All envelopes are merged into the track chunk at once (cached by the caller)
+	if (wantChunk)
+		SetEnvelopes(tr, mask);
 	if (mask & FXCHAIN_MASK)
 	{
 		GetSetMediaTrackInfo(tr, "I_FXEN", &m_iFXEn);
-		if (wantChunk) SetFXChain(tr, m_sFXChain.Get());
+		if (wantChunk)
+		{
+			// an unresolved shared FX chain must not clear the track's FX
+			if (m_sFXChain.Resolve())
+				SetFXChain(tr, m_sFXChain.GetLength() ? m_sFXChain.Get() : NULL);
+			else
+				(*fxErr)++;
+		}
 	}
 	if (mask & SENDS_MASK)
 	{
@@ -393,7 +422,9 @@ bool TrackSnapshot::Cleanup()
 }
 
 // Only append, don't overwrite the chunk string
-void TrackSnapshot::GetChunk(WDL_FastString* chunk)
+// bBlobRefs: reference the FX chain and envelopes rather than inlining them,
+//            the blobs must be written beforehand (see GetBlobs())
+void TrackSnapshot::GetChunk(WDL_FastString* chunk, bool bBlobRefs)
 {
 	char guidStr[64];
 	guidToString(&m_guid, guidStr);
@@ -404,7 +435,19 @@ void TrackSnapshot::GetChunk(WDL_FastString* chunk)
 	m_sends.GetChunk(chunk);
 	for (int i = 0; i < m_fx.GetSize(); i++)
 		m_fx.Get(i)->GetChunk(chunk);
-	if (m_sFXChain.GetSize())
+
+	if (bBlobRefs)
+	{
+		if (m_sFXChain.GetLength())
+			chunk->AppendFormatted(SNM_MAX_CHUNK_LINE_LENGTH, "FXCHAINREF %s\n", m_sFXChain.GetBlob()->GetHash());
+		for (int i = 0; i < NUM_SNAPSHOT_ENVS; i++)
+			if (SnapshotBlob* blob = (this->*g_snapshotEnvs[i].str).GetBlob())
+				chunk->AppendFormatted(SNM_MAX_CHUNK_LINE_LENGTH, "ENVREF %s %s\n", g_snapshotEnvs[i].keyword + 1, blob->GetHash());
+		chunk->Append(">\n");
+		return;
+	}
+
+	if (m_sFXChain.GetLength())
 		chunk->Append(m_sFXChain.Get());
 	if (m_sVolEnv.GetLength())
 		chunk->Append(m_sVolEnv.Get());
@@ -423,6 +466,22 @@ void TrackSnapshot::GetChunk(WDL_FastString* chunk)
 	chunk->Append(">\n");
 }
 
+// Append the blobs referenced by this track snapshot that were not written yet
+void TrackSnapshot::GetBlobs(WDL_FastString* chunk, int iSaveStamp, bool bCompress)
+{
+	SnapshotBlob* blobs[NUM_SNAPSHOT_ENVS+1];
+	blobs[0] = m_sFXChain.GetBlob();
+	for (int i = 0; i < NUM_SNAPSHOT_ENVS; i++)
+		blobs[i+1] = (this->*g_snapshotEnvs[i].str).GetBlob();
+
+	for (int i = 0; i < NUM_SNAPSHOT_ENVS+1; i++)
+		if (blobs[i] && blobs[i]->m_iSaveStamp != iSaveStamp)
+		{
+			blobs[i]->m_iSaveStamp = iSaveStamp;
+			blobs[i]->GetChunk(chunk, bCompress);
+		}
+}
+
 void TrackSnapshot::GetDetails(WDL_FastString* details, int iMask)
 {
 	MediaTrack* tr = GuidToTrack(&m_guid);
@@ -556,7 +615,7 @@ void TrackSnapshot::GetDetails(WDL_FastString* details, int iMask)
 		details->Append(m_iFXEn ? __LOCALIZE("on","sws_DLG_101") : __LOCALIZE("off","sws_DLG_101"));
 		details->Append("\r\n");
 
-		if (!m_sFXChain.GetSize())
+		if (!m_sFXChain.GetLength())
 		{
 			details->Append(__LOCALIZE("Empty FX chain","sws_DLG_101"));
 			details->Append("\r\n");
@@ -691,21 +750,180 @@ void TrackSnapshot::GetSetEnvelope(MediaTrack* tr, WDL_FastString* str, const ch
 	}
 }
 
-bool TrackSnapshot::ProcessEnv(const char* chunk, char* line, int iLineMax, int* pos, const char* env, WDL_FastString* str)
+// Extract all the "std" envelopes in a single pass over the track chunk,
+// rather than one GetSetEnvelopeState() call per envelope
+void TrackSnapshot::GetEnvelopes(MediaTrack* tr, int mask)
+{
+	for (int i = 0; i < NUM_SNAPSHOT_ENVS; i++)
+		(this->*g_snapshotEnvs[i].str).Set("");
+
+	if (!(mask & (VOL_MASK | PAN_MASK | MUTE_MASK)))
+		return;
+
+	// Master envelopes are not part of the master track chunk
+	if (tr == GetMasterTrack(NULL))
+	{
+		for (int i = 0; i < NUM_SNAPSHOT_ENVS; i++)
+			if (mask & g_snapshotEnvs[i].mask)
+			{
+				WDL_FastString env;
+				GetSetEnvelope(tr, &env, g_snapshotEnvs[i].name, false);
+				(this->*g_snapshotEnvs[i].str).Set(env.Get(), env.GetLength());
+			}
+		return;
+	}
+
+	const char* chunk = SWS_GetSetObjectState(tr, NULL);
+	if (!chunk)
+		return;
+
+	int iDepth = 0;
+	const char* p = chunk;
+	while (*p)
+	{
+		if (*p == '<')
+		{
+			int env;
+			if (iDepth == 1 && (env = FindSnapshotEnv(p)) >= 0 && (mask & g_snapshotEnvs[env].mask))
+			{
+				const char* pEnd = SkipSubChunk(p);
+				(this->*g_snapshotEnvs[env].str).Set(p, (int)(pEnd - p));
+				p = pEnd;
+				continue;
+			}
+			iDepth++;
+		}
+		else if (*p == '>')
+			iDepth--;
+		p = NextChunkLine(p);
+	}
+	SWS_FreeHeapPtr(chunk);
+}
+
+// Merge all the stored "std" envelopes into the track chunk, in a single
+// read/write of the track state. Empty envelopes leave the current ones as-is.
+void TrackSnapshot::SetEnvelopes(MediaTrack* tr, int mask)
+{
+	bool bWanted[NUM_SNAPSHOT_ENVS];
+	bool bAny = false;
+	for (int i = 0; i < NUM_SNAPSHOT_ENVS; i++)
+	{
+		// unresolved shared envelopes leave the current ones as-is too
+		bWanted[i] = (mask & g_snapshotEnvs[i].mask) && (this->*g_snapshotEnvs[i].str).Resolve() && (this->*g_snapshotEnvs[i].str).GetLength();
+		bAny |= bWanted[i];
+	}
+	if (!bAny)
+		return;
+
+	if (tr == GetMasterTrack(NULL))
+	{
+		for (int i = 0; i < NUM_SNAPSHOT_ENVS; i++)
+			if (bWanted[i])
+			{
+				WDL_FastString env;
+				env.Set((this->*g_snapshotEnvs[i].str).Get());
+				GetSetEnvelope(tr, &env, g_snapshotEnvs[i].name, true);
+			}
+		return;
+	}
+
+	const char* chunk = SWS_GetSetObjectState(tr, NULL);
+	if (!chunk)
+		return;
+
+	WDL_FastString newChunk;
+	int iDepth = 0, iInsertPos = -1;
+	const char* p = chunk;
+	while (*p)
+	{
+		const char* pNext = NextChunkLine(p);
+		if (*p == '<')
+		{
+			int env;
+			if (iDepth == 1 && (env = FindSnapshotEnv(p)) >= 0 && bWanted[env])
+			{
+				newChunk.Append((this->*g_snapshotEnvs[env].str).Get());
+				bWanted[env] = false;
+				p = SkipSubChunk(p);
+				continue;
+			}
+			// New envelopes go before the items, like REAPER does
+			if (iDepth == 1 && iInsertPos < 0 && !strncmp(p, "<ITEM", 5))
+				iInsertPos = newChunk.GetLength();
+			iDepth++;
+		}
+		else if (*p == '>')
+		{
+			if (--iDepth == 0 && iInsertPos < 0)
+				iInsertPos = newChunk.GetLength();
+		}
+		newChunk.Append(p, (int)(pNext - p));
+		p = pNext;
+	}
+
+	if (iInsertPos >= 0)
+	{
+		WDL_FastString newEnvs;
+		for (int i = 0; i < NUM_SNAPSHOT_ENVS; i++)
+			if (bWanted[i])
+				newEnvs.Append((this->*g_snapshotEnvs[i].str).Get());
+		if (newEnvs.GetLength())
+			newChunk.Insert(newEnvs.Get(), iInsertPos);
+	}
+
+	// Envelopes already as stored: do not set the state (would re-instantiate FX, etc)
+	const bool bChanged = strcmp(newChunk.Get(), chunk) != 0;
+	SWS_FreeHeapPtr(chunk);
+	if (bChanged)
+		SWS_GetSetObjectState(tr, &newChunk);
+}
+
+bool TrackSnapshot::ProcessEnv(const char* chunk, char* line, int iLineMax, int* pos, const char* env, SnapshotBlobRef* str)
 {
 	if (strcmp(env, line) == 0)
 	{
-		str->Set(line);
-		str->Append("\n");
+		WDL_FastString envStr;
+		envStr.Set(line);
+		envStr.Append("\n");
 		int iDepth = 1;
 		while (iDepth && GetChunkLine(chunk, line, iLineMax, pos, true))
 		{
-			str->Append(line);
+			envStr.Append(line);
 			if (line[0] == '<')
 				iDepth++;
 			else if (line[0] == '>')
 				iDepth--;
 		}
+		str->Set(envStr.Get(), envStr.GetLength());
+		return true;
+	}
+	return false;
+}
+
+static void SetBlobRef(SnapshotBlobRef* ref, const char* hash)
+{
+	if (SnapshotBlob* blob = SnapshotBlob::Find(hash))
+		ref->SetBlob(blob);
+	else
+		ref->SetMissing();
+}
+
+// Resolve FXCHAINREF/ENVREF lines of snapshots saved in projects, blobs are
+// loaded beforehand (see SnapshotBlob::FromChunk)
+bool TrackSnapshot::ProcessBlobRef(LineParser* lp)
+{
+	if (!strcmp("FXCHAINREF", lp->gettoken_str(0)))
+	{
+		SetBlobRef(&m_sFXChain, lp->gettoken_str(1));
+		return true;
+	}
+	else if (!strcmp("ENVREF", lp->gettoken_str(0)))
+	{
+		WDL_FastString keyword;
+		keyword.SetFormatted(64, "<%s", lp->gettoken_str(1));
+		const int env = FindSnapshotEnv(keyword.Get());
+		if (env >= 0)
+			SetBlobRef(&(this->*g_snapshotEnvs[env].str), lp->gettoken_str(2));
 		return true;
 	}
 	return false;
@@ -721,6 +939,7 @@ Snapshot::Snapshot(int slot, int mask, bool bSelOnly, const char* name, const ch
 	SetName(name);
 	SetNotes(notes);
 
+	// The cache ensures each track chunk is read only once (FX chain, envelopes, etc)
 	SWS_CacheObjectState(true);
 	for (int i = 0; i <= GetNumTracks(); i++)
 	{
@@ -839,26 +1058,23 @@ Snapshot::Snapshot(const char* chunk)
 			}
 			else if (strcmp("<FXCHAIN", lp.gettoken_str(0)) == 0) // Multiple lines
 			{
-				int iLen = (int)strlen(line);
-				ts->m_sFXChain.Resize(iLen + 2);
-				strcpy(ts->m_sFXChain.Get(), line);
-				strcpy(ts->m_sFXChain.Get()+iLen, "\n");
-				iLen++;
+				WDL_FastString fxChain;
+				fxChain.Set(line);
+				fxChain.Append("\n");
 
 				int iDepth = 1;
 				while(iDepth && GetChunkLine(chunk, line, 4096, &pos, true))
 				{
-					int iNewLen = iLen + (int)strlen(line);
-					ts->m_sFXChain.Resize(iNewLen + 1);
-					strcpy(ts->m_sFXChain.Get()+iLen, line);
-					iLen = iNewLen;
+					fxChain.Append(line);
 
 					if (line[0] == '>')
 						iDepth--;
 					else if (line[0] == '<')
 						iDepth++;
 				}
+				ts->m_sFXChain.Set(fxChain.Get(), fxChain.GetLength());
 			}
+			else if (ts->ProcessBlobRef(&lp)) {}
 			// Yuck, not too happy with the below code, but it works.
 			else if (ts->ProcessEnv(chunk, line, 4096, &pos, "<VOLENV", &ts->m_sVolEnv)) {}
 			else if (ts->ProcessEnv(chunk, line, 4096, &pos, "<VOLENV2", &ts->m_sVolEnv2)) {}
@@ -903,7 +1119,8 @@ bool Snapshot::UpdateReaper(int mask, bool bSelOnly, bool bHideNewVis)
 	for (int i = 0; i < m_tracks.GetSize(); i++)
 		m_tracks.Get(i)->UpdateReaper(mask & m_iMask, bSelOnly, &fxErr, false, &sendFixes);
 
-	// Then cache all ObjectState changes for the chunk updating
+	// Then cache all ObjectState changes for the chunk updating: envelopes, FX
+	// chains and sends of a track are all merged into a single chunk write
 	SWS_CacheObjectState(true);
 	for (int i = 0; i < m_tracks.GetSize(); i++)
 		if (m_tracks.Get(i)->UpdateReaper(mask & m_iMask, bSelOnly, &fxErr, true, &sendFixes))
@@ -1145,16 +1362,24 @@ char* Snapshot::GetTimeString(char* str, int iStrMax, bool bDate)
 }
 
 // Get chunk for writing out
-void Snapshot::GetChunk(WDL_FastString* chunk)
+// bBlobRefs: see TrackSnapshot::GetChunk(), inlined chunks are self-contained (clipboard, export)
+void Snapshot::GetChunk(WDL_FastString* chunk, bool bBlobRefs)
 {
 	WDL_FastString notes;
 	makeEscapedConfigString(m_cNotes, &notes);
 	chunk->SetFormatted(SNM_MAX_CHUNK_LINE_LENGTH, "<SWSSNAPSHOT \"%s\" %d %d %d %s\n", m_cName, m_iSlot, m_iMask, m_time, notes.Get());
 	for (int i = 0; i < m_tracks.GetSize(); i++)
-		m_tracks.Get(i)->GetChunk(chunk);
+		m_tracks.Get(i)->GetChunk(chunk, bBlobRefs);
 	chunk->Append(">\n");
 }
 
+// Append the <SWSBLOBS chunks not written yet for iSaveStamp
+void Snapshot::GetBlobs(WDL_FastString* chunk, int iSaveStamp, bool bCompress)
+{
+	for (int i = 0; i < m_tracks.GetSize(); i++)
+		m_tracks.Get(i)->GetBlobs(chunk, iSaveStamp, bCompress);
+}
+
 // Get a human-readable string that explains the snapshot
 void Snapshot::GetDetails(WDL_FastString* details)
 {
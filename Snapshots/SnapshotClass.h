@@ -27,6 +27,8 @@
 
 #pragma once
 
+#include "SnapshotBlobs.h"
+
 #define DOUBLES_PER_LINE 8
 
 class FXSnapshot
@@ -59,11 +61,15 @@ public:
 
 	bool UpdateReaper(int mask, bool bSelOnly, int* fxErr, bool wantChunk, WDL_PtrList<TrackSendFix>* pFix);
 	bool Cleanup();
-	void GetChunk(WDL_FastString* chunk);
+	void GetChunk(WDL_FastString* chunk, bool bBlobRefs = false);
+	void GetBlobs(WDL_FastString* chunk, int iSaveStamp, bool bCompress);
 	void GetDetails(WDL_FastString* details, int iMask);
+	void GetEnvelopes(MediaTrack* tr, int mask);
+	void SetEnvelopes(MediaTrack* tr, int mask);
 
 	static void GetSetEnvelope(MediaTrack* tr, WDL_FastString* str, const char* env, bool bSet);
-	static bool ProcessEnv(const char* chunk, char* line, int iLineMax, int* pos, const char* env, WDL_FastString* str);
+	static bool ProcessEnv(const char* chunk, char* line, int iLineMax, int* pos, const char* env, SnapshotBlobRef* str);
+	bool ProcessBlobRef(LineParser* lp);
 
 // TODO these should be private
 	GUID m_guid;
@@ -79,7 +85,7 @@ public:
 	int m_iPlayOffsetFlag;
 	double m_dPlayOffset;
     WDL_PtrList<FXSnapshot> m_fx;
-	WDL_TypedBuf<char> m_sFXChain;
+	SnapshotBlobRef m_sFXChain;
 	TrackSends m_sends;
 	WDL_FastString m_sName;
 	int m_iTrackNum;
@@ -91,13 +97,14 @@ public:
 	double m_dPanR;
 	double m_dPanLaw;
 	
-	WDL_FastString m_sVolEnv;
-	WDL_FastString m_sVolEnv2;
-	WDL_FastString m_sPanEnv;
-	WDL_FastString m_sPanEnv2;
-	WDL_FastString m_sWidthEnv;
-	WDL_FastString m_sWidthEnv2;
-	WDL_FastString m_sMuteEnv;
+	// FX chain and envelopes are shared with other snapshots, see SnapshotBlob
+	SnapshotBlobRef m_sVolEnv;
+	SnapshotBlobRef m_sVolEnv2;
+	SnapshotBlobRef m_sPanEnv;
+	SnapshotBlobRef m_sPanEnv2;
+	SnapshotBlobRef m_sWidthEnv;
+	SnapshotBlobRef m_sWidthEnv2;
+	SnapshotBlobRef m_sMuteEnv;
 };
 
 // Mask:
@@ -136,7 +143,8 @@ public:
 	void SelectTracks();
 	int Find(MediaTrack* tr);
 	char* GetTimeString(char* str, int iStrMax, bool bDate);
-	void GetChunk(WDL_FastString* chunk);
+	void GetChunk(WDL_FastString* chunk, bool bBlobRefs = false);
+	void GetBlobs(WDL_FastString* chunk, int iSaveStamp, bool bCompress);
 	void GetDetails(WDL_FastString* details);
 	bool IncludesSelTracks();
 
@@ -37,6 +37,7 @@
 #include <WDL/localize/localize.h>
 
 #define SNAP_OPTIONS_KEY "Snapshot Options"
+#define SNAP_COMPRESS_KEY "SnapshotsCompress"
 #define RENAME_MSG	0x10001
 #define DELETE_MSG	0x10002
 #define SAVE_MSG	0x10003
@@ -62,9 +63,10 @@ class ProjSnapshot
 {
 public:
 	WDL_PtrList<Snapshot> m_snapshots;
+	WDL_PtrList<SnapshotBlobRef> m_loadedBlobs; // keeps blobs alive until snapshots reference them
 	Snapshot* m_pCurSnapshot;
 	ProjSnapshot() : m_pCurSnapshot(NULL) {}
-	~ProjSnapshot() { m_snapshots.Empty(true); }
+	~ProjSnapshot() { m_snapshots.Empty(true); m_loadedBlobs.Empty(true); }
 };
 
 // Globals
@@ -1050,6 +1052,11 @@ void ToggleSelOnlySave(COMMAND_T*)	{ g_bSelOnly_OnSave = !g_bSelOnly_OnSave; Upd
 void ToggleSelOnlyRecall(COMMAND_T*){ g_bSelOnly_OnRecall = !g_bSelOnly_OnRecall; UpdateSnapshotsDialog(); }
 void ToggleShowForSelTracks(COMMAND_T*){ g_bShowSelOnly = !g_bShowSelOnly; UpdateSnapshotsDialog(); }
 void ToggleAppToRec(COMMAND_T*)	 { g_bApplyFilterOnRecall = !g_bApplyFilterOnRecall; UpdateSnapshotsDialog(); }
+void ToggleCompress(COMMAND_T*)
+{
+	SetSnapshotBlobsCompressed(!SnapshotBlobsCompressed());
+	WritePrivateProfileString(SWS_INI, SNAP_COMPRESS_KEY, SnapshotBlobsCompressed() ? "1" : "0", get_ini_file());
+}
 void ClearFilter(COMMAND_T*)	 { g_pSSWnd->SetFilterType(2); g_iMask = 0; UpdateSnapshotsDialog(); }
 void SaveFilter(COMMAND_T*)		 { g_iSavedMask = g_iMask; g_iSavedType = g_pSSWnd->GetFilterType(); }
 void RestoreFilter(COMMAND_T*)	 { g_pSSWnd->SetFilterType(g_iSavedType); g_iMask = g_iSavedMask; UpdateSnapshotsDialog(); }
@@ -1066,6 +1073,8 @@ int IsSnapParamEn(COMMAND_T* ct)
 		return g_bShowSelOnly;
 	else if (ct->doCommand == ToggleAppToRec)
 		return g_bApplyFilterOnRecall;
+	else if (ct->doCommand == ToggleCompress)
+		return SnapshotBlobsCompressed();
 	return false;
 }
 
@@ -1207,6 +1216,7 @@ static COMMAND_T g_commandTable[] =
 	{ { DEFACCEL, "SWS: Toggle snapshot selected only on recall" },			"SWSSNAPSHOT_SELONLYRECALL",ToggleSelOnlyRecall,	NULL, 0,			IsSnapParamEn },
 	{ { DEFACCEL, "SWS: Toggle snapshot apply filter to recall" },			"SWSSNAPSHOT_APPLYLOAD",	ToggleAppToRec,			NULL, 0,			IsSnapParamEn },
 	{ { DEFACCEL, "SWS: Toggle snapshot show only for selected tracks" },	"SWSSNAPSHOT_SHOWONLYSEL",	ToggleShowForSelTracks, NULL, 0,			IsSnapParamEn },
+	{ { DEFACCEL, "SWS: Toggle snapshot compression in project files" },	"SWSSNAPSHOT_COMPRESS",		ToggleCompress,			NULL, 0,			IsSnapParamEn },
 
 	{ { DEFACCEL, "SWS: Clear all snapshot filter options" },				"SWSSNAPSHOT_CLEARFILT", ClearFilter,    NULL, },
 	{ { DEFACCEL, "SWS: Save current snapshot filter options" },			"SWSSNAPSHOT_SAVEFILT",  SaveFilter,     NULL, },
@@ -1218,6 +1228,14 @@ static COMMAND_T g_commandTable[] =
 static bool ProcessExtensionLine(const char *line, ProjectStateContext *ctx, bool isUndo, struct project_config_extension_t *reg)
 {
 	WDL_TypedBuf<char> buf;
+	// Shared FX chains/envelopes, saved before the snapshots referencing them
+	// (not named <SWSSNAPSHOT...: older builds match section names by prefix)
+	if (GetChunkFromProjectState("<SWSBLOBS", &buf, line, ctx))
+	{
+		if (SnapshotBlob* blob = SnapshotBlob::FromChunk(buf.Get()))
+			g_ss.Get()->m_loadedBlobs.Add(new SnapshotBlobRef)->SetBlob(blob);
+		return true;
+	}
 	if (GetChunkFromProjectState("<SWSSNAPSHOT", &buf, line, ctx))
 	{
 		g_ss.Get()->m_snapshots.Add(new Snapshot(buf.Get()));
@@ -1229,12 +1247,28 @@ static bool ProcessExtensionLine(const char *line, ProjectStateContext *ctx, boo
 
 static void SaveExtensionConfig(ProjectStateContext *ctx, bool isUndo, struct project_config_extension_t *reg)
 {
+	static int s_iSaveStamp = 0;
+	s_iSaveStamp++;
+
+	// Snapshots hold their own references by now
+	g_ss.Get()->m_loadedBlobs.Empty(true);
+
+	// Write each shared FX chain/envelope once, snapshots reference them by hash
 	WDL_FastString chunk;
 	char line[4096];
+	for (int i = 0; i < g_ss.Get()->m_snapshots.GetSize(); i++)
+	{
+		chunk.Set("");
+		g_ss.Get()->m_snapshots.Get(i)->GetBlobs(&chunk, s_iSaveStamp, SnapshotBlobsCompressed());
+		int iPos = 0;
+		while(GetChunkLine(chunk.Get(), line, 4096, &iPos, false))
+			ctx->AddLine("%s",line);
+	}
+
 	for (int i = 0; i < g_ss.Get()->m_snapshots.GetSize(); i++)
 	{
 		Snapshot* ss = g_ss.Get()->m_snapshots.Get(i);
-		ss->GetChunk(&chunk);
+		ss->GetChunk(&chunk, true);
 		int iPos = 0;
 		while(GetChunkLine(chunk.Get(), line, 4096, &iPos, false))
 			ctx->AddLine("%s",line);
@@ -1244,6 +1278,7 @@ static void SaveExtensionConfig(ProjectStateContext *ctx, bool isUndo, struct pr
 static void BeginLoadProjectState(bool isUndo, struct project_config_extension_t *reg)
 {
 	DeleteAllSnapshots();
+	g_ss.Get()->m_loadedBlobs.Empty(true);
 	g_ss.Cleanup();
 	UpdateSnapshotsDialog();
 }
@@ -1275,6 +1310,8 @@ int SnapshotsInit()
 	if (nbrecall >= 0)
 		FindDynamicAction(GetSnapshot)->count = nbrecall;
 
+	SetSnapshotBlobsCompressed(GetPrivateProfileInt(SWS_INI, SNAP_COMPRESS_KEY, 0, get_ini_file()) ? true : false);
+
 	g_pSSWnd = new SWS_SnapshotsWnd;
 
 	// disable features unavailable in the running version of REAPER
@@ -0,0 +1,310 @@
+/******************************************************************************
+/ ArrangeIndex.cpp
+/
+/ Copyright (c) 2023 ReaTeam
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/ 
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/ 
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+
+#include "stdafx.h"
+
+#include "ArrangeIndex.h"
+#include "../Breeder/BR_Util.h" // TcpVis, GetMasterTcpGap
+
+#include <unordered_map>
+
+// Items of a track sorted by start as an implicit augmented interval tree
+// (same layout as https://github.com/lh3/cgranges): node i at level k is the
+// middle of [i - 2^k + 1, i + 2^k - 1] and holds the max. end of that range
+class TrackItemIndex
+{
+public:
+	struct Node
+	{
+		MediaItem* item;
+		int order; // in track
+		double start, end, maxEnd;
+	};
+
+	TrackItemIndex() : m_root(-1), m_built(false), m_missRebuilt(false) {}
+
+	bool IsBuilt() const { return m_built; }
+	bool IsMissRebuilt() const { return m_missRebuilt; }
+	void SetMissRebuilt() { m_missRebuilt = true; }
+	int Count() const { return (int)m_nodes.size(); }
+
+	void Build(MediaTrack* tr)
+	{
+		const int count = CountTrackMediaItems(tr);
+		m_nodes.resize(count);
+		for (int i = 0; i < count; i++)
+		{
+			Node& node = m_nodes[i];
+			node.item = GetTrackMediaItem(tr, i);
+			node.order = i;
+			node.start = *(double*)GetSetMediaItemInfo(node.item, "D_POSITION", NULL);
+			node.end = node.start + *(double*)GetSetMediaItemInfo(node.item, "D_LENGTH", NULL);
+		}
+		sort(m_nodes.begin(), m_nodes.end(), SortByStart);
+		m_root = Augment();
+		m_built = true;
+	}
+
+	// Nodes overlapping [start, end], bounds included
+	void Query(double start, double end, vector<const Node*>& hits) const
+	{
+		if (m_root < 0)
+			return;
+
+		const int n = (int)m_nodes.size();
+		struct { int k, x, w; } stack[64];
+		int t = 0;
+		stack[t].k = m_root, stack[t].x = (1 << m_root) - 1, stack[t++].w = 0;
+		while (t)
+		{
+			const int k = stack[--t].k, x = stack[t].x, w = stack[t].w;
+			if (k <= 3) // small subtree, scan it
+			{
+				const int i0 = x >> k << k;
+				const int i1 = min(i0 + (1 << (k + 1)) - 1, n);
+				for (int i = i0; i < i1 && m_nodes[i].start <= end; i++)
+					if (m_nodes[i].end >= start)
+						hits.push_back(&m_nodes[i]);
+			}
+			else if (w == 0) // left child first, x is revisited afterwards
+			{
+				const int y = x - (1 << (k - 1)); // can be out of range
+				stack[t].k = k, stack[t].x = x, stack[t++].w = 1;
+				if (y >= n || m_nodes[y].maxEnd >= start)
+					stack[t].k = k - 1, stack[t].x = y, stack[t++].w = 0;
+			}
+			else if (x < n && m_nodes[x].start <= end)
+			{
+				if (m_nodes[x].end >= start)
+					hits.push_back(&m_nodes[x]);
+				stack[t].k = k - 1, stack[t].x = x + (1 << (k - 1)), stack[t++].w = 0;
+			}
+		}
+	}
+
+private:
+	static bool SortByStart(const Node& a, const Node& b)
+	{
+		return a.start < b.start || (a.start == b.start && a.order < b.order);
+	}
+
+	// Returns the root level
+	int Augment()
+	{
+		const int n = (int)m_nodes.size();
+		if (!n)
+			return -1;
+
+		int lastI = 0;
+		double last = 0.0;
+		for (int i = 0; i < n; i += 2)
+			lastI = i, last = m_nodes[i].maxEnd = m_nodes[i].end;
+
+		int k = 1;
+		for (; 1 << k <= n; k++)
+		{
+			const int x = 1 << (k - 1), i0 = (x << 1) - 1, step = x << 2;
+			for (int i = i0; i < n; i += step)
+			{
+				const double el = m_nodes[i - x].maxEnd;
+				const double er = i + x < n ? m_nodes[i + x].maxEnd : last;
+				m_nodes[i].maxEnd = max(m_nodes[i].end, max(el, er));
+			}
+			lastI = (lastI >> k & 1) ? lastI - x : lastI + x;
+			if (lastI < n && m_nodes[lastI].maxEnd > last)
+				last = m_nodes[lastI].maxEnd;
+		}
+		return k - 1;
+	}
+
+	vector<Node> m_nodes;
+	int m_root;
+	bool m_built;
+	bool m_missRebuilt; // rebuilt once on a miss, indexes are dropped on state changes
+};
+
+static ReaProject* s_proj = NULL;
+static int s_stateCount = -1;
+static std::unordered_map<MediaTrack*, TrackItemIndex> s_items;
+static vector<int> s_trackTops, s_trackHeights; // by track id, 0 = master
+static int s_tracksEnd = 0;
+
+static void CheckProject()
+{
+	ReaProject* proj = EnumProjects(-1, NULL, 0);
+	const int stateCount = GetProjectStateChangeCount(proj);
+	if (proj != s_proj || stateCount != s_stateCount)
+	{
+		ArrangeIndex_Invalidate();
+		s_proj = proj;
+		s_stateCount = stateCount;
+	}
+}
+
+static bool IsStale(MediaTrack* tr, const TrackItemIndex::Node* node)
+{
+	if (!ValidatePtr2(s_proj, node->item, "MediaItem*") || GetMediaItem_Track(node->item) != tr)
+		return true;
+	const double start = *(double*)GetSetMediaItemInfo(node->item, "D_POSITION", NULL);
+	const double end = start + *(double*)GetSetMediaItemInfo(node->item, "D_LENGTH", NULL);
+	return start != node->start || end != node->end;
+}
+
+static bool SortByOrder(const TrackItemIndex::Node* a, const TrackItemIndex::Node* b)
+{
+	return a->order < b->order;
+}
+
+int ArrangeIndex_GetItems(MediaTrack* tr, double start, double end, WDL_TypedBuf<MediaItem*>* items)
+{
+	if (!items)
+		return 0;
+	items->Resize(0, false);
+	if (!tr)
+		return 0;
+
+	CheckProject();
+	TrackItemIndex& index = s_items[tr];
+	bool rebuilt = false;
+	if (!index.IsBuilt() || index.Count() != CountTrackMediaItems(tr))
+	{
+		index.Build(tr);
+		rebuilt = true;
+	}
+
+	vector<const TrackItemIndex::Node*> hits;
+	for (;;)
+	{
+		hits.clear();
+		index.Query(start, end, hits);
+
+		// items edited without notification: rebuild once, never worse than the linear scan we replace
+		bool stale = false;
+		for (size_t i = 0; !stale && i < hits.size(); i++)
+			stale = IsStale(tr, hits[i]);
+
+		// a miss can't be checked like hits (items moved into the range without notification):
+		// rebuild once per project state, repeated misses (e.g. clicks in empty areas) stay O(log n)
+		if (!stale && hits.size())
+			break;
+		if (rebuilt || (!stale && index.IsMissRebuilt()))
+			break;
+		index.Build(tr);
+		if (!stale)
+			index.SetMissRebuilt();
+		rebuilt = true;
+	}
+
+	sort(hits.begin(), hits.end(), SortByOrder);
+	for (size_t i = 0; i < hits.size(); i++)
+		items->Add(hits[i]->item);
+	return items->GetSize();
+}
+
+MediaItem* ArrangeIndex_GetItemAt(MediaTrack* tr, double pos)
+{
+	WDL_TypedBuf<MediaItem*> items;
+	return ArrangeIndex_GetItems(tr, pos, pos, &items) ? items.Get()[0] : NULL;
+}
+
+static void BuildTrackLayout()
+{
+	const int nbTracks = GetNumTracks();
+	s_trackTops.resize(nbTracks + 1);
+	s_trackHeights.resize(nbTracks + 1);
+
+	int y = 0;
+	for (int i = 0; i <= nbTracks; i++)
+	{
+		MediaTrack* tr = CSurf_TrackFromID(i, false);
+		const int h = *(int*)GetSetMediaTrackInfo(tr, "I_WNDH", NULL);
+		s_trackTops[i] = y;
+		s_trackHeights[i] = h;
+		y += h;
+		if (i == 0 && TcpVis(tr) && h != 0)
+			y += GetMasterTcpGap();
+	}
+	s_tracksEnd = y;
+}
+
+int ArrangeIndex_GetTrackAtY(int y, int vScrollPos, int* yMin, int* yMax)
+{
+	CheckProject();
+	const int nbTracks = GetNumTracks();
+	bool rebuilt = false;
+	if ((int)s_trackHeights.size() != nbTracks + 1)
+	{
+		BuildTrackLayout();
+		rebuilt = true;
+	}
+
+	for (;;)
+	{
+		// first track whose bottom is below y, as if walking tracks from the top
+		const int yAbs = y + vScrollPos;
+		int lo = 0, hi = nbTracks + 1;
+		while (lo < hi)
+		{
+			const int mid = (lo + hi) / 2;
+			if (s_trackTops[mid] + s_trackHeights[mid] > yAbs)
+				hi = mid;
+			else
+				lo = mid + 1;
+		}
+
+		// heights change without project state change (zoom, envelope lanes...): check the
+		// layout against REAPER's for the track we return (or the last one), rebuild on mismatch
+		if (!rebuilt)
+		{
+			const int id = min(lo, nbTracks);
+			MediaTrack* tr = CSurf_TrackFromID(id, false);
+			if (*(int*)GetSetMediaTrackInfo(tr, "I_WNDH", NULL) != s_trackHeights[id] ||
+				(s_trackHeights[id] && (int)GetMediaTrackInfo_Value(tr, "I_TCPY") != s_trackTops[id] - vScrollPos))
+			{
+				BuildTrackLayout();
+				rebuilt = true;
+				continue;
+			}
+		}
+
+		if (lo <= nbTracks)
+		{
+			WritePtr(yMin, s_trackTops[lo] - vScrollPos);
+			WritePtr(yMax, s_trackTops[lo] + s_trackHeights[lo] - vScrollPos);
+			return lo;
+		}
+		WritePtr(yMin, s_tracksEnd - vScrollPos);
+		WritePtr(yMax, s_tracksEnd - vScrollPos);
+		return -1;
+	}
+}
+
+void ArrangeIndex_Invalidate()
+{
+	s_items.clear();
+	s_trackTops.clear();
+	s_trackHeights.clear();
+}
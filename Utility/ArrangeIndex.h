@@ -0,0 +1,43 @@
+/******************************************************************************
+/ ArrangeIndex.h
+/
+/ Copyright (c) 2023 ReaTeam
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/ 
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/ 
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+
+#pragma once
+
+// Arrange view lookups for the current project, shared by hit tests and item selection actions.
+// Indexes are built lazily and dropped on project switch/state change (or when a track's item
+// count changes), results are always re-checked against the real items/tracks.
+// Items moved within an action before its undo point can be missed: call ArrangeIndex_Invalidate() first.
+
+// Items of tr overlapping [start, end] (bounds included) in track order, O(log n + k).
+// Stale hits or the first miss of a given project state rebuild the track's index, O(n log n)
+int ArrangeIndex_GetItems(MediaTrack* tr, double start, double end, WDL_TypedBuf<MediaItem*>* items);
+MediaItem* ArrangeIndex_GetItemAt(MediaTrack* tr, double pos); // first one in track order
+
+// Track at y (client coords) using track heights prefix sums, O(log n)
+// Returns the track id (0 = master) or -1 below the last track, yMin/yMax: track extents in client coords
+int ArrangeIndex_GetTrackAtY(int y, int vScrollPos, int* yMin, int* yMax);
+
+void ArrangeIndex_Invalidate();
@@ -30,12 +30,48 @@
 #include <string.h>
 #include "Base64.h"
 
-// This following Base64 code adapted from http://base64.sourceforge.net/b64.c
+// Table-driven codec, originally adapted from http://base64.sourceforge.net/b64.c
 // Copyright (c) 2001 Bob Trower, Trantor Standard Systems Inc.
 // Visit above link for full license info or to get original source.
-// Modified so that the '=' char returns zero for compat with other base64 systems.
+// Encoding: 12 input bits -> 2 output chars per lookup.
+// Decoding: 4 input chars -> 3 output bytes with one lookup per char in tables
+// holding pre-shifted values, invalid chars set a flag bit so that the fast path
+// has no per-char branch (padding, line breaks and errors go through the slow path).
 static const char cb64[]="ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-static const char cd64[]="|$$$}rstuvwxyz{$$$>$$$>?@ABCDEFGHIJKLMNOPQRSTUVW$$$$$$XYZ[\\]^_`abcdefghijklmnopq";
+
+#define B64_BAD 0x01000000
+
+static struct Base64Tables
+{
+	unsigned short enc[4096]; // 2 chars, in memory order
+	unsigned int dec[4][256]; // value << 18, << 12, << 6, << 0 (or B64_BAD)
+
+	Base64Tables()
+	{
+		for (int i = 0; i < 4096; i++)
+		{
+			char c[2] = { cb64[i >> 6], cb64[i & 0x3F] };
+			memcpy(&enc[i], c, 2);
+		}
+		for (int i = 0; i < 256; i++)
+			dec[0][i] = dec[1][i] = dec[2][i] = dec[3][i] = B64_BAD;
+		for (int i = 0; i < 64; i++)
+		{
+			const unsigned char c = (unsigned char)cb64[i];
+			dec[0][c] = i << 18;
+			dec[1][c] = i << 12;
+			dec[2][c] = i << 6;
+			dec[3][c] = i;
+		}
+	}
+} s_b64;
+
+static inline void EncodeTriplet(const unsigned char* in, char* out)
+{
+	const unsigned int v = (in[0] << 16) | (in[1] << 8) | in[2];
+	memcpy(out, &s_b64.enc[v >> 12], 2);
+	memcpy(out + 2, &s_b64.enc[v & 0xFFF], 2);
+}
 
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
@@ -58,124 +94,196 @@ Base64::~Base64()
 //////////////////////////////////////////////////////////////////////
 char* Base64::Encode(const char* pInput, int iInputLen, const bool pad)
 {
-	int iLen = iInputLen;
-	int iEncodedLen;
-	
-	//calculate encoded buffer size
-	if (pad)
-		iEncodedLen = static_cast<int>(4 * ceil(iLen / 3.f));
-	else
-		iEncodedLen = static_cast<int>(ceil(4 * iLen / 3.f));
-
-	// allocate:
-	if (m_pEncodedBuf != NULL)
-		free (m_pEncodedBuf);
+	const int iEncodedLen = EncodedLength(iInputLen, pad);
+	delete [] m_pEncodedBuf;
 	m_pEncodedBuf = new char[iEncodedLen + 1];
-	char* pOutput = m_pEncodedBuf;
+	EncodeTo(pInput, iInputLen, m_pEncodedBuf, iEncodedLen + 1, pad);
+	return m_pEncodedBuf;
+}
+
+// Decode a base64 string to a binary buffer
+// Encoded string must be null terminated
+char* Base64::Decode(const char* pEncodedBuf, int *iOutLen)
+{
+	if (iOutLen)
+		*iOutLen = 0;
+
+	const int iEncodedLen = (int)strlen(pEncodedBuf);
+	const int iMaxLen = MaxDecodedLength(iEncodedLen);
+	delete [] m_pDecodedBuf;
+	m_pDecodedBuf = new char[iMaxLen ? iMaxLen : 1];
+
+	const int iLen = DecodeTo(pEncodedBuf, iEncodedLen, m_pDecodedBuf, iMaxLen);
+	if (iLen < 0)
+		return NULL;
+	if (iOutLen)
+		*iOutLen = iLen;
+	return m_pDecodedBuf;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Allocation-free versions
+//////////////////////////////////////////////////////////////////////
+
+int Base64::EncodedLength(int iLen, bool pad)
+{
+	return pad ? 4 * ((iLen + 2) / 3) : (4 * iLen + 2) / 3;
+}
 
-	//let's step through the buffer (in groups of three bytes) and encode it...
-	while (iLen >= 3)
+int Base64::MaxDecodedLength(int iEncodedLen)
+{
+	return 3 * ((iEncodedLen + 3) / 4);
+}
+
+int Base64::EncodeTo(const char* pInput, int iLen, char* pOut, int iOutSize, bool pad)
+{
+	const int iEncodedLen = EncodedLength(iLen, pad);
+	if (!pOut || iOutSize <= iEncodedLen)
+		return -1;
+
+	const unsigned char* in = (const unsigned char*)pInput;
+	char* out = pOut;
+	for (; iLen >= 6; iLen -= 6, in += 6, out += 8)
 	{
-		*(pOutput++) = cb64[(unsigned char)pInput[0] >> 2];
-		*(pOutput++) = cb64[(((unsigned char)pInput[0] & 0x03) << 4) | (((unsigned char)pInput[1] & 0xF0) >> 4)];
-		*(pOutput++) = cb64[(((unsigned char)pInput[1] & 0x0F) << 2) | (((unsigned char)pInput[2] & 0xC0) >> 6)];
-		*(pOutput++) = cb64[(unsigned char)pInput[2] & 0x3F];
-		iLen -= 3;
-		pInput += 3;
+		EncodeTriplet(in, out);
+		EncodeTriplet(in + 3, out + 4);
 	}
+	for (; iLen >= 3; iLen -= 3, in += 3, out += 4)
+		EncodeTriplet(in, out);
 
-	//do we have some chars left?
-	if (iLen != 0)
+	if (iLen)
 	{
-		*(pOutput++) = cb64[(unsigned char)pInput[0] >> 2];
-
+		*(out++) = cb64[in[0] >> 2];
 		if (iLen == 1)
+			*(out++) = cb64[(in[0] & 0x03) << 4];
+		else
 		{
-			*(pOutput++) = cb64[((unsigned char)pInput[0] & 0x03) << 4];
-		}
-		else // iLen == 2
-		{
-			*(pOutput++) = cb64[(((unsigned char)pInput[0] & 0x03) << 4) | (((unsigned char)pInput[1] & 0xF0) >> 4)];
-			*(pOutput++) = cb64[(((unsigned char)pInput[1] & 0x0F) << 2)];
+			*(out++) = cb64[((in[0] & 0x03) << 4) | (in[1] >> 4)];
+			*(out++) = cb64[(in[1] & 0x0F) << 2];
 		}
 	}
 
-	while (pad && pOutput < m_pEncodedBuf + iEncodedLen)
-		*(pOutput++) = '=';
-
-	// Null terminate
-	*pOutput = 0;
-	
-	return m_pEncodedBuf;
+	while (out < pOut + iEncodedLen)
+		*(out++) = '=';
+	*out = 0;
+	return iEncodedLen;
 }
 
-// Decode a base64 string to a binary buffer
-// Encoded string must be null terminated
-char* Base64::Decode(const char* pEncodedBuf, int *iOutLen)
+int Base64::DecodeTo(const char* pInput, int iLen, char* pOut, int iOutSize)
 {
-	int iDecodedLen;
-	int iLen, iBlock, i;
-	if (iOutLen)
-		*iOutLen = 0;
+	Decoder dec(false);
+	const int n = dec.Feed(pInput, iLen, pOut, iOutSize);
+	if (n < 0)
+		return -1;
+	const int m = dec.Finish(pOut + n, iOutSize - n);
+	return m < 0 ? -1 : n + m;
+}
 
-	// allocate buffer to hold the decoded string:
-	const int iEncodedLen = strlen(pEncodedBuf);
-	iDecodedLen = static_cast<int>(3 * (iEncodedLen / 4.f));
+void Base64::AppendLines(WDL_FastString* pOut, const char* pInput, int iLen, int iBytesPerLine, bool pad)
+{
+	if (iBytesPerLine <= 0)
+		iBytesPerLine = iLen;
 
-	// remove padding from decoded length
-	for(int i = iEncodedLen - 1; i >= 0 && pEncodedBuf[i] == '='; --i, --iDecodedLen);
+	char buf[1024+1];
+	const int iMaxPiece = 3 * (sizeof(buf) / 4 - 1); // multiple of 3: no padding within a line
+	for (int i = 0; i < iLen; i += iBytesPerLine)
+	{
+		const int iLineLen = min(iBytesPerLine, iLen - i);
+		for (int j = 0; j < iLineLen; j += iMaxPiece)
+		{
+			const int n = EncodeTo(pInput + i + j, min(iMaxPiece, iLineLen - j), buf, sizeof(buf), pad);
+			if (n > 0)
+				pOut->Append(buf, n);
+		}
+		pOut->Append("\n");
+	}
+}
 
-	if (m_pDecodedBuf != NULL)
-		free (m_pDecodedBuf);
-	m_pDecodedBuf = new char[iDecodedLen];
+//////////////////////////////////////////////////////////////////////
+// Streaming decoder
+//////////////////////////////////////////////////////////////////////
 
-	// allocate a local scratch buffer for decoding - work with BYTE's to avoid fatal sign extensions by compiler:
-	char* pInput = new char[iEncodedLen+1];
-	strcpy(pInput, pEncodedBuf);
+int Base64::Decoder::Feed(const char* pInput, int iLen, char* pOut, int iOutSize)
+{
+	if (m_failed)
+		return -1;
 
-	// Loop for each byte of input:
-	iLen = iBlock = i = 0;
-	while (pInput[iBlock+i])
+	const unsigned char* in = (const unsigned char*)pInput;
+	const unsigned char* end = in + iLen;
+	char* out = pOut;
+	char* outEnd = pOut + iOutSize;
+	while (in < end)
 	{
-		if ((unsigned char)pInput[iBlock+i] < 0x2B || (unsigned char)pInput[iBlock+i] > 0x7A)
+		// fast path: whole quads
+		if (!m_n && !m_pad)
 		{
-			delete [] pInput;
-			return NULL;
+			for (; end - in >= 4; in += 4, out += 3)
+			{
+				const unsigned int v = s_b64.dec[0][in[0]] | s_b64.dec[1][in[1]] | s_b64.dec[2][in[2]] | s_b64.dec[3][in[3]];
+				if (v & B64_BAD)
+					break;
+				if (outEnd - out < 3)
+				{
+					m_failed = true;
+					return -1;
+				}
+				out[0] = (char)(v >> 16);
+				out[1] = (char)(v >> 8);
+				out[2] = (char)v;
+			}
+			if (in >= end)
+				break;
 		}
-		if (pInput[iBlock+i] == '=')
-			break;
-		pInput[iBlock+i] = cd64[(unsigned char)pInput[iBlock+i] - 0x2B];
-		if (pInput[iBlock+i] == '$')
+
+		const unsigned char c = *(in++);
+		const unsigned int v = s_b64.dec[3][c];
+		if (!(v & B64_BAD) && !m_pad)
 		{
-			delete [] pInput;
-			return NULL;
+			m_acc = (m_acc << 6) | v;
+			if (++m_n == 4)
+			{
+				if (outEnd - out < 3)
+				{
+					m_failed = true;
+					return -1;
+				}
+				*(out++) = (char)(m_acc >> 16);
+				*(out++) = (char)(m_acc >> 8);
+				*(out++) = (char)m_acc;
+				m_acc = 0;
+				m_n = 0;
+			}
 		}
-		pInput[iBlock+i] -= 0x3E;
-
-		switch(i++)
+		else if (c == '=')
+			m_pad = true; // only padding (or spaces) from now on
+		else if (!m_skipSpaces || (c != '\n' && c != '\r' && c != ' ' && c != '\t'))
 		{
-			// case 0: no data to copy yet!
-		case 1:
-			m_pDecodedBuf[iLen++] = ((unsigned char)pInput[iBlock+0] << 2 | (unsigned char)pInput[iBlock+1] >> 4);
-			break;
-		case 2:
-			m_pDecodedBuf[iLen++] = ((unsigned char)pInput[iBlock+1] << 4 | (unsigned char)pInput[iBlock+2] >> 2);
-			break;
-		case 3:
-			m_pDecodedBuf[iLen++] = ((((unsigned char)pInput[iBlock+2] << 6) & 0xC0) | (unsigned char)pInput[iBlock+3]);
-			i = 0;
-			iBlock += 4;
-			break;
+			m_failed = true;
+			return -1;
 		}
 	}
+	return (int)(out - pOut);
+}
 
-	// clean and check:
-	delete [] pInput;
-	if (iLen != iDecodedLen)
-		return NULL;
+int Base64::Decoder::Finish(char* pOut, int iOutSize)
+{
+	if (m_failed)
+		return -1;
 
-	// done:
-	if (iOutLen)
-		*iOutLen = iLen;
-	return m_pDecodedBuf;
+	int n = 0;
+	if (m_n >= 2) // a single remaining char carries less than a byte, ignored
+	{
+		n = m_n - 1;
+		if (iOutSize < n)
+		{
+			m_failed = true;
+			return -1;
+		}
+		const unsigned int v = m_acc << (6 * (4 - m_n));
+		pOut[0] = (char)(v >> 16);
+		if (n > 1)
+			pOut[1] = (char)(v >> 8);
+	}
+	Reset();
+	return n;
 }
@@ -33,8 +33,38 @@ class Base64
 		Base64();
 		virtual ~Base64();
 
+		// Results are owned by the Base64 object and valid until the next call
 		char* Decode(const char* pInput, int *bufsize);	//bufsize holds the decoded length
 		char* Encode(const char* pEncodedBuf, int iLen, bool pad = false);
 		char* m_pEncodedBuf;
 		char* m_pDecodedBuf;
+
+		// Allocation-free versions, the caller provides the output buffer
+		static int EncodedLength(int iLen, bool pad = false); // without the null terminator
+		static int MaxDecodedLength(int iEncodedLen);
+		// Returns the encoded length (output is null terminated), -1 if pOut is too small
+		static int EncodeTo(const char* pInput, int iLen, char* pOut, int iOutSize, bool pad = false);
+		// Returns the decoded length, -1 on invalid input (line breaks included) or if pOut is too small
+		static int DecodeTo(const char* pInput, int iLen, char* pOut, int iOutSize);
+		// Appends base64 lines of iBytesPerLine input bytes each (use a multiple of 3 if pad is true)
+		static void AppendLines(WDL_FastString* pOut, const char* pInput, int iLen, int iBytesPerLine, bool pad = false);
+
+		// Streaming decoder: base64 text can be fed in pieces of any size, e.g. chunk
+		// lines as REAPER wraps them. Line breaks and spaces are skipped.
+		class Decoder
+		{
+			public:
+				Decoder(bool skipSpaces = true) : m_skipSpaces(skipSpaces) { Reset(); }
+				void Reset() { m_acc = 0; m_n = 0; m_pad = m_failed = false; }
+				// pOut needs MaxDecodedLength(iLen) bytes at most, returns -1 on error
+				int Feed(const char* pInput, int iLen, char* pOut, int iOutSize);
+				// Flushes the last 1 or 2 bytes (if any), returns -1 on error
+				int Finish(char* pOut, int iOutSize);
+				bool Failed() const { return m_failed; }
+
+			private:
+				unsigned int m_acc;
+				int m_n;
+				bool m_pad, m_failed, m_skipSpaces;
+		};
 };
@@ -0,0 +1,193 @@
+/******************************************************************************
+/ GuidIndex.cpp
+/
+/ Copyright (c) 2023 ReaTeam
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/ 
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/ 
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+
+#include "stdafx.h"
+
+#include "GuidIndex.h"
+
+#include <unordered_map>
+
+enum { GUIDIDX_TRACKS=0, GUIDIDX_ITEMS, GUIDIDX_NUM };
+
+static const char* s_ptrTypes[GUIDIDX_NUM] = { "MediaTrack*", "MediaItem*" };
+
+static bool GetObjectGuid(int type, void* obj, GUID* g)
+{
+	const GUID* p = type == GUIDIDX_TRACKS ?
+		(const GUID*)GetSetMediaTrackInfo((MediaTrack*)obj, "GUID", nullptr) :
+		(const GUID*)GetSetMediaItemInfo((MediaItem*)obj, "GUID", nullptr);
+	if (!p)
+		return false;
+	*g = *p;
+	return true;
+}
+
+class ProjectGuidIndex
+{
+public:
+	ProjectGuidIndex(ReaProject* proj) : m_proj(proj)
+	{
+		for (int i = 0; i < GUIDIDX_NUM; i++)
+			m_stateCount[i] = m_missRebuild[i] = m_nbObjects[i] = -1;
+	}
+
+	ReaProject* GetProject() const { return m_proj; }
+
+	void* Find(int type, const GUID* guid)
+	{
+		bool rebuilt = false;
+		if (m_stateCount[type] != GetProjectStateChangeCount(m_proj))
+		{
+			Build(type);
+			rebuilt = true;
+		}
+
+		if (void* obj = Lookup(type, guid))
+			return obj;
+
+		// objects can be added or get new GUIDs without any notification (e.g. within an action):
+		// rebuild once per state count or when the number of objects changed, not on every miss
+		if (!rebuilt && (m_missRebuild[type] != m_stateCount[type] || m_nbObjects[type] != CountObjects(type)))
+		{
+			Build(type);
+			m_missRebuild[type] = m_stateCount[type];
+			return Lookup(type, guid);
+		}
+		return nullptr;
+	}
+
+private:
+	typedef std::unordered_map<GUID, void*, GuidHash, GuidEqual> GuidMap;
+
+	void* Lookup(int type, const GUID* guid)
+	{
+		GuidMap::const_iterator it = m_maps[type].find(*guid);
+		if (it == m_maps[type].end())
+			return nullptr;
+
+		// stale entries (deleted object, GUID changed) must not be returned
+		void* obj = it->second;
+		if (!ValidatePtr2(m_proj, obj, s_ptrTypes[type]))
+			return nullptr;
+		if (type == GUIDIDX_TRACKS && obj == GetMasterTrack(m_proj))
+			return obj; // keyed by GUID_NULL, see TrackToGuid()
+
+		GUID g;
+		return GetObjectGuid(type, obj, &g) && GuidsEqual(&g, guid) ? obj : nullptr;
+	}
+
+	int CountObjects(int type) const
+	{
+		return type == GUIDIDX_TRACKS ? CountTracks(m_proj) : CountMediaItems(m_proj);
+	}
+
+	void Add(int type, void* obj)
+	{
+		GUID g;
+		if (obj && GetObjectGuid(type, obj, &g))
+			m_maps[type][g] = obj;
+	}
+
+	void Build(int type)
+	{
+		GuidMap& map = m_maps[type];
+		map.clear();
+		m_stateCount[type] = GetProjectStateChangeCount(m_proj);
+		m_nbObjects[type] = CountObjects(type);
+
+		const int nbTracks = CountTracks(m_proj);
+		for (int i = -1; i < nbTracks; i++)
+		{
+			MediaTrack* tr = i < 0 ? GetMasterTrack(m_proj) : GetTrack(m_proj, i);
+			if (!tr)
+				continue;
+
+			switch (type)
+			{
+				case GUIDIDX_TRACKS:
+					// see TrackToGuid()
+					if (i < 0)
+						map[GUID_NULL] = tr;
+					else
+						Add(type, tr);
+					break;
+				case GUIDIDX_ITEMS:
+					for (int j = 0; j < CountTrackMediaItems(tr); j++)
+						Add(type, GetTrackMediaItem(tr, j));
+					break;
+			}
+		}
+	}
+
+	ReaProject* m_proj;
+	GuidMap m_maps[GUIDIDX_NUM];
+	int m_stateCount[GUIDIDX_NUM];
+	int m_missRebuild[GUIDIDX_NUM]; // state count of the last rebuild due to a miss
+	int m_nbObjects[GUIDIDX_NUM]; // CountTracks()/CountMediaItems() at build time
+};
+
+static WDL_PtrList<ProjectGuidIndex> s_indexes;
+
+static void* Find(ReaProject* proj, int type, const GUID* guid)
+{
+	if (!guid)
+		return nullptr;
+
+	if (!proj)
+		proj = EnumProjects(-1, nullptr, 0);
+
+	ProjectGuidIndex* idx = nullptr;
+	for (int i = 0; !idx && i < s_indexes.GetSize(); i++)
+		if (s_indexes.Get(i)->GetProject() == proj)
+			idx = s_indexes.Get(i);
+
+	if (!idx)
+	{
+		// drop indexes of closed projects
+		for (int i = s_indexes.GetSize()-1; i >= 0; i--)
+			if (!ValidatePtr(s_indexes.Get(i)->GetProject(), "ReaProject*"))
+				s_indexes.Delete(i, true);
+
+		idx = s_indexes.Add(new ProjectGuidIndex(proj));
+	}
+
+	return idx->Find(type, guid);
+}
+
+MediaTrack* GuidIndex_FindTrack(ReaProject* proj, const GUID* guid)
+{
+	return (MediaTrack*)Find(proj, GUIDIDX_TRACKS, guid);
+}
+
+MediaItem* GuidIndex_FindItem(ReaProject* proj, const GUID* guid)
+{
+	return (MediaItem*)Find(proj, GUIDIDX_ITEMS, guid);
+}
+
+void GuidIndex_Invalidate()
+{
+	s_indexes.Empty(true);
+}
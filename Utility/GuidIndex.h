@@ -0,0 +1,58 @@
+/******************************************************************************
+/ GuidIndex.h
+/
+/ Copyright (c) 2023 ReaTeam
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/ 
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/ 
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+
+#pragma once
+
+// Per-project GUID -> object lookups, O(1) once the index is built.
+// The index is built lazily, dropped on project state/track list changes and
+// rebuilt on the first miss of a given project state or when the number of
+// tracks/items changed (objects can be added without any state change, e.g.
+// within an action): repeated misses, e.g. GUIDs of deleted objects, don't
+// rescan the project each time.
+// proj == NULL means the current project.
+MediaTrack* GuidIndex_FindTrack(ReaProject* proj, const GUID* guid);
+MediaItem* GuidIndex_FindItem(ReaProject* proj, const GUID* guid);
+
+// Called from CSurf SetTrackListChange(), also fine to call after bulk edits
+void GuidIndex_Invalidate();
+
+// Functors for std::unordered_map/set keyed by GUID
+struct GuidHash
+{
+	size_t operator()(const GUID& g) const
+	{
+		// GUIDs are random enough, just fold them
+		unsigned long long a, b;
+		memcpy(&a, &g, sizeof(a));
+		memcpy(&b, (const char*)&g + sizeof(a), sizeof(b));
+		return (size_t)(a ^ (b * 0x9E3779B97F4A7C15ULL));
+	}
+};
+
+struct GuidEqual
+{
+	bool operator()(const GUID& g1, const GUID& g2) const { return !memcmp(&g1, &g2, sizeof(GUID)); }
+};
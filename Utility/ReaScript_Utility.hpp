@@ -25,4 +25,11 @@
 ******************************************************************************/
 #pragma once
 
+// reaper.new_array() buffers ("reaper_array*" parameters), see reaimgui's api/types.hpp
+struct reaper_array
+{
+	const unsigned int size, alloc;
+	double data[1];
+};
+
 void CopyToBuffer(const char* value, char* buf, const size_t bufSize);
@@ -0,0 +1,189 @@
+/******************************************************************************
+/ TempoMap.cpp
+/
+/ Copyright (c) 2023 ReaTeam
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/ 
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/ 
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+
+#include "stdafx.h"
+
+#include "TempoMap.h"
+
+static const TempoMapSnapshot* s_current = NULL;
+
+void TempoMapSnapshot::Build(ReaProject* proj)
+{
+	m_segments.clear();
+
+	// positions of segment starts are REAPER's own, math is only done within segments
+	auto addSegment = [&](double time, double bpm)
+	{
+		Segment s;
+		s.time = time;
+		s.qn = TimeMap2_timeToQN(proj, time);
+		s.bpm = bpm;
+		s.slope = 0.0;
+		s.measureBeat = TimeMap2_timeToBeats(proj, time, &s.measure, &s.num, &s.beats, &s.den);
+		if (s.den <= 0) s.den = 4;
+		if (s.num <= 0) s.num = 4;
+		m_segments.push_back(s);
+	};
+
+	const int count = CountTempoTimeSigMarkers(proj);
+	double firstTime = 0.0;
+	if (!count || (GetTempoTimeSigMarker(proj, 0, &firstTime, NULL, NULL, NULL, NULL, NULL, NULL) && firstTime > 0.0))
+	{
+		double bpm;
+		TimeMap_GetTimeSigAtTime(proj, 0.0, NULL, NULL, &bpm);
+		addSegment(0.0, bpm);
+	}
+
+	vector<bool> linear(m_segments.size(), false);
+	for (int i = 0; i < count; i++)
+	{
+		double time, bpm;
+		bool lin;
+		if (GetTempoTimeSigMarker(proj, i, &time, NULL, NULL, &bpm, NULL, NULL, &lin))
+		{
+			addSegment(time, bpm);
+			linear.push_back(lin);
+		}
+	}
+
+	if (m_segments.empty()) // can't happen, keep conversions safe anyway
+	{
+		addSegment(0.0, 120.0);
+		linear.push_back(false);
+	}
+
+	for (size_t i = 0; i + 1 < m_segments.size(); i++)
+	{
+		const double dt = m_segments[i + 1].time - m_segments[i].time;
+		if (linear[i] && dt > 0.0)
+			m_segments[i].slope = (m_segments[i + 1].bpm - m_segments[i].bpm) / dt;
+	}
+}
+
+// last segment whose key <= value (first one if none)
+int TempoMapSnapshot::FindSegment(double Segment::* key, double value) const
+{
+	int lo = 0, hi = (int)m_segments.size();
+	while (lo < hi)
+	{
+		const int mid = (lo + hi) / 2;
+		if (m_segments[mid].*key <= value)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo > 0 ? lo - 1 : 0;
+}
+
+double TempoMapSnapshot::SegmentTimeToQN(const Segment& s, double time) const
+{
+	const double dt = time - s.time;
+	if (dt <= 0.0 || s.slope == 0.0)
+		return s.qn + s.bpm * dt / 60.0;
+	return s.qn + (s.bpm * dt + s.slope * dt * dt / 2.0) / 60.0;
+}
+
+double TempoMapSnapshot::SegmentQNToTime(const Segment& s, double qn) const
+{
+	const double dq = qn - s.qn;
+	if (dq <= 0.0 || s.slope == 0.0)
+		return s.time + 60.0 * dq / s.bpm;
+
+	// slope/2 * dt^2 + bpm * dt - 60 * dq = 0, stable root
+	const double d = s.bpm * s.bpm + 120.0 * s.slope * dq;
+	return s.time + 120.0 * dq / (s.bpm + sqrt(d > 0.0 ? d : 0.0));
+}
+
+double TempoMapSnapshot::TimeToQN(double time) const
+{
+	return SegmentTimeToQN(m_segments[FindSegment(&Segment::time, time)], time);
+}
+
+double TempoMapSnapshot::QNToTime(double qn) const
+{
+	return SegmentQNToTime(m_segments[FindSegment(&Segment::qn, qn)], qn);
+}
+
+double TempoMapSnapshot::TimeToBeats(double time, int* measure, int* num, double* fullBeats, int* den) const
+{
+	const Segment& s = m_segments[FindSegment(&Segment::time, time)];
+	const double qn = SegmentTimeToQN(s, time);
+	const double beats = SegmentQNToBeats(s, qn);
+	WritePtr(num, s.num);
+	WritePtr(den, s.den);
+	WritePtr(fullBeats, beats);
+	if (!measure)
+		return beats;
+
+	double measureBeat = s.measureBeat + (beats - s.beats);
+	const int measures = (int)floor(measureBeat / s.num);
+	measureBeat -= measures * s.num;
+	*measure = s.measure + measures;
+	return measureBeat;
+}
+
+double TempoMapSnapshot::BeatsToTime(double beats, const int* measure) const
+{
+	if (!measure)
+	{
+		const Segment& s = m_segments[FindSegment(&Segment::beats, beats)];
+		return QNToTime(s.qn + (beats - s.beats) * 4.0 / s.den);
+	}
+
+	// last segment starting before measure:beats
+	int i = (int)m_segments.size() - 1;
+	while (i > 0 && (m_segments[i].measure > *measure || (m_segments[i].measure == *measure && m_segments[i].measureBeat > beats)))
+		i--;
+	const Segment& s = m_segments[i];
+	const double beatsFromSegment = (*measure - s.measure) * s.num + beats - s.measureBeat;
+	return QNToTime(s.qn + beatsFromSegment * 4.0 / s.den);
+}
+
+double TempoMapSnapshot::BpmAtTime(double time) const
+{
+	const Segment& s = m_segments[FindSegment(&Segment::time, time)];
+	return time > s.time ? s.bpm + s.slope * (time - s.time) : s.bpm;
+}
+
+double TempoMapSnapshot::DividedBpmAtTime(double time) const
+{
+	return BpmAtTime(time) * m_segments[FindSegment(&Segment::time, time)].den / 4.0;
+}
+
+const TempoMapSnapshot* TempoMapSnapshot::GetCurrent()
+{
+	return s_current;
+}
+
+TempoMapScope::TempoMapScope(ReaProject* proj) : m_map(proj), m_prev(s_current)
+{
+	s_current = &m_map;
+}
+
+TempoMapScope::~TempoMapScope()
+{
+	s_current = m_prev;
+}
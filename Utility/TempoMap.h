@@ -0,0 +1,88 @@
+/******************************************************************************
+/ TempoMap.h
+/
+/ Copyright (c) 2023 ReaTeam
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/ 
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/ 
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+
+#pragma once
+
+// Snapshot of a project's tempo map: tempo markers with their QN, beat and
+// measure positions, built once with a few TimeMap2 calls per marker.
+// Conversions are then a binary search and closed-form math, linear tempo
+// ramps included (linear in time).
+// Results match REAPER's TimeMap2 functions as long as the tempo map isn't
+// edited, see TempoMapScope (and SNM_test9 in reascript_test.c).
+class TempoMapSnapshot
+{
+public:
+	explicit TempoMapSnapshot(ReaProject* proj = NULL) { Build(proj); }
+	void Build(ReaProject* proj = NULL);
+
+	double TimeToQN(double time) const;
+	double QNToTime(double qn) const;
+
+	// Same as TimeMap2_timeToBeats(): returns full beats if measure is NULL,
+	// beats since the measure start otherwise
+	double TimeToBeats(double time, int* measure = NULL, int* num = NULL, double* fullBeats = NULL, int* den = NULL) const;
+	// Same as TimeMap2_beatsToTime(): beats since the start of measure, if any
+	double BeatsToTime(double beats, const int* measure = NULL) const;
+
+	double BpmAtTime(double time) const;        // QN per minute
+	double DividedBpmAtTime(double time) const; // same as TimeMap2_GetDividedBpmAtTime()
+
+	// Innermost TempoMapScope's snapshot, NULL if none
+	static const TempoMapSnapshot* GetCurrent();
+
+private:
+	struct Segment
+	{
+		double time, qn;
+		double bpm, slope; // slope: bpm per second, non-zero for linear tempo ramps
+		double beats;      // full beats
+		int measure;
+		double measureBeat;
+		int num, den;
+	};
+
+	int FindSegment(double Segment::* key, double value) const;
+	double SegmentTimeToQN(const Segment& s, double time) const;
+	double SegmentQNToTime(const Segment& s, double qn) const;
+	double SegmentQNToBeats(const Segment& s, double qn) const { return s.beats + (qn - s.qn) * s.den / 4.0; }
+
+	std::vector<Segment> m_segments;
+};
+
+// Publishes a snapshot of the current tempo map (see TempoMapSnapshot::GetCurrent(),
+// used by Fingers' TimeMap functions) for the scope duration.
+// Only for code that doesn't edit the tempo map, main thread only.
+class TempoMapScope
+{
+public:
+	explicit TempoMapScope(ReaProject* proj = NULL);
+	~TempoMapScope();
+	const TempoMapSnapshot& Get() const { return m_map; }
+
+private:
+	TempoMapSnapshot m_map;
+	const TempoMapSnapshot* m_prev;
+};
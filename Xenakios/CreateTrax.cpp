@@ -28,6 +28,7 @@
 #include "stdafx.h"
 
 #include "../SnM/SnM_Dlg.h"
+#include "../SnM/SnM_Util.h"
 
 #include <WDL/localize/localize.h>
 
@@ -108,8 +109,9 @@ WDL_DLGRET CreateTxDlgProc(HWND hwnd, UINT Message, WPARAM wParam, LPARAM lParam
 		}
 		Undo_EndBlock(__LOCALIZE("Create tracks","sws_undo"),0);
 		sprintf(buf,"%d",g_newtrackparams.numtracks);
-		WritePrivateProfileString("XENAKIOSCOMMANDS","NTDLG_NUMNEWTRACKS",buf,g_XenIniFilename.Get());
-		WritePrivateProfileString("XENAKIOSCOMMANDS","NTDLG_BASENAME",g_newtrackparams.basename.c_str(),g_XenIniFilename.Get());
+		SNM_SetIniString("XENAKIOSCOMMANDS","NTDLG_NUMNEWTRACKS",buf,g_XenIniFilename.Get());
+		SNM_SetIniString("XENAKIOSCOMMANDS","NTDLG_BASENAME",g_newtrackparams.basename.c_str(),g_XenIniFilename.Get());
+		SNM_FlushIniFile(g_XenIniFilename.Get());
 		EndDialog(hwnd,0);
 		return 0;
 	}
@@ -124,11 +126,11 @@ WDL_DLGRET CreateTxDlgProc(HWND hwnd, UINT Message, WPARAM wParam, LPARAM lParam
 void DoCreateTraxDlg(COMMAND_T*)
 {
 	char buf[512];
-	GetPrivateProfileString("XENAKIOSCOMMANDS","NTDLG_NUMNEWTRACKS","1",buf,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","NTDLG_NUMNEWTRACKS","1",buf,512,g_XenIniFilename.Get());
 	g_newtrackparams.numtracks=atoi(buf);
 	if (g_newtrackparams.numtracks<1) g_newtrackparams.numtracks=1;
 	if (g_newtrackparams.numtracks>256) g_newtrackparams.numtracks=256;
-	GetPrivateProfileString("XENAKIOSCOMMANDS","NTDLG_BASENAME","New Track",buf,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","NTDLG_BASENAME","New Track",buf,512,g_XenIniFilename.Get());
 	g_newtrackparams.basename.assign(buf);
 	DialogBox(g_hInst,MAKEINTRESOURCE(IDD_CRTNEWTX), g_hwndParent,(DLGPROC)CreateTxDlgProc);
 }
@@ -31,6 +31,11 @@
 #include "../SnM/SnM_Dlg.h"
 
 #include <WDL/localize/localize.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 using namespace std;
 
@@ -53,6 +58,17 @@ struct t_project_take
 
 vector<t_mediafile_status> g_RProjectFiles;
 
+// Found media files by file name (without path)
+typedef unordered_map<string, vector<string> > t_mediafile_index;
+
+static const char* GetFileBaseName(const char* FileName)
+{
+	const char* p = FileName + strlen(FileName);
+	while (p > FileName && p[-1] != '\\' && p[-1] != '/')
+		p--;
+	return p;
+}
+
 string RemoveDoubleBackSlashes(string TheFileName)
 {
 	string ResultString;
@@ -130,9 +146,8 @@ void GetAllProjectTakes(vector<t_project_take>& ATakeList)
 
 void GetProjectFileList(vector<t_mediafile_status>& AMediaList)
 {
-	vector<string> ProjectFiles;
 	vector<string> TempList;
-	vector<int> vecusedcount;
+	unordered_set<string> TempSet;
 	int i;
 	int j;
 	int k;
@@ -172,17 +187,8 @@ void GetProjectFileList(vector<t_mediafile_status>& AMediaList)
 								else
 									FName.assign("no file...");
 							}
-							if (!ispurelyMIDI)
-							{
-								int Matches=0;
-								for (int L=0;L<(int)TempList.size();L++)
-								{
-									if (FName.compare(TempList[L])==0)
-										Matches++;
-								}
-								if (Matches==0)
-									TempList.push_back(FName);
-							}
+							if (!ispurelyMIDI && TempSet.insert(FName).second)
+								TempList.push_back(FName);
 						}
 					}
 				}
@@ -203,16 +209,18 @@ void GetProjectFileList(vector<t_mediafile_status>& AMediaList)
 	}
 }
 
-int IsFileUsedInProject(string AFile)
+// Number of times each file appears in g_RProjectFiles, built once per list update
+void GetProjectFilesUseCount(unordered_map<string, int>& AUseCount)
 {
-	int Matches=0;
-	int i;
-	for (i=0;i<(int)g_RProjectFiles.size();i++)
-	{
-		if (AFile.compare(g_RProjectFiles[i].FileName)==0) Matches++;
-	}
-	return Matches;
-	//if (Matches>0) return true; else return false;
+	AUseCount.clear();
+	for (int i=0;i<(int)g_RProjectFiles.size();i++)
+		AUseCount[g_RProjectFiles[i].FileName]++;
+}
+
+int IsFileUsedInProject(const string& AFile, const unordered_map<string, int>& AUseCount)
+{
+	unordered_map<string, int>::const_iterator it = AUseCount.find(AFile);
+	return it != AUseCount.end() ? it->second : 0;
 }
 
 vector<string> g_ProjFolFiles;
@@ -247,6 +255,8 @@ void UpdateProjFolderList(HWND hList, bool onlyUnused)
 	GetProjectPath(buf,2048);
 
 	SearchDirectory(g_ProjFolFiles,buf,NULL,true);
+	unordered_map<string, int> UseCount;
+	GetProjectFilesUseCount(UseCount);
 	int j=0;
 	bool HidePaths=false;
 	if (IsDlgButtonChecked(g_hMediaDlg,IDC_HIDEPATHS) == BST_CHECKED)
@@ -269,7 +279,7 @@ void UpdateProjFolderList(HWND hList, bool onlyUnused)
 
 		item.iItem=j;
 		item.iSubItem = 0;
-		int UsedInProject=IsFileUsedInProject(g_ProjFolFiles[i]);
+		int UsedInProject=IsFileUsedInProject(g_ProjFolFiles[i], UseCount);
 		if (onlyUnused)
 		{
 			if (UsedInProject==0)
@@ -356,6 +366,7 @@ WDL_DLGRET MulMatchesFoundDlgProc(HWND hwnd, UINT Message, WPARAM wParam, LPARAM
 				ListView_SetItemText(GetDlgItem(hwnd,IDC_MULMATCHLIST),i,1,buf);
 #endif
 			}
+			ListView_SetItemState(GetDlgItem(hwnd,IDC_MULMATCHLIST),0,LVIS_SELECTED|LVIS_FOCUSED,LVIS_SELECTED|LVIS_FOCUSED); // best candidate
 			return 0;
 		}
 		case WM_COMMAND:
@@ -390,17 +401,140 @@ WDL_DLGRET MulMatchesFoundDlgProc(HWND hwnd, UINT Message, WPARAM wParam, LPARAM
 
 bool g_ScanFinished=false;
 
-vector<string> FoundMediaFiles;
+t_mediafile_index g_FoundMediaFiles;
 char g_FolderName[1024] = "";
 
+// The search folder is scanned by several threads sharing a queue of folders
+// to visit, each one indexes the media files it finds by file name.
+// g_ScanMutex also guards g_CurrentScanFile while scanning
+static mutex g_ScanMutex;
+static condition_variable g_ScanCond; // folders queued, or a thread done
+static vector<string> g_ScanFolders;
+static int g_ScanBusyThreads = 0;
+
+static void GetCurrentScanFile(char* Buf, int BufSize)
+{
+	lock_guard<mutex> lock(g_ScanMutex);
+	lstrcpyn(Buf, g_CurrentScanFile, BufSize);
+}
+
+unsigned int WINAPI DirScanWorkerFunc(void* pIndex)
+{
+	t_mediafile_index* FoundFiles = (t_mediafile_index*)pIndex;
+	for (;;)
+	{
+		string Folder;
+		{
+			// idle threads wait: busy ones may still queue subfolders
+			unique_lock<mutex> lock(g_ScanMutex);
+			g_ScanCond.wait(lock, [] { return g_bAbortScan || !g_ScanFolders.empty() || !g_ScanBusyThreads; });
+			if (g_bAbortScan || g_ScanFolders.empty())
+				break;
+			Folder.swap(g_ScanFolders.back());
+			g_ScanFolders.pop_back();
+			g_ScanBusyThreads++;
+			lstrcpyn(g_CurrentScanFile, Folder.c_str(), 1024);
+		}
+
+		WDL_DirScan ds;
+		if (!ds.First(Folder.c_str()))
+		{
+			do
+			{
+				const char* FileName = ds.GetCurrentFN();
+				if (strcmp(FileName, ".") == 0 || strcmp(FileName, "..") == 0)
+					continue;
+				WDL_String FullFileName;
+				ds.GetCurrentFullFN(&FullFileName);
+				if (ds.GetCurrentIsDirectory())
+				{
+					lock_guard<mutex> lock(g_ScanMutex);
+					g_ScanFolders.push_back(FullFileName.Get());
+					g_ScanCond.notify_one();
+				}
+				else if (const char* Ext = strrchr(FileName, '.'))
+				{
+					if (IsMediaExtension(Ext + 1, false))
+						(*FoundFiles)[FileName].push_back(FullFileName.Get());
+				}
+			}
+			while (!ds.Next() && !g_bAbortScan);
+		}
+
+		lock_guard<mutex> lock(g_ScanMutex);
+		if (!--g_ScanBusyThreads || g_bAbortScan)
+			g_ScanCond.notify_all(); // scan done (or aborted): wake up idle threads so that they exit
+	}
+	return 0;
+}
+
 unsigned int WINAPI DirScanThreadFunc(void*)
 {
-	FoundMediaFiles.clear();
-	SearchDirectory(FoundMediaFiles, g_FolderName, NULL, true);
+	g_FoundMediaFiles.clear();
+	g_ScanFolders.assign(1, g_FolderName);
+	g_ScanBusyThreads = 0;
+
+	// I/O bound, a few threads already help a lot with network drives and big libraries
+	const int NumThreads = min(max((int)std::thread::hardware_concurrency(), 2), 8);
+	vector<t_mediafile_index> ThreadFiles(NumThreads);
+	vector<HANDLE> Threads;
+	for (int i=0;i<NumThreads;i++)
+		Threads.push_back((HANDLE)_beginthreadex(NULL, 0, DirScanWorkerFunc, &ThreadFiles[i], 0, NULL));
+	for (int i=0;i<NumThreads;i++)
+	{
+		WaitForSingleObject(Threads[i], INFINITE);
+		CloseHandle(Threads[i]);
+	}
+	g_ScanFolders.clear();
+
+	for (int i=0;i<NumThreads;i++)
+	{
+		for (t_mediafile_index::iterator it = ThreadFiles[i].begin(); it != ThreadFiles[i].end(); ++it)
+		{
+			vector<string>& Paths = g_FoundMediaFiles[it->first];
+			Paths.insert(Paths.end(), it->second.begin(), it->second.end());
+		}
+	}
+
 	g_ScanStatus = 0;
 	return 0;
 }
 
+// Number of parent folders (innermost first) both files have in common, case insensitive
+static int CountCommonParentFolders(const char* FileA, const char* FileB)
+{
+	const char* pA = GetFileBaseName(FileA);
+	const char* pB = GetFileBaseName(FileB);
+	int Count = 0;
+	while (pA > FileA && pB > FileB)
+	{
+		const char* EndA = --pA; // skip separator
+		const char* EndB = --pB;
+		while (pA > FileA && pA[-1] != '\\' && pA[-1] != '/')
+			pA--;
+		while (pB > FileB && pB[-1] != '\\' && pB[-1] != '/')
+			pB--;
+		if (EndA == pA || EndA - pA != EndB - pB || _strnicmp(pA, pB, EndA - pA))
+			break;
+		Count++;
+	}
+	return Count;
+}
+
+// Sorts g_MatchingFiles so that candidates sharing most parent folders with the
+// missing file come first, returns true if the first one is the only best match
+static bool SortMatchingFiles(const string& MissingFile)
+{
+	vector<pair<int, string> > Scored;
+	for (int i=0;i<(int)g_MatchingFiles.size();i++)
+		Scored.push_back(make_pair(-CountCommonParentFolders(MissingFile.c_str(), g_MatchingFiles[i].c_str()), g_MatchingFiles[i]));
+	sort(Scored.begin(), Scored.end());
+
+	for (int i=0;i<(int)Scored.size();i++)
+		g_MatchingFiles[i].swap(Scored[i].second);
+	return Scored.size() > 1 && Scored[0].first < 0 && Scored[0].first != Scored[1].first;
+}
+
 WDL_DLGRET ScanProgDlgProc(HWND hwnd, UINT Message, WPARAM wParam, LPARAM lParam)
 {
 	static HANDLE hThread = NULL;
@@ -422,7 +556,9 @@ WDL_DLGRET ScanProgDlgProc(HWND hwnd, UINT Message, WPARAM wParam, LPARAM lParam
 			{
 				if (wParam==1717)
 				{
-					SetDlgItemText(hwnd,IDC_SCANFILE,g_CurrentScanFile);
+					char ScanFile[1024];
+					GetCurrentScanFile(ScanFile, sizeof(ScanFile));
+					SetDlgItemText(hwnd,IDC_SCANFILE,ScanFile);
 					if (g_ScanStatus==0)
 					{
 						KillTimer(hwnd,1717);
@@ -448,7 +584,9 @@ WDL_DLGRET ScanProgDlgProc(HWND hwnd, UINT Message, WPARAM wParam, LPARAM lParam
 				}
 				if (wParam==0xff)
 				{
-					SetDlgItemText(g_hScanProgressDlg,IDC_SCANFILE,g_CurrentScanFile);
+					char ScanFile[1024];
+					GetCurrentScanFile(ScanFile, sizeof(ScanFile));
+					SetDlgItemText(g_hScanProgressDlg,IDC_SCANFILE,ScanFile);
 #ifdef _WIN32 // TODO is this necessary?  what to do for OSX?
 					RedrawWindow(g_hScanProgressDlg, NULL, NULL, RDW_INVALIDATE | RDW_UPDATENOW);
 #else
@@ -467,85 +605,57 @@ void FindMissingFiles()
 {
 	if (BrowseForDirectory("Select search folder", NULL, g_FolderName, 1024))
 	{
-		char FullFilename[2048];
-		char FullFilenameB[2048];
-		char Shortfilename[2048];
-		char ShortfilenameB[2048];
-
 		DialogBox(g_hInst,MAKEINTRESOURCE(IDD_SCANPROGR),g_hMediaDlg,(DLGPROC)ScanProgDlgProc);
 		g_ScanStatus=0;
 		g_ScanFinished=true;
 		SetForegroundWindow(g_hMediaDlg);
 		vector<t_project_take> ProjectTakes;
-		vector<t_project_take> TakesMissingFiles;
 		GetAllProjectTakes(ProjectTakes);
+
+		// Group takes by missing file, each file is then relinked with a single index lookup
+		vector<string> MissingFiles;
+		unordered_map<string, vector<MediaItem_Take*> > TakesMissingFiles;
 		int i;
 		for (i=0;i<(int)ProjectTakes.size();i++)
+		{
 			if (ProjectTakes[i].FileMissing==true)
-				TakesMissingFiles.push_back(ProjectTakes[i]);
+			{
+				vector<MediaItem_Take*>& Takes=TakesMissingFiles[ProjectTakes[i].FileName];
+				if (Takes.empty())
+					MissingFiles.push_back(ProjectTakes[i].FileName);
+				Takes.push_back(ProjectTakes[i].TheTake);
+			}
+		}
 		Main_OnCommand(40100,0); // set all media offline
-		int SanityCheck=(int)TakesMissingFiles.size();
-		i=0;
 
-		bool TakesLeft=true;
-		if (TakesMissingFiles.size()==0) TakesLeft=false;
-		while (TakesLeft==true)
+		int AutoPick=-1; // use unambiguous best candidates without asking? asked once, on the first one
+		for (i=0;i<(int)MissingFiles.size();i++)
 		{
-			t_project_take TempTake;
-			TempTake=TakesMissingFiles[i];
-			int FileMatches=0;
-			strcpy(FullFilename,TakesMissingFiles[i].FileName.c_str());
-			ExtractFileNameEx(FullFilename,Shortfilename,false);
-			g_MatchingFiles.clear();
-			int j;
-			for (j=0;j<(int)FoundMediaFiles.size();j++)
-			{
-				strcpy(FullFilenameB,FoundMediaFiles[j].c_str());
-				ExtractFileNameEx(FullFilenameB,ShortfilenameB,false);
-				if (strcmp(Shortfilename,ShortfilenameB)==0)
-				{
-					FileMatches++;
-					g_MatchingFiles.push_back(FoundMediaFiles[j]);
-				}
-			}
-			string TheMatchingFile;
-			TheMatchingFile.assign(TakesMissingFiles[i].FileName);
-			if (g_MatchingFiles.size()==0)
-				TakesMissingFiles.erase(TakesMissingFiles.begin()+i);
-			else if (g_MatchingFiles.size()==1)
-			{
-				TheMatchingFile.assign(g_MatchingFiles[0]);
-				ReplaceTakeSourceFile(TakesMissingFiles[i].TheTake,TheMatchingFile);
-				TakesMissingFiles.erase(TakesMissingFiles.begin()+i);
-			}
-			else if (g_MatchingFiles.size()>1)
+			t_mediafile_index::const_iterator Found=g_FoundMediaFiles.find(GetFileBaseName(MissingFiles[i].c_str()));
+			if (Found==g_FoundMediaFiles.end())
+				continue;
+
+			g_MatchingFiles=Found->second;
+			int Match=0;
+			if (g_MatchingFiles.size()>1)
 			{
-				g_SelectedMatchFile=-1;
-				DialogBox(g_hInst,MAKEINTRESOURCE(IDD_MULMATCH),g_hMediaDlg , (DLGPROC)MulMatchesFoundDlgProc);
-				if (g_SelectedMatchFile>=0)
+				const bool HasBest=SortMatchingFiles(MissingFiles[i]);
+				if (HasBest && AutoPick<0)
+					AutoPick = MessageBox(g_hMediaDlg,
+						__LOCALIZE("Several files match some of the missing media.\nAutomatically use the best match (the one sharing most parent folders with the missing file) when there is one?\n\nNo: choose each file in a list.","sws_mbox"),
+						__LOCALIZE("SWS - Find missing media","sws_mbox"), MB_YESNO) == IDYES ? 1 : 0;
+				if (!HasBest || !AutoPick)
 				{
-					TheMatchingFile.assign(g_MatchingFiles[g_SelectedMatchFile]);
-					ReplaceTakeSourceFile(TakesMissingFiles[i].TheTake,TheMatchingFile);
+					g_SelectedMatchFile=-1;
+					DialogBox(g_hInst,MAKEINTRESOURCE(IDD_MULMATCH),g_hMediaDlg , (DLGPROC)MulMatchesFoundDlgProc);
+					Match=g_SelectedMatchFile;
 				}
-				TakesMissingFiles.erase(TakesMissingFiles.begin()+i);
 			}
-			// Searching remaining takes using the same file...
-			int k;
-			for (k=0;k<(int)TakesMissingFiles.size();k++)
+			if (Match>=0)
 			{
-				if (TakesMissingFiles[k].FileName.compare(FullFilename)==0)
-				{
-					// replace file
-					ReplaceTakeSourceFile(TakesMissingFiles[k].TheTake,TheMatchingFile);
-					TakesMissingFiles.erase(TakesMissingFiles.begin()+k);
-				}
-			}
-			if (TakesMissingFiles.size()==0) TakesLeft=false;
-			SanityCheck--;
-			if (SanityCheck<0)
-			{
-				// Sanity check, exiting while (TakesMissingFiles.size()>0)
-				break;
+				const vector<MediaItem_Take*>& Takes=TakesMissingFiles[MissingFiles[i]];
+				for (int j=0;j<(int)Takes.size();j++)
+					ReplaceTakeSourceFile(Takes[j],g_MatchingFiles[Match]);
 			}
 		}
 		Main_OnCommand(40101,0); // set all media online
@@ -554,11 +664,12 @@ void FindMissingFiles()
 	}
 }
 
-int NumTimesFileUsedInProject(string &fn, vector<MediaItem_Take*>& thetakes)
+// Number of takes using each file, so the used list is filled with one lookup per file
+void GetTakesPerFile(vector<MediaItem_Take*>& thetakes, unordered_map<string, int>& takesPerFile)
 {
 	int i;
-	int matches=0;
 	string cmpfn;
+	takesPerFile.clear();
 	for (i=0;i<(int)thetakes.size();i++)
 	{
 		PCM_source *src=(PCM_source*)GetSetMediaItemTakeInfo(thetakes[i],"P_SOURCE",0);
@@ -573,11 +684,15 @@ int NumTimesFileUsedInProject(string &fn, vector<MediaItem_Take*>& thetakes)
 				if (src2)
 					cmpfn.assign(src2->GetFileName() ? src2->GetFileName() : "");
 			}
-			if (fn.compare(cmpfn)==0)
-				matches++;
+			takesPerFile[cmpfn]++;
 		}
 	}
-	return matches;
+}
+
+int NumTimesFileUsedInProject(const string &fn, const unordered_map<string, int>& takesPerFile)
+{
+	unordered_map<string, int>::const_iterator it = takesPerFile.find(fn);
+	return it != takesPerFile.end() ? it->second : 0;
 }
 
 void PopulateProjectUsedList(bool HidePaths)
@@ -587,6 +702,8 @@ void PopulateProjectUsedList(bool HidePaths)
 	char buf[2048];
 	vector<MediaItem_Take*> thetakes;
 	XenGetProjectTakes(thetakes, false, false);
+	unordered_map<string, int> takesPerFile;
+	GetTakesPerFile(thetakes, takesPerFile);
 
 	for (int i = 0; i < (int)g_RProjectFiles.size(); i++)
 	{
@@ -605,7 +722,7 @@ void PopulateProjectUsedList(bool HidePaths)
 		ListView_InsertItem(GetDlgItem(g_hMediaDlg, IDC_PROJFILES_USED), &item);
 		ListView_SetItemText(GetDlgItem(g_hMediaDlg,IDC_PROJFILES_USED), i, 2, g_RProjectFiles[i].IsOnline ? "Online" : "Missing");
 		char ynh[20];
-		sprintf(ynh, "%d", NumTimesFileUsedInProject(g_RProjectFiles[i].FileName, thetakes));
+		sprintf(ynh, "%d", NumTimesFileUsedInProject(g_RProjectFiles[i].FileName, takesPerFile));
 		ListView_SetItemText(GetDlgItem(g_hMediaDlg, IDC_PROJFILES_USED), i, 1, ynh);
 	}
 }
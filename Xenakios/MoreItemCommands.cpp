@@ -1430,7 +1430,7 @@ void SetSelItemsFadesToConf(const char *confID)
 	vector<MediaItem*> selitems;
 	XenGetProjectItems(selitems, true, false);
 	char resultString[512];
-	GetPrivateProfileString("XENAKIOSCOMMANDS",confID,"0.005 1 0.005 1",resultString,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS",confID,"0.005 1 0.005 1",resultString,512,g_XenIniFilename.Get());
 	LineParser lp(false);
 	lp.parse(resultString);
 	double fadeinlen    = lp.gettoken_float(0);
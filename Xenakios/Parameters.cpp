@@ -28,6 +28,7 @@
 #include "stdafx.h"
 
 #include "../SnM/SnM_Dlg.h"
+#include "../SnM/SnM_Util.h"
 #include "Parameters.h"
 
 #include <WDL/localize/localize.h>
@@ -59,39 +60,39 @@ void DoLaunchExtTool(COMMAND_T* t)
 void ReadINIfile()
 {
 	char resultString[512];
-	GetPrivateProfileString("XENAKIOSCOMMANDS","ITEMPOSNUDGESECS","1.0",resultString,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","ITEMPOSNUDGESECS","1.0",resultString,512,g_XenIniFilename.Get());
 	g_command_params.ItemPosNudgeSecs=atof(resultString);
-	GetPrivateProfileString("XENAKIOSCOMMANDS","ITEMPOSNUDGEBEATS","1.0",resultString,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","ITEMPOSNUDGEBEATS","1.0",resultString,512,g_XenIniFilename.Get());
 	g_command_params.ItemPosNudgeBeats=atof(resultString);
-	GetPrivateProfileString("XENAKIOSCOMMANDS","FADEINTIMEA","0.001",resultString,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","FADEINTIMEA","0.001",resultString,512,g_XenIniFilename.Get());
 	g_command_params.CommandFadeInA=atof(resultString);
-	GetPrivateProfileString("XENAKIOSCOMMANDS","FADEINTIMEB","0.001",resultString,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","FADEINTIMEB","0.001",resultString,512,g_XenIniFilename.Get());
 	g_command_params.CommandFadeInB=atof(resultString);
-	GetPrivateProfileString("XENAKIOSCOMMANDS","FADEOUTTIMEA","0.001",resultString,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","FADEOUTTIMEA","0.001",resultString,512,g_XenIniFilename.Get());
 	g_command_params.CommandFadeOutA=atof(resultString);
-	GetPrivateProfileString("XENAKIOSCOMMANDS","FADEOUTTIMEB","0.001",resultString,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","FADEOUTTIMEB","0.001",resultString,512,g_XenIniFilename.Get());
 	g_command_params.CommandFadeOutB=atof(resultString);
-	GetPrivateProfileString("XENAKIOSCOMMANDS","FADEINSHAPEA","0",resultString,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","FADEINSHAPEA","0",resultString,512,g_XenIniFilename.Get());
 	g_command_params.CommandFadeInShapeA=atoi(resultString);
-	GetPrivateProfileString("XENAKIOSCOMMANDS","FADEINSHAPEB","0",resultString,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","FADEINSHAPEB","0",resultString,512,g_XenIniFilename.Get());
 	g_command_params.CommandFadeInShapeB=atoi(resultString);
-	GetPrivateProfileString("XENAKIOSCOMMANDS","FADEOUTSHAPEA","0",resultString,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","FADEOUTSHAPEA","0",resultString,512,g_XenIniFilename.Get());
 	g_command_params.CommandFadeOutShapeA=atoi(resultString);
-	GetPrivateProfileString("XENAKIOSCOMMANDS","FADEOUTSHAPEB","0",resultString,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","FADEOUTSHAPEB","0",resultString,512,g_XenIniFilename.Get());
 	g_command_params.CommandFadeOutShapeB=atoi(resultString);
 	
-	GetPrivateProfileString("XENAKIOSCOMMANDS","EDITCURRNDMEAN","1.0",resultString,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","EDITCURRNDMEAN","1.0",resultString,512,g_XenIniFilename.Get());
 	g_command_params.EditCurRndMean=atof(resultString);
 
-	GetPrivateProfileString("XENAKIOSCOMMANDS","ITEMVOLUMENUDGE","1.0",resultString,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","ITEMVOLUMENUDGE","1.0",resultString,512,g_XenIniFilename.Get());
 	g_command_params.ItemVolumeNudge=atof(resultString);
 
-	GetPrivateProfileString("XENAKIOSCOMMANDS","ITEMPITCHNUDGE","1.0",resultString,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","ITEMPITCHNUDGE","1.0",resultString,512,g_XenIniFilename.Get());
 	g_command_params.ItemPitchNudgeA=atof(resultString);
-	GetPrivateProfileString("XENAKIOSCOMMANDS","ITEMPITCHNUDGEB","1.0",resultString,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","ITEMPITCHNUDGEB","1.0",resultString,512,g_XenIniFilename.Get());
 	g_command_params.ItemPitchNudgeB=atof(resultString);
 
-	GetPrivateProfileString("XENAKIOSCOMMANDS","RNDITEMSELPROB","50.0",resultString,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","RNDITEMSELPROB","50.0",resultString,512,g_XenIniFilename.Get());
 	g_command_params.RndItemSelProb=atof(resultString);
 
 	delete [] g_external_app_paths.PathToTool1; g_external_app_paths.PathToTool1 = NULL;
@@ -99,58 +100,58 @@ void ReadINIfile()
 	delete [] g_external_app_paths.PathToAudioEditor1; g_external_app_paths.PathToAudioEditor1 = NULL;
 	delete [] g_external_app_paths.PathToAudioEditor2; g_external_app_paths.PathToAudioEditor2 = NULL;
 
-	GetPrivateProfileString("XENAKIOSCOMMANDS","EXTERNALTOOL1PATH","",resultString,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","EXTERNALTOOL1PATH","",resultString,512,g_XenIniFilename.Get());
 	if (resultString[0])
 	{
 		g_external_app_paths.PathToTool1=new char[strlen(resultString)+sizeof(char)];
 		strcpy(g_external_app_paths.PathToTool1, resultString);
 	}
 
-	GetPrivateProfileString("XENAKIOSCOMMANDS","EXTERNALTOOL2PATH","",resultString,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","EXTERNALTOOL2PATH","",resultString,512,g_XenIniFilename.Get());
 	if (resultString[0])
 	{
 		g_external_app_paths.PathToTool2=new char[strlen(resultString)+sizeof(char)];
 		strcpy(g_external_app_paths.PathToTool2, resultString);
 	}
 
-	GetPrivateProfileString("XENAKIOSCOMMANDS","EXTERNALEDITOR1PATH","",resultString,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","EXTERNALEDITOR1PATH","",resultString,512,g_XenIniFilename.Get());
 	if (resultString[0])
 	{
 		g_external_app_paths.PathToAudioEditor1=new char[strlen(resultString)+sizeof(char)];
 		strcpy(g_external_app_paths.PathToAudioEditor1, resultString);
 	}
 
-	GetPrivateProfileString("XENAKIOSCOMMANDS","EXTERNALEDITOR2PATH","",resultString,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","EXTERNALEDITOR2PATH","",resultString,512,g_XenIniFilename.Get());
 	if (resultString[0])
 	{
 		g_external_app_paths.PathToAudioEditor2=new char[strlen(resultString)+sizeof(char)];
 		strcpy(g_external_app_paths.PathToAudioEditor2, resultString);
 	}
 
-	GetPrivateProfileString("XENAKIOSCOMMANDS","PIXELAMOUNT","12",resultString,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","PIXELAMOUNT","12",resultString,512,g_XenIniFilename.Get());
 	g_command_params.PixAmount=atoi(resultString);
 
-	GetPrivateProfileString("XENAKIOSCOMMANDS","SECTLOOPNUDGESECS","0.1",resultString,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","SECTLOOPNUDGESECS","0.1",resultString,512,g_XenIniFilename.Get());
 	g_command_params.SectionLoopNudgeSecs=atof(resultString);
 
 	//CURPOSSECSAMOUNT
 
-	GetPrivateProfileString("XENAKIOSCOMMANDS","CURPOSSECSAMOUNT","0.005",resultString,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","CURPOSSECSAMOUNT","0.005",resultString,512,g_XenIniFilename.Get());
 	g_command_params.CurPosSecsAmount=atof(resultString);
 
-	GetPrivateProfileString("XENAKIOSCOMMANDS","TRACKHEIGHTA","50",resultString,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","TRACKHEIGHTA","50",resultString,512,g_XenIniFilename.Get());
 	g_command_params.TrackHeight[0]=atoi(resultString);
-	GetPrivateProfileString("XENAKIOSCOMMANDS","TRACKHEIGHTB","50",resultString,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","TRACKHEIGHTB","50",resultString,512,g_XenIniFilename.Get());
 	g_command_params.TrackHeight[1]=atoi(resultString);
 	
-	GetPrivateProfileString("XENAKIOSCOMMANDS","TRACKLABELDEFAULT","Audio",resultString,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","TRACKLABELDEFAULT","Audio",resultString,512,g_XenIniFilename.Get());
 	g_command_params.DefaultTrackLabel.assign(resultString);
-	GetPrivateProfileString("XENAKIOSCOMMANDS","TRACKLABELPREFIX","",resultString,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","TRACKLABELPREFIX","",resultString,512,g_XenIniFilename.Get());
 	g_command_params.TrackLabelPrefix.assign(resultString);
-	GetPrivateProfileString("XENAKIOSCOMMANDS","TRACKLABELSUFFIX","",resultString,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","TRACKLABELSUFFIX","",resultString,512,g_XenIniFilename.Get());
 	g_command_params.TrackLabelSuffix.assign(resultString);
 
-	GetPrivateProfileString("XENAKIOSCOMMANDS","TRACKVOLNUDGEDB","1.0",resultString,512,g_XenIniFilename.Get());
+	SNM_GetIniString("XENAKIOSCOMMANDS","TRACKVOLNUDGEDB","1.0",resultString,512,g_XenIniFilename.Get());
 	g_command_params.TrackVolumeNudge=atof(resultString);
 }
 
@@ -159,67 +160,69 @@ void UpdateINIfile()
 {
 	char TextBuf[512];
 	sprintf(TextBuf,"%f",g_command_params.TrackVolumeNudge);
-	WritePrivateProfileString("XENAKIOSCOMMANDS","TRACKVOLNUDGEDB",TextBuf,g_XenIniFilename.Get());
+	SNM_SetIniString("XENAKIOSCOMMANDS","TRACKVOLNUDGEDB",TextBuf,g_XenIniFilename.Get());
 	sprintf(TextBuf,"%f",g_command_params.ItemPosNudgeSecs);
-	WritePrivateProfileString("XENAKIOSCOMMANDS","ITEMPOSNUDGESECS",TextBuf,g_XenIniFilename.Get());
+	SNM_SetIniString("XENAKIOSCOMMANDS","ITEMPOSNUDGESECS",TextBuf,g_XenIniFilename.Get());
 	sprintf(TextBuf,"%f",g_command_params.ItemPosNudgeBeats);
-	WritePrivateProfileString("XENAKIOSCOMMANDS","ITEMPOSNUDGEBEATS",TextBuf,g_XenIniFilename.Get());
+	SNM_SetIniString("XENAKIOSCOMMANDS","ITEMPOSNUDGEBEATS",TextBuf,g_XenIniFilename.Get());
 	sprintf(TextBuf,"%f",g_command_params.CommandFadeInA);
-	WritePrivateProfileString("XENAKIOSCOMMANDS","FADEINTIMEA",TextBuf,g_XenIniFilename.Get());
+	SNM_SetIniString("XENAKIOSCOMMANDS","FADEINTIMEA",TextBuf,g_XenIniFilename.Get());
 	sprintf(TextBuf,"%f",g_command_params.CommandFadeInB);
-	WritePrivateProfileString("XENAKIOSCOMMANDS","FADEINTIMEB",TextBuf,g_XenIniFilename.Get());
+	SNM_SetIniString("XENAKIOSCOMMANDS","FADEINTIMEB",TextBuf,g_XenIniFilename.Get());
 	sprintf(TextBuf,"%f",g_command_params.CommandFadeOutA);
-	WritePrivateProfileString("XENAKIOSCOMMANDS","FADEOUTTIMEA",TextBuf,g_XenIniFilename.Get());
+	SNM_SetIniString("XENAKIOSCOMMANDS","FADEOUTTIMEA",TextBuf,g_XenIniFilename.Get());
 	sprintf(TextBuf,"%f",g_command_params.CommandFadeOutB);
-	WritePrivateProfileString("XENAKIOSCOMMANDS","FADEOUTTIMEB",TextBuf,g_XenIniFilename.Get());
+	SNM_SetIniString("XENAKIOSCOMMANDS","FADEOUTTIMEB",TextBuf,g_XenIniFilename.Get());
 	sprintf(TextBuf,"%d",g_command_params.CommandFadeInShapeA);
-	WritePrivateProfileString("XENAKIOSCOMMANDS","FADEINSHAPEA",TextBuf,g_XenIniFilename.Get());
+	SNM_SetIniString("XENAKIOSCOMMANDS","FADEINSHAPEA",TextBuf,g_XenIniFilename.Get());
 	sprintf(TextBuf,"%d",g_command_params.CommandFadeInShapeB);
-	WritePrivateProfileString("XENAKIOSCOMMANDS","FADEINSHAPEB",TextBuf,g_XenIniFilename.Get());
+	SNM_SetIniString("XENAKIOSCOMMANDS","FADEINSHAPEB",TextBuf,g_XenIniFilename.Get());
 	sprintf(TextBuf,"%d",g_command_params.CommandFadeOutShapeA);
-	WritePrivateProfileString("XENAKIOSCOMMANDS","FADEOUTSHAPEA",TextBuf,g_XenIniFilename.Get());
+	SNM_SetIniString("XENAKIOSCOMMANDS","FADEOUTSHAPEA",TextBuf,g_XenIniFilename.Get());
 	sprintf(TextBuf,"%d",g_command_params.CommandFadeOutShapeB);
-	WritePrivateProfileString("XENAKIOSCOMMANDS","FADEOUTSHAPEB",TextBuf,g_XenIniFilename.Get());
+	SNM_SetIniString("XENAKIOSCOMMANDS","FADEOUTSHAPEB",TextBuf,g_XenIniFilename.Get());
 	
 	sprintf(TextBuf,"%f",g_command_params.EditCurRndMean);
-	WritePrivateProfileString("XENAKIOSCOMMANDS","EDITCURRNDMEAN",TextBuf,g_XenIniFilename.Get());
+	SNM_SetIniString("XENAKIOSCOMMANDS","EDITCURRNDMEAN",TextBuf,g_XenIniFilename.Get());
 	
 	sprintf(TextBuf,"%f",g_command_params.ItemVolumeNudge);
-	WritePrivateProfileString("XENAKIOSCOMMANDS","ITEMVOLUMENUDGE",TextBuf,g_XenIniFilename.Get());
+	SNM_SetIniString("XENAKIOSCOMMANDS","ITEMVOLUMENUDGE",TextBuf,g_XenIniFilename.Get());
 	
 	sprintf(TextBuf,"%f",g_command_params.ItemPitchNudgeA);
-	WritePrivateProfileString("XENAKIOSCOMMANDS","ITEMPITCHNUDGE",TextBuf,g_XenIniFilename.Get());
+	SNM_SetIniString("XENAKIOSCOMMANDS","ITEMPITCHNUDGE",TextBuf,g_XenIniFilename.Get());
 	sprintf(TextBuf,"%f",g_command_params.ItemPitchNudgeB);
-	WritePrivateProfileString("XENAKIOSCOMMANDS","ITEMPITCHNUDGEB",TextBuf,g_XenIniFilename.Get());
+	SNM_SetIniString("XENAKIOSCOMMANDS","ITEMPITCHNUDGEB",TextBuf,g_XenIniFilename.Get());
 	
 	sprintf(TextBuf,"%f",g_command_params.RndItemSelProb);
-	WritePrivateProfileString("XENAKIOSCOMMANDS","RNDITEMSELPROB",TextBuf,g_XenIniFilename.Get());
+	SNM_SetIniString("XENAKIOSCOMMANDS","RNDITEMSELPROB",TextBuf,g_XenIniFilename.Get());
 	if (g_external_app_paths.PathToTool1)
-		WritePrivateProfileString("XENAKIOSCOMMANDS","EXTERNALTOOL1PATH",g_external_app_paths.PathToTool1,g_XenIniFilename.Get());
+		SNM_SetIniString("XENAKIOSCOMMANDS","EXTERNALTOOL1PATH",g_external_app_paths.PathToTool1,g_XenIniFilename.Get());
 	if (g_external_app_paths.PathToTool2)
-		WritePrivateProfileString("XENAKIOSCOMMANDS","EXTERNALTOOL2PATH",g_external_app_paths.PathToTool2,g_XenIniFilename.Get());
+		SNM_SetIniString("XENAKIOSCOMMANDS","EXTERNALTOOL2PATH",g_external_app_paths.PathToTool2,g_XenIniFilename.Get());
 	if (g_external_app_paths.PathToAudioEditor1)
-		WritePrivateProfileString("XENAKIOSCOMMANDS","EXTERNALEDITOR1PATH",g_external_app_paths.PathToAudioEditor1,g_XenIniFilename.Get());
+		SNM_SetIniString("XENAKIOSCOMMANDS","EXTERNALEDITOR1PATH",g_external_app_paths.PathToAudioEditor1,g_XenIniFilename.Get());
 	if (g_external_app_paths.PathToAudioEditor2)
-		WritePrivateProfileString("XENAKIOSCOMMANDS","EXTERNALEDITOR2PATH",g_external_app_paths.PathToAudioEditor2,g_XenIniFilename.Get());
+		SNM_SetIniString("XENAKIOSCOMMANDS","EXTERNALEDITOR2PATH",g_external_app_paths.PathToAudioEditor2,g_XenIniFilename.Get());
 
 	sprintf(TextBuf,"%d",g_command_params.PixAmount);
-	WritePrivateProfileString("XENAKIOSCOMMANDS","PIXELAMOUNT",TextBuf,g_XenIniFilename.Get());
+	SNM_SetIniString("XENAKIOSCOMMANDS","PIXELAMOUNT",TextBuf,g_XenIniFilename.Get());
 
 	sprintf(TextBuf,"%f",g_command_params.CurPosSecsAmount);
-	WritePrivateProfileString("XENAKIOSCOMMANDS","CURPOSSECSAMOUNT",TextBuf,g_XenIniFilename.Get());
+	SNM_SetIniString("XENAKIOSCOMMANDS","CURPOSSECSAMOUNT",TextBuf,g_XenIniFilename.Get());
 	
 	sprintf(TextBuf,"%d",g_command_params.TrackHeight[0]);
-	WritePrivateProfileString("XENAKIOSCOMMANDS","TRACKHEIGHTA",TextBuf,g_XenIniFilename.Get());
+	SNM_SetIniString("XENAKIOSCOMMANDS","TRACKHEIGHTA",TextBuf,g_XenIniFilename.Get());
 	sprintf(TextBuf,"%d",g_command_params.TrackHeight[1]);
-	WritePrivateProfileString("XENAKIOSCOMMANDS","TRACKHEIGHTB",TextBuf,g_XenIniFilename.Get());
+	SNM_SetIniString("XENAKIOSCOMMANDS","TRACKHEIGHTB",TextBuf,g_XenIniFilename.Get());
 
 	sprintf(TextBuf,"%f",g_command_params.SectionLoopNudgeSecs);
-	WritePrivateProfileString("XENAKIOSCOMMANDS","SECTLOOPNUDGESECS",TextBuf,g_XenIniFilename.Get());
+	SNM_SetIniString("XENAKIOSCOMMANDS","SECTLOOPNUDGESECS",TextBuf,g_XenIniFilename.Get());
 
-	WritePrivateProfileString("XENAKIOSCOMMANDS","TRACKLABELDEFAULT",g_command_params.DefaultTrackLabel.c_str(),g_XenIniFilename.Get());
-	WritePrivateProfileString("XENAKIOSCOMMANDS","TRACKLABELPREFIX",g_command_params.TrackLabelPrefix.c_str(),g_XenIniFilename.Get());
-	WritePrivateProfileString("XENAKIOSCOMMANDS","TRACKLABELSUFFIX",g_command_params.TrackLabelSuffix.c_str(),g_XenIniFilename.Get());
+	SNM_SetIniString("XENAKIOSCOMMANDS","TRACKLABELDEFAULT",g_command_params.DefaultTrackLabel.c_str(),g_XenIniFilename.Get());
+	SNM_SetIniString("XENAKIOSCOMMANDS","TRACKLABELPREFIX",g_command_params.TrackLabelPrefix.c_str(),g_XenIniFilename.Get());
+	SNM_SetIniString("XENAKIOSCOMMANDS","TRACKLABELSUFFIX",g_command_params.TrackLabelSuffix.c_str(),g_XenIniFilename.Get());
+
+	SNM_FlushIniFile(g_XenIniFilename.Get()); // one file rewrite for all the above
 }
 
 WDL_DLGRET ExoticParamsDlgProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
@@ -32,6 +32,7 @@
 #include "./nofish/nofish.h" // NF_IsObeyTrackHeightLockEnabled
 #include "./ObjectState/TrackEnvelope.h"
 #include "./SnM/SnM_Dlg.h"
+#include "./Utility/ArrangeIndex.h"
 
 #include <WDL/localize/localize.h>
 
@@ -670,37 +671,18 @@ MediaTrack* TrackAtPoint(HWND hTrackView, int iY, int* iOffset, int* iYMin, int*
 	si.fMask = SIF_ALL;
 	CoolSB_GetScrollInfo(hTrackView, SB_VERT, &si);
 
-	int iVPos = -si.nPos; // Account for current scroll pos
-	int iTrack = 0;
-	int iTrackH = 0;
-
-	// Find the current track #
-	while (iTrack <= GetNumTracks())
-	{
-		MediaTrack* track = CSurf_TrackFromID(iTrack, false);
-		iTrackH = *(int*)GetSetMediaTrackInfo(track, "I_WNDH", NULL);
-		if (iVPos + iTrackH > iY)
-			break;
-		if (iTrack == 0 && TcpVis(track) && iTrackH != 0)
-			iTrackH += GetMasterTcpGap();
-		iVPos += iTrackH;
-		iTrack++;
-	}
-
-	// Set extents if outside of std region
+	// Find the current track # (and its extents, or the tracks' end if outside of std region)
+	int iYMin2, iYMax2;
+	const int iTrack = ArrangeIndex_GetTrackAtY(iY, si.nPos, &iYMin2, &iYMax2);
 	if (iYMin)
-		*iYMin = iVPos;
+		*iYMin = iYMin2;
 	if (iYMax)
-		*iYMax = iVPos;
+		*iYMax = iYMax2;
 
-	if (iTrack <= GetNumTracks())
+	if (iTrack >= 0)
 	{
-		if (iYMin)
-			*iYMin = iVPos;
-		if (iYMax)
-			*iYMax = iVPos + iTrackH;
 		if (iOffset)
-			*iOffset = iY - iVPos;
+			*iOffset = iY - iYMin2;
 		return CSurf_TrackFromID(iTrack, false);
 	}
 	return NULL;
@@ -734,20 +716,16 @@ MediaItem* ItemAtPoint(HWND hTrackView, POINT p, RECT* rExtents, MediaTrack** pT
 	double dPos = (p.x + si.nPos) / GetHZoomLevel();
 
 	// Then, maybe find an item
-	for (int i = 0; i < GetTrackNumMediaItems(tr); i++)
+	if (MediaItem* mi = ArrangeIndex_GetItemAt(tr, dPos))
 	{
-		MediaItem* mi = GetTrackMediaItem(tr, i);
 		double dStart = *(double*)GetSetMediaItemInfo(mi, "D_POSITION", NULL);
 		double dEnd   = *(double*)GetSetMediaItemInfo(mi, "D_LENGTH", NULL) + dStart;
-		if (dPos >= dStart && dPos <= dEnd)
+		if (rExtents)
 		{
-			if (rExtents)
-			{
-				rExtents->left  = (int)(GetHZoomLevel() * dStart + 0.5) - si.nPos;
-				rExtents->right = (int)(GetHZoomLevel() * dEnd + 0.5) - si.nPos;
-			}
-			return mi;
+			rExtents->left  = (int)(GetHZoomLevel() * dStart + 0.5) - si.nPos;
+			rExtents->right = (int)(GetHZoomLevel() * dEnd + 0.5) - si.nPos;
 		}
+		return mi;
 	}
 	return NULL;
 }
@@ -1,15 +1,42 @@
 #include "stdafx.h"
 #include "pitchshiftsource.hpp"
 
+// frames per gain kernel pass
+static constexpr int GAIN_CHUNK { 128 };
+
+PitchShiftSource::ParamsBuffer::ParamsBuffer(const Params &params)
+  : m_slots { params, params, params }, m_middle { 1 }, m_back { 0 }, m_front { 2 }
+{
+}
+
+void PitchShiftSource::ParamsBuffer::publish(const Params &params)
+{
+  m_slots[m_back] = params;
+  m_back = m_middle.exchange(m_back | NewFlag, std::memory_order_acq_rel) & IndexMask;
+}
+
+auto PitchShiftSource::ParamsBuffer::read() -> const Params &
+{
+  if(m_middle.load(std::memory_order_relaxed) & NewFlag)
+    m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & IndexMask;
+  return m_slots[m_front];
+}
+
 PitchShiftSource::PitchShiftSource(PCM_source *src)
-  : m_pitch { 0.0 }, m_rate { 1.0 }, m_volume { 1.0 }, m_pan { 0.0 },
-    m_fadeInLen { 0.0 }, m_fadeOutLen { 0.0 }, m_preservePitch { true },
-    m_mode { -1 }, m_src { src->Duplicate() },
+  : m_params {
+      0.0, 1.0, 1.0, 0.0, // pitch, rate, volume, pan
+      0.0, 0.0, 0.0,      // fadeInLen, fadeOutLen, fadeOutEnd
+      true, -1,           // preservePitch, mode
+    },
+    m_shared { m_params }, m_rate { m_params.rate },
+    m_src { src->Duplicate() },
     m_ps { ReaperGetPitchShiftAPI(REAPER_PITCHSHIFT_API_VER) },
-    m_readTime { 0.0 }, m_writeTime { 0.0 }, m_playTime { 0.0 }, m_fadeOutEnd { 0.0 }
+    m_applied { m_params }, m_volume { m_params.volume }, m_pan { m_params.pan },
+    m_readTime { 0.0 }, m_writeTime { 0.0 }, m_playTime { 0.0 }
 {
-  updateTempoShift();
-  m_ps->SetQualityParameter(m_mode);
+  m_ps->set_tempo(m_applied.rate);
+  m_ps->set_shift(1.0);
+  m_ps->SetQualityParameter(m_applied.mode);
 }
 
 PitchShiftSource::~PitchShiftSource()
@@ -21,66 +48,136 @@ PitchShiftSource::~PitchShiftSource()
 
 double PitchShiftSource::GetLength()
 {
-  WDL_MutexLockShared lock { &m_mutex };
-  return currentLength();
-}
-
-double PitchShiftSource::currentLength()
-{
-  return m_src->GetLength() / m_rate;
+  return m_src->GetLength() / m_rate.load(std::memory_order_relaxed);
 }
 
 bool PitchShiftSource::isPastEnd(const double position)
 {
-  WDL_MutexLockShared lock { &m_mutex };
-  return position >= currentLength() || (m_fadeOutEnd && position >= m_fadeOutEnd);
+  return position >= m_src->GetLength() / m_params.rate ||
+    (m_params.fadeOutEnd && position >= m_params.fadeOutEnd);
 }
 
 void PitchShiftSource::GetSamples(PCM_source_transfer_t *block)
 {
-  WDL_MutexLockShared lock { &m_mutex };
-  if(m_rate == 1.0 && m_pitch == 0.0)
+  const Params &params { m_shared.read() };
+  applyParams(params);
+
+  if(params.rate == 1.0 && params.pitch == 0.0)
     m_src->GetSamples(block);
   else
-    getShiftedSamples(block);
+    getShiftedSamples(block, params.rate);
 
   const double sampleTime   { 1.0 / block->samplerate },
-               fadeOutEnd   { m_fadeOutEnd ? m_fadeOutEnd : currentLength() },
-               fadeOutStart { fadeOutEnd - m_fadeOutLen },
+               fadeOutEnd   { params.fadeOutEnd ? params.fadeOutEnd
+                                                : m_src->GetLength() / params.rate },
+               fadeOutStart { fadeOutEnd - params.fadeOutLen },
                blockEndTime { block->time_s + (block->length * sampleTime) };
 
-  if(m_volume != 1.0 || m_pan != 0.0 ||
-     m_playTime < m_fadeInLen || blockEndTime >= fadeOutStart)
-    applyGain(block, sampleTime, fadeOutStart);
+  if(m_playTime == 0.0) {
+    // nothing to smooth from before the first block
+    m_volume = params.volume;
+    m_pan = params.pan;
+  }
+
+  if(params.volume != 1.0 || params.pan != 0.0 ||
+     m_volume != params.volume || m_pan != params.pan ||
+     m_playTime < params.fadeInLen || blockEndTime >= fadeOutStart)
+    applyGain(block, params, sampleTime, fadeOutStart);
   else
     m_playTime += block->length * sampleTime;
 }
 
+// number of frames before a linear ramp (value + i * step) reaches limit
+static int framesBefore(const double value, const double step,
+  const double limit, const int count)
+{
+  if(step == 0.0)
+    return count;
+
+  const double frames { (limit - value) / step };
+  if(!(frames > 0.0))
+    return 0;
+  return frames < count ? static_cast<int>(ceil(frames)) : count;
+}
+
+// volume and pan are ramped from their previous value over the block to avoid
+// zipper noise when they are automated; fade limits are computed per chunk so
+// that the loops below have no branches nor divides and can be vectorized
 void PitchShiftSource::applyGain(PCM_source_transfer_t *block,
-  const double sampleTime, const double fadeOutStart)
+  const Params &params, const double sampleTime, const double fadeOutStart)
 {
   // no pan law
-  const double pan[] {
-    m_pan > 0 ? 1.0 - m_pan : 1.0, // left
-    m_pan < 0 ? m_pan + 1.0 : 1.0, // right
-  };
-
-  ReaSample *sample { block->samples },
-            *lastSample { sample + (block->samples_out * block->nch) };
-
-  for(double time { block->time_s }; sample < lastSample; sample += block->nch) {
-    const double fadeIn { m_playTime < m_fadeInLen ? m_playTime / m_fadeInLen : 1.0 },
-                 timeInFadeOut { m_fadeOutLen ? time - fadeOutStart : 0.0 },
-                 fadeOut { timeInFadeOut > 0 ? 1 - (timeInFadeOut / m_fadeOutLen) : 1.0 },
-                 gain { m_volume * fadeIn * fadeOut };
-    for(int i {}; i < block->nch; ++i)
-      sample[i] *= gain * pan[i & 1];
-    time += sampleTime;
-    m_playTime += sampleTime;
+  const auto panLeft  = [](const double pan) { return pan > 0 ? 1.0 - pan : 1.0; };
+  const auto panRight = [](const double pan) { return pan < 0 ? pan + 1.0 : 1.0; };
+
+  const int frames { block->samples_out }, nch { block->nch };
+  if(frames <= 0 || nch <= 0) {
+    m_volume = params.volume;
+    m_pan = params.pan;
+    return;
+  }
+
+  // every gain factor is linear in time (before clamping)
+  const double volStep   { (params.volume - m_volume) / frames },
+               leftStep  { (panLeft(params.pan) - panLeft(m_pan)) / frames },
+               rightStep { (panRight(params.pan) - panRight(m_pan)) / frames },
+               fadeInStep  { params.fadeInLen > 0 ? sampleTime / params.fadeInLen : 0.0 },
+               fadeOutStep { params.fadeOutLen > 0 ? -sampleTime / params.fadeOutLen : 0.0 };
+  double volume { m_volume }, left { panLeft(m_pan) }, right { panRight(m_pan) },
+         fadeIn  { params.fadeInLen > 0 ? m_playTime / params.fadeInLen : 1.0 },
+         fadeOut { params.fadeOutLen > 0 ?
+                   1.0 - ((block->time_s - fadeOutStart) / params.fadeOutLen) : 1.0 };
+
+  double gain[GAIN_CHUNK], gainLeft[GAIN_CHUNK], gainRight[GAIN_CHUNK];
+  ReaSample *samples { block->samples };
+
+  for(int done {}; done < frames; done += GAIN_CHUNK) {
+    const int count { frames - done < GAIN_CHUNK ? frames - done : GAIN_CHUNK },
+              fadeInEnd { fadeIn < 1.0 ? framesBefore(fadeIn, fadeInStep, 1.0, count) : 0 },
+              fadeOutBegin { fadeOut < 1.0 ? 0 : framesBefore(fadeOut, fadeOutStep, 1.0, count) },
+              silenceBegin { fadeOut > 0.0 ? framesBefore(fadeOut, fadeOutStep, 0.0, count) : 0 };
+
+    for(int i {}; i < count; ++i)
+      gain[i] = volume + (i * volStep);
+    for(int i {}; i < fadeInEnd; ++i)
+      gain[i] *= fadeIn + (i * fadeInStep);
+    for(int i { fadeOutBegin }; i < silenceBegin; ++i)
+      gain[i] *= fadeOut + (i * fadeOutStep);
+    for(int i { silenceBegin }; i < count; ++i)
+      gain[i] = 0.0;
+    for(int i {}; i < count; ++i) {
+      gainLeft[i]  = gain[i] * (left + (i * leftStep));
+      gainRight[i] = gain[i] * (right + (i * rightStep));
+    }
+
+    if(nch == 2) {
+      for(int i {}; i < count; ++i) {
+        samples[i * 2]     *= gainLeft[i];
+        samples[i * 2 + 1] *= gainRight[i];
+      }
+    }
+    else {
+      for(int c {}; c < nch; ++c) {
+        const double *gains { c & 1 ? gainRight : gainLeft };
+        for(int i {}; i < count; ++i)
+          samples[(i * nch) + c] *= gains[i];
+      }
+    }
+
+    samples += count * nch;
+    volume  += count * volStep;
+    left    += count * leftStep;
+    right   += count * rightStep;
+    fadeIn  += count * fadeInStep;
+    fadeOut += count * fadeOutStep;
   }
+
+  m_volume = params.volume;
+  m_pan = params.pan;
+  m_playTime += frames * sampleTime;
 }
 
-void PitchShiftSource::getShiftedSamples(PCM_source_transfer_t *block)
+void PitchShiftSource::getShiftedSamples(PCM_source_transfer_t *block, const double rate)
 {
   m_ps->set_srate(block->samplerate);
   m_ps->set_nch(block->nch);
@@ -88,12 +185,12 @@ void PitchShiftSource::getShiftedSamples(PCM_source_transfer_t *block)
   PCM_source_transfer_t sourceBlock {};
   sourceBlock.samplerate = block->samplerate;
   sourceBlock.nch = block->nch;
-  sourceBlock.length = static_cast<int>(block->length * m_rate);
+  sourceBlock.length = static_cast<int>(block->length * rate);
 
   const double sampleTime { 1.0 / block->samplerate };
   if(m_writeTime != block->time_s) {
     // reset m_readTime when seeking
-    m_readTime  = block->time_s * m_rate;
+    m_readTime  = block->time_s * rate;
     m_writeTime = block->time_s;
     m_ps->Reset(); // to give immediate feedback with very slow play rates
   }
@@ -115,102 +212,112 @@ void PitchShiftSource::getShiftedSamples(PCM_source_transfer_t *block)
   } while(sourceBlock.samples_out == sourceBlock.length); // until EOF
 }
 
-void PitchShiftSource::updateTempoShift()
+// reconfigures the pitch shifter from the audio thread, where it is used
+void PitchShiftSource::applyParams(const Params &params)
 {
-  double shift { pow(2.0, m_pitch / 12.0) };
-  if(!m_preservePitch)
-    shift *= m_rate;
+  if(params.mode != m_applied.mode)
+    m_ps->SetQualityParameter(params.mode);
+
+  if(params.rate != m_applied.rate || params.pitch != m_applied.pitch ||
+     params.preservePitch != m_applied.preservePitch) {
+    double shift { pow(2.0, params.pitch / 12.0) };
+    if(!params.preservePitch)
+      shift *= params.rate;
+
+    m_ps->set_tempo(params.rate);
+    m_ps->set_shift(shift);
+
+    // to have getShiftedSamples reset m_readTime and m_ps next time it's used
+    if(params.rate == 1.0 && params.pitch == 0.0)
+      m_writeTime = 0.0;
+  }
 
-  m_ps->set_tempo(m_rate);
-  m_ps->set_shift(shift);
+  m_applied = params;
+}
 
-  // to have getShiftedSamples reset m_readTime and m_ps next time it's used
-  if(m_rate == 1.0 && m_pitch == 0.0)
-    m_writeTime = 0.0;
+void PitchShiftSource::publish()
+{
+  m_rate.store(m_params.rate, std::memory_order_relaxed);
+  m_shared.publish(m_params);
 }
 
 void PitchShiftSource::setVolume(const double volume)
 {
-  // OK to read unlocked: only called/modified from the main thread
-  if(volume == m_volume || volume < 0)
-    return; // don't exclusively lock the mutex for no reason
+  if(volume == m_params.volume || volume < 0)
+    return;
 
-  WDL_MutexLockExclusive lock { &m_mutex };
-  m_volume = volume;
+  m_params.volume = volume;
+  publish();
 }
 
 void PitchShiftSource::setPan(const double pan)
 {
-  if(pan == m_pan || pan < -1 || pan > 1)
+  if(pan == m_params.pan || pan < -1 || pan > 1)
     return;
 
-  WDL_MutexLockExclusive lock { &m_mutex };
-  m_pan = pan;
+  m_params.pan = pan;
+  publish();
 }
 
 void PitchShiftSource::setPlayRate(const double playRate)
 {
-  if(playRate < 0.1 || playRate == m_rate)
+  if(playRate < 0.1 || playRate == m_params.rate)
     return;
 
-  WDL_MutexLockExclusive lock { &m_mutex };
-  m_rate = playRate;
-  updateTempoShift();
+  m_params.rate = playRate;
+  publish();
 }
 
 void PitchShiftSource::setPitch(const double pitch)
 {
-  if(pitch == m_pitch)
+  if(pitch == m_params.pitch)
     return;
 
-  WDL_MutexLockExclusive lock { &m_mutex };
-  m_pitch = pitch;
-  updateTempoShift();
+  m_params.pitch = pitch;
+  publish();
 }
 
 void PitchShiftSource::setPreservePitch(const bool preservePitch)
 {
-  if(preservePitch == m_preservePitch)
+  if(preservePitch == m_params.preservePitch)
     return;
 
-  WDL_MutexLockExclusive lock { &m_mutex };
-  m_preservePitch = preservePitch;
-  updateTempoShift();
+  m_params.preservePitch = preservePitch;
+  publish();
 }
 
 void PitchShiftSource::setMode(const int mode)
 {
-  if(mode == m_mode)
+  if(mode == m_params.mode)
     return;
 
-  WDL_MutexLockExclusive lock { &m_mutex };
-  m_ps->SetQualityParameter(mode);
-  m_mode = mode;
+  m_params.mode = mode;
+  publish();
 }
 
 void PitchShiftSource::setFadeInLen(const double len)
 {
-  if(len == m_fadeInLen)
+  if(len == m_params.fadeInLen)
     return;
 
-  WDL_MutexLockExclusive lock { &m_mutex };
-  m_fadeInLen = len;
+  m_params.fadeInLen = len;
+  publish();
 }
 
 void PitchShiftSource::setFadeOutLen(const double len)
 {
-  if(len == m_fadeOutLen)
+  if(len == m_params.fadeOutLen)
     return;
 
-  WDL_MutexLockExclusive lock { &m_mutex };
-  m_fadeOutLen = len;
+  m_params.fadeOutLen = len;
+  publish();
 }
 
 void PitchShiftSource::setFadeOutEnd(const double time)
 {
-  if(time == m_fadeOutEnd)
+  if(time == m_params.fadeOutEnd)
     return;
 
-  WDL_MutexLockExclusive lock { &m_mutex };
-  m_fadeOutEnd = time;
+  m_params.fadeOutEnd = time;
+  publish();
 }
@@ -27,7 +27,7 @@
 
 #pragma once
 
-#include <WDL/mutex.h>
+#include <atomic>
 
 class PitchShiftSource : public PCM_source {
 public:
@@ -53,40 +53,63 @@ public:
 
   // only safe to call from the main thread
   bool isPastEnd(double position);
-  double getVolume() { return m_volume; }
+  double getVolume() { return m_params.volume; }
   void   setVolume(double v);
-  double getPan() { return m_pan; }
+  double getPan() { return m_params.pan; }
   void   setPan(double p);
-  double getPlayRate() { return m_rate; }
+  double getPlayRate() { return m_params.rate; }
   void   setPlayRate(double);
-  double getPitch() { return m_pitch; }
+  double getPitch() { return m_params.pitch; }
   void   setPitch(double);
-  bool   getPreservePitch() { return m_preservePitch; }
+  bool   getPreservePitch() { return m_params.preservePitch; }
   void   setPreservePitch(bool);
-  int    getMode() { return m_mode; }
+  int    getMode() { return m_params.mode; }
   void   setMode(int);
-  double getFadeInLen() { return m_fadeInLen; }
+  double getFadeInLen() { return m_params.fadeInLen; }
   void   setFadeInLen(double);
-  double getFadeOutLen() { return m_fadeOutLen; }
+  double getFadeOutLen() { return m_params.fadeOutLen; }
   void   setFadeOutLen(double);
-  double getFadeOutEnd() { return m_fadeOutEnd; }
+  double getFadeOutEnd() { return m_params.fadeOutEnd; }
   void   setFadeOutEnd(double);
 
 private:
-  // must lock m_mutex before using these
-  double currentLength();
-  void getShiftedSamples(PCM_source_transfer_t *);
-  void applyGain(PCM_source_transfer_t *, double sampleTime, double fadeOutStart);
-  void updateTempoShift();
+  struct Params {
+    double pitch, rate, volume, pan, fadeInLen, fadeOutLen, fadeOutEnd;
+    bool preservePitch;
+    int mode;
+  };
 
-  double m_pitch, m_rate, m_volume, m_pan, m_fadeInLen, m_fadeOutLen;
-  bool m_preservePitch;
-  int m_mode;
+  // triple buffer: one writer (main thread), one reader (audio thread),
+  // neither of them ever waits for the other
+  class ParamsBuffer {
+  public:
+    ParamsBuffer(const Params &);
+    void publish(const Params &);
+    const Params &read(); // latest published parameters
+
+  private:
+    enum { IndexMask = 3, NewFlag = 4 };
+    Params m_slots[3];
+    std::atomic<int> m_middle; // slot index | NewFlag if not read yet
+    int m_back, m_front;
+  };
+
+  void publish();
+
+  // audio thread only
+  void applyParams(const Params &);
+  void getShiftedSamples(PCM_source_transfer_t *, double rate);
+  void applyGain(PCM_source_transfer_t *, const Params &,
+                 double sampleTime, double fadeOutStart);
+
+  Params m_params; // main thread's copy
+  ParamsBuffer m_shared;
+  std::atomic<double> m_rate; // for GetLength, which may be called from any thread
 
-  WDL_SharedMutex m_mutex;
   PCM_source *m_src;
   IReaperPitchShift *m_ps;
+  Params m_applied; // settings of m_ps
+  double m_volume, m_pan; // smoothed gain, in sync with the last processed block
   double m_readTime, m_writeTime; // for pitch-shifting
   double m_playTime; // position-independent
-  double m_fadeOutEnd;
 };
@@ -16,10 +16,14 @@ find_package_handle_standard_args(ZLIB REQUIRED_VARS ZLIB_INCLUDE_DIR)
 
 add_library(z
   ${ZLIB_INCLUDE_DIR}/adler32.c
+  ${ZLIB_INCLUDE_DIR}/compress.c
   ${ZLIB_INCLUDE_DIR}/crc32.c
+  ${ZLIB_INCLUDE_DIR}/deflate.c
   ${ZLIB_INCLUDE_DIR}/inffast.c
   ${ZLIB_INCLUDE_DIR}/inflate.c
   ${ZLIB_INCLUDE_DIR}/inftrees.c
+  ${ZLIB_INCLUDE_DIR}/trees.c
+  ${ZLIB_INCLUDE_DIR}/uncompr.c
   ${ZLIB_INCLUDE_DIR}/zutil.c
 )
 
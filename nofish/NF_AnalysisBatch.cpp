@@ -0,0 +1,284 @@
+/******************************************************************************
+/ NF_AnalysisBatch.cpp
+/
+/ Copyright (c) 2023 ReaTeam
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/ 
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/ 
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+
+#include "stdafx.h"
+#include "NF_AnalysisBatch.h"
+
+#include "../Breeder/BR_Loudness.h"
+#include "../Breeder/BR_Util.h" // NEGATIVE_INF
+#include "../Misc/Analysis.h"
+#include "../sws_waitdlg.h"
+
+#include <WDL/localize/localize.h>
+#include <thread>
+
+NF_AnalysisBatch::Job::Job (MediaItem* item) :
+item       (item),
+pcm        (NULL),
+samplerate (0.0),
+loudness   (NULL)
+{
+	for (int i = 0; i < NF_ANALYZE_METRICS_COUNT; ++i)
+		results[i] = NEGATIVE_INF;
+	results[MetricIndex(NF_ANALYZE_PEAK_POS)]      = -1;
+	results[MetricIndex(NF_ANALYZE_TRUE_PEAK_POS)] = -1;
+	results[MetricIndex(NF_ANALYZE_LRA)]           = 0;
+}
+
+NF_AnalysisBatch::Job::~Job ()
+{
+	delete pcm;
+	delete loudness;
+}
+
+NF_AnalysisBatch::NF_AnalysisBatch () :
+m_metrics    (0),
+m_nextJob    (0),
+m_doneJobs   (0),
+m_windowSize (0.0),
+m_progress   (0.0),
+m_started    (false),
+m_abort      (false)
+{
+}
+
+NF_AnalysisBatch::~NF_AnalysisBatch ()
+{
+	this->Abort();
+}
+
+bool NF_AnalysisBatch::AddItem (MediaItem* item)
+{
+	if (m_started || !item)
+		return false;
+
+	m_jobs.Add(new Job(item));
+	return true;
+}
+
+int NF_AnalysisBatch::CountItems ()
+{
+	return m_jobs.GetSize();
+}
+
+bool NF_AnalysisBatch::Start (int metrics, bool wait)
+{
+	metrics &= NF_ANALYZE_PEAK_RMS_MASK | NF_ANALYZE_LOUDNESS_MASK;
+	if (m_started || !metrics)
+		return false;
+
+	m_metrics = metrics;
+	m_started = true;
+	if (metrics & NF_ANALYZE_RMS_WINDOWED)
+		NF_GetRMSOptions(NULL, &m_windowSize);
+
+	// Sources and audio accessors can only be created from the main thread
+	const bool doPeakRMS      = !!(metrics & NF_ANALYZE_PEAK_RMS_MASK);
+	const bool doLoudness     = !!(metrics & NF_ANALYZE_LOUDNESS_MASK);
+	const bool integratedOnly = (metrics & NF_ANALYZE_LOUDNESS_MASK) == NF_ANALYZE_LUFS_I;
+	const bool doTruePeak     = !!(metrics & (NF_ANALYZE_TRUE_PEAK | NF_ANALYZE_TRUE_PEAK_POS));
+	const bool highPrecision  = doLoudness && IsHighPrecisionOptionEnabled(NULL);
+
+	for (int i = 0; i < m_jobs.GetSize(); ++i)
+	{
+		Job* job = m_jobs.Get(i);
+		if (!ValidatePtr2(NULL, job->item, "MediaItem*"))
+			continue;
+
+		if (doPeakRMS && (job->pcm = PrepareItemAnalysis(job->item)))
+			job->samplerate = job->pcm->GetSampleRate();
+
+		MediaItem_Take* take = doLoudness ? GetActiveTake(job->item) : NULL;
+		if (take && !TakeIsMIDI(take))
+		{
+			job->loudness = new BR_LoudnessObject(take);
+			if (!job->loudness->PrepareAnalyze(integratedOnly, doTruePeak, highPrecision, false))
+			{
+				delete job->loudness;
+				job->loudness = NULL;
+			}
+		}
+	}
+
+	if (!m_jobs.GetSize())
+	{
+		SWS_SectionLock lock(&m_mutex);
+		m_progress = 1.0;
+		return true;
+	}
+
+	const int workers = min((int)max(std::thread::hardware_concurrency(), 1u), m_jobs.GetSize());
+	for (int i = 0; i < workers; ++i)
+		m_workers.Add((void*)_beginthreadex(NULL, 0, NF_AnalysisBatch::WorkerThread, (void*)this, 0, NULL));
+
+	if (wait)
+	{
+		SWS_WaitDlg waitDlg(__LOCALIZE("Please wait, analyzing items...","sws_analysis"), &m_progress, NULL, &m_mutex);
+		this->WaitWorkers();
+	}
+	return true;
+}
+
+void NF_AnalysisBatch::Abort ()
+{
+	{
+		SWS_SectionLock lock(&m_mutex);
+		m_abort = true;
+		for (int i = 0; i < m_nextJob; ++i) // jobs being analyzed, others won't start
+			if (BR_LoudnessObject* loudness = m_jobs.Get(i)->loudness)
+				loudness->RequestAbort();
+	}
+
+	this->WaitWorkers();
+	SWS_SectionLock lock(&m_mutex);
+	m_progress = 1.0;
+}
+
+bool NF_AnalysisBatch::IsRunning ()
+{
+	SWS_SectionLock lock(&m_mutex);
+	return m_started && !m_abort && m_doneJobs < m_jobs.GetSize();
+}
+
+double NF_AnalysisBatch::GetProgress ()
+{
+	SWS_SectionLock lock(&m_mutex);
+	return m_progress;
+}
+
+int NF_AnalysisBatch::GetResults (int metric, double* values, int valuesSz)
+{
+	const int id = MetricIndex(metric);
+	if (id < 0 || !(m_metrics & metric) || !values)
+		return 0;
+
+	SWS_SectionLock lock(&m_mutex);
+	if (!m_started || m_abort || m_doneJobs < m_jobs.GetSize())
+		return 0;
+
+	const int count = min(valuesSz, m_jobs.GetSize());
+	for (int i = 0; i < count; ++i)
+		values[i] = m_jobs.Get(i)->results[id];
+	return count;
+}
+
+unsigned WINAPI NF_AnalysisBatch::WorkerThread (void* batch)
+{
+	NF_AnalysisBatch* _this = (NF_AnalysisBatch*)batch;
+	while (Job* job = _this->NextJob())
+	{
+		_this->RunJob(job);
+		_this->JobDone();
+	}
+	return 0;
+}
+
+int NF_AnalysisBatch::MetricIndex (int metric)
+{
+	for (int i = 0; i < NF_ANALYZE_METRICS_COUNT; ++i)
+		if (metric == 1 << i)
+			return i;
+	return -1;
+}
+
+NF_AnalysisBatch::Job* NF_AnalysisBatch::NextJob ()
+{
+	SWS_SectionLock lock(&m_mutex);
+	if (m_abort || m_nextJob >= m_jobs.GetSize())
+		return NULL;
+	return m_jobs.Get(m_nextJob++);
+}
+
+void NF_AnalysisBatch::RunJob (Job* job)
+{
+	double* results = job->results;
+
+	// Peak and all RMS flavors come out of a single pass over the source
+	if (job->pcm && job->samplerate)
+	{
+		const int channels = job->pcm->GetNumChannels();
+
+		ANALYZE_PCM a;
+		memset(&a, 0, sizeof(a));
+		a.pcm = job->pcm;
+		a.iChannels = channels;
+		a.dTotalRMSs = new double[channels];
+		a.dWindowSize = (m_metrics & NF_ANALYZE_RMS_WINDOWED) ? m_windowSize : 0.0;
+
+		if (AnalyzePreparedItem(&a))
+		{
+			double peakRMS = 0.0;
+			for (int i = 0; i < channels; ++i)
+				peakRMS = max(peakRMS, a.dTotalRMSs[i]);
+
+			results[MetricIndex(NF_ANALYZE_PEAK)]        = VAL2DB(a.dPeakVal);
+			results[MetricIndex(NF_ANALYZE_PEAK_POS)]    = a.peakSample / job->samplerate;
+			results[MetricIndex(NF_ANALYZE_RMS_AVERAGE)] = VAL2DB(a.dTotalRMS);
+			results[MetricIndex(NF_ANALYZE_RMS_PEAK)]    = VAL2DB(peakRMS);
+			if (m_metrics & NF_ANALYZE_RMS_WINDOWED)
+				results[MetricIndex(NF_ANALYZE_RMS_WINDOWED)] = VAL2DB(a.dRMS);
+		}
+		delete[] a.dTotalRMSs;
+	}
+
+	if (job->loudness)
+	{
+		job->loudness->AnalyzeInCurrentThread();
+
+		double integrated, range, truePeak, truePeakPos, shortTermMax, momentaryMax;
+		job->loudness->GetAnalyzeData(&integrated, &range, &truePeak, &truePeakPos, &shortTermMax, &momentaryMax, NULL, NULL);
+
+		results[MetricIndex(NF_ANALYZE_LUFS_I)] = integrated;
+		if ((m_metrics & NF_ANALYZE_LOUDNESS_MASK) != NF_ANALYZE_LUFS_I)
+		{
+			results[MetricIndex(NF_ANALYZE_LRA)]         = range;
+			results[MetricIndex(NF_ANALYZE_LUFS_S_MAX)]  = shortTermMax;
+			results[MetricIndex(NF_ANALYZE_LUFS_M_MAX)]  = momentaryMax;
+			if (m_metrics & (NF_ANALYZE_TRUE_PEAK | NF_ANALYZE_TRUE_PEAK_POS))
+			{
+				results[MetricIndex(NF_ANALYZE_TRUE_PEAK)]     = truePeak;
+				results[MetricIndex(NF_ANALYZE_TRUE_PEAK_POS)] = truePeakPos;
+			}
+		}
+	}
+}
+
+void NF_AnalysisBatch::JobDone ()
+{
+	SWS_SectionLock lock(&m_mutex);
+	++m_doneJobs;
+	m_progress = (double)m_doneJobs / m_jobs.GetSize();
+}
+
+void NF_AnalysisBatch::WaitWorkers ()
+{
+	for (int i = 0; i < m_workers.GetSize(); ++i)
+	{
+		WaitForSingleObject((HANDLE)m_workers.Get(i), INFINITE);
+		CloseHandle((HANDLE)m_workers.Get(i));
+	}
+	m_workers.Empty();
+}
@@ -0,0 +1,95 @@
+/******************************************************************************
+/ NF_AnalysisBatch.h
+/
+/ Copyright (c) 2023 ReaTeam
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/ 
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/ 
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+
+#pragma once
+
+class BR_LoudnessObject;
+
+// Metrics bitmask for NF_AnalysisBatch::Start(), GetResults() takes a single one
+enum
+{
+	NF_ANALYZE_PEAK          = 1 << 0,  // max. peak, dBFS
+	NF_ANALYZE_PEAK_POS      = 1 << 1,  // max. peak position, relative to item start
+	NF_ANALYZE_RMS_AVERAGE   = 1 << 2,  // average RMS of all channels, dB
+	NF_ANALYZE_RMS_PEAK      = 1 << 3,  // highest non-windowed channel RMS, dB
+	NF_ANALYZE_RMS_WINDOWED  = 1 << 4,  // highest RMS window (SWS analysis window size), dB
+	NF_ANALYZE_LUFS_I        = 1 << 5,
+	NF_ANALYZE_LRA           = 1 << 6,
+	NF_ANALYZE_TRUE_PEAK     = 1 << 7,  // dBTP
+	NF_ANALYZE_TRUE_PEAK_POS = 1 << 8,  // relative to item start
+	NF_ANALYZE_LUFS_S_MAX    = 1 << 9,
+	NF_ANALYZE_LUFS_M_MAX    = 1 << 10,
+	NF_ANALYZE_METRICS_COUNT = 11,
+
+	NF_ANALYZE_PEAK_RMS_MASK = NF_ANALYZE_PEAK | NF_ANALYZE_PEAK_POS | NF_ANALYZE_RMS_AVERAGE | NF_ANALYZE_RMS_PEAK | NF_ANALYZE_RMS_WINDOWED,
+	NF_ANALYZE_LOUDNESS_MASK = NF_ANALYZE_LUFS_I | NF_ANALYZE_LRA | NF_ANALYZE_TRUE_PEAK | NF_ANALYZE_TRUE_PEAK_POS | NF_ANALYZE_LUFS_S_MAX | NF_ANALYZE_LUFS_M_MAX,
+};
+
+// Analyzes a list of items on a pool of worker threads, all requested metrics
+// of an item are computed by the same job (peak/RMS in a single pass over the audio)
+class NF_AnalysisBatch
+{
+public:
+	NF_AnalysisBatch ();
+	~NF_AnalysisBatch (); // aborts and waits for running jobs
+
+	/* Call from the main thread only */
+	bool AddItem (MediaItem* item); // only before Start()
+	int CountItems ();
+	bool Start (int metrics, bool wait); // wait: blocks with a progress dialog until done
+	void Abort ();
+
+	/* Polling */
+	bool IsRunning ();
+	double GetProgress (); // 0.0-1.0, 1.0 when all jobs are done
+	int GetResults (int metric, double* values, int valuesSz); // returns number of values written, 0 while running
+
+private:
+	struct Job
+	{
+		MediaItem* item;
+		PCM_source* pcm;
+		double samplerate;
+		BR_LoudnessObject* loudness;
+		double results[NF_ANALYZE_METRICS_COUNT];
+		Job (MediaItem* item);
+		~Job ();
+	};
+
+	static unsigned WINAPI WorkerThread (void* batch);
+	static int MetricIndex (int metric);
+	Job* NextJob ();
+	void RunJob (Job* job);
+	void JobDone ();
+	void WaitWorkers ();
+
+	WDL_PtrList_DeleteOnDestroy<Job> m_jobs;
+	WDL_PtrList<void> m_workers;
+	int m_metrics, m_nextJob, m_doneJobs;
+	double m_windowSize, m_progress;
+	bool m_started, m_abort;
+	SWS_Mutex m_mutex;
+};
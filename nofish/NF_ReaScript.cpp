@@ -28,6 +28,7 @@
 
 #include "stdafx.h"
 #include "NF_ReaScript.h"
+#include "NF_AnalysisBatch.h"
 
 #include <taglib/fileref.h>
 #ifdef _WIN32
@@ -261,6 +262,49 @@ bool NF_AnalyzeMediaItemPeakAndRMS(MediaItem* item, double windowSize, void* rea
 	return success;
 }
 
+// batch analysis, the list is just to validate function parameters
+static WDL_PtrList_DOD<NF_AnalysisBatch> g_script_analysisBatches;
+
+NF_AnalysisBatch* NF_AnalysisBatch_Create()
+{
+	return g_script_analysisBatches.Add(new NF_AnalysisBatch());
+}
+
+bool NF_AnalysisBatch_AddItem(NF_AnalysisBatch* batch, MediaItem* item)
+{
+	if (batch && g_script_analysisBatches.Find(batch) >= 0 && ValidatePtr2(NULL, item, "MediaItem*"))
+		return batch->AddItem(item);
+	return false;
+}
+
+bool NF_AnalysisBatch_Start(NF_AnalysisBatch* batch, int metrics, bool wait)
+{
+	if (batch && g_script_analysisBatches.Find(batch) >= 0)
+		return batch->Start(metrics, wait);
+	return false;
+}
+
+double NF_AnalysisBatch_GetProgress(NF_AnalysisBatch* batch)
+{
+	if (batch && g_script_analysisBatches.Find(batch) >= 0)
+		return batch->GetProgress();
+	return -1.0;
+}
+
+int NF_AnalysisBatch_GetResults(NF_AnalysisBatch* batch, int metric, reaper_array* values)
+{
+	if (batch && g_script_analysisBatches.Find(batch) >= 0 && values)
+		return batch->GetResults(metric, values->data, (int)values->size);
+	return 0;
+}
+
+void NF_AnalysisBatch_Free(NF_AnalysisBatch* batch)
+{
+	const int idx = g_script_analysisBatches.Find(batch);
+	if (idx >= 0)
+		g_script_analysisBatches.Delete(idx, true); // aborts running analysis
+}
+
 void NF_GetSWS_RMSoptions(double* targetOut, double* windowSizeOut)
 {
 	NF_GetRMSOptions(targetOut, windowSizeOut);
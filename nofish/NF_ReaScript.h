@@ -28,6 +28,9 @@
 
 #pragma once
 
+class NF_AnalysisBatch;
+struct reaper_array;
+
 // #781
 double          NF_GetMediaItemMaxPeak(MediaItem* item);
 double          NF_GetMediaItemMaxPeakAndMaxPeakPos(MediaItem* item, double* maxPeakPosOut); // // #953
@@ -39,6 +42,14 @@ bool            NF_AnalyzeMediaItemPeakAndRMS(MediaItem* item, double windowSize
 void            NF_GetSWS_RMSoptions(double* targetOut, double* windowSizeOut);
 bool            NF_SetSWS_RMSoptions(double target, double windowSize);
 
+// batch peak/RMS/loudness analysis
+NF_AnalysisBatch* NF_AnalysisBatch_Create();
+bool            NF_AnalysisBatch_AddItem(NF_AnalysisBatch* batch, MediaItem* item);
+bool            NF_AnalysisBatch_Start(NF_AnalysisBatch* batch, int metrics, bool wait);
+double          NF_AnalysisBatch_GetProgress(NF_AnalysisBatch* batch);
+int             NF_AnalysisBatch_GetResults(NF_AnalysisBatch* batch, int metric, reaper_array* values);
+void            NF_AnalysisBatch_Free(NF_AnalysisBatch* batch);
+
 // #880
 bool            NF_AnalyzeTakeLoudness_IntegratedOnly(MediaItem_Take* take, double* lufsIntegratedOut);
 bool            NF_AnalyzeTakeLoudness(MediaItem_Take* take, bool analyzeTruePeak, double* lufsOut, double* rangeOut, double* truePeakOut, double* truePeakPosOut, double* shorTermMaxOut, double* momentaryMaxOut);
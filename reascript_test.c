@@ -70,3 +70,90 @@ const char* SNM_test8(char* buf1, int buf1_sz, const char* buf2, int buf2_sz, in
   if (buf3) lstrcpyn(buf3,"SNM_test8 new parm val for buf3",buf3_sz);
   return "SNM_test8";
 }
+
+// TempoMapSnapshot vs. REAPER's TimeMap2 functions in the current project (use one with tempo/time
+// sig markers, linear ramps, partial measures, etc..): returns the max. error, measure/time sig mismatches in *mismatches
+double SNM_test9(int* mismatches)
+{
+  TempoMapSnapshot map;
+  const double end = GetProjectLength(NULL) + 10.0;
+  const int nbSamples = 10000;
+  double err = 0.0;
+  int errMeasures = 0;
+  for (int i = 0; i <= nbSamples; i++)
+  {
+    const double t = -1.0 + (end + 1.0) * i / nbSamples;
+
+    const double qn = map.TimeToQN(t);
+    err = max(err, fabs(qn - TimeMap2_timeToQN(NULL, t)));
+    err = max(err, fabs(map.QNToTime(qn) - TimeMap2_QNToTime(NULL, qn)));
+    err = max(err, fabs(map.DividedBpmAtTime(t) - TimeMap2_GetDividedBpmAtTime(NULL, t)));
+
+    int m1, m2, num1, num2;
+    const double b1 = map.TimeToBeats(t, &m1, &num1);
+    const double b2 = TimeMap2_timeToBeats(NULL, t, &m2, &num2, NULL, NULL);
+    if (m1 != m2 || num1 != num2)
+      errMeasures++;
+    else
+      err = max(err, fabs(b1 - b2));
+    err = max(err, fabs(map.BeatsToTime(0.0, &m2) - TimeMap2_beatsToTime(NULL, 0.0, &m2)));
+    err = max(err, fabs(map.BeatsToTime(b2) - TimeMap2_beatsToTime(NULL, b2, NULL)));
+  }
+  if (mismatches) *mismatches = errMeasures;
+  return err;
+}
+
+// Base64 codec: RFC 4648 vectors, round-trips around the triplet boundaries (padded or not),
+// wrapped lines through the streaming decoder, invalid input. Returns the number of errors
+int SNM_test10()
+{
+  static const char* vectors[][2] = {
+    {"", ""}, {"f", "Zg=="}, {"fo", "Zm8="}, {"foo", "Zm9v"},
+    {"foob", "Zm9vYg=="}, {"fooba", "Zm9vYmE="}, {"foobar", "Zm9vYmFy"} };
+  int errors = 0;
+  char enc[1024], dec[1024];
+  for (int i = 0; i < (int)(sizeof(vectors) / sizeof(vectors[0])); i++)
+  {
+    const int len = (int)strlen(vectors[i][0]);
+    if (Base64::EncodeTo(vectors[i][0], len, enc, sizeof(enc), true) != (int)strlen(vectors[i][1]) || strcmp(enc, vectors[i][1]))
+      errors++;
+    if (Base64::DecodeTo(vectors[i][1], (int)strlen(vectors[i][1]), dec, sizeof(dec)) != len || memcmp(dec, vectors[i][0], len))
+      errors++;
+  }
+
+  unsigned char data[512];
+  for (int i = 0; i < 512; i++)
+    data[i] = (unsigned char)(i * 97 + 13);
+  for (int len = 0; len <= 512; len++)
+  {
+    for (int pad = 0; pad < 2; pad++)
+    {
+      const int n = Base64::EncodeTo((const char*)data, len, enc, sizeof(enc), pad != 0);
+      if (n != Base64::EncodedLength(len, pad != 0) || Base64::DecodeTo(enc, n, dec, sizeof(dec)) != len || memcmp(dec, data, len))
+        errors++;
+    }
+
+    // wrapped like in chunks, fed in pieces of 7 chars
+    WDL_FastString lines;
+    Base64::AppendLines(&lines, (const char*)data, len, 48);
+    Base64::Decoder decoder;
+    int n = 0;
+    for (int i = 0; n >= 0 && i < lines.GetLength(); i += 7)
+    {
+      const int m = decoder.Feed(lines.Get() + i, min(7, lines.GetLength() - i), dec + n, sizeof(dec) - n);
+      n = m < 0 ? -1 : n + m;
+    }
+    if (n >= 0)
+    {
+      const int m = decoder.Finish(dec + n, sizeof(dec) - n);
+      n = m < 0 ? -1 : n + m;
+    }
+    if (n != len || memcmp(dec, data, len))
+      errors++;
+  }
+
+  if (Base64::DecodeTo("QUJD\nREVG", 9, dec, sizeof(dec)) != -1 || Base64::DecodeTo("QU=JD", 5, dec, sizeof(dec)) != -1 ||
+      Base64::DecodeTo("QUJD", 4, dec, 2) != -1)
+    errors++;
+  return errors;
+}
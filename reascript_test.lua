@@ -235,3 +235,26 @@ if test8p==123456789 then
 else
   reaper.ShowConsoleMsg("KO !\n");
 end
+
+
+--   { APIFUNC(SNM_test9), "double", "int*", "mismatchesOut", "", },
+-- EEL: double extension_api("SNM_test9", int &mismatchesOut)
+-- Lua: number retval, number mismatchesOut reaper.SNM_test9()
+reaper.ShowConsoleMsg("SNM_test9 -- tempo map snapshot vs. TimeMap2 in the current project\n");
+test9r,test9p = reaper.SNM_test9();
+if test9r < 0.000001 and test9p == 0 then
+  reaper.ShowConsoleMsg("ok\n");
+else
+  reaper.ShowConsoleMsg("KO ! max error " .. test9r .. ", mismatches " .. test9p .. "\n");
+end
+
+
+--   { APIFUNC(SNM_test10), "int", "", "", "", },
+-- EEL: int extension_api("SNM_test10")
+-- Lua: integer reaper.SNM_test10()
+reaper.ShowConsoleMsg("SNM_test10 -- base64 codec\n");
+if reaper.SNM_test10() == 0 then
+  reaper.ShowConsoleMsg("ok\n");
+else
+  reaper.ShowConsoleMsg("KO !\n");
+end
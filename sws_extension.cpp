@@ -57,6 +57,8 @@
 #include "Wol/wol.h"
 #include "nofish/nofish.h"
 #include "snooks/snooks.h"
+#include "Utility/ArrangeIndex.h"
+#include "Utility/GuidIndex.h"
 
 #define LOCALIZE_IMPORT_PREFIX "sws_"
 #include <WDL/localize/localize-import.h>
@@ -372,6 +374,34 @@ void ActionsList(COMMAND_T*)
 }
 #endif
 
+// Startup profiler: time spent in each subsystem init (in REAPER_PLUGIN_ENTRYPOINT)
+struct SWS_StartupTiming
+{
+	const char* name;
+	double ms;
+};
+static vector<SWS_StartupTiming> g_startupTimings;
+
+static void AddStartupTiming(const char* name, double startTime)
+{
+	SWS_StartupTiming t = { name, (time_precise() - startTime) * 1000.0 };
+	g_startupTimings.push_back(t);
+}
+
+void ShowStartupTimings(COMMAND_T*)
+{
+	double total = 0.0;
+	for (size_t i = 0; i < g_startupTimings.size(); i++)
+		total += g_startupTimings[i].ms;
+
+	WDL_FastString report;
+	report.SetFormatted(128, "SWS startup timings (%d subsystems, %.2f ms):\n", (int)g_startupTimings.size(), total);
+	for (size_t i = 0; i < g_startupTimings.size(); i++)
+		report.AppendFormatted(256, "  %-16s %8.2f ms  %5.1f%%\n", g_startupTimings[i].name, g_startupTimings[i].ms,
+			total > 0.0 ? 100.0 * g_startupTimings[i].ms / total : 0.0);
+	ShowConsoleMsg(report.Get());
+}
+
 COMMAND_T** SWSGetCommand(const int index)
 {
 	return g_commands.EnumeratePtr(index);
@@ -500,7 +530,7 @@ public:
 		{
 			m_bChanged = false;
 			ScheduleTracklistUpdate();
-			g_pMarkerList->Update();
+			MarkerListUpdate();
 			UpdateSnapshotsDialog();
 			ProjectListUpdate();
 		}
@@ -526,6 +556,8 @@ public:
 	void SetTrackListChange()
 	{
 		m_bChanged = true;
+		ArrangeIndex_Invalidate();
+		GuidIndex_Invalidate();
 		AutoColorTrack(false);
 		AutoColorMarkerRegion(false);
 		SNM_CSurfSetTrackListChange();
@@ -658,6 +690,8 @@ void ErrMsg(const char* errmsg, bool wantblabla=true)
 #define IMPAPI(x)       if (!errcnt && !((*(void **)&(x)) = (void *)rec->GetFunc(#x))) errcnt++;
 #define IMPAP_OPT(x)    *((void **)&(x)) = (void *)rec->GetFunc(#x);
 #define ERR_RETURN(a)   { ErrMsg(a); goto error; }
+// calls a subsystem init and records its duration for ShowStartupTimings()
+#define TIMED_INIT(name, init) { const double t0 = time_precise(); const bool ok = !!(init); AddStartupTiming(name, t0); if (!ok) ERR_RETURN(name " init error.") }
 
 extern "C"
 {
@@ -1251,52 +1285,29 @@ error:
 			ERR_RETURN("Toggle action hook error.")
 
 		// Call plugin specific init
-		if (!AutoColorInit())
-			ERR_RETURN("Auto Color init error.")
-		if (!ColorInit())
-			ERR_RETURN("Color init error.")
-		if (!MarkerListInit())
-			ERR_RETURN("Marker list init error.")
-		if (!MarkerActionsInit())
-			ERR_RETURN("Marker action init error.")
-		if (!ConsoleInit())
-			ERR_RETURN("ReaConsole init error.")
-		if (!FreezeInit())
-			ERR_RETURN("Freeze init error.")
-		if (!SnapshotsInit()) // must be called before SNM_Init registers dynamic actions
-			ERR_RETURN("Snapshots init error.")
-		if (!TrackListInit())
-			ERR_RETURN("Tracklist init error.")
-		if (!ProjectListInit())
-			ERR_RETURN("Project List init error.")
-		if (!ProjectMgrInit())
-			ERR_RETURN("Project Mgr init error.")
-		if (!XenakiosInit())
-			ERR_RETURN("Xenakios init error.")
-		if (!MiscInit())
-			ERR_RETURN("Misc init error.")
-		if (!ZoomInit(false))
-			ERR_RETURN("Zoom init error.")
-		if(!FNGExtensionInit())
-			ERR_RETURN("Fingers init error.")
-		if (!PadreInit())
-			ERR_RETURN("Padre init error.")
-		if (!AboutBoxInit())
-			ERR_RETURN("About box init error.")
-		if (!AutorenderInit())
-			ERR_RETURN("Autorender init error.")
-		if (!IXInit())
-			ERR_RETURN("IX init error.")
-		if (!BR_Init())
-			ERR_RETURN("Breeder init error.")
-		if (!WOL_Init())
-			ERR_RETURN("Wol init error.")
-		if (!nofish_Init())
-			ERR_RETURN("nofish init error.")
-		if (!snooks_Init())
-			ERR_RETURN("snooks init error.")
-		if (!SNM_Init(rec)) // keep it as the last init (for cycle actions)
-			ERR_RETURN("S&M init error.")
+		TIMED_INIT("Auto Color", AutoColorInit())
+		TIMED_INIT("Color", ColorInit())
+		TIMED_INIT("Marker list", MarkerListInit())
+		TIMED_INIT("Marker action", MarkerActionsInit())
+		TIMED_INIT("ReaConsole", ConsoleInit())
+		TIMED_INIT("Freeze", FreezeInit())
+		TIMED_INIT("Snapshots", SnapshotsInit()) // must be called before SNM_Init registers dynamic actions
+		TIMED_INIT("Tracklist", TrackListInit())
+		TIMED_INIT("Project List", ProjectListInit())
+		TIMED_INIT("Project Mgr", ProjectMgrInit())
+		TIMED_INIT("Xenakios", XenakiosInit())
+		TIMED_INIT("Misc", MiscInit())
+		TIMED_INIT("Zoom", ZoomInit(false))
+		TIMED_INIT("Fingers", FNGExtensionInit())
+		TIMED_INIT("Padre", PadreInit())
+		TIMED_INIT("About box", AboutBoxInit())
+		TIMED_INIT("Autorender", AutorenderInit())
+		TIMED_INIT("IX", IXInit())
+		TIMED_INIT("Breeder", BR_Init())
+		TIMED_INIT("Wol", WOL_Init())
+		TIMED_INIT("nofish", nofish_Init())
+		TIMED_INIT("snooks", snooks_Init())
+		TIMED_INIT("S&M", SNM_Init(rec)) // keep it as the last init (for cycle actions)
 
 		// above specific inits went well
 		{
@@ -29,6 +29,7 @@
 #include "stdafx.h"
 
 #include "Breeder/BR_Util.h"
+#include "Utility/GuidIndex.h"
 
 #include <WDL/sha.h>
 #include <WDL/localize/localize.h>
@@ -490,21 +491,7 @@ const GUID* TrackToGuid(ReaProject* proj, MediaTrack* tr)
 
 MediaTrack* GuidToTrack(ReaProject* project, const GUID* guid)
 {
-	if (!guid)
-		return nullptr;
-
-	MediaTrack* master = GetMasterTrack(project);
-	if (master && TrackMatchesGuid(project, master, guid))
-		return master;
-
-	const int trackCount = CountTracks(project);
-	for (int i = 0; i < trackCount; ++i) {
-		MediaTrack* tr = GetTrack(project, i);
-		if (tr && TrackMatchesGuid(project, tr, guid))
-			return tr;
-	}
-
-	return nullptr;
+	return GuidIndex_FindTrack(project, guid);
 }
 
 bool GuidsEqual(const GUID* g1, const GUID* g2)
@@ -211,6 +211,7 @@ int SWSCreateRegisterDynamicCmd(int uniqueSectionId, int cmdId, void(*doCommand)
 bool SWSFreeUnregisterDynamicCmd(int id);
 
 void ActionsList(COMMAND_T*);
+void ShowStartupTimings(COMMAND_T*);
 int SWSGetCommandID(void (*cmdFunc)(COMMAND_T*), INT_PTR user = 0, const char** pMenuText = NULL);
 COMMAND_T** SWSGetCommand(int index);
 COMMAND_T* SWSGetCommandByID(int cmdId);
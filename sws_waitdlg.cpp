@@ -42,21 +42,30 @@
 
 const char SWS_WAITDLG_WNDPOS_KEY[] = "Wait Dialog Position";
 
-SWS_WaitDlg::SWS_WaitDlg(const char* cTitle, double* dProgress, HWND hParent)
+SWS_WaitDlg::SWS_WaitDlg(const char* cTitle, double* dProgress, HWND hParent, SWS_Mutex* pLock)
 {
 	m_hwnd = NULL;
 	m_dProgress = dProgress;
+	m_pLock = pLock;
 	m_cTitle = cTitle;
-	double dPrevProgress = *dProgress;
+	double dPrevProgress = GetProgress();
 	Sleep(0);
-	if (*dProgress - dPrevProgress < 0.10)
+	if (GetProgress() - dPrevProgress < 0.10)
 		// 10% done in one time slice?  Skip the dlg display.
 		DialogBoxParam(g_hInst, MAKEINTRESOURCE(IDD_SNM_WAIT), hParent ? hParent : g_hwndParent, sWaitDlgWndProc, (LPARAM)this);
 	// Block until process done if user-closed dlg
-	while (*dProgress < 1.0)
+	while (GetProgress() < 1.0)
 		Sleep(1);
 }
 
+double SWS_WaitDlg::GetProgress()
+{
+	if (!m_pLock)
+		return *m_dProgress;
+	SWS_SectionLock lock(m_pLock);
+	return *m_dProgress;
+}
+
 INT_PTR WINAPI SWS_WaitDlg::sWaitDlgWndProc(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lParam) // static
 {
 	SWS_WaitDlg* pObj = (SWS_WaitDlg*)GetWindowLongPtr(hwndDlg, GWLP_USERDATA);
@@ -82,16 +91,19 @@ int SWS_WaitDlg::waitDlgWndProc(UINT uMsg, WPARAM wParam, LPARAM lParam)
 			SetWindowText(m_hwnd, m_cTitle);
 			RestoreWindowPos(m_hwnd, SWS_WAITDLG_WNDPOS_KEY, false);
 			hProgress = GetDlgItem(m_hwnd, IDC_PROGRESS);
-			SendMessage(hProgress, PBM_SETPOS, (int)(*m_dProgress * 100.0), 0);
+			SendMessage(hProgress, PBM_SETPOS, (int)(GetProgress() * 100.0), 0);
 			SetTimer(m_hwnd, 1, 50, NULL);
 			break;
 		}
 		case WM_TIMER:
-			SendMessage(hProgress, PBM_SETPOS, (int)(*m_dProgress * 100.0)+1, 0); // Silly workaround for Win7 progress bar
-			SendMessage(hProgress, PBM_SETPOS, (int)(*m_dProgress * 100.0), 0);
-			if (*m_dProgress >= 1.0)
+		{
+			const double dProgress = GetProgress();
+			SendMessage(hProgress, PBM_SETPOS, (int)(dProgress * 100.0)+1, 0); // Silly workaround for Win7 progress bar
+			SendMessage(hProgress, PBM_SETPOS, (int)(dProgress * 100.0), 0);
+			if (dProgress >= 1.0)
 				SendMessage(m_hwnd, WM_COMMAND, IDCANCEL, 0);
 			break;
+		}
 		case WM_COMMAND:
 			switch (LOWORD(wParam))
 			{
@@ -30,12 +30,14 @@
 class SWS_WaitDlg
 {
 public:
-	SWS_WaitDlg(const char* cTitle, double* dProgress, HWND hParent = NULL);
+	SWS_WaitDlg(const char* cTitle, double* dProgress, HWND hParent = NULL, SWS_Mutex* pLock = NULL); // pLock: guards dProgress, if any
 	~SWS_WaitDlg() {}
 private:
+	double GetProgress();
 	static INT_PTR WINAPI sWaitDlgWndProc(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lParam); // static
 	int waitDlgWndProc(UINT uMsg, WPARAM wParam, LPARAM lParam);
 	const char* m_cTitle;
 	double* m_dProgress;
+	SWS_Mutex* m_pLock;
 	HWND m_hwnd;
 };
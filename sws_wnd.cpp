@@ -710,6 +710,16 @@ void SWS_SetDockWndState(const char* _stateBuf, int _len, SWS_DockWnd_State* _st
 // SWS_ListView
 ///////////////////////////////////////////////////////////////////////////////
 
+class SWS_ListViewRow
+{
+public:
+	SWS_ListViewRow(SWS_ListItem* item, int iCols) : m_item(item), m_iVersion(-1), m_cells(new WDL_FastString[iCols]) {}
+	~SWS_ListViewRow() { delete [] m_cells; }
+	SWS_ListItem* m_item;
+	int m_iVersion; // cells are up to date when equal to SWS_ListView::m_iVersion
+	WDL_FastString* m_cells; // data column order
+};
+
 SWS_ListView::SWS_ListView(HWND hwndList, HWND hwndEdit, int iCols, SWS_LVColumn* pCols, const char* cINIKey, bool bTooltips, const char* cLocalizeSection, bool bDrawArrow)
 :m_hwndList(hwndList), m_hwndEdit(hwndEdit), m_hwndTooltip(NULL), m_iSortCol(1), m_iEditingItem(-1), m_iEditingCol(-1),
   m_iCols(iCols), m_pCols(NULL), m_pDefaultCols(NULL), m_bDisableUpdates(false), m_cINIKey(cINIKey), m_cLocalizeSection(cLocalizeSection),m_bDrawArrow(bDrawArrow),
@@ -719,6 +729,9 @@ SWS_ListView::SWS_ListView(HWND hwndList, HWND hwndEdit, int iCols, SWS_LVColumn
   m_dwSavedSelTime(0),m_bShiftSel(false)
 #endif
 {
+	m_bVirtual = (GetWindowLong(hwndList, GWL_STYLE) & LVS_OWNERDATA) != 0;
+	m_iVersion = 0;
+	m_bVirtualResort = false;
 	memset(m_oldColors,0,sizeof(m_oldColors));
 	SetWindowLongPtr(hwndList, GWLP_USERDATA, (LONG_PTR)this);
 	if (m_hwndEdit)
@@ -811,12 +824,20 @@ SWS_ListView::SWS_ListView(HWND hwndList, HWND hwndEdit, int iCols, SWS_LVColumn
 SWS_ListView::~SWS_ListView()
 {
 	delete [] m_pCols;
+	m_vRows.Empty(true);
 }
 
 SWS_ListItem* SWS_ListView::GetListItem(int index, int* iState)
 {
 	if (index < 0)
 		return NULL;
+	if (m_bVirtual)
+	{
+		if (iState)
+			*iState = ListView_GetItemState(m_hwndList, index, LVIS_SELECTED | LVIS_FOCUSED);
+		SWS_ListViewRow* row = m_vRows.Get(index);
+		return row ? row->m_item : NULL;
+	}
 	LVITEM li;
 	li.mask = LVIF_PARAM | (iState ? LVIF_STATE : 0);
 	li.stateMask = LVIS_SELECTED | LVIS_FOCUSED;
@@ -843,23 +864,16 @@ SWS_ListItem* SWS_ListView::EnumSelected(int* i, int iOffset)
 	int temp = 0;
 	if (!i)
 		i = &temp;
-	LVITEM li;
-	li.mask = LVIF_PARAM | LVIF_STATE;
-	li.stateMask = LVIS_SELECTED;
-	li.iSubItem = 0;
 
 	while (*i < ListView_GetItemCount(m_hwndList))
 	{
-		li.iItem = (*i)++;
-		ListView_GetItem(m_hwndList, &li);
-		if (li.state)
+		int iState;
+		SWS_ListItem* item = GetListItem((*i)++, &iState);
+		if (iState & LVIS_SELECTED)
 		{
 			if ((iOffset != 0) && (((*i - 1) + iOffset) >= 0) && (((*i - 1) + iOffset) < ListView_GetItemCount(m_hwndList)))  //sanitizing
-			{
-				li.iItem += iOffset;  //this allows the selection of another item besides the one clicked.
-				ListView_GetItem(m_hwndList, &li);
-			}
-			return (SWS_ListItem*)li.lParam;
+				item = GetListItem((*i - 1) + iOffset);  //this allows the selection of another item besides the one clicked.
+			return item;
 		}
 	}
 	return NULL;
@@ -879,18 +893,22 @@ bool SWS_ListView::SelectByItem(SWS_ListItem* _item, bool bSelectOnly, bool bEns
 {
 	if (_item)
 	{
-		for (int i = 0; i < GetListItemCount(); i++)
+		int iItem = -1;
+		if (m_bVirtual)
+			iItem = m_vRowIdx.Get((INT_PTR)_item, -1);
+		else
+			for (int i = 0; iItem < 0 && i < GetListItemCount(); i++)
+				if (GetListItem(i) == _item)
+					iItem = i;
+
+		if (iItem >= 0)
 		{
-			SWS_ListItem* item = GetListItem(i);
-			if (item == _item)
-			{
-				if (bSelectOnly)
-					ListView_SetItemState(m_hwndList, -1, 0, LVIS_SELECTED);
-				ListView_SetItemState(m_hwndList, i, LVIS_SELECTED, LVIS_SELECTED);
-				if (bEnsureVisible)
-					ListView_EnsureVisible(m_hwndList, i, true);
-				return true;
-			}
+			if (bSelectOnly)
+				ListView_SetItemState(m_hwndList, -1, 0, LVIS_SELECTED);
+			ListView_SetItemState(m_hwndList, iItem, LVIS_SELECTED, LVIS_SELECTED);
+			if (bEnsureVisible)
+				ListView_EnsureVisible(m_hwndList, iItem, true);
+			return true;
 		}
 	}
 	return false;
@@ -900,7 +918,48 @@ int SWS_ListView::OnNotify(WPARAM wParam, LPARAM lParam)
 {
 	NMLISTVIEW* s = (NMLISTVIEW*)lParam;
 
+	if (m_bVirtual && (s->hdr.code == LVN_GETDISPINFO
+#ifdef _WIN32
+		|| s->hdr.code == LVN_GETDISPINFOW
+#endif
+		))
+	{
+		NMLVDISPINFO* di = (NMLVDISPINFO*)lParam;
+		if (di->item.mask & LVIF_TEXT)
+		{
+			lstrcpyn_safe(di->item.pszText, GetVirtualCellText(di->item.iItem, DisplayToDataCol(di->item.iSubItem)), di->item.cchTextMax);
+#ifdef _WIN32
+			if (s->hdr.code == LVN_GETDISPINFOW)
+				WDL_UTF8_ListViewConvertDispInfoToW(di);
+#endif
+		}
+		if (di->item.mask & LVIF_PARAM)
+			di->item.lParam = (LPARAM)GetListItem(di->item.iItem);
+		return 0;
+	}
+
 #ifdef _WIN32
+	// Owner data list views notify range selections with a single LVN_ODSTATECHANGED (and no LVN_ITEMCHANGING at all)
+	if (m_bVirtual && !m_bDisableUpdates && s->hdr.code == LVN_ODSTATECHANGED)
+	{
+		NMLVODSTATECHANGE* od = (NMLVODSTATECHANGE*)lParam;
+		if ((od->uNewState ^ od->uOldState) & LVIS_SELECTED)
+			for (int i = od->iFrom; i <= od->iTo; i++)
+				OnItemSelChanged(GetListItem(i), od->uNewState);
+		return 0;
+	}
+	if (m_bVirtual && !m_bDisableUpdates && s->hdr.code == LVN_ITEMCHANGED && s->iItem < 0)
+	{
+		if (s->uChanged & LVIF_STATE && (s->uNewState ^ s->uOldState) & LVIS_SELECTED)
+			for (int i = 0; i < ListView_GetItemCount(m_hwndList); i++)
+			{
+				int iState;
+				SWS_ListItem* item = GetListItem(i, &iState);
+				OnItemSelChanged(item, iState);
+			}
+		return 0;
+	}
+
 	if (!m_bDisableUpdates && s->hdr.code == LVN_ITEMCHANGING && s->iItem >= 0 && (s->uNewState ^ s->uOldState) & LVIS_SELECTED)
 	{
 		// These calls are made in big groups, save the cur state on the first call
@@ -1176,7 +1235,8 @@ void SWS_ListView::Update(const bool reassign)
 	if (m_iEditingItem == -1 && !m_bDisableUpdates)
 	{
 		m_bDisableUpdates = true;
-		SendMessage(m_hwndList, WM_SETREDRAW, 0, 0);
+		if (!m_bVirtual) // virtual lists only redraw changed rows
+			SendMessage(m_hwndList, WM_SETREDRAW, 0, 0);
 
 		char str[CELL_MAX_LEN]="";
 
@@ -1188,6 +1248,14 @@ void SWS_ListView::Update(const bool reassign)
 			bResort = true;
 		}
 
+		if (m_bVirtual)
+		{
+			UpdateVirtual(bResort || reassign);
+			UpdateTooltips();
+			m_bDisableUpdates = false;
+			return;
+		}
+
 		SWS_ListItemList items;
 		GetItemList(&items);
 
@@ -1298,41 +1366,251 @@ void SWS_ListView::Update(const bool reassign)
 		if (bResort)
 			Sort();
 
+		UpdateTooltips();
+
+		SendMessage(m_hwndList, WM_SETREDRAW, 1, 0);
 #ifdef _WIN32
-		if (m_hwndTooltip)
+		RedrawWindow(m_hwndList, nullptr, nullptr, RDW_ERASE | RDW_FRAME | RDW_INVALIDATE | RDW_ALLCHILDREN);
+#endif
+		m_bDisableUpdates = false;
+	}
+}
+
+void SWS_ListView::UpdateTooltips()
+{
+#ifdef _WIN32
+	if (m_hwndTooltip)
+	{
+		char str[CELL_MAX_LEN]="";
+		TOOLINFO ti = { sizeof(TOOLINFO), };
+		ti.lpszText = str;
+		ti.hwnd = m_hwndList;
+		ti.uFlags = TTF_SUBCLASS;
+		ti.hinst  = g_hInst;
+
+		// Delete all existing tools
+		while (SendMessage(m_hwndTooltip, TTM_ENUMTOOLS, 0, (LPARAM)&ti))
+			SendMessage(m_hwndTooltip, TTM_DELTOOL, 0, (LPARAM)&ti);
+
+		// Virtual lists: visible rows only
+		int iFirst = 0, iLast = ListView_GetItemCount(m_hwndList);
+		if (m_bVirtual)
 		{
-			TOOLINFO ti = { sizeof(TOOLINFO), };
-			ti.lpszText = str;
-			ti.hwnd = m_hwndList;
-			ti.uFlags = TTF_SUBCLASS;
-			ti.hinst  = g_hInst;
-
-			// Delete all existing tools
-			while (SendMessage(m_hwndTooltip, TTM_ENUMTOOLS, 0, (LPARAM)&ti))
-				SendMessage(m_hwndTooltip, TTM_DELTOOL, 0, (LPARAM)&ti);
-
-			RECT r;
-			// Add tooltips after sort
-			for (int i = 0; i < ListView_GetItemCount(m_hwndList); i++)
+			iFirst = ListView_GetTopIndex(m_hwndList);
+			iLast = min(iLast, iFirst + ListView_GetCountPerPage(m_hwndList) + 1);
+		}
+
+		RECT r;
+		// Add tooltips after sort
+		for (int i = iFirst; i < iLast; i++)
+		{
+			// Get the rect of the line
+			ListView_GetItemRect(m_hwndList, i, &r, LVIR_BOUNDS);
+			memcpy(&ti.rect, &r, sizeof(RECT));
+			ti.uId = i;
+			GetItemTooltip(GetListItem(i), str, sizeof(str));
+			SendMessage(m_hwndTooltip, TTM_ADDTOOL, 0, (LPARAM)&ti);
+		}
+	}
+#endif
+}
+
+// Re-renders a single item, e.g. when the derived class knows only this one has changed.
+// Virtual lists: the row is pulled again when drawn, a sort key change re-sorts on the next Update()
+void SWS_ListView::InvalidateItem(SWS_ListItem* item)
+{
+	if (!item || m_iEditingItem != -1 || m_bDisableUpdates)
+		return;
+
+	if (m_bVirtual)
+	{
+		int iRow = m_vRowIdx.Get((INT_PTR)item, -1);
+		if (SWS_ListViewRow* row = m_vRows.Get(iRow))
+		{
+			const int iSortCol = abs(m_iSortCol) - 1;
+			if (!m_bVirtualResort && iSortCol >= 0 && iSortCol < m_iCols)
 			{
-				// Get the rect of the line
-				ListView_GetItemRect(m_hwndList, i, &r, LVIR_BOUNDS);
-				memcpy(&ti.rect, &r, sizeof(RECT));
-				ti.uId = i;
-				GetItemTooltip(GetListItem(i), str, sizeof(str));
-				SendMessage(m_hwndTooltip, TTM_ADDTOOL, 0, (LPARAM)&ti);
+				char str[CELL_MAX_LEN] = "";
+				GetItemText(item, iSortCol, str, sizeof(str));
+				m_bVirtualResort = strcmp(str, row->m_cells[iSortCol].Get()) != 0;
 			}
+			row->m_iVersion = -1;
+			ListView_RedrawItems(m_hwndList, iRow, iRow);
 		}
-#endif
+		return;
+	}
 
-		SendMessage(m_hwndList, WM_SETREDRAW, 1, 0);
+	for (int i = 0; i < GetListItemCount(); i++)
+		if (GetListItem(i) == item)
+		{
+			char str[CELL_MAX_LEN], curStr[CELL_MAX_LEN];
+			for (int k = 0; k < m_iCols; k++)
+				if (m_pCols[k].iPos != -1)
+				{
+					str[0] = curStr[0] = 0;
+					GetItemText(item, k, str, sizeof(str));
+					ListView_GetItemText(m_hwndList, i, DataToDisplayCol(k), curStr, sizeof(curStr));
+					if (strcmp(str, curStr))
+						ListView_SetItemText(m_hwndList, i, DataToDisplayCol(k), str);
+				}
+			break;
+		}
+}
+
+// All texts may have changed (e.g. time format), virtual lists: rows are pulled again when
+// drawn and re-sorted on the next Update(). Not needed otherwise, Update() refreshes all rows
+void SWS_ListView::InvalidateAllItems()
+{
+	if (!m_bVirtual)
+		return;
+	m_iVersion++;
+	m_bVirtualResort = true;
+	InvalidateRect(m_hwndList, NULL, FALSE);
+}
+
+void SWS_ListView::UpdateVirtual(bool bResort)
+{
+	SWS_ListItemList items;
+	GetItemList(&items);
+
+	WDL_PtrKeyedArray<int> sel;
+	GetVirtualSel(&sel);
+
+	// Keep rows of existing items in place (already sorted), drop the others, append new ones.
+	// The item list is sorted by pointer, so this is O(n log n)
+	WDL_TypedBuf<char> used;
+	memset(used.ResizeOK(items.GetSize(), false), 0, items.GetSize());
+	WDL_PtrList<SWS_ListViewRow> rows;
+	bool bChanged = false;
+	for (int i = 0; i < m_vRows.GetSize(); i++)
+	{
+		SWS_ListViewRow* row = m_vRows.Get(i);
+		int iIndex = items.Find(row->m_item);
+		if (iIndex >= 0 && !used.Get()[iIndex])
+		{
+			used.Get()[iIndex] = 1;
+			rows.Add(row);
+		}
+		else
+		{
+			delete row;
+			bChanged = true;
+		}
+	}
+	for (int i = 0; i < items.GetSize(); i++)
+		if (!used.Get()[i])
+		{
+			rows.Add(new SWS_ListViewRow(items.Get(i), m_iCols));
+			bChanged = bResort = true;
+		}
+
+	if (bChanged)
+	{
+		m_vRows.Empty(false);
+		for (int i = 0; i < rows.GetSize(); i++)
+			m_vRows.Add(rows.Get(i));
+		IndexVirtualRows();
+		InvalidateRect(m_hwndList, NULL, FALSE); // rows have moved
+	}
+
+	if (ListView_GetItemCount(m_hwndList) != m_vRows.GetSize())
 #ifdef _WIN32
-		RedrawWindow(m_hwndList, nullptr, nullptr, RDW_ERASE | RDW_FRAME | RDW_INVALIDATE | RDW_ALLCHILDREN);
+		ListView_SetItemCountEx(m_hwndList, m_vRows.GetSize(), LVSICF_NOINVALIDATEALL | LVSICF_NOSCROLL);
+#else
+		ListView_SetItemCount(m_hwndList, m_vRows.GetSize());
 #endif
-		m_bDisableUpdates = false;
+
+	// Cells of existing rows are only refreshed when invalidated, see InvalidateItem()
+	bResort |= m_bVirtualResort;
+	m_bVirtualResort = false;
+	if (bResort)
+	{
+		const int iSortCol = abs(m_iSortCol) - 1;
+		SortVirtual();
+		SetListviewColumnArrows(m_iSortCol < 0 ? -(DataToDisplayCol(iSortCol) + 1) : DataToDisplayCol(iSortCol) + 1);
+		OnItemSortEnd();
+	}
+	if (bChanged || bResort)
+		SetVirtualSel(&sel);
+
+	for (int i = 0; i < m_vRows.GetSize(); i++)
+	{
+		int iNewState = GetItemState(m_vRows.Get(i)->m_item);
+		if (iNewState >= 0)
+		{
+			int iCurState = ListView_GetItemState(m_hwndList, i, LVIS_SELECTED | LVIS_FOCUSED);
+			if (iNewState && !(iCurState & LVIS_SELECTED))
+				ListView_SetItemState(m_hwndList, i, LVIS_SELECTED, LVIS_SELECTED);
+			else if (!iNewState && (iCurState & LVIS_SELECTED))
+				ListView_SetItemState(m_hwndList, i, 0, LVIS_SELECTED | (iCurState & LVIS_FOCUSED));
+		}
 	}
 }
 
+void SWS_ListView::SortVirtual()
+{
+	std::stable_sort(m_vRows.GetList(), m_vRows.GetList() + m_vRows.GetSize(),
+		[this](SWS_ListViewRow* row1, SWS_ListViewRow* row2) { return OnItemSort(row1->m_item, row2->m_item) < 0; });
+	IndexVirtualRows();
+	InvalidateRect(m_hwndList, NULL, FALSE);
+}
+
+void SWS_ListView::IndexVirtualRows()
+{
+	m_vRowIdx.DeleteAll();
+	for (int i = 0; i < m_vRows.GetSize(); i++)
+		m_vRowIdx.AddUnsorted((INT_PTR)m_vRows.Get(i)->m_item, i);
+	m_vRowIdx.Resort();
+}
+
+// Selection states are stored by index in owner data list views, these follow items across row changes
+void SWS_ListView::GetVirtualSel(WDL_PtrKeyedArray<int>* sel)
+{
+	sel->DeleteAll();
+	const int iCount = min(m_vRows.GetSize(), ListView_GetItemCount(m_hwndList));
+	for (int i = 0; i < iCount; i++)
+		if (int iState = ListView_GetItemState(m_hwndList, i, LVIS_SELECTED | LVIS_FOCUSED))
+			sel->AddUnsorted((INT_PTR)m_vRows.Get(i)->m_item, iState);
+	sel->Resort();
+}
+
+void SWS_ListView::SetVirtualSel(WDL_PtrKeyedArray<int>* sel)
+{
+	bool bSaveDisableUpdates = m_bDisableUpdates;
+	m_bDisableUpdates = true;
+	ListView_SetItemState(m_hwndList, -1, 0, LVIS_SELECTED | LVIS_FOCUSED);
+	for (int i = 0; i < sel->GetSize(); i++)
+	{
+		INT_PTR item;
+		int iState = sel->Enumerate(i, &item);
+		int iRow = m_vRowIdx.Get(item, -1);
+		if (iRow >= 0)
+			ListView_SetItemState(m_hwndList, iRow, iState, LVIS_SELECTED | LVIS_FOCUSED);
+	}
+	m_bDisableUpdates = bSaveDisableUpdates;
+}
+
+const char* SWS_ListView::GetVirtualCellText(int iRow, int iCol)
+{
+	SWS_ListViewRow* row = m_vRows.Get(iRow);
+	if (!row || iCol < 0 || iCol >= m_iCols)
+		return "";
+
+	if (row->m_iVersion != m_iVersion)
+	{
+		char str[CELL_MAX_LEN];
+		for (int k = 0; k < m_iCols; k++)
+			if (m_pCols[k].iPos != -1)
+			{
+				str[0] = 0;
+				GetItemText(row->m_item, k, str, sizeof(str));
+				row->m_cells[k].Set(str);
+			}
+		row->m_iVersion = m_iVersion;
+	}
+	return row->m_cells[iCol].Get();
+}
+
 // Return TRUE if a the column header was clicked
 bool SWS_ListView::DoColumnMenu(int x, int y)
 {
@@ -1467,6 +1745,13 @@ SWS_ListItem* SWS_ListView::GetHitItem(int x, int y, int* iCol)
 void SWS_ListView::EditListItem(SWS_ListItem* item, int iCol)
 {
 	// Convert to index and call edit
+	if (m_bVirtual)
+	{
+		int iItem = m_vRowIdx.Get((INT_PTR)item, -1);
+		if (iItem >= 0)
+			EditListItem(iItem, iCol);
+		return;
+	}
 #ifdef _WIN32
 	LVFINDINFO fi;
 	fi.flags = LVFI_PARAM;
@@ -1558,11 +1843,28 @@ bool SWS_ListView::EditListItemEnd(bool bSave, bool bResort)
 			{
 				SetItemText(item, editedCol, newStr);
 				GetItemText(item, editedCol, newStr, sizeof(newStr));
-				ListView_SetItemText(m_hwndList, m_iEditingItem, DataToDisplayCol(editedCol), newStr);
+				if (m_bVirtual)
+				{
+					if (SWS_ListViewRow* row = m_vRows.Get(m_iEditingItem))
+						row->m_iVersion = -1;
+					ListView_RedrawItems(m_hwndList, m_iEditingItem, m_iEditingItem);
+				}
+				else
+					ListView_SetItemText(m_hwndList, m_iEditingItem, DataToDisplayCol(editedCol), newStr);
 				updated = true;
 			}
 			if (bResort)
-				ListView_SortItems(m_hwndList, sListCompare, (LPARAM)this);
+			{
+				if (m_bVirtual)
+				{
+					WDL_PtrKeyedArray<int> sel;
+					GetVirtualSel(&sel);
+					SortVirtual();
+					SetVirtualSel(&sel);
+				}
+				else
+					ListView_SortItems(m_hwndList, sListCompare, (LPARAM)this);
+			}
 			// TODO resort? Just call update?
 			// Update is likely called when SetItemText is called too...
 		}
@@ -1624,7 +1926,15 @@ void SWS_ListView::ShowColumns()
 
 void SWS_ListView::Sort()
 {
-	ListView_SortItems(m_hwndList, sListCompare, (LPARAM)this);
+	if (m_bVirtual)
+	{
+		WDL_PtrKeyedArray<int> sel;
+		GetVirtualSel(&sel);
+		SortVirtual();
+		SetVirtualSel(&sel);
+	}
+	else
+		ListView_SortItems(m_hwndList, sListCompare, (LPARAM)this);
 	int iCol = abs(m_iSortCol) - 1;
 	iCol = DataToDisplayCol(iCol) + 1;
 	if (m_iSortCol < 0)
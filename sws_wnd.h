@@ -49,6 +49,7 @@ typedef struct SWS_LVColumn
 } SWS_LVColumn;
 
 class SWS_ListItem; // abstract.  At some point it might make sense to make this a real class?
+class SWS_ListViewRow; // virtual mode only, see sws_wnd.cpp
 
 class SWS_ListItemList
 {
@@ -87,6 +88,9 @@ public:
 	int EditingKeyHandler(MSG *msg);
 	int LVKeyHandler(MSG *msg, int iKeyState);
 	void Update(bool reassign = false);
+	void InvalidateItem(SWS_ListItem* item);
+	void InvalidateAllItems();
+	bool IsVirtual() { return m_bVirtual; }
 	bool DoColumnMenu(int x, int y);
 	bool HeaderHitTest(const POINT &) const;
 	SWS_ListItem* GetHitItem(int x, int y, int* iCol);
@@ -150,6 +154,7 @@ protected:
 private:
 	void ShowColumns();
 	void Sort();
+	void UpdateTooltips();
 
 #ifndef _WIN32
 	int m_iClickedCol;
@@ -162,6 +167,24 @@ private:
 	HWND m_hwndEdit;
 	SWS_LVColumn* m_pDefaultCols;
 	const char* m_cINIKey;
+
+	// Virtual mode, enabled by the LVS_OWNERDATA style: the list view only holds a row count,
+	// cell texts are pulled on demand (visible rows only) and cached until the row is invalidated.
+	// Update() only adds/removes rows: items changed in place must be passed to InvalidateItem()
+	// (or InvalidateAllItems()). Only worth it for lists with thousands of rows (Marker List),
+	// other lists keep the regular mode, their Update() compares all rows.
+	// Note: no OnItemSelChanging() calls in this mode on Windows
+	void UpdateVirtual(bool bResort);
+	void SortVirtual();
+	void IndexVirtualRows();
+	void GetVirtualSel(WDL_PtrKeyedArray<int>* sel);
+	void SetVirtualSel(WDL_PtrKeyedArray<int>* sel);
+	const char* GetVirtualCellText(int iRow, int iCol);
+	bool m_bVirtual;
+	int m_iVersion;
+	bool m_bVirtualResort;
+	WDL_PtrList<SWS_ListViewRow> m_vRows;
+	WDL_PtrKeyedArray<int> m_vRowIdx; // item -> row
 };
 
 #pragma pack(push, 4)